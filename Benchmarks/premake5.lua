@@ -0,0 +1,107 @@
+project "Benchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "off"
+
+	targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- The renderer loads its shaders from assets/
+	debugdir "%{wks.location}/Engine"
+
+	-- Everything of the engine except its entry point
+	files
+	{
+		"src/**.h",
+		"src/**.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/**.h",
+		"%{wks.location}/Engine/src/Nutcrackz/**.cpp"
+	}
+
+	removefiles
+	{
+		"%{wks.location}/Engine/src/Nutcrackz/Core/EntryPoint.cpp"
+	}
+
+	includedirs
+	{
+		"src",
+		"%{wks.location}/Engine/src",
+		"%{IncludeDir.glm}",
+		"%{IncludeDir.crosswindow}",
+		"%{IncludeDir.crosswindow_graphics}",
+	}
+
+	links
+	{
+		"CrossWindow"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+		defines
+		{
+			"WIN32",
+			"_CRT_SECURE_NO_WARNINGS",
+			"_SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING",
+			"XWIN_WIN32=1",
+			"XGFX_DIRECTX12=1",
+		}
+
+		removefiles
+		{
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/Vulkan/**"
+		}
+
+	filter "system:linux"
+		defines
+		{
+			"XWIN_XCB=1",
+			"XGFX_VULKAN=1",
+		}
+
+		removefiles
+		{
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/DirectX12*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/BindlessDescriptorHeap.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/ClusteredLighting.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/CommandCache.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/FenceTimeline.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/FrameReadback.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/HudRenderer.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/MaterialRegistry.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/PersistentBuffer.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/QueueScheduler.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/ResidencyManager.*",
+			"%{wks.location}/Engine/src/Nutcrackz/Renderer/TextureStreamer.*",
+		}
+
+		links
+		{
+			"%{Library.Vulkan}",
+			"%{Library.XCB}",
+			"pthread",
+		}
+
+		-- Engine compiles the SPIR-V shaders
+		dependson
+		{
+			"Engine"
+		}
+
+	filter "configurations:Debug"
+		defines "SDR_DEBUG"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "SDR_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "SDR_DIST"
+		runtime "Release"
+		optimize "on"
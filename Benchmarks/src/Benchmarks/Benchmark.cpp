@@ -0,0 +1,266 @@
+#include "Benchmarks/Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+// Helper functions
+
+namespace
+{
+volatile float s_Sink = 0.0f;
+
+// Nearest rank on sorted samples
+double Percentile(const std::vector<double>& sorted, double percentile)
+{
+    const size_t rank = static_cast<size_t>(std::ceil(percentile * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+BenchmarkResult Summarize(const std::string& name, const std::string& unit, std::vector<double> samples)
+{
+    BenchmarkResult result;
+    result.Name = name;
+    result.Unit = unit;
+    result.Repetitions = static_cast<uint32_t>(samples.size());
+
+    if (samples.empty())
+        return result;
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+
+    result.Mean = sum / samples.size();
+
+    double squares = 0.0;
+    for (double sample : samples)
+        squares += (sample - result.Mean) * (sample - result.Mean);
+
+    // Sample standard deviation, the repetitions are a sample of all runs
+    result.StdDev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0.0;
+
+    const size_t middle = samples.size() / 2;
+    result.Median = samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) * 0.5;
+
+    result.Min = samples.front();
+    result.Max = samples.back();
+    result.P95 = Percentile(samples, 0.95);
+
+    return result;
+}
+
+std::string EscapeJson(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+// Reads the name and median of every benchmark in a file written by
+// WriteJson. Not a general JSON parser, it relies on "median" following
+// "name" within each benchmark.
+std::unordered_map<std::string, double> ReadBaselineMedians(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open baseline " + path + "!");
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string json = buffer.str();
+
+    std::unordered_map<std::string, double> medians;
+
+    size_t position = json.find("\"benchmarks\"");
+    while (position != std::string::npos)
+    {
+        position = json.find("\"name\"", position);
+        if (position == std::string::npos)
+            break;
+
+        const size_t nameStart = json.find('"', json.find(':', position)) + 1;
+        const size_t nameEnd = json.find('"', nameStart);
+        const size_t nextName = json.find("\"name\"", nameEnd);
+        const size_t median = json.find("\"median\"", nameEnd);
+
+        if (nameStart == 0 || nameEnd == std::string::npos || median == std::string::npos || median > nextName)
+            throw std::runtime_error("malformed baseline " + path + "!");
+
+        medians[json.substr(nameStart, nameEnd - nameStart)] = std::strtod(json.c_str() + json.find(':', median) + 1, nullptr);
+        position = nameEnd;
+    }
+
+    return medians;
+}
+}
+
+// Benchmark Runner
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions& options)
+    : m_Options(options)
+{
+    m_Options.Repetitions = std::max(m_Options.Repetitions, 1u);
+}
+
+bool BenchmarkRunner::IsEnabled(const std::string& prefix) const
+{
+    const std::string& filter = m_Options.Filter;
+
+    // Either the filter selects a part of this group or the whole of it
+    return filter.empty() || filter.rfind(prefix, 0) == 0 || prefix.rfind(filter, 0) == 0;
+}
+
+bool BenchmarkRunner::PassesFilter(const std::string& name) const
+{
+    return m_Options.Filter.empty() || name.rfind(m_Options.Filter, 0) == 0;
+}
+
+void BenchmarkRunner::Run(const std::string& name, const std::string& unit, const std::function<double()>& sample)
+{
+    if (!PassesFilter(name))
+        return;
+
+    for (uint32_t i = 0; i < m_Options.Warmup; ++i)
+        sample();
+
+    std::vector<double> samples(m_Options.Repetitions);
+    for (double& value : samples)
+        value = sample();
+
+    m_Results.push_back(Summarize(name, unit, std::move(samples)));
+
+    const BenchmarkResult& result = m_Results.back();
+    std::cout << result.Name << ": " << result.Median << " " << result.Unit << " (+/- " << result.StdDev << ")\n";
+}
+
+void BenchmarkRunner::Add(const std::string& name, const std::string& unit, const std::vector<double>& samples)
+{
+    if (!PassesFilter(name) || samples.empty())
+        return;
+
+    m_Results.push_back(Summarize(name, unit, samples));
+}
+
+uint32_t BenchmarkRunner::CompareToBaseline(const std::string& path)
+{
+    const std::unordered_map<std::string, double> medians = ReadBaselineMedians(path);
+
+    uint32_t regressions = 0;
+    for (BenchmarkResult& result : m_Results)
+    {
+        auto baseline = medians.find(result.Name);
+        if (baseline == medians.end() || baseline->second <= 0.0)
+            continue;
+
+        result.BaselineMedian = baseline->second;
+        result.Change = result.Median / result.BaselineMedian - 1.0;
+        result.Regression = result.Change > m_Options.Threshold;
+
+        if (result.Regression)
+            regressions++;
+    }
+
+    return regressions;
+}
+
+void BenchmarkRunner::WriteJson(std::ostream& out, const std::string& backend) const
+{
+    char timestamp[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    uint32_t regressions = 0;
+    for (const BenchmarkResult& result : m_Results)
+        regressions += result.Regression ? 1 : 0;
+
+    out.precision(9);
+    out << "{\n";
+    out << "  \"version\": 1,\n";
+    out << "  \"timestamp\": \"" << timestamp << "\",\n";
+    out << "  \"backend\": \"" << EscapeJson(backend) << "\",\n";
+    out << "  \"warmup\": " << m_Options.Warmup << ",\n";
+    out << "  \"repetitions\": " << m_Options.Repetitions << ",\n";
+    out << "  \"threshold\": " << m_Options.Threshold << ",\n";
+    out << "  \"regressions\": " << regressions << ",\n";
+    out << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < m_Results.size(); ++i)
+    {
+        const BenchmarkResult& result = m_Results[i];
+
+        out << (i ? ",\n" : "\n") << "    {\n";
+        out << "      \"name\": \"" << EscapeJson(result.Name) << "\",\n";
+        out << "      \"unit\": \"" << EscapeJson(result.Unit) << "\",\n";
+        out << "      \"repetitions\": " << result.Repetitions << ",\n";
+        out << "      \"min\": " << result.Min << ",\n";
+        out << "      \"median\": " << result.Median << ",\n";
+        out << "      \"mean\": " << result.Mean << ",\n";
+        out << "      \"stddev\": " << result.StdDev << ",\n";
+        out << "      \"p95\": " << result.P95 << ",\n";
+        out << "      \"max\": " << result.Max;
+
+        if (result.BaselineMedian > 0.0)
+        {
+            out << ",\n      \"baseline_median\": " << result.BaselineMedian << ",\n";
+            out << "      \"change\": " << result.Change << ",\n";
+            out << "      \"regression\": " << (result.Regression ? "true" : "false");
+        }
+
+        out << "\n    }";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+void BenchmarkRunner::PrintTable(std::ostream& out) const
+{
+    char line[256];
+    snprintf(line, sizeof(line), "%-32s %12s %12s %12s %6s %10s\n", "Benchmark", "Median", "StdDev", "P95", "Unit", "Change");
+    out << "\n" << line;
+
+    for (const BenchmarkResult& result : m_Results)
+    {
+        char change[32] = "";
+        if (result.BaselineMedian > 0.0)
+            snprintf(change, sizeof(change), "%+.1f%%%s", result.Change * 100.0, result.Regression ? " !" : "");
+
+        snprintf(line, sizeof(line), "%-32s %12.4g %12.4g %12.4g %6s %10s\n", result.Name.c_str(), result.Median, result.StdDev,
+                 result.P95, result.Unit.c_str(), change);
+        out << line;
+    }
+}
+
+// Timing helpers
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double NanosecondsPerOperation(std::chrono::steady_clock::time_point start, uint64_t operations)
+{
+    const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return nanoseconds / std::max<uint64_t>(operations, 1);
+}
+
+void DoNotOptimize(float value)
+{
+    s_Sink = value;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Benchmarks
+
+struct BenchmarkOptions
+{
+    // Only benchmarks whose name starts with this run, empty runs all
+    std::string Filter;
+
+    // Untimed samples before the timed ones, to warm caches, allocators and
+    // the GPU's clocks
+    uint32_t Warmup = 2;
+
+    // Timed samples per benchmark
+    uint32_t Repetitions = 10;
+
+    // Relative slowdown of the median over the baseline's median that counts
+    // as a regression
+    double Threshold = 0.1;
+};
+
+struct BenchmarkResult
+{
+    std::string Name;
+
+    // Unit of every statistic below, lower is better
+    std::string Unit;
+
+    uint32_t Repetitions = 0;
+
+    double Min = 0.0;
+    double Median = 0.0;
+    double Mean = 0.0;
+    double StdDev = 0.0;
+    double P95 = 0.0;
+    double Max = 0.0;
+
+    // Filled in by CompareToBaseline. BaselineMedian is 0 when the baseline
+    // doesn't have this benchmark, Change is relative, positive is slower.
+    double BaselineMedian = 0.0;
+    double Change = 0.0;
+    bool Regression = false;
+};
+
+// Runs benchmarks as they are called and keeps their statistics. A benchmark
+// is a function returning one sample, usually the time per operation of a
+// batch of operations, and is called Warmup + Repetitions times.
+class BenchmarkRunner
+{
+  public:
+    BenchmarkRunner(const BenchmarkOptions& options);
+
+    // Whether any benchmark under this name prefix passes the filter. Lets
+    // suites skip expensive setup such as creating a device.
+    bool IsEnabled(const std::string& prefix) const;
+
+    void Run(const std::string& name, const std::string& unit, const std::function<double()>& sample);
+
+    // Record samples measured elsewhere, such as GPU times collected while
+    // another benchmark ran
+    void Add(const std::string& name, const std::string& unit, const std::vector<double>& samples);
+
+    // Read a file written by WriteJson and compare every result against it.
+    // Returns the number of regressions.
+    uint32_t CompareToBaseline(const std::string& path);
+
+    // Machine readable results, backend names the graphics API
+    void WriteJson(std::ostream& out, const std::string& backend) const;
+
+    // Human readable results
+    void PrintTable(std::ostream& out) const;
+
+    const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+  protected:
+    bool PassesFilter(const std::string& name) const;
+
+    BenchmarkOptions m_Options;
+    std::vector<BenchmarkResult> m_Results;
+};
+
+// Timing helpers
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start);
+
+double NanosecondsPerOperation(std::chrono::steady_clock::time_point start, uint64_t operations);
+
+// Keeps the optimizer from removing work whose result is otherwise unused
+void DoNotOptimize(float value);
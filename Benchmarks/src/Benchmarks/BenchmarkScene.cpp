@@ -0,0 +1,68 @@
+#include "Benchmarks/BenchmarkScene.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Benchmark Scene
+
+BenchmarkScene CreateGridScene(uint32_t objectCount, MaterialHandle material, unsigned width, unsigned height)
+{
+    BenchmarkScene scene;
+    scene.Objects.resize(objectCount);
+
+    // Same density at every size, the camera backs off to keep it all in view
+    const uint32_t side = std::max(static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(objectCount)))), 1u);
+    const float half = (side - 1) * 0.5f;
+
+    for (uint32_t i = 0; i < objectCount; ++i)
+    {
+        const glm::vec3 position = glm::vec3(float(i % side) - half, float((i / side) % side) - half, float(i / (side * side)));
+
+        SceneObject& object = scene.Objects[i];
+        object.Transform = glm::scale(glm::translate(glm::identity<glm::mat4>(), position), glm::vec3(0.3f));
+        object.BoundsCenter[0] = position.x;
+        object.BoundsCenter[1] = position.y;
+        object.BoundsCenter[2] = position.z;
+        object.BoundsRadius = 0.45f;
+        object.MaterialIndex = material;
+    }
+
+    scene.Constants.ProjectionMatrix = glm::perspective(45.0f, (float)width / (float)height, 0.01f, 1024.0f);
+    scene.Constants.ViewMatrix = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, 0.0f, side * 1.5f + 2.0f));
+
+    return scene;
+}
+
+void FillSceneFrame(FrameSnapshot& frame, const BenchmarkScene& scene, unsigned width, unsigned height, uint32_t firstUpdate, uint32_t updateCount, uint32_t drawCount)
+{
+    frame.View.Width = width;
+    frame.View.Height = height;
+    frame.Constants = scene.Constants;
+
+    const uint32_t objectCount = static_cast<uint32_t>(scene.Objects.size());
+    if (objectCount == 0)
+        return;
+
+    const glm::mat4 spin = glm::rotate(glm::identity<glm::mat4>(), float(frame.FrameNumber % 628) * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    updateCount = std::min(updateCount, objectCount);
+    for (uint32_t i = 0; i < updateCount; ++i)
+    {
+        SceneObjectUpdate update;
+        update.Index = (firstUpdate + i) % objectCount;
+        update.Object = scene.Objects[update.Index];
+        update.Object.Transform = update.Object.Transform * spin;
+        frame.ObjectUpdates.push_back(update);
+    }
+
+    drawCount = std::min(drawCount, objectCount);
+    for (uint32_t i = 0; i < drawCount; ++i)
+    {
+        DrawPacket draw;
+        draw.IndexCount = 3;
+        draw.ObjectIndex = i;
+        frame.Draws.push_back(draw);
+    }
+}
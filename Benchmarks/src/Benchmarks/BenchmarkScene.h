@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Nutcrackz/Renderer/FrameSnapshot.h"
+
+#include <cstdint>
+#include <vector>
+
+// Benchmark Scene
+
+// Objects on a cubic grid in front of the camera, every one a draw of the
+// renderer's triangle
+struct BenchmarkScene
+{
+    std::vector<SceneObject> Objects;
+    FrameConstants Constants;
+};
+
+BenchmarkScene CreateGridScene(uint32_t objectCount, MaterialHandle material, unsigned width, unsigned height);
+
+// Fill frame with the scene's view, updates of updateCount objects starting
+// at firstUpdate, wrapping around, and draws of the first drawCount objects.
+// Updated objects turn a little with every frame number.
+void FillSceneFrame(FrameSnapshot& frame, const BenchmarkScene& scene, unsigned width, unsigned height, uint32_t firstUpdate, uint32_t updateCount, uint32_t drawCount);
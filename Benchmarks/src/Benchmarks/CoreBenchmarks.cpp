@@ -0,0 +1,373 @@
+#include "Benchmarks/BenchmarkScene.h"
+#include "Benchmarks/Suites.h"
+
+#include "Nutcrackz/Core/SPSCQueue.h"
+#include "Nutcrackz/Renderer/PerformanceHud.h"
+#include "Nutcrackz/Renderer/ResidencyPlanner.h"
+#include "Nutcrackz/Scene/SceneFile.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <filesystem>
+#include <random>
+#include <thread>
+
+// Helper functions
+
+namespace
+{
+// Operations per sample, enough that timer resolution doesn't matter
+const uint32_t s_MathOperations = 1 << 16;
+
+std::vector<glm::mat4> CreateRandomMatrices(uint32_t count)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<glm::mat4> matrices(count);
+    for (glm::mat4& matrix : matrices)
+    {
+        const glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 2.0f, 0.0f));
+        matrix = glm::translate(glm::identity<glm::mat4>(), glm::vec3(unit(random), unit(random), unit(random)) * 10.0f);
+        matrix = glm::rotate(matrix, unit(random) * 3.14159265f, axis);
+        matrix = glm::scale(matrix, glm::vec3(1.5f + unit(random)));
+    }
+
+    return matrices;
+}
+}
+
+// Math
+
+void RunMathBenchmarks(BenchmarkRunner& runner)
+{
+    if (!runner.IsEnabled("math/"))
+        return;
+
+    // Small enough to stay in cache, these measure the math and not memory
+    const uint32_t count = 1024;
+    const std::vector<glm::mat4> matrices = CreateRandomMatrices(count);
+
+    std::mt19937 random(4321);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<glm::vec3> points(count);
+    for (glm::vec3& point : points)
+        point = glm::vec3(unit(random), unit(random), unit(random)) * 10.0f;
+
+    runner.Run("math/mat4_multiply", "ns", [&]() {
+        glm::mat4 result = glm::identity<glm::mat4>();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_MathOperations; ++i)
+        {
+            // Renormalize now and then so the chain neither overflows nor
+            // turns into denormals
+            result = matrices[i % count] * result;
+            if ((i & 7) == 7)
+                result = matrices[(i * 7) % count];
+        }
+        const double nanoseconds = NanosecondsPerOperation(start, s_MathOperations);
+
+        DoNotOptimize(result[3][0]);
+        return nanoseconds;
+    });
+
+    runner.Run("math/mat4_inverse", "ns", [&]() {
+        float sum = 0.0f;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_MathOperations; ++i)
+            sum += glm::inverse(matrices[i % count])[3][0];
+        const double nanoseconds = NanosecondsPerOperation(start, s_MathOperations);
+
+        DoNotOptimize(sum);
+        return nanoseconds;
+    });
+
+    // Translate, rotate and scale into an object's transform, as the game
+    // thread does for every moving object
+    runner.Run("math/transform_compose", "ns", [&]() {
+        float sum = 0.0f;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_MathOperations; ++i)
+        {
+            const glm::vec3& point = points[i % count];
+
+            glm::mat4 transform = glm::translate(glm::identity<glm::mat4>(), point);
+            transform = glm::rotate(transform, point.x, glm::vec3(0.0f, 1.0f, 0.0f));
+            transform = glm::scale(transform, glm::vec3(0.5f));
+            sum += transform[3][0];
+        }
+        const double nanoseconds = NanosecondsPerOperation(start, s_MathOperations);
+
+        DoNotOptimize(sum);
+        return nanoseconds;
+    });
+
+    runner.Run("math/transform_points", "ns", [&]() {
+        glm::vec4 sum = glm::vec4(0.0f);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_MathOperations; ++i)
+            sum += matrices[(i >> 4) % count] * glm::vec4(points[i % count], 1.0f);
+        const double nanoseconds = NanosecondsPerOperation(start, s_MathOperations);
+
+        DoNotOptimize(sum.x + sum.y + sum.z);
+        return nanoseconds;
+    });
+
+    // Model view projection of every object, what culling or a CPU side
+    // transform pass costs per object
+    runner.Run("math/model_view_projection", "ns", [&]() {
+        const glm::mat4 projection = glm::perspective(45.0f, 16.0f / 9.0f, 0.01f, 1024.0f);
+        const glm::mat4 view = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, 0.0f, 20.0f));
+        const glm::mat4 viewProjection = projection * view;
+
+        float sum = 0.0f;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_MathOperations; ++i)
+            sum += (viewProjection * matrices[i % count])[3][3];
+        const double nanoseconds = NanosecondsPerOperation(start, s_MathOperations);
+
+        DoNotOptimize(sum);
+        return nanoseconds;
+    });
+}
+
+// Allocation
+
+void RunAllocationBenchmarks(BenchmarkRunner& runner)
+{
+    if (!runner.IsEnabled("alloc/"))
+        return;
+
+    const uint32_t objectCount = 10000;
+    const BenchmarkScene scene = CreateGridScene(objectCount, 0, 1280, 720);
+
+    // Steady state frames reuse the snapshot's capacity
+    FrameSnapshot reused;
+    runner.Run("alloc/snapshot_reuse_10k", "us", [&]() {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            reused.Clear();
+            reused.FrameNumber = i;
+            FillSceneFrame(reused, scene, 1280, 720, 0, objectCount, objectCount);
+        }
+        return NanosecondsPerOperation(start, 16) / 1000.0;
+    });
+
+    // What every frame would cost if snapshots were built from scratch
+    runner.Run("alloc/snapshot_fresh_10k", "us", [&]() {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            FrameSnapshot fresh;
+            fresh.FrameNumber = i;
+            FillSceneFrame(fresh, scene, 1280, 720, 0, objectCount, objectCount);
+            DoNotOptimize(static_cast<float>(fresh.Draws.size()));
+        }
+        return NanosecondsPerOperation(start, 16) / 1000.0;
+    });
+
+    // Handing indices from one thread to another, as RenderThread does with
+    // snapshots
+    runner.Run("alloc/spsc_handoff", "ns", [&]() {
+        const uint32_t count = 1 << 18;
+        SPSCQueue<uint32_t, 256> queue;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        std::thread consumer([&queue, count]() {
+            uint32_t sum = 0;
+            for (uint32_t i = 0; i < count; ++i)
+                sum += queue.Pop();
+
+            DoNotOptimize(static_cast<float>(sum));
+        });
+
+        for (uint32_t i = 0; i < count; ++i)
+            queue.Push(i);
+
+        consumer.join();
+        return NanosecondsPerOperation(start, count);
+    });
+}
+
+// Residency
+
+void RunResidencyBenchmarks(BenchmarkRunner& runner)
+{
+    if (!runner.IsEnabled("residency/"))
+        return;
+
+    // 10k objects of 1 MiB with room for 6k, each frame uses a window of 2k
+    // that slides along, so every frame evicts some and brings some back.
+    // The OS is simulated: usage is what the planner keeps resident.
+    const uint32_t objectCount = 10000;
+    const uint32_t workingSet = 2000;
+    const uint64_t objectSize = 1024 * 1024;
+
+    ResidencyPlanner planner;
+    std::vector<ResidencyHandle> objects(objectCount);
+    for (ResidencyHandle& object : objects)
+        object = planner.Add(objectSize);
+
+    uint64_t fenceValue = 1;
+    auto simulateFrame = [&](uint64_t budget) {
+        const ResidencyStats& stats = planner.GetStats();
+
+        ResidencyBudget simulated;
+        simulated.Budget = budget;
+        simulated.Usage = stats.TrackedBytes - stats.EvictedBytes;
+        planner.UpdateBudget(simulated);
+
+        const uint32_t first = static_cast<uint32_t>(fenceValue * 97 % objectCount);
+        for (uint32_t i = 0; i < workingSet; ++i)
+            planner.MarkUsed(objects[(first + i) % objectCount], fenceValue);
+
+        // Two frames in flight
+        const ResidencyPlan& plan = planner.Plan(fenceValue, fenceValue > 2 ? fenceValue - 2 : 0);
+        fenceValue++;
+
+        return plan.Evict.size() + plan.MakeResident.size();
+    };
+
+    runner.Run("residency/plan_10k", "us", [&]() {
+        size_t changes = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < 16; ++i)
+            changes += simulateFrame(6000 * objectSize);
+
+        DoNotOptimize(static_cast<float>(changes));
+        return NanosecondsPerOperation(start, 16) / 1000.0;
+    });
+
+    // The budget halving under a full working set, then recovering
+    runner.Run("residency/budget_drop_10k", "us", [&]() {
+        size_t changes = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        changes += simulateFrame(3000 * objectSize);
+        changes += simulateFrame(6000 * objectSize);
+
+        DoNotOptimize(static_cast<float>(changes));
+        return NanosecondsPerOperation(start, 2) / 1000.0;
+    });
+}
+
+// HUD
+
+void RunHudBenchmarks(BenchmarkRunner& runner)
+{
+    if (!runner.IsEnabled("hud/"))
+        return;
+
+    // Full graphs and every stat filled in, as after a couple of seconds
+    PerformanceHud hud;
+
+    HudFrameStats stats;
+    stats.Draws = 10000;
+    stats.Triangles = 2500000;
+    stats.ResolutionScale = 0.85f;
+    stats.TextureResidentBytes = 180ull * 1024 * 1024;
+    stats.TextureBudgetBytes = 256ull * 1024 * 1024;
+    stats.VideoMemoryUsageBytes = 1200ull * 1024 * 1024;
+    stats.VideoMemoryBudgetBytes = 3500ull * 1024 * 1024;
+
+    for (uint32_t i = 0; i < PerformanceHud::s_HistoryLength; ++i)
+    {
+        stats.CpuFrameMs = 8.0f + (i % 7);
+        stats.GpuFrameMs = 12.0f + (i % 5);
+        hud.AddFrame(stats);
+    }
+
+    // Laying out the quads the renderer copies into its upload ring
+    runner.Run("hud/layout_1080p", "us", [&]() {
+        size_t quads = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < 64; ++i)
+            quads += hud.Build(1920, 1080).GetQuads().size();
+
+        DoNotOptimize(static_cast<float>(quads));
+        return NanosecondsPerOperation(start, 64) / 1000.0;
+    });
+}
+
+// Scene Loading
+
+void RunSceneLoadBenchmarks(BenchmarkRunner& runner)
+{
+    if (!runner.IsEnabled("load/"))
+        return;
+
+    const uint32_t objectCounts[] = { 1000, 10000, 100000 };
+    const char* names[] = { "load/scene_1k", "load/scene_10k", "load/scene_100k" };
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        if (!runner.IsEnabled(names[i]))
+            continue;
+
+        // Groups of ten objects under a parent each, with a handful of
+        // materials. Loads come from the OS file cache, the first run after
+        // writing the file pays for the disk.
+        const uint32_t objectCount = objectCounts[i];
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / ("benchmark_" + std::to_string(objectCount) + ".nscene");
+
+        {
+            std::mt19937 random(1234);
+            std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+            SceneFileBuilder builder;
+            const uint32_t mesh = builder.AddMesh("triangle", 3, 0, 0);
+
+            uint32_t materials[8];
+            for (uint32_t material = 0; material < 8; ++material)
+                materials[material] = builder.AddMaterial("material_" + std::to_string(material), glm::vec4(unit(random), unit(random), unit(random), 1.0f));
+
+            AABB bounds;
+            bounds.Min = glm::vec3(-0.5f);
+            bounds.Max = glm::vec3(0.5f);
+
+            uint32_t parent = s_SceneFileNone;
+            for (uint32_t object = 0; object < objectCount; ++object)
+            {
+                const glm::vec3 position = glm::vec3(unit(random), unit(random), unit(random)) * 100.0f;
+                const glm::mat4 transform = glm::translate(glm::identity<glm::mat4>(), position);
+
+                if (object % 10 == 0)
+                    parent = builder.AddEntity("group_" + std::to_string(object / 10), s_SceneFileNone, transform, s_SceneFileNone, s_SceneFileNone, bounds);
+                else
+                    builder.AddEntity("object_" + std::to_string(object), parent, transform, mesh, materials[object % 8], bounds);
+            }
+
+            builder.Write(path.string());
+        }
+
+        // Map, check and fix up, what a level load waits for before it can
+        // hand the world transforms to the renderer
+        auto load = [&path](bool verifyChecksum) {
+            const auto start = std::chrono::steady_clock::now();
+
+            SceneFile scene(path.string(), verifyChecksum);
+            scene.ResolveMaterials([](const SceneFileMaterial& material) { return static_cast<uint32_t>(material.Roughness * 4.0f); });
+
+            DoNotOptimize(scene.GetWorldTransforms()[scene.GetEntityCount() - 1][3].x);
+            return MillisecondsSince(start);
+        };
+
+        runner.Run(names[i], "ms", [&]() { return load(true); });
+
+        // What the checksum costs
+        if (objectCount == 100000)
+            runner.Run(std::string(names[i]) + "/unverified", "ms", [&]() { return load(false); });
+
+        std::filesystem::remove(path);
+    }
+}
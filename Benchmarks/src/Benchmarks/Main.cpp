@@ -0,0 +1,138 @@
+#include "Benchmarks/Benchmark.h"
+#include "Benchmarks/Suites.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Helper functions
+
+namespace
+{
+struct RunOptions
+{
+    BenchmarkOptions Benchmarks;
+    HeadlessDesc Headless;
+
+    std::string Output = "benchmark_results.json";
+    std::string Baseline;
+
+    // Only the benchmarks that need no GPU
+    bool CpuOnly = false;
+};
+
+void PrintUsage()
+{
+    std::cout << "Usage:\n"
+                 "  Benchmarks [options]\n"
+                 "\n"
+                 "Options:\n"
+                 "  --filter <prefix>         Only run benchmarks whose name starts with it, e.g. scene/\n"
+                 "  --repetitions <count>     Timed samples per benchmark (default 10)\n"
+                 "  --warmup <count>          Untimed samples before them (default 2)\n"
+                 "  --output <path>           JSON results (default benchmark_results.json)\n"
+                 "  --baseline <path>         Compare against an earlier results file\n"
+                 "  --threshold <fraction>    Median slowdown that is a regression (default 0.1)\n"
+                 "  --software                Render on a software rasterizer\n"
+                 "  --cpu-only                Skip everything that needs a renderer\n"
+                 "\n"
+                 "Exits with 2 when a benchmark regressed against the baseline.\n";
+}
+
+bool ParseArguments(int argc, const char** argv, RunOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--filter" && hasValue)
+            options.Benchmarks.Filter = argv[++i];
+        else if (argument == "--repetitions" && hasValue)
+            options.Benchmarks.Repetitions = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (argument == "--warmup" && hasValue)
+            options.Benchmarks.Warmup = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (argument == "--output" && hasValue)
+            options.Output = argv[++i];
+        else if (argument == "--baseline" && hasValue)
+            options.Baseline = argv[++i];
+        else if (argument == "--threshold" && hasValue)
+            options.Benchmarks.Threshold = std::atof(argv[++i]);
+        else if (argument == "--software")
+            options.Headless.UseSoftwareRasterizer = true;
+        else if (argument == "--cpu-only")
+            options.CpuOnly = true;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+const char* GetBackendName()
+{
+#if defined(XGFX_VULKAN)
+    return "Vulkan";
+#else
+    return "DirectX 12";
+#endif
+}
+}
+
+int main(int argc, const char** argv)
+{
+    RunOptions options;
+
+    if (!ParseArguments(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    try
+    {
+        BenchmarkRunner runner(options.Benchmarks);
+
+        RunMathBenchmarks(runner);
+        RunAllocationBenchmarks(runner);
+        RunResidencyBenchmarks(runner);
+        RunHudBenchmarks(runner);
+        RunLightBenchmarks(runner);
+        RunBVHBenchmarks(runner);
+        RunSceneLoadBenchmarks(runner);
+
+        if (!options.CpuOnly)
+        {
+            RunRendererBenchmarks(runner, options.Headless);
+            RunSceneBenchmarks(runner, options.Headless);
+        }
+
+        uint32_t regressions = 0;
+        if (!options.Baseline.empty())
+            regressions = runner.CompareToBaseline(options.Baseline);
+
+        runner.PrintTable(std::cout);
+
+        std::ofstream output(options.Output);
+        if (!output.is_open())
+            throw std::runtime_error("failed to open " + options.Output + "!");
+
+        runner.WriteJson(output, GetBackendName());
+        std::cout << "\nWrote " << runner.GetResults().size() << " results to " << options.Output << "\n";
+
+        if (regressions > 0)
+        {
+            std::cout << regressions << " benchmarks regressed by more than " << options.Benchmarks.Threshold * 100.0
+                      << "% against " << options.Baseline << "\n";
+            return 2;
+        }
+
+        return 0;
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
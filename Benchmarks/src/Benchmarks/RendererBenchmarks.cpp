@@ -0,0 +1,154 @@
+#include "Benchmarks/BenchmarkScene.h"
+#include "Benchmarks/Suites.h"
+
+#include "Nutcrackz/Renderer/Renderer.h"
+#include "Nutcrackz/Renderer/RenderThread.h"
+
+// Helper functions
+
+namespace
+{
+// Frames averaged into each sample
+const uint32_t s_FramesPerSample = 16;
+
+// Objects the upload and recording benchmarks work with
+const uint32_t s_ObjectCount = 10000;
+
+double Milliseconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+}
+
+// Renderer
+
+void RunRendererBenchmarks(BenchmarkRunner& runner, const HeadlessDesc& desc)
+{
+    if (!runner.IsEnabled("upload/") && !runner.IsEnabled("record/") && !runner.IsEnabled("frame/"))
+        return;
+
+    Renderer renderer(desc);
+
+    const MaterialHandle material = renderer.CreateMaterial(MaterialDesc());
+    const BenchmarkScene scene = CreateGridScene(s_ObjectCount, material, desc.Width, desc.Height);
+
+    FrameSnapshot frame;
+    uint64_t frameNumber = 0;
+
+    // Average CPU time of RenderFrame over frameCount frames, without the
+    // time it spent waiting for the GPU to finish an earlier frame
+    auto renderCpuMs = [&](uint32_t updateCount, uint32_t drawCount, uint32_t frameCount) {
+        double totalMs = 0.0;
+
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            frame.Clear();
+            frame.FrameNumber = frameNumber++;
+            FillSceneFrame(frame, scene, desc.Width, desc.Height, 0, updateCount, drawCount);
+
+            const auto start = std::chrono::steady_clock::now();
+            renderer.RenderFrame(frame);
+            totalMs += MillisecondsSince(start) - Milliseconds(renderer.GetLastFenceWait());
+        }
+
+        return totalMs / frameCount;
+    };
+
+    // Every draw needs its object in the scene buffer
+    renderCpuMs(s_ObjectCount, 0, 1);
+
+    // Upload
+    runner.Run("upload/scene_objects_1k", "ms", [&]() { return renderCpuMs(1000, 1, s_FramesPerSample); });
+    runner.Run("upload/scene_objects_10k", "ms", [&]() { return renderCpuMs(10000, 1, s_FramesPerSample); });
+
+    if (runner.IsEnabled("upload/materials"))
+    {
+        std::vector<MaterialHandle> materials;
+        for (uint32_t i = 0; i < 1000; ++i)
+            materials.push_back(renderer.CreateMaterial(MaterialDesc()));
+
+        // Editing the base color of every material, then the frame that
+        // uploads them
+        runner.Run("upload/materials_1k", "ms", [&]() {
+            double totalMs = 0.0;
+
+            for (uint32_t i = 0; i < s_FramesPerSample; ++i)
+            {
+                MaterialDesc materialDesc;
+                materialDesc.BaseColor = glm::vec4(float(i % 2), 0.5f, 0.5f, 1.0f);
+
+                const auto start = std::chrono::steady_clock::now();
+                for (MaterialHandle handle : materials)
+                    renderer.UpdateMaterial(handle, materialDesc);
+                totalMs += MillisecondsSince(start);
+
+                totalMs += renderCpuMs(0, 1, 1);
+            }
+
+            return totalMs / s_FramesPerSample;
+        });
+
+        for (MaterialHandle handle : materials)
+            renderer.DestroyMaterial(handle);
+    }
+
+    // Command recording. Unchanged draw lists may be replayed rather than
+    // recorded again where the backend caches them, which is part of what
+    // is measured.
+    runner.Run("record/draws_1k", "ms", [&]() { return renderCpuMs(0, 1000, s_FramesPerSample); });
+    runner.Run("record/draws_10k", "ms", [&]() { return renderCpuMs(0, 10000, s_FramesPerSample); });
+
+    // A tenth of the objects moving every frame keeps invalidating the draw
+    // list
+    runner.Run("record/draws_10k_moving", "ms", [&]() {
+        double totalMs = 0.0;
+
+        for (uint32_t i = 0; i < s_FramesPerSample; ++i)
+        {
+            frame.Clear();
+            frame.FrameNumber = frameNumber++;
+            FillSceneFrame(frame, scene, desc.Width, desc.Height, static_cast<uint32_t>(frameNumber * 1000 % s_ObjectCount), 1000, s_ObjectCount);
+
+            const auto start = std::chrono::steady_clock::now();
+            renderer.RenderFrame(frame);
+            totalMs += MillisecondsSince(start) - Milliseconds(renderer.GetLastFenceWait());
+        }
+
+        return totalMs / s_FramesPerSample;
+    });
+
+    // Frame loop
+
+    // Wall time per frame of the game thread driving the render thread, GPU
+    // waits included. With little to draw this is the overhead of the loop
+    // itself.
+    runner.Run("frame/render_thread", "ms", [&]() {
+        RenderThread renderThread(renderer, 1);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_FramesPerSample; ++i)
+        {
+            FrameSnapshot& threadFrame = renderThread.BeginFrame();
+            threadFrame.FrameNumber = frameNumber++;
+            FillSceneFrame(threadFrame, scene, desc.Width, desc.Height, 0, 1, 1);
+            renderThread.EndFrame();
+        }
+
+        renderThread.Stop();
+        return MillisecondsSince(start) / s_FramesPerSample;
+    });
+
+    // The same frames rendered on the calling thread
+    runner.Run("frame/render_frame", "ms", [&]() {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_FramesPerSample; ++i)
+        {
+            frame.Clear();
+            frame.FrameNumber = frameNumber++;
+            FillSceneFrame(frame, scene, desc.Width, desc.Height, 0, 1, 1);
+            renderer.RenderFrame(frame);
+        }
+
+        return MillisecondsSince(start) / s_FramesPerSample;
+    });
+}
@@ -0,0 +1,72 @@
+#include "Benchmarks/BenchmarkScene.h"
+#include "Benchmarks/Suites.h"
+
+#include "Nutcrackz/Renderer/Renderer.h"
+
+#include <algorithm>
+#include <string>
+
+// Helper functions
+
+namespace
+{
+// Frames averaged into each sample
+const uint32_t s_FramesPerSample = 8;
+
+void RunScene(BenchmarkRunner& runner, const HeadlessDesc& desc, uint32_t objectCount, const std::string& name)
+{
+    // A renderer per scene, so one scene's buffers don't carry over into the
+    // next
+    Renderer renderer(desc);
+
+    const MaterialHandle material = renderer.CreateMaterial(MaterialDesc());
+    const BenchmarkScene scene = CreateGridScene(objectCount, material, desc.Width, desc.Height);
+
+    // Like a frame of gameplay, a tenth of the objects move every frame
+    const uint32_t movingCount = std::max(objectCount / 10, 1u);
+
+    FrameSnapshot frame;
+    uint64_t frameNumber = 0;
+
+    // Upload the whole scene first
+    FillSceneFrame(frame, scene, desc.Width, desc.Height, 0, objectCount, objectCount);
+    renderer.RenderFrame(frame);
+
+    std::vector<double> gpuMs;
+
+    runner.Run(name, "ms", [&]() {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_FramesPerSample; ++i)
+        {
+            frame.Clear();
+            frame.FrameNumber = ++frameNumber;
+            FillSceneFrame(frame, scene, desc.Width, desc.Height, static_cast<uint32_t>(frameNumber * movingCount % objectCount), movingCount, objectCount);
+            renderer.RenderFrame(frame);
+        }
+
+        // The GPU time of a frame that finished during this sample, 0 where
+        // the device has no timestamps
+        if (renderer.GetLastGpuFrameMs() > 0.0f)
+            gpuMs.push_back(renderer.GetLastGpuFrameMs());
+
+        return MillisecondsSince(start) / s_FramesPerSample;
+    });
+
+    // Includes the warmup samples, which are already past the first upload
+    runner.Add(name + "/gpu", "ms", gpuMs);
+}
+}
+
+// Scenes
+
+void RunSceneBenchmarks(BenchmarkRunner& runner, const HeadlessDesc& desc)
+{
+    const uint32_t objectCounts[] = { 1000, 10000, 100000 };
+    const char* names[] = { "scene/1k", "scene/10k", "scene/100k" };
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        if (runner.IsEnabled(names[i]))
+            RunScene(runner, desc, objectCounts[i], names[i]);
+    }
+}
@@ -0,0 +1,235 @@
+#include "Benchmarks/Suites.h"
+
+#include "Nutcrackz/Renderer/LightBinner.h"
+#include "Nutcrackz/Scene/DynamicBVH.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+
+// Helper functions
+
+namespace
+{
+// Queries per sample, enough that timer resolution doesn't matter
+const uint32_t s_RayCount = 10000;
+const uint32_t s_BoxQueryCount = 1000;
+
+// Lights scattered through a city block sized box around the origin
+std::vector<PointLight> CreateRandomLights(uint32_t count)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<PointLight> lights(count);
+    for (PointLight& light : lights)
+    {
+        light.Position = (glm::vec3(unit(random), unit(random), unit(random)) * 2.0f - 1.0f) * glm::vec3(100.0f, 20.0f, 100.0f);
+        light.Radius = 1.0f + 7.0f * unit(random);
+        light.Color = glm::vec3(unit(random), unit(random), unit(random));
+        light.Intensity = 1.0f;
+    }
+
+    return lights;
+}
+
+void RunBVH(BenchmarkRunner& runner, uint32_t objectCount, const std::string& name)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    auto randomPoint = [&](float side) {
+        return glm::vec3(unit(random), unit(random), unit(random)) * side;
+    };
+
+    auto randomDirection = [&]() {
+        return glm::vec3(unit(random), unit(random), unit(random)) * 2.0f - 1.0f;
+    };
+
+    // Objects keep the same density at every size
+    const float side = 4.0f * std::cbrt(static_cast<float>(objectCount));
+
+    std::vector<AABB> bounds(objectCount);
+    for (AABB& box : bounds)
+    {
+        const glm::vec3 center = randomPoint(side);
+        const glm::vec3 halfSize = glm::vec3(0.5f + unit(random));
+        box = { center - halfSize, center + halfSize };
+    }
+
+    // The same queries in every sample, made up front so they aren't timed
+    std::vector<BVHRay> rays(s_RayCount);
+    for (BVHRay& ray : rays)
+    {
+        ray.Origin = randomPoint(side);
+        ray.Direction = randomDirection();
+        ray.MaxDistance = 50.0f;
+    }
+
+    // Packets of four rays from one origin in nearly the same direction
+    std::vector<BVHRay> packetRays(s_RayCount);
+    for (uint32_t i = 0; i < s_RayCount; i += 4)
+    {
+        const glm::vec3 origin = randomPoint(side);
+        const glm::vec3 direction = randomDirection();
+
+        for (uint32_t j = i; j < i + 4; ++j)
+        {
+            packetRays[j].Origin = origin;
+            packetRays[j].Direction = direction + randomDirection() * 0.01f;
+            packetRays[j].MaxDistance = 50.0f;
+        }
+    }
+
+    std::vector<glm::vec3> boxCorners(s_BoxQueryCount);
+    for (glm::vec3& corner : boxCorners)
+        corner = randomPoint(side);
+
+    std::vector<glm::vec3> offsets(objectCount / 10);
+    for (glm::vec3& offset : offsets)
+        offset = randomDirection() * 0.1f;
+
+    // Filling an empty tree, as a level load does. A tree of its own, the
+    // queries below run on one built whatever the filter.
+    runner.Run(name + "/insert", "ms", [&]() {
+        DynamicBVH scratch;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < objectCount; ++i)
+            scratch.Insert(bounds[i], i);
+        return MillisecondsSince(start);
+    });
+
+    DynamicBVH bvh;
+    std::vector<BVHProxy> proxies(objectCount);
+    for (uint32_t i = 0; i < objectCount; ++i)
+        proxies[i] = bvh.Insert(bounds[i], i);
+
+    runner.Run(name + "/rebuild", "ms", [&]() {
+        const auto start = std::chrono::steady_clock::now();
+        bvh.Rebuild();
+        return MillisecondsSince(start);
+    });
+
+    runner.Run(name + "/raycast", "ns", [&]() {
+        uint32_t hitCount = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const BVHRay& ray : rays)
+        {
+            BVHRayHit hit;
+            hitCount += bvh.RayCast(ray, hit) ? 1 : 0;
+        }
+        const double nanoseconds = NanosecondsPerOperation(start, s_RayCount);
+
+        DoNotOptimize(static_cast<float>(hitCount));
+        return nanoseconds;
+    });
+
+    // Per ray, to compare with single rays
+    runner.Run(name + "/raycast_packet", "ns", [&]() {
+        uint32_t hitCount = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < s_RayCount; i += 4)
+        {
+            const BVHRay packet[4] = { packetRays[i], packetRays[i + 1], packetRays[i + 2], packetRays[i + 3] };
+
+            BVHRayHit hits[4];
+            hitCount += bvh.RayCastPacket(packet, hits);
+        }
+        const double nanoseconds = NanosecondsPerOperation(start, s_RayCount);
+
+        DoNotOptimize(static_cast<float>(hitCount));
+        return nanoseconds;
+    });
+
+    // Boxes of 8 units, about what a gameplay proximity query covers
+    std::vector<BVHProxy> results;
+    runner.Run(name + "/query_aabb", "ns", [&]() {
+        size_t resultCount = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const glm::vec3& corner : boxCorners)
+        {
+            results.clear();
+            bvh.QueryAABB({ corner, corner + glm::vec3(8.0f) }, results);
+            resultCount += results.size();
+        }
+        const double nanoseconds = NanosecondsPerOperation(start, s_BoxQueryCount);
+
+        DoNotOptimize(static_cast<float>(resultCount));
+        return nanoseconds;
+    });
+
+    // A tenth of the objects moving a little, as in a frame of gameplay.
+    // Every other sample moves them back, so the tree doesn't drift.
+    float direction = 1.0f;
+    runner.Run(name + "/move_10pct", "ms", [&]() {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < objectCount / 10; ++i)
+        {
+            AABB box = bvh.GetBounds(proxies[i]);
+            box.Min = box.Min + offsets[i] * direction;
+            box.Max = box.Max + offsets[i] * direction;
+            bvh.Move(proxies[i], box);
+        }
+        const double milliseconds = MillisecondsSince(start);
+
+        direction = -direction;
+        return milliseconds;
+    });
+}
+}
+
+// Lights
+
+void RunLightBenchmarks(BenchmarkRunner& runner)
+{
+    if (!runner.IsEnabled("lights/"))
+        return;
+
+    const uint32_t lightCounts[] = { 1024, 16384 };
+    const char* names[] = { "lights/bin_1k", "lights/bin_16k" };
+
+    ThreadPool threadPool;
+
+    const glm::mat4 projection = glm::perspective(45.0f, 1280.0f / 720.0f, 0.01f, 1024.0f);
+    const glm::mat4 view = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, 0.0f, 100.0f));
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        if (!runner.IsEnabled(names[i]))
+            continue;
+
+        // A binner per count, the warmup samples size its buffers
+        LightBinner binner;
+        const std::vector<PointLight> lights = CreateRandomLights(lightCounts[i]);
+
+        runner.Run(names[i], "ms", [&]() {
+            const auto start = std::chrono::steady_clock::now();
+            binner.Bin(lights, view, projection, threadPool);
+            const double milliseconds = MillisecondsSince(start);
+
+            DoNotOptimize(static_cast<float>(binner.GetStats().IndexCount));
+            return milliseconds;
+        });
+    }
+}
+
+// BVH
+
+void RunBVHBenchmarks(BenchmarkRunner& runner)
+{
+    const uint32_t objectCounts[] = { 10000, 100000, 1000000 };
+    const char* names[] = { "bvh/10k", "bvh/100k", "bvh/1m" };
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        // With the slash, so "bvh/100k" doesn't also build the 10k tree
+        if (runner.IsEnabled(std::string(names[i]) + "/"))
+            RunBVH(runner, objectCounts[i], names[i]);
+    }
+}
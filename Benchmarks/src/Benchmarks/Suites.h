@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Benchmarks/Benchmark.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+
+// Benchmark Suites
+
+// Matrix and transform math, "math/"
+void RunMathBenchmarks(BenchmarkRunner& runner);
+
+// Frame snapshot and queue allocation paths, "alloc/"
+void RunAllocationBenchmarks(BenchmarkRunner& runner);
+
+// Residency planning against a simulated video memory budget, "residency/"
+void RunResidencyBenchmarks(BenchmarkRunner& runner);
+
+// Laying out the performance HUD, "hud/"
+void RunHudBenchmarks(BenchmarkRunner& runner);
+
+// Binning 1k and 16k point lights into the clusters of a view, "lights/"
+void RunLightBenchmarks(BenchmarkRunner& runner);
+
+// Inserts, rebuilds, ray casts, box queries and moves on a dynamic BVH of
+// 10k, 100k and 1M objects, "bvh/"
+void RunBVHBenchmarks(BenchmarkRunner& runner);
+
+// Mapping and checking scene files of 1k, 10k and 100k objects, "load/"
+void RunSceneLoadBenchmarks(BenchmarkRunner& runner);
+
+// Scene and material uploads, command recording and the frame loop on a
+// headless renderer, "upload/", "record/" and "frame/". Times are CPU time,
+// waits on the GPU are left out unless noted.
+void RunRendererBenchmarks(BenchmarkRunner& runner, const HeadlessDesc& desc);
+
+// Whole frames of 1k, 10k and 100k object scenes on a headless renderer,
+// "scene/"
+void RunSceneBenchmarks(BenchmarkRunner& runner, const HeadlessDesc& desc);
@@ -0,0 +1,64 @@
+project "Checks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "off"
+
+	targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- Only the engine's plain C++ subsystems, nothing here needs a GPU
+	files
+	{
+		"src/**.h",
+		"src/**.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/FixedVector.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/LinearArena.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/LinearArena.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/MemoryTracking.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/MemoryTracking.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/ThreadPool.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/ThreadPool.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/HudLayout.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/HudLayout.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/QueuePlanner.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/QueuePlanner.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/RendererCommon.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/ResidencyPlanner.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/ResidencyPlanner.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/ResolutionController.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/ResolutionController.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/TextureFile.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/TextureFile.cpp"
+	}
+
+	includedirs
+	{
+		"src",
+		"%{wks.location}/Engine/src",
+		"%{IncludeDir.glm}"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "system:linux"
+		links
+		{
+			"pthread"
+		}
+
+	filter "configurations:Debug"
+		defines "SDR_DEBUG"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "SDR_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "SDR_DIST"
+		runtime "Release"
+		optimize "on"
@@ -0,0 +1,44 @@
+#include "Checks/Check.h"
+
+#include <exception>
+
+// Checks
+
+CheckRunner::CheckRunner(const std::string& filter, std::ostream& out)
+    : m_Filter(filter), m_Out(out)
+{
+}
+
+void CheckRunner::Run(const std::string& name, const std::function<void(CheckRunner&)>& check)
+{
+    if (name.compare(0, m_Filter.size(), m_Filter) != 0)
+        return;
+
+    m_Current = name;
+    m_CurrentFailures = 0;
+
+    try
+    {
+        check(*this);
+    }
+    catch (std::exception& e)
+    {
+        Expect(false, std::string("no exception, got: ") + e.what());
+    }
+
+    m_RunCount++;
+
+    if (m_CurrentFailures > 0)
+        m_FailedCount++;
+    else
+        m_Out << "ok    " << name << "\n";
+}
+
+void CheckRunner::Expect(bool condition, const std::string& description)
+{
+    if (condition)
+        return;
+
+    m_Out << "FAIL  " << m_Current << ": expected " << description << "\n";
+    m_CurrentFailures++;
+}
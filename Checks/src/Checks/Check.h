@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+// Checks
+
+// Runs behaviour checks of the engine's plain C++ subsystems and counts their
+// failures. A check is a function stating what it expects through Expect,
+// every unmet expectation fails it and is printed with the check's name.
+class CheckRunner
+{
+  public:
+    // Only checks whose name starts with filter run, empty runs all
+    CheckRunner(const std::string& filter, std::ostream& out);
+
+    // A check that throws fails too
+    void Run(const std::string& name, const std::function<void(CheckRunner&)>& check);
+
+    // Fail the running check unless condition holds, description says what
+    // was expected
+    void Expect(bool condition, const std::string& description);
+
+    uint32_t GetRunCount() const { return m_RunCount; }
+    uint32_t GetFailedCount() const { return m_FailedCount; }
+
+  protected:
+    std::string m_Filter;
+    std::ostream& m_Out;
+
+    std::string m_Current;
+    uint32_t m_CurrentFailures = 0;
+
+    uint32_t m_RunCount = 0;
+    uint32_t m_FailedCount = 0;
+};
@@ -0,0 +1,141 @@
+#include "Checks/Suites.h"
+
+#include "Nutcrackz/Renderer/HudLayout.h"
+
+#include <string>
+
+// Helper functions
+
+namespace
+{
+const uint32_t s_White = HudColor(255, 255, 255);
+
+bool IsRect(const HudQuad& quad, float x, float y, float width, float height)
+{
+    return quad.Rect[0] == x && quad.Rect[1] == y && quad.Rect[2] == width && quad.Rect[3] == height;
+}
+
+bool SamplesGlyph(const HudQuad& quad, char character)
+{
+    float x, y;
+    HudFont::GetGlyphOrigin(character, x, y);
+
+    return quad.TexelRect[0] == x && quad.TexelRect[1] == y && quad.TexelRect[2] == float(HudFont::s_GlyphWidth) &&
+           quad.TexelRect[3] == float(HudFont::s_GlyphHeight);
+}
+
+bool IsAtlasTexelSet(const std::vector<uint32_t>& atlas, uint32_t x, uint32_t y)
+{
+    const uint32_t texel = y * HudFont::s_AtlasWidth + x;
+    return (atlas[texel / 32] >> (texel % 32) & 1) != 0;
+}
+}
+
+// HUD Layout
+
+void RunHudChecks(CheckRunner& runner)
+{
+    // A quad per glyph at the pen position, spaces only advance it
+    runner.Run("hud/text_quads", [](CheckRunner& check) {
+        HudLayout layout(2);
+        const float width = layout.AddText(10.0f, 20.0f, "ab c", s_White);
+
+        const std::vector<HudQuad>& quads = layout.GetQuads();
+        check.Expect(quads.size() == 3, "3 quads, got " + std::to_string(quads.size()));
+        check.Expect(width == 48.0f, "a width of 4 cells of 12 pixels, got " + std::to_string(width));
+
+        if (quads.size() != 3)
+            return;
+
+        check.Expect(IsRect(quads[0], 10.0f, 20.0f, 10.0f, 14.0f), "a at the pen, the glyph scaled by 2");
+        check.Expect(IsRect(quads[1], 22.0f, 20.0f, 10.0f, 14.0f), "b one cell right of a");
+        check.Expect(IsRect(quads[2], 46.0f, 20.0f, 10.0f, 14.0f), "c after the space");
+        check.Expect(SamplesGlyph(quads[0], 'a') && SamplesGlyph(quads[1], 'b') && SamplesGlyph(quads[2], 'c'), "each quad sampling its glyph");
+        check.Expect(quads[0].Color == s_White, "the text's color");
+    });
+
+    // A newline returns to the left edge one line down, the width is the
+    // widest line's
+    runner.Run("hud/text_lines", [](CheckRunner& check) {
+        HudLayout layout(1);
+        const float width = layout.AddText(4.0f, 8.0f, "a\nbcd\ne", s_White);
+
+        const std::vector<HudQuad>& quads = layout.GetQuads();
+        check.Expect(quads.size() == 5, "5 quads, got " + std::to_string(quads.size()));
+        check.Expect(width == 18.0f, "the width of bcd, got " + std::to_string(width));
+
+        if (quads.size() != 5)
+            return;
+
+        check.Expect(IsRect(quads[1], 4.0f, 16.0f, 5.0f, 7.0f), "b at the left edge of the second line");
+        check.Expect(IsRect(quads[4], 4.0f, 24.0f, 5.0f, 7.0f), "e at the left edge of the third line");
+    });
+
+    // Characters outside the atlas show up as a question mark
+    runner.Run("hud/unknown_character", [](CheckRunner& check) {
+        HudLayout layout;
+        layout.AddText(0.0f, 0.0f, "\x01\xe9", s_White);
+
+        const std::vector<HudQuad>& quads = layout.GetQuads();
+        check.Expect(quads.size() == 2 && SamplesGlyph(quads[0], '?') && SamplesGlyph(quads[1], '?'), "two question marks");
+    });
+
+    // Bars are bottom aligned, oldest value first, clamped at the maximum,
+    // and empty values add no quad
+    runner.Run("hud/graph_bars", [](CheckRunner& check) {
+        HudLayout layout;
+
+        // Ring buffer whose oldest value is at index 2
+        const float values[] = { 10.0f, 0.0f, 5.0f, 40.0f };
+        layout.AddGraph(100.0f, 50.0f, 40.0f, 20.0f, values, 4, 2, 20.0f, s_White);
+
+        const std::vector<HudQuad>& quads = layout.GetQuads();
+        check.Expect(quads.size() == 3, "3 bars, the empty value skipped, got " + std::to_string(quads.size()));
+
+        if (quads.size() != 3)
+            return;
+
+        check.Expect(IsRect(quads[0], 100.0f, 65.0f, 10.0f, 5.0f), "the oldest value, 5, first at a quarter height");
+        check.Expect(IsRect(quads[1], 110.0f, 50.0f, 10.0f, 20.0f), "40 clamped to the full height");
+        check.Expect(IsRect(quads[2], 120.0f, 60.0f, 10.0f, 10.0f), "10 at half height");
+        check.Expect(quads[0].TexelRect[2] == 0.0f && quads[0].TexelRect[3] == 0.0f, "bars sampling a single texel");
+    });
+
+    // The quads past the GPU buffers' capacity are counted and dropped, Clear
+    // starts over
+    runner.Run("hud/quad_limit", [](CheckRunner& check) {
+        HudLayout layout;
+        for (uint32_t i = 0; i < HudLayout::s_MaxQuads + 10; ++i)
+            layout.AddRect(0.0f, 0.0f, 1.0f, 1.0f, s_White);
+
+        check.Expect(layout.GetQuads().size() == HudLayout::s_MaxQuads, "s_MaxQuads quads kept");
+        check.Expect(layout.GetDroppedQuads() == 10, "10 dropped, got " + std::to_string(layout.GetDroppedQuads()));
+
+        layout.Clear();
+        check.Expect(layout.GetQuads().empty() && layout.GetDroppedQuads() == 0, "nothing left after Clear");
+    });
+
+    // Rectangles sample the middle of the solid glyph, which has to be set
+    // in the atlas, and a space's cell is empty
+    runner.Run("hud/atlas", [](CheckRunner& check) {
+        const std::vector<uint32_t> atlas = HudFont::BuildAtlas();
+        check.Expect(atlas.size() * 32 >= HudFont::s_AtlasWidth * HudFont::s_AtlasHeight, "an atlas covering every texel");
+
+        HudLayout layout;
+        layout.AddRect(0.0f, 0.0f, 8.0f, 8.0f, s_White);
+        const HudQuad& quad = layout.GetQuads().front();
+        check.Expect(IsAtlasTexelSet(atlas, uint32_t(quad.TexelRect[0]), uint32_t(quad.TexelRect[1])), "the texel rectangles sample set");
+
+        float x, y;
+        HudFont::GetGlyphOrigin(' ', x, y);
+
+        bool spaceEmpty = true;
+        for (uint32_t row = 0; row < HudFont::s_CellHeight; ++row)
+        {
+            for (uint32_t column = 0; column < HudFont::s_CellWidth; ++column)
+                spaceEmpty = spaceEmpty && !IsAtlasTexelSet(atlas, uint32_t(x) + column, uint32_t(y) + row);
+        }
+
+        check.Expect(spaceEmpty, "an empty space glyph");
+    });
+}
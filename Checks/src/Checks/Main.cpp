@@ -0,0 +1,53 @@
+#include "Checks/Check.h"
+#include "Checks/Suites.h"
+
+#include <iostream>
+#include <string>
+
+// Helper functions
+
+namespace
+{
+void PrintUsage()
+{
+    std::cout << "Usage:\n"
+                 "  Checks [options]\n"
+                 "\n"
+                 "Options:\n"
+                 "  --filter <prefix>         Only run checks whose name starts with it, e.g. resolution/\n"
+                 "\n"
+                 "Exits with 1 when a check failed.\n";
+}
+}
+
+int main(int argc, const char** argv)
+{
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+
+        if (argument == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    CheckRunner runner(filter, std::cout);
+
+    RunResolutionChecks(runner);
+    RunScheduleChecks(runner);
+    RunResidencyChecks(runner);
+    RunHudChecks(runner);
+    RunThreadPoolChecks(runner);
+    RunTextureFileChecks(runner);
+
+    std::cout << "\n" << runner.GetRunCount() << " checks, " << runner.GetFailedCount() << " failed\n";
+    return runner.GetFailedCount() > 0 ? 1 : 0;
+}
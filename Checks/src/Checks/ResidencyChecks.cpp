@@ -0,0 +1,127 @@
+#include "Checks/Suites.h"
+
+#include "Nutcrackz/Renderer/ResidencyPlanner.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+
+// Helper functions
+
+namespace
+{
+const uint64_t s_ObjectSize = 100;
+
+// Four objects of s_ObjectSize, used in the order D, C, B, A by the
+// submissions with fences 1 to 4, so the least recently used order is the
+// reverse of their creation order
+struct ResidencyScene
+{
+    ResidencyPlanner Planner;
+    ResidencyHandle A, B, C, D;
+
+    ResidencyScene()
+    {
+        A = Planner.Add(s_ObjectSize);
+        B = Planner.Add(s_ObjectSize);
+        C = Planner.Add(s_ObjectSize);
+        D = Planner.Add(s_ObjectSize);
+
+        Planner.MarkUsed(D, 1);
+        Planner.MarkUsed(C, 2);
+        Planner.MarkUsed(B, 3);
+        Planner.MarkUsed(A, 4);
+    }
+
+    // All four resident, budget for two and a half
+    void GoOverBudget() { Planner.UpdateBudget({ s_ObjectSize * 5 / 2, s_ObjectSize * 4 }); }
+};
+
+bool Equals(const std::vector<ResidencyHandle>& handles, std::initializer_list<ResidencyHandle> expected)
+{
+    return handles.size() == expected.size() && std::equal(handles.begin(), handles.end(), expected.begin());
+}
+}
+
+// Residency Planning
+
+void RunResidencyChecks(CheckRunner& runner)
+{
+    // Over budget, the least recently used objects go first, and only until
+    // usage fits
+    runner.Run("residency/evicts_least_recently_used", [](CheckRunner& check) {
+        ResidencyScene scene;
+        scene.GoOverBudget();
+
+        const ResidencyPlan& plan = scene.Planner.Plan(5, 4);
+
+        check.Expect(Equals(plan.Evict, { scene.D, scene.C }), "D then C evicted, got " + std::to_string(plan.Evict.size()) + " evictions");
+        check.Expect(plan.MakeResident.empty(), "nothing made resident");
+        check.Expect(!scene.Planner.GetStats().OverBudget, "usage within the budget");
+        check.Expect(scene.Planner.IsResident(scene.B) && scene.Planner.IsResident(scene.A), "A and B still resident");
+    });
+
+    // Objects the GPU may still be using are skipped, even if that leaves
+    // usage over budget
+    runner.Run("residency/keeps_objects_in_flight", [](CheckRunner& check) {
+        ResidencyScene scene;
+        scene.GoOverBudget();
+
+        const ResidencyPlan& plan = scene.Planner.Plan(5, 1);
+
+        check.Expect(Equals(plan.Evict, { scene.D }), "only D evicted, the others are in flight");
+        check.Expect(scene.Planner.GetStats().OverBudget, "usage still over budget");
+    });
+
+    // What the planned submission references is never evicted, however old
+    // it was before
+    runner.Run("residency/keeps_objects_of_the_submission", [](CheckRunner& check) {
+        ResidencyScene scene;
+        scene.Planner.MarkUsed(scene.D, 5);
+        scene.GoOverBudget();
+
+        const ResidencyPlan& plan = scene.Planner.Plan(5, 4);
+
+        check.Expect(Equals(plan.Evict, { scene.C, scene.B }), "C then B evicted, D is used by the submission");
+        check.Expect(scene.Planner.IsResident(scene.D), "D resident");
+    });
+
+    // An evicted object a submission uses is made resident, and something
+    // older makes room for it
+    runner.Run("residency/restores_used_objects", [](CheckRunner& check) {
+        ResidencyScene scene;
+        scene.GoOverBudget();
+        scene.Planner.Plan(5, 4);
+
+        scene.Planner.MarkUsed(scene.D, 6);
+        const ResidencyPlan& plan = scene.Planner.Plan(6, 5);
+
+        check.Expect(Equals(plan.MakeResident, { scene.D }), "D made resident");
+        check.Expect(Equals(plan.Evict, { scene.B }), "B evicted to make room");
+        check.Expect(scene.Planner.GetStats().EvictedBytes == s_ObjectSize * 2, "B and C evicted, " + std::to_string(scene.Planner.GetStats().EvictedBytes) + " bytes");
+    });
+
+    // Without a known budget nothing is evicted
+    runner.Run("residency/unknown_budget_evicts_nothing", [](CheckRunner& check) {
+        ResidencyScene scene;
+        scene.Planner.UpdateBudget({ 0, s_ObjectSize * 4 });
+
+        check.Expect(scene.Planner.Plan(5, 4).Evict.empty(), "no evictions");
+    });
+
+    // Listeners hear about the first budget and about changes over the
+    // threshold, not about every small move
+    runner.Run("residency/budget_notifications", [](CheckRunner& check) {
+        ResidencyPlanner planner;
+
+        uint32_t notifications = 0;
+        planner.AddBudgetListener([&notifications](const ResidencyBudget&) { notifications++; });
+
+        planner.UpdateBudget({ 1000, 0 });
+        planner.UpdateBudget({ 1030, 0 });
+        check.Expect(notifications == 1, "one notification for a 3% change, got " + std::to_string(notifications));
+
+        planner.UpdateBudget({ 800, 0 });
+        check.Expect(notifications == 2, "a notification for a 20% drop, got " + std::to_string(notifications));
+    });
+}
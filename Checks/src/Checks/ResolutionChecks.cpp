@@ -0,0 +1,116 @@
+#include "Checks/Suites.h"
+
+#include "Nutcrackz/Renderer/ResolutionController.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+// Helper functions
+
+namespace
+{
+const float s_TargetFrameMs = 14.0f;
+
+// Time of every frame that doesn't scale with resolution
+const float s_FixedMs = 2.0f;
+
+// Frames the controller gets to settle, the checks look at the rest
+const uint32_t s_SettleFrames = 600;
+const uint32_t s_TraceFrames = 1200;
+
+// Full resolution frame times around fullMs, each off by up to noise
+// times fullMs
+std::vector<float> CreateTrace(float fullMs, float noise)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<float> trace(s_TraceFrames);
+    for (float& frameMs : trace)
+        frameMs = fullMs * (1.0f + noise * unit(random));
+
+    return trace;
+}
+
+// Mean and worst frame time once the controller settled
+void GetSettledFrameMs(const ResolutionSimulation& simulation, float& meanMs, float& maxMs)
+{
+    double sum = 0.0;
+    maxMs = 0.0f;
+
+    for (size_t frame = s_SettleFrames; frame < simulation.FrameMs.size(); ++frame)
+    {
+        sum += simulation.FrameMs[frame];
+        maxMs = std::max(maxMs, simulation.FrameMs[frame]);
+    }
+
+    meanMs = static_cast<float>(sum / (simulation.FrameMs.size() - s_SettleFrames));
+}
+
+ResolutionController CreateController()
+{
+    ResolutionControllerDesc desc;
+    desc.TargetFrameMs = s_TargetFrameMs;
+
+    return ResolutionController(desc);
+}
+}
+
+// Dynamic Resolution
+
+void RunResolutionChecks(CheckRunner& runner)
+{
+    // A steady load settles at or under the target, and not so far under it
+    // that resolution is wasted
+    for (float fullMs : { 15.0f, 20.0f, 28.0f })
+    {
+        runner.Run("resolution/settles_under_target_" + std::to_string(int(fullMs)) + "ms", [fullMs](CheckRunner& check) {
+            const ResolutionSimulation simulation = SimulateResolution(CreateController(), CreateTrace(fullMs, 0.0f), s_FixedMs);
+
+            float meanMs, maxMs;
+            GetSettledFrameMs(simulation, meanMs, maxMs);
+
+            check.Expect(maxMs <= s_TargetFrameMs, "settled frames at or under " + std::to_string(s_TargetFrameMs) + " ms, worst was " + std::to_string(maxMs));
+            check.Expect(meanMs >= s_TargetFrameMs * 0.9f, "settled frames within 10% of the target, mean was " + std::to_string(meanMs));
+        });
+    }
+
+    // Starting a few percent over the target, inside what used to be the
+    // deadband, still lowers the scale
+    runner.Run("resolution/leaves_slightly_over_target", [](CheckRunner& check) {
+        const float fullMs = 20.0f;
+
+        // The scale that renders frames of 14.43 ms
+        ResolutionController controller = CreateController();
+        controller.Reset(std::sqrt((14.43f - s_FixedMs) / (fullMs - s_FixedMs)));
+
+        const ResolutionSimulation simulation = SimulateResolution(controller, CreateTrace(fullMs, 0.0f), s_FixedMs);
+
+        check.Expect(simulation.FrameMs.front() > s_TargetFrameMs, "the first frame over the target");
+        check.Expect(simulation.FrameMs.back() <= s_TargetFrameMs, "the last frame at or under the target, it took " + std::to_string(simulation.FrameMs.back()) + " ms");
+    });
+
+    // Noise makes single frames miss, on average the load stays under
+    runner.Run("resolution/noisy_mean_under_target", [](CheckRunner& check) {
+        const ResolutionSimulation simulation = SimulateResolution(CreateController(), CreateTrace(20.0f, 0.05f), s_FixedMs);
+
+        float meanMs, maxMs;
+        GetSettledFrameMs(simulation, meanMs, maxMs);
+
+        check.Expect(meanMs <= s_TargetFrameMs, "a mean settled frame time at or under the target, it was " + std::to_string(meanMs));
+    });
+
+    // Once the load drops the scale climbs back to full resolution
+    runner.Run("resolution/recovers_full_scale", [](CheckRunner& check) {
+        std::vector<float> trace = CreateTrace(24.0f, 0.0f);
+        const std::vector<float> light = CreateTrace(10.0f, 0.0f);
+        trace.insert(trace.end(), light.begin(), light.end());
+
+        const ResolutionSimulation simulation = SimulateResolution(CreateController(), trace, s_FixedMs);
+
+        check.Expect(simulation.Scales[s_TraceFrames - 1] < 1.0f, "a lowered scale under the heavy load");
+        check.Expect(simulation.Scales.back() == 1.0f, "full scale again under the light load, got " + std::to_string(simulation.Scales.back()));
+    });
+}
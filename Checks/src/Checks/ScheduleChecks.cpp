@@ -0,0 +1,271 @@
+#include "Checks/Suites.h"
+
+#include "Nutcrackz/Renderer/QueuePlanner.h"
+
+#include <initializer_list>
+#include <string>
+
+// Helper functions
+
+namespace
+{
+// Resource identities, the planner never dereferences them
+const uint64_t s_Upload = 1;
+const uint64_t s_Lights = 2;
+const uint64_t s_Shadows = 3;
+const uint64_t s_Target = 4;
+const uint64_t s_SceneBuffer = 5;
+const uint64_t s_Materials = 6;
+
+ResourceUse Read(uint64_t resource)
+{
+    ResourceUse use;
+    use.Resource = resource;
+    use.Write = false;
+    return use;
+}
+
+ResourceUse Write(uint64_t resource)
+{
+    ResourceUse use;
+    use.Resource = resource;
+    use.Write = true;
+    return use;
+}
+
+PassDesc CreatePass(const char* name, QueueType queue, std::initializer_list<ResourceUse> uses)
+{
+    PassDesc pass;
+    pass.Name = name;
+    pass.Queue = queue;
+    pass.Uses = uses;
+    return pass;
+}
+
+// A frame using all three queues: an upload on the copy queue, light binning
+// and shadows on the compute queue, and the direct queue drawing with all
+// of them
+std::vector<PassDesc> CreateFrame()
+{
+    return {
+        CreatePass("Upload", QueueType::Copy, { Write(s_Upload) }),
+        CreatePass("BinLights", QueueType::Compute, { Read(s_Upload), Write(s_Lights) }),
+        CreatePass("Shadows", QueueType::Compute, { Read(s_Upload), Write(s_Shadows) }),
+        CreatePass("Main", QueueType::Direct, { Read(s_Upload), Read(s_Lights), Read(s_Shadows), Write(s_Target) }),
+    };
+}
+
+std::string JoinHazards(const std::vector<std::string>& hazards)
+{
+    std::string joined;
+    for (const std::string& hazard : hazards)
+        joined += (joined.empty() ? "" : "; ") + hazard;
+
+    return joined;
+}
+
+// Index of the pass's wait for queue, -1 if it doesn't wait for it
+int FindWait(const PlannedPass& pass, QueueType queue)
+{
+    for (size_t wait = 0; wait < pass.Waits.size(); ++wait)
+    {
+        if (pass.Waits[wait].Queue == queue)
+            return int(wait);
+    }
+
+    return -1;
+}
+
+// The pass's waits without the one at index
+QueueWaitList RemoveWait(const QueueWaitList& waits, int index)
+{
+    QueueWaitList remaining;
+    for (size_t wait = 0; wait < waits.size(); ++wait)
+    {
+        if (int(wait) != index)
+            remaining.push_back(waits[wait]);
+    }
+
+    return remaining;
+}
+}
+
+// Queue Planning
+
+void RunScheduleChecks(CheckRunner& runner)
+{
+    // A three queue frame plans without hazards, and the simulation starts
+    // every consumer after its producers finished
+    runner.Run("schedule/three_queue_frame", [](CheckRunner& check) {
+        const std::vector<PassDesc> passes = CreateFrame();
+
+        QueuePlanner planner;
+        const SchedulePlan& plan = planner.Plan(passes);
+
+        const std::vector<std::string> hazards = ValidateSchedule(plan, passes);
+        check.Expect(hazards.empty(), "no hazards, got: " + JoinHazards(hazards));
+
+        const SimulatedTimeline timeline = SimulateSchedule(plan, { 1.0, 2.0, 3.0, 4.0 });
+        check.Expect(!timeline.Deadlocked, "the simulation to finish");
+        check.Expect(timeline.Passes[1].Start >= timeline.Passes[0].End, "BinLights to start after Upload");
+        check.Expect(timeline.Passes[3].Start >= timeline.Passes[2].End, "Main to start after Shadows");
+        check.Expect(timeline.Duration == 10.0, "a duration of 10 for the chain, got " + std::to_string(timeline.Duration));
+    });
+
+    // The direct queue only waits for compute, which already waited for the
+    // upload on the copy queue
+    runner.Run("schedule/transitive_wait_elided", [](CheckRunner& check) {
+        QueuePlanner planner;
+        const SchedulePlan& plan = planner.Plan(CreateFrame());
+
+        check.Expect(FindWait(plan.Passes[3], QueueType::Compute) >= 0, "Main to wait for compute");
+        check.Expect(FindWait(plan.Passes[3], QueueType::Copy) < 0, "Main not to wait for copy");
+        check.Expect(FindWait(plan.Passes[2], QueueType::Copy) < 0, "Shadows not to wait for copy again");
+        check.Expect(plan.WaitCount == 2, "2 waits, got " + std::to_string(plan.WaitCount));
+        check.Expect(plan.ElidedWaits == 2, "2 elided waits, got " + std::to_string(plan.ElidedWaits));
+    });
+
+    // Reads on different queues don't order each other
+    runner.Run("schedule/independent_queues_overlap", [](CheckRunner& check) {
+        const std::vector<PassDesc> passes = {
+            CreatePass("Readback", QueueType::Copy, { Read(s_Target) }),
+            CreatePass("Histogram", QueueType::Compute, { Read(s_Target), Write(s_Lights) }),
+            CreatePass("Overlay", QueueType::Direct, { Read(s_Target), Write(s_Shadows) }),
+        };
+
+        QueuePlanner planner;
+        const SchedulePlan& plan = planner.Plan(passes);
+        check.Expect(plan.WaitCount == 0, "no waits, got " + std::to_string(plan.WaitCount));
+
+        const SimulatedTimeline timeline = SimulateSchedule(plan, { 3.0, 3.0, 3.0 });
+        check.Expect(timeline.Duration == 3.0, "all three queues to overlap, took " + std::to_string(timeline.Duration));
+    });
+
+    // Removing any cross queue wait from a valid plan is reported as a hazard
+    runner.Run("schedule/missing_wait_reported", [](CheckRunner& check) {
+        const std::vector<PassDesc> passes = CreateFrame();
+
+        QueuePlanner planner;
+        const SchedulePlan& plan = planner.Plan(passes);
+
+        for (uint32_t passIndex = 0; passIndex < plan.Passes.size(); ++passIndex)
+        {
+            for (size_t wait = 0; wait < plan.Passes[passIndex].Waits.size(); ++wait)
+            {
+                SchedulePlan tampered = plan;
+                tampered.Passes[passIndex].Waits = RemoveWait(plan.Passes[passIndex].Waits, int(wait));
+
+                check.Expect(!ValidateSchedule(tampered, passes).empty(), std::string("a hazard without a wait of ") + passes[passIndex].Name);
+            }
+        }
+    });
+
+    // A wait for a value whose signal is submitted later is a fence ordering
+    // error, even when the simulation could still finish
+    runner.Run("schedule/wait_before_signal_reported", [](CheckRunner& check) {
+        const std::vector<PassDesc> passes = {
+            CreatePass("Shadows", QueueType::Direct, { Write(s_Shadows) }),
+            CreatePass("BinLights", QueueType::Compute, { Read(s_Shadows), Write(s_Lights) }),
+            CreatePass("Main", QueueType::Direct, { Read(s_Lights), Write(s_Target) }),
+        };
+
+        QueuePlanner planner;
+        SchedulePlan plan = planner.Plan(passes);
+        check.Expect(ValidateSchedule(plan, passes).empty(), "no hazards before tampering");
+
+        // Shadows waits for BinLights, which is submitted after it
+        QueueWait wait;
+        wait.Queue = QueueType::Compute;
+        wait.Value = plan.Passes[1].Value;
+        plan.Passes[0].Waits.push_back(wait);
+
+        const std::vector<std::string> hazards = ValidateSchedule(plan, passes);
+        check.Expect(!hazards.empty(), "a hazard for the wait before the signal");
+        check.Expect(SimulateSchedule(plan, { 1.0, 1.0, 1.0 }).Deadlocked, "the simulation to deadlock, the queues wait for each other");
+    });
+
+    // Waits for signals that no pass makes leave the queues stuck
+    runner.Run("schedule/unsignalled_wait_deadlocks", [](CheckRunner& check) {
+        const std::vector<PassDesc> passes = {
+            CreatePass("Upload", QueueType::Copy, { Write(s_Upload) }),
+            CreatePass("Main", QueueType::Direct, { Read(s_Upload), Write(s_Target) }),
+        };
+
+        QueuePlanner planner;
+        SchedulePlan plan = planner.Plan(passes);
+
+        // Main waits for a copy value past anything planned
+        plan.Passes[1].Waits[0].Value = plan.Passes[0].Value + 1;
+
+        check.Expect(!ValidateSchedule(plan, passes).empty(), "a hazard for the unsignalled wait");
+        check.Expect(SimulateSchedule(plan, { 1.0, 1.0 }).Deadlocked, "the simulation to deadlock");
+    });
+
+    // Work of an earlier frame that isn't known to have finished is waited
+    // for, and not once its completion is reported
+    runner.Run("schedule/earlier_frame_dependency", [](CheckRunner& check) {
+        QueuePlanner planner;
+
+        const std::vector<PassDesc> first = { CreatePass("BinLights", QueueType::Compute, { Write(s_Lights) }) };
+        const uint64_t lightsValue = planner.Plan(first).Passes[0].Value;
+
+        const std::vector<PassDesc> second = { CreatePass("Main", QueueType::Direct, { Read(s_Lights), Write(s_Target) }) };
+        const SchedulePlan pending = planner.Plan(second);
+
+        const int wait = FindWait(pending.Passes[0], QueueType::Compute);
+        check.Expect(wait >= 0 && pending.Passes[0].Waits[wait].Value == lightsValue, "Main to wait for the earlier frame's BinLights");
+        check.Expect(ValidateSchedule(pending, second).empty(), "no hazards across frames");
+
+        SchedulePlan tampered = pending;
+        tampered.Passes[0].Waits.clear();
+        check.Expect(!ValidateSchedule(tampered, second).empty(), "a hazard without the wait for the earlier frame");
+
+        // Writing again after BinLights finished needs no wait
+        planner.SetCompletedValue(QueueType::Compute, lightsValue);
+        planner.SetCompletedValue(QueueType::Direct, pending.Passes[0].Value);
+
+        const std::vector<PassDesc> third = { CreatePass("Main", QueueType::Direct, { Read(s_Lights), Write(s_Target) }) };
+        check.Expect(planner.Plan(third).WaitCount == 0, "no waits once the earlier frame finished");
+    });
+
+    // The renderer's frame: scene and material uploads on the copy queue,
+    // read by Main on the direct queue. The next frame's uploads wait for
+    // the Main still reading the previous contents.
+    runner.Run("schedule/renderer_frame", [](CheckRunner& check) {
+        const std::vector<PassDesc> frame = {
+            CreatePass("Uploads", QueueType::Copy, { Write(s_SceneBuffer), Write(s_Materials) }),
+            CreatePass("Main", QueueType::Direct, { Write(s_Target), Read(s_SceneBuffer), Read(s_Materials) }),
+        };
+
+        QueuePlanner planner;
+        const SchedulePlan first = planner.Plan(frame);
+
+        check.Expect(FindWait(first.Passes[1], QueueType::Copy) >= 0, "Main to wait for the uploads");
+        check.Expect(ValidateSchedule(first, frame).empty(), "no hazards in the first frame");
+
+        const SchedulePlan second = planner.Plan(frame);
+        const int wait = FindWait(second.Passes[0], QueueType::Direct);
+
+        check.Expect(wait >= 0 && second.Passes[0].Waits[wait].Value == first.Passes[1].Value, "the next uploads to wait for the first Main");
+        check.Expect(ValidateSchedule(second, frame).empty(), "no hazards in the second frame");
+    });
+
+    // A write on one queue after reads on two others waits for both
+    runner.Run("schedule/write_after_reads", [](CheckRunner& check) {
+        const std::vector<PassDesc> passes = {
+            CreatePass("Readback", QueueType::Copy, { Read(s_Target) }),
+            CreatePass("Histogram", QueueType::Compute, { Read(s_Target) }),
+            CreatePass("Main", QueueType::Direct, { Write(s_Target) }),
+        };
+
+        QueuePlanner planner;
+        const SchedulePlan& plan = planner.Plan(passes);
+
+        check.Expect(FindWait(plan.Passes[2], QueueType::Copy) >= 0, "Main to wait for the copy queue's read");
+        check.Expect(FindWait(plan.Passes[2], QueueType::Compute) >= 0, "Main to wait for the compute queue's read");
+        check.Expect(ValidateSchedule(plan, passes).empty(), "no hazards");
+
+        const SimulatedTimeline timeline = SimulateSchedule(plan, { 2.0, 5.0, 1.0 });
+        check.Expect(timeline.Passes[2].Start == 5.0, "Main to start after the slower read, at " + std::to_string(timeline.Passes[2].Start));
+    });
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Checks/Check.h"
+
+// Check Suites
+
+// The dynamic resolution controller against synthetic frame time traces,
+// "resolution/"
+void RunResolutionChecks(CheckRunner& runner);
+
+// Queue planning of multi queue frames, and plans tampered with to break
+// their waits, "schedule/"
+void RunScheduleChecks(CheckRunner& runner);
+
+// Residency planning against a simulated video memory budget, "residency/"
+void RunResidencyChecks(CheckRunner& runner);
+
+// Text and graph quads of the performance HUD, "hud/"
+void RunHudChecks(CheckRunner& runner);
+
+// Thread pool ranges, exceptions and lanes, "threadpool/"
+void RunThreadPoolChecks(CheckRunner& runner);
+
+// DDS and KTX2 headers, including malformed ones, "texturefile/"
+void RunTextureFileChecks(CheckRunner& runner);
@@ -0,0 +1,233 @@
+#include "Checks/Suites.h"
+
+#include "Nutcrackz/Renderer/TextureFile.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Helper functions
+
+namespace
+{
+void Append(std::vector<uint8_t>& bytes, const void* data, size_t size)
+{
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    bytes.insert(bytes.end(), source, source + size);
+}
+
+void AppendU32(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    Append(bytes, &value, sizeof(value));
+}
+
+void AppendU64(std::vector<uint8_t>& bytes, uint64_t value)
+{
+    Append(bytes, &value, sizeof(value));
+}
+
+// An RGBA8 DDS with mipCount mips declared and dataSize bytes of texels
+std::vector<uint8_t> CreateDds(uint32_t width, uint32_t height, uint32_t mipCount, size_t dataSize)
+{
+    std::vector<uint8_t> bytes;
+    AppendU32(bytes, 0x20534444);
+
+    // Size, flags, height, width, pitch, depth, mip count, reserved
+    AppendU32(bytes, 124);
+    AppendU32(bytes, 0);
+    AppendU32(bytes, height);
+    AppendU32(bytes, width);
+    AppendU32(bytes, 0);
+    AppendU32(bytes, 0);
+    AppendU32(bytes, mipCount);
+    for (uint32_t i = 0; i < 11; ++i)
+        AppendU32(bytes, 0);
+
+    // Pixel format: size, DDPF_RGB, no FourCC, 32 bits, RGBA masks
+    AppendU32(bytes, 32);
+    AppendU32(bytes, 0x40);
+    AppendU32(bytes, 0);
+    AppendU32(bytes, 32);
+    AppendU32(bytes, 0x000000ff);
+    AppendU32(bytes, 0x0000ff00);
+    AppendU32(bytes, 0x00ff0000);
+    AppendU32(bytes, 0xff000000);
+
+    // Caps, caps 2 to 4, reserved
+    for (uint32_t i = 0; i < 5; ++i)
+        AppendU32(bytes, 0);
+
+    bytes.resize(bytes.size() + dataSize);
+    return bytes;
+}
+
+struct Ktx2Level
+{
+    uint64_t Offset;
+    uint64_t Length;
+};
+
+// An RGBA8 KTX2 with the given level index, padded to fileSize bytes
+std::vector<uint8_t> CreateKtx2(uint32_t width, uint32_t height, const std::vector<Ktx2Level>& levels, size_t fileSize)
+{
+    const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    std::vector<uint8_t> bytes(identifier, identifier + sizeof(identifier));
+
+    // VK_FORMAT_R8G8B8A8_UNORM, type size, size, depth, layers, faces,
+    // levels, supercompression
+    AppendU32(bytes, 37);
+    AppendU32(bytes, 1);
+    AppendU32(bytes, width);
+    AppendU32(bytes, height);
+    AppendU32(bytes, 0);
+    AppendU32(bytes, 0);
+    AppendU32(bytes, 1);
+    AppendU32(bytes, static_cast<uint32_t>(levels.size()));
+    AppendU32(bytes, 0);
+
+    // No data format descriptor, key/values or global data
+    for (uint32_t i = 0; i < 4; ++i)
+        AppendU32(bytes, 0);
+    AppendU64(bytes, 0);
+    AppendU64(bytes, 0);
+
+    for (const Ktx2Level& level : levels)
+    {
+        AppendU64(bytes, level.Offset);
+        AppendU64(bytes, level.Length);
+        AppendU64(bytes, level.Length);
+    }
+
+    bytes.resize(std::max(bytes.size(), fileSize));
+    return bytes;
+}
+
+std::string WriteFile(const std::string& name, const std::vector<uint8_t>& bytes)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / name).string();
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+    return path;
+}
+
+// The error ReadTextureFileDesc throws for the file, empty if it accepts it
+std::string GetReadError(const std::string& name, const std::vector<uint8_t>& bytes)
+{
+    const std::string path = WriteFile(name, bytes);
+
+    std::string error;
+    try
+    {
+        ReadTextureFileDesc(path);
+    }
+    catch (std::runtime_error& e)
+    {
+        error = e.what();
+    }
+
+    std::filesystem::remove(path);
+    return error;
+}
+
+// Header, then the level index of up to 4 levels
+const size_t s_Ktx2DataOffset = 80 + 4 * 24;
+}
+
+// Texture Files
+
+void RunTextureFileChecks(CheckRunner& runner)
+{
+    // A full chain is accepted, with its mips back to back
+    runner.Run("texturefile/dds_full_chain", [](CheckRunner& check) {
+        const std::string path = WriteFile("checks_full_chain.dds", CreateDds(8, 4, 4, 32 * 4 + 8 * 4 + 2 * 4 + 4));
+
+        TextureFileDesc desc;
+        std::string error;
+        try
+        {
+            desc = ReadTextureFileDesc(path);
+        }
+        catch (std::runtime_error& e)
+        {
+            error = e.what();
+        }
+
+        std::filesystem::remove(path);
+
+        check.Expect(error.empty(), "the file read, got: " + error);
+        check.Expect(desc.Mips.size() == 4, "4 mips, got " + std::to_string(desc.Mips.size()));
+
+        if (desc.Mips.size() == 4)
+        {
+            check.Expect(desc.Mips[3].Width == 1 && desc.Mips[3].Height == 1, "a 1x1 last mip");
+            check.Expect(desc.Mips[1].Offset == desc.Mips[0].Offset + 128, "the second mip after the first's 128 bytes");
+        }
+    });
+
+    // More mips than halving the largest side allows
+    runner.Run("texturefile/dds_too_many_mips", [](CheckRunner& check) {
+        check.Expect(!GetReadError("checks_many_mips.dds", CreateDds(8, 4, 5, 4096)).empty(), "5 mips of an 8x4 texture rejected");
+        check.Expect(!GetReadError("checks_huge_mips.dds", CreateDds(8, 4, 40, 4096)).empty(), "40 mips rejected");
+    });
+
+    // A file cut off inside its mips
+    runner.Run("texturefile/dds_truncated", [](CheckRunner& check) {
+        check.Expect(!GetReadError("checks_truncated.dds", CreateDds(8, 4, 4, 32 * 4)).empty(), "mips past the end of the file rejected");
+    });
+
+    // Empty and oversized textures
+    runner.Run("texturefile/dds_size", [](CheckRunner& check) {
+        check.Expect(!GetReadError("checks_empty.dds", CreateDds(0, 4, 1, 0)).empty(), "a texture without texels rejected");
+        check.Expect(!GetReadError("checks_wide.dds", CreateDds(1u << 30, 1, 1, 0)).empty(), "a texture wider than the limit rejected");
+    });
+
+    // KTX2 levels keep their offsets, the size is the mip's even with
+    // padding after it
+    runner.Run("texturefile/ktx2_levels", [](CheckRunner& check) {
+        const std::vector<Ktx2Level> levels = { { s_Ktx2DataOffset + 64, 64 }, { s_Ktx2DataOffset, 20 }, { s_Ktx2DataOffset + 32, 4 } };
+        const std::string path = WriteFile("checks_levels.ktx2", CreateKtx2(4, 4, levels, s_Ktx2DataOffset + 128));
+
+        TextureFileDesc desc;
+        std::string error;
+        try
+        {
+            desc = ReadTextureFileDesc(path);
+        }
+        catch (std::runtime_error& e)
+        {
+            error = e.what();
+        }
+
+        std::filesystem::remove(path);
+
+        check.Expect(error.empty(), "the file read, got: " + error);
+        check.Expect(desc.Mips.size() == 3 && desc.Mips[0].Offset == s_Ktx2DataOffset + 64 && desc.Mips[1].Size == 16, "the levels' offsets and sizes");
+    });
+
+    // A level shorter than its mip would be read past its end
+    runner.Run("texturefile/ktx2_short_level", [](CheckRunner& check) {
+        const std::vector<Ktx2Level> levels = { { s_Ktx2DataOffset, 60 } };
+        check.Expect(!GetReadError("checks_short.ktx2", CreateKtx2(4, 4, levels, s_Ktx2DataOffset + 64)).empty(), "a 60 byte level of a 4x4 mip rejected");
+    });
+
+    // Levels past the end of the file, also when offset plus length wraps
+    runner.Run("texturefile/ktx2_level_past_end", [](CheckRunner& check) {
+        const std::vector<Ktx2Level> pastEnd = { { s_Ktx2DataOffset + 32, 64 } };
+        check.Expect(!GetReadError("checks_past_end.ktx2", CreateKtx2(4, 4, pastEnd, s_Ktx2DataOffset + 64)).empty(), "a level past the end rejected");
+
+        const std::vector<Ktx2Level> wrapped = { { ~0ull - 8, 64 } };
+        check.Expect(!GetReadError("checks_wrapped.ktx2", CreateKtx2(4, 4, wrapped, s_Ktx2DataOffset + 64)).empty(), "a wrapping level rejected");
+    });
+
+    // More levels than the size allows
+    runner.Run("texturefile/ktx2_too_many_levels", [](CheckRunner& check) {
+        const std::vector<Ktx2Level> levels(4, Ktx2Level{ s_Ktx2DataOffset, 4 });
+        check.Expect(!GetReadError("checks_levels.ktx2", CreateKtx2(2, 2, levels, s_Ktx2DataOffset + 64)).empty(), "4 levels of a 2x2 texture rejected");
+    });
+}
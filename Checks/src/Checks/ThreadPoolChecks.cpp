@@ -0,0 +1,96 @@
+#include "Checks/Suites.h"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Thread Pool
+
+void RunThreadPoolChecks(CheckRunner& runner)
+{
+    // Every index is visited exactly once
+    runner.Run("threadpool/parallel_for_covers_range", [](CheckRunner& check) {
+        ThreadPool threadPool(4);
+
+        std::vector<std::atomic<uint32_t>> visits(1000);
+        threadPool.ParallelFor(1000, [&visits](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+                visits[i]++;
+        });
+
+        bool once = true;
+        for (const std::atomic<uint32_t>& count : visits)
+            once = once && count == 1;
+
+        check.Expect(once, "every index visited once");
+    });
+
+    // A range that throws fails the ParallelFor, after the other ranges ran
+    runner.Run("threadpool/parallel_for_rethrows", [](CheckRunner& check) {
+        ThreadPool threadPool(4);
+        std::atomic<uint32_t> visited = 0;
+
+        bool caught = false;
+        try
+        {
+            threadPool.ParallelFor(64, [&visited](uint32_t begin, uint32_t end) {
+                visited += end - begin;
+                if (begin == 0)
+                    throw std::runtime_error("range failed!");
+            });
+        }
+        catch (std::runtime_error& e)
+        {
+            caught = std::string(e.what()) == "range failed!";
+        }
+
+        check.Expect(caught, "the range's exception rethrown to the caller");
+        check.Expect(visited == 64, "every range run, got " + std::to_string(visited.load()));
+
+        // The pool keeps working
+        std::atomic<uint32_t> after = 0;
+        threadPool.ParallelFor(8, [&after](uint32_t begin, uint32_t end) { after += end - begin; });
+        check.Expect(after == 8, "a ParallelFor after the failure to complete");
+    });
+
+    // A submitted job that throws doesn't take the worker or the process
+    // down with it
+    runner.Run("threadpool/submit_survives_exceptions", [](CheckRunner& check) {
+        ThreadPool threadPool(1);
+        std::atomic<bool> ran = false;
+
+        threadPool.Submit([]() { throw std::runtime_error("job failed!"); });
+        threadPool.Submit([&ran]() { ran = true; });
+        threadPool.WaitIdle();
+
+        check.Expect(ran, "the next job to run on the same worker");
+    });
+
+    // With every worker stuck in a long job, like a texture read, ParallelFor
+    // still finishes on the calling thread
+    runner.Run("threadpool/parallel_for_passes_long_jobs", [](CheckRunner& check) {
+        ThreadPool threadPool(2);
+
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+
+        for (uint32_t worker = 0; worker < threadPool.GetWorkerCount() * 2; ++worker)
+            threadPool.Submit([released]() { released.wait(); });
+
+        std::atomic<uint32_t> visited = 0;
+        const auto start = std::chrono::steady_clock::now();
+        threadPool.ParallelFor(100, [&visited](uint32_t begin, uint32_t end) { visited += end - begin; });
+        const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        release.set_value();
+        threadPool.WaitIdle();
+
+        check.Expect(visited == 100, "every index visited, got " + std::to_string(visited.load()));
+        check.Expect(elapsedMs < 1000.0, "no wait for the blocked workers, took " + std::to_string(elapsedMs) + " ms");
+    });
+}
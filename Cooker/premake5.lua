@@ -0,0 +1,47 @@
+project "Cooker"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++20"
+	staticruntime "off"
+
+	targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files
+	{
+		"src/**.h",
+		"src/**.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/ThreadPool.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Core/ThreadPool.cpp",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/TextureFile.h",
+		"%{wks.location}/Engine/src/Nutcrackz/Renderer/TextureFile.cpp"
+	}
+
+	defines
+	{
+		"_CRT_SECURE_NO_WARNINGS"
+	}
+
+	includedirs
+	{
+		"src",
+		"%{wks.location}/Engine/src"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		defines "SDR_DEBUG"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "SDR_RELEASE"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "SDR_DIST"
+		runtime "Release"
+		optimize "on"
@@ -0,0 +1,270 @@
+#include "BCDecoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// Helper functions
+
+namespace
+{
+void Unpack565(uint16_t packed, uint32_t* color)
+{
+    const uint32_t r = (packed >> 11) & 31;
+    const uint32_t g = (packed >> 5) & 63;
+    const uint32_t b = packed & 31;
+
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+    color[3] = 255;
+}
+
+// Decode one BC4 style block into 16 values
+void DecodeSingleChannel(const uint8_t* block, uint8_t* values)
+{
+    const uint32_t e0 = block[0];
+    const uint32_t e1 = block[1];
+
+    uint32_t palette[8];
+    palette[0] = e0;
+    palette[1] = e1;
+
+    if (e0 > e1)
+    {
+        for (uint32_t p = 2; p < 8; ++p)
+            palette[p] = ((8 - p) * e0 + (p - 1) * e1 + 3) / 7;
+    }
+    else
+    {
+        for (uint32_t p = 2; p < 6; ++p)
+            palette[p] = ((6 - p) * e0 + (p - 1) * e1 + 2) / 5;
+
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (uint32_t i = 0; i < 6; ++i)
+        indices |= uint64_t(block[2 + i]) << (i * 8);
+
+    for (uint32_t i = 0; i < 16; ++i)
+        values[i] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+}
+
+struct BitReader
+{
+    const uint8_t* Data;
+    uint32_t Position = 0;
+
+    uint32_t Read(uint32_t bits)
+    {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < bits; ++i, ++Position)
+            value |= uint32_t((Data[Position >> 3] >> (Position & 7)) & 1) << i;
+
+        return value;
+    }
+};
+}
+
+// Block Decompression
+
+void DecodeBlockBC1(const uint8_t* block, bool forceFourColor, uint8_t* texels)
+{
+    uint16_t color0, color1;
+    uint32_t indices;
+    memcpy(&color0, block, 2);
+    memcpy(&color1, block + 2, 2);
+    memcpy(&indices, block + 4, 4);
+
+    uint32_t palette[4][4];
+    Unpack565(color0, palette[0]);
+    Unpack565(color1, palette[1]);
+
+    if (forceFourColor || color0 > color1)
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+        palette[2][3] = palette[3][3] = 255;
+    }
+    else
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 0;
+    }
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        const uint32_t index = (indices >> (i * 2)) & 3;
+        for (uint32_t c = 0; c < 4; ++c)
+            texels[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+    }
+}
+
+void DecodeBlockBC3(const uint8_t* block, uint8_t* texels)
+{
+    uint8_t alpha[16];
+    DecodeSingleChannel(block, alpha);
+    DecodeBlockBC1(block + 8, true, texels);
+
+    for (uint32_t i = 0; i < 16; ++i)
+        texels[i * 4 + 3] = alpha[i];
+}
+
+void DecodeBlockBC4(const uint8_t* block, uint8_t* texels)
+{
+    uint8_t red[16];
+    DecodeSingleChannel(block, red);
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        texels[i * 4 + 0] = red[i];
+        texels[i * 4 + 1] = 0;
+        texels[i * 4 + 2] = 0;
+        texels[i * 4 + 3] = 255;
+    }
+}
+
+void DecodeBlockBC5(const uint8_t* block, uint8_t* texels)
+{
+    uint8_t red[16], green[16];
+    DecodeSingleChannel(block, red);
+    DecodeSingleChannel(block + 8, green);
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        texels[i * 4 + 0] = red[i];
+        texels[i * 4 + 1] = green[i];
+        texels[i * 4 + 2] = 0;
+        texels[i * 4 + 3] = 255;
+    }
+}
+
+void DecodeBlockBC7(const uint8_t* block, uint8_t* texels)
+{
+    static const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    BitReader reader{ block };
+
+    if (reader.Read(7) != (1 << 6))
+    {
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            texels[i * 4 + 0] = 255;
+            texels[i * 4 + 1] = 0;
+            texels[i * 4 + 2] = 255;
+            texels[i * 4 + 3] = 255;
+        }
+        return;
+    }
+
+    uint32_t e0[4], e1[4];
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        e0[c] = reader.Read(7);
+        e1[c] = reader.Read(7);
+    }
+
+    const uint32_t pbit0 = reader.Read(1);
+    const uint32_t pbit1 = reader.Read(1);
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        e0[c] = (e0[c] << 1) | pbit0;
+        e1[c] = (e1[c] << 1) | pbit1;
+    }
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        const uint32_t index = reader.Read(i == 0 ? 3 : 4);
+        const uint32_t weight = weights[index];
+
+        for (uint32_t c = 0; c < 4; ++c)
+            texels[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * e0[c] + weight * e1[c] + 32) >> 6);
+    }
+}
+
+Image DecompressImage(const std::vector<uint8_t>& data, uint32_t width, uint32_t height, TextureFormat format)
+{
+    const uint32_t blockBytes = GetFormatBlockBytes(format);
+    const uint32_t blocksX = std::max((width + 3) / 4, 1u);
+    const uint32_t blocksY = std::max((height + 3) / 4, 1u);
+
+    if (data.size() < size_t(blocksX) * blocksY * blockBytes)
+        throw std::runtime_error("compressed image is too small!");
+
+    Image image;
+    image.Width = width;
+    image.Height = height;
+    image.Texels.resize(size_t(width) * height * 4);
+
+    uint8_t texels[64];
+
+    for (uint32_t blockY = 0; blockY < blocksY; ++blockY)
+    {
+        for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+        {
+            const uint8_t* block = &data[(size_t(blockY) * blocksX + blockX) * blockBytes];
+
+            switch (format)
+            {
+            case TextureFormat::BC1:
+            case TextureFormat::BC1_SRGB: DecodeBlockBC1(block, false, texels); break;
+            case TextureFormat::BC3:
+            case TextureFormat::BC3_SRGB: DecodeBlockBC3(block, texels); break;
+            case TextureFormat::BC4: DecodeBlockBC4(block, texels); break;
+            case TextureFormat::BC5: DecodeBlockBC5(block, texels); break;
+            case TextureFormat::BC7:
+            case TextureFormat::BC7_SRGB: DecodeBlockBC7(block, texels); break;
+            default: throw std::runtime_error("unsupported block compression format!");
+            }
+
+            for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; ++y)
+            {
+                for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; ++x)
+                    memcpy(&image.Texels[(size_t(blockY * 4 + y) * width + blockX * 4 + x) * 4], &texels[(y * 4 + x) * 4], 4);
+            }
+        }
+    }
+
+    return image;
+}
+
+double ComputePSNR(const Image& reference, const Image& decoded, TextureFormat format)
+{
+    uint32_t channelCount = 4;
+    switch (format)
+    {
+    case TextureFormat::BC1:
+    case TextureFormat::BC1_SRGB: channelCount = 3; break;
+    case TextureFormat::BC4: channelCount = 1; break;
+    case TextureFormat::BC5: channelCount = 2; break;
+    default: break;
+    }
+
+    double squaredError = 0.0;
+    for (size_t i = 0; i < reference.Texels.size(); i += 4)
+    {
+        for (uint32_t c = 0; c < channelCount; ++c)
+        {
+            const double delta = double(reference.Texels[i + c]) - double(decoded.Texels[i + c]);
+            squaredError += delta * delta;
+        }
+    }
+
+    const double meanSquaredError = squaredError / (double(reference.Texels.size() / 4) * channelCount);
+    if (meanSquaredError <= 0.0)
+        return 99.0;
+
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Cooker/Image.h"
+#include "Nutcrackz/Renderer/TextureFile.h"
+
+#include <cstdint>
+#include <vector>
+
+// Block Decompression
+
+// Reference decoders used to measure encoder quality. Each writes 16 RGBA8
+// texels in row order. Channels a format doesn't store decode as 0, alpha
+// as 255.
+void DecodeBlockBC1(const uint8_t* block, bool forceFourColor, uint8_t* texels);
+void DecodeBlockBC3(const uint8_t* block, uint8_t* texels);
+void DecodeBlockBC4(const uint8_t* block, uint8_t* texels);
+void DecodeBlockBC5(const uint8_t* block, uint8_t* texels);
+
+// Only mode 6 is supported, which is the only mode the encoder writes. Other
+// modes decode as magenta so they stand out in comparisons.
+void DecodeBlockBC7(const uint8_t* block, uint8_t* texels);
+
+// Decompress an image produced by CompressImage
+Image DecompressImage(const std::vector<uint8_t>& data, uint32_t width, uint32_t height, TextureFormat format);
+
+// Peak signal to noise ratio in dB over the channels the format stores
+double ComputePSNR(const Image& reference, const Image& decoded, TextureFormat format);
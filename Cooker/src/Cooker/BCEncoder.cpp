@@ -0,0 +1,798 @@
+#include "BCEncoder.h"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <emmintrin.h>
+
+// Helper functions
+
+namespace
+{
+// 16 texels stored per channel so four texels fit in one SSE register
+struct BlockTexels
+{
+    alignas(16) float Channels[4][16];
+};
+
+struct Endpoints
+{
+    float A[4];
+    float B[4];
+};
+
+// Interpolation factor from endpoint A to B for every palette index
+const float s_BC1Weights4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+const float s_BC1Weights3[3] = { 0.0f, 1.0f, 0.5f };
+const float s_BC4Weights8[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+const uint32_t s_BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+BlockTexels LoadBlock(const uint8_t* texels)
+{
+    BlockTexels block;
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+            block.Channels[c][i] = texels[i * 4 + c];
+    }
+
+    return block;
+}
+
+// Pick the nearest palette entry for every texel and return the summed
+// squared error. Channels must be 16 byte aligned arrays of 16 values.
+float FindIndices(const float* const* channels, uint32_t channelCount, const float (*palette)[4], uint32_t paletteSize, uint8_t* indices, float* errors = nullptr)
+{
+    float totalError = 0.0f;
+
+    for (uint32_t group = 0; group < 4; ++group)
+    {
+        __m128 values[4];
+        for (uint32_t c = 0; c < channelCount; ++c)
+            values[c] = _mm_load_ps(channels[c] + group * 4);
+
+        __m128 best = _mm_set1_ps(FLT_MAX);
+        __m128 bestIndex = _mm_setzero_ps();
+
+        for (uint32_t p = 0; p < paletteSize; ++p)
+        {
+            __m128 distance = _mm_setzero_ps();
+            for (uint32_t c = 0; c < channelCount; ++c)
+            {
+                const __m128 delta = _mm_sub_ps(values[c], _mm_set1_ps(palette[p][c]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(delta, delta));
+            }
+
+            const __m128 closer = _mm_cmplt_ps(distance, best);
+            best = _mm_min_ps(distance, best);
+            bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(float(p))), _mm_andnot_ps(closer, bestIndex));
+        }
+
+        alignas(16) float bestErrors[4];
+        alignas(16) float bestIndices[4];
+        _mm_store_ps(bestErrors, best);
+        _mm_store_ps(bestIndices, bestIndex);
+
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            indices[group * 4 + i] = static_cast<uint8_t>(bestIndices[i]);
+            totalError += bestErrors[i];
+
+            if (errors)
+                errors[group * 4 + i] = bestErrors[i];
+        }
+    }
+
+    return totalError;
+}
+
+void BoundingBoxEndpoints(const float* const* channels, uint32_t channelCount, Endpoints& endpoints)
+{
+    for (uint32_t c = 0; c < channelCount; ++c)
+    {
+        float minValue = 255.0f;
+        float maxValue = 0.0f;
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            minValue = std::min(minValue, channels[c][i]);
+            maxValue = std::max(maxValue, channels[c][i]);
+        }
+
+        // Inset slightly, the extremes are rarely worth a whole palette entry
+        const float inset = (maxValue - minValue) / 16.0f;
+        endpoints.A[c] = maxValue - inset;
+        endpoints.B[c] = minValue + inset;
+    }
+}
+
+// Endpoints at the extremes of the texels projected on their principal axis
+void PrincipalAxisEndpoints(const float* const* channels, uint32_t channelCount, Endpoints& endpoints)
+{
+    float mean[4] = {};
+    for (uint32_t c = 0; c < channelCount; ++c)
+    {
+        for (uint32_t i = 0; i < 16; ++i)
+            mean[c] += channels[c][i];
+        mean[c] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        for (uint32_t a = 0; a < channelCount; ++a)
+        {
+            for (uint32_t b = 0; b < channelCount; ++b)
+                covariance[a][b] += (channels[a][i] - mean[a]) * (channels[b][i] - mean[b]);
+        }
+    }
+
+    // Start from the covariance row of the channel that varies the most, the
+    // power iteration then converges on the dominant eigenvector.
+    uint32_t widest = 0;
+    for (uint32_t c = 1; c < channelCount; ++c)
+    {
+        if (covariance[c][c] > covariance[widest][widest])
+            widest = c;
+    }
+
+    // Flat block, every texel is the mean
+    if (covariance[widest][widest] < 1e-4f)
+    {
+        for (uint32_t c = 0; c < channelCount; ++c)
+            endpoints.A[c] = endpoints.B[c] = mean[c];
+        return;
+    }
+
+    float axis[4] = {};
+    for (uint32_t c = 0; c < channelCount; ++c)
+        axis[c] = covariance[widest][c];
+
+    for (uint32_t iteration = 0; iteration < 8; ++iteration)
+    {
+        float next[4] = {};
+        float length = 0.0f;
+
+        for (uint32_t a = 0; a < channelCount; ++a)
+        {
+            for (uint32_t b = 0; b < channelCount; ++b)
+                next[a] += covariance[a][b] * axis[b];
+            length += next[a] * next[a];
+        }
+
+        length = std::sqrt(length);
+        if (length < 1e-6f)
+            break;
+
+        for (uint32_t c = 0; c < channelCount; ++c)
+            axis[c] = next[c] / length;
+    }
+
+    float minProjection = FLT_MAX;
+    float maxProjection = -FLT_MAX;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        float projection = 0.0f;
+        for (uint32_t c = 0; c < channelCount; ++c)
+            projection += (channels[c][i] - mean[c]) * axis[c];
+
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    for (uint32_t c = 0; c < channelCount; ++c)
+    {
+        endpoints.A[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+        endpoints.B[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+    }
+}
+
+// Solve for the endpoints that best fit the texels given their current
+// palette indices. Indices at or past weightCount are ignored.
+bool LeastSquaresEndpoints(const float* const* channels, uint32_t channelCount, const uint8_t* indices, const float* weights, uint32_t weightCount, Endpoints& endpoints)
+{
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        if (indices[i] >= weightCount)
+            continue;
+
+        const float b = weights[indices[i]];
+        const float a = 1.0f - b;
+
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+
+        for (uint32_t c = 0; c < channelCount; ++c)
+        {
+            ax[c] += a * channels[c][i];
+            bx[c] += b * channels[c][i];
+        }
+    }
+
+    const float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f)
+        return false;
+
+    for (uint32_t c = 0; c < channelCount; ++c)
+    {
+        endpoints.A[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+        endpoints.B[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+// BC1
+
+uint16_t Pack565(const float* color)
+{
+    const uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+    const uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+    const uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void Unpack565(uint16_t packed, float* color)
+{
+    const uint32_t r = (packed >> 11) & 31;
+    const uint32_t g = (packed >> 5) & 63;
+    const uint32_t b = packed & 31;
+
+    color[0] = float((r << 3) | (r >> 2));
+    color[1] = float((g << 2) | (g >> 4));
+    color[2] = float((b << 3) | (b >> 2));
+    color[3] = 255.0f;
+}
+
+struct ColorBlock
+{
+    uint16_t Color0;
+    uint16_t Color1;
+    uint8_t Indices[16];
+    float Error;
+};
+
+ColorBlock TryColorEndpoints(const float* const* channels, Endpoints& endpoints, bool threeColor, const bool* transparent)
+{
+    ColorBlock block;
+    block.Color0 = Pack565(endpoints.A);
+    block.Color1 = Pack565(endpoints.B);
+
+    // Four color mode needs color0 > color1, three color mode the opposite
+    if (threeColor ? block.Color0 > block.Color1 : block.Color0 < block.Color1)
+    {
+        std::swap(block.Color0, block.Color1);
+        std::swap(endpoints.A, endpoints.B);
+    }
+
+    float palette[4][4];
+    Unpack565(block.Color0, palette[0]);
+    Unpack565(block.Color1, palette[1]);
+
+    const uint32_t paletteSize = threeColor ? 3 : 4;
+    const float* weights = threeColor ? s_BC1Weights3 : s_BC1Weights4;
+
+    for (uint32_t p = 2; p < paletteSize; ++p)
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+            palette[p][c] = palette[0][c] + (palette[1][c] - palette[0][c]) * weights[p];
+    }
+
+    float errors[16];
+    FindIndices(channels, 3, palette, paletteSize, block.Indices, errors);
+
+    block.Error = 0.0f;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        if (transparent[i])
+            block.Indices[i] = 3;
+        else
+            block.Error += errors[i];
+    }
+
+    // Equal endpoints decode as three color mode, where index 3 is black
+    if (!threeColor && block.Color0 == block.Color1)
+        memset(block.Indices, 0, sizeof(block.Indices));
+
+    return block;
+}
+
+void WriteColorBlock(const ColorBlock& block, uint8_t* output)
+{
+    uint32_t indices = 0;
+    for (uint32_t i = 0; i < 16; ++i)
+        indices |= uint32_t(block.Indices[i]) << (i * 2);
+
+    memcpy(output, &block.Color0, 2);
+    memcpy(output + 2, &block.Color1, 2);
+    memcpy(output + 4, &indices, 4);
+}
+
+void EncodeColor(const BlockTexels& source, bool allowTransparent, EncodeQuality quality, uint8_t* output)
+{
+    BlockTexels block = source;
+
+    bool transparent[16] = {};
+    uint32_t transparentCount = 0;
+    float opaqueMean[3] = {};
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        transparent[i] = allowTransparent && block.Channels[3][i] < 128.0f;
+
+        if (transparent[i])
+        {
+            transparentCount++;
+            continue;
+        }
+
+        for (uint32_t c = 0; c < 3; ++c)
+            opaqueMean[c] += block.Channels[c][i];
+    }
+
+    if (transparentCount == 16)
+    {
+        // Three color mode with every index pointing at transparent black
+        const uint8_t allTransparent[8] = { 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff };
+        memcpy(output, allTransparent, sizeof(allTransparent));
+        return;
+    }
+
+    // Moving transparent texels to the opaque mean keeps them from pulling
+    // the endpoints around.
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+        opaqueMean[c] /= float(16 - transparentCount);
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            if (transparent[i])
+                block.Channels[c][i] = opaqueMean[c];
+        }
+    }
+
+    const float* channels[3] = { block.Channels[0], block.Channels[1], block.Channels[2] };
+    const bool threeColor = transparentCount > 0;
+    const float* weights = threeColor ? s_BC1Weights3 : s_BC1Weights4;
+    const uint32_t weightCount = threeColor ? 3 : 4;
+
+    // Fast fits the bounding box. The principal axis misses blocks whose
+    // colors don't lie along a line, so the other presets refine both and
+    // keep whichever ends up closer.
+    Endpoints starts[2];
+    uint32_t startCount = 0;
+
+    BoundingBoxEndpoints(channels, 3, starts[startCount++]);
+    if (quality != EncodeQuality::Fast)
+        PrincipalAxisEndpoints(channels, 3, starts[startCount++]);
+
+    const uint32_t iterations = quality == EncodeQuality::Fast ? 0 : (quality == EncodeQuality::Normal ? 1 : 4);
+
+    ColorBlock best = {};
+    best.Error = FLT_MAX;
+
+    for (uint32_t start = 0; start < startCount; ++start)
+    {
+        Endpoints endpoints = starts[start];
+        ColorBlock fit = TryColorEndpoints(channels, endpoints, threeColor, transparent);
+
+        for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+        {
+            Endpoints refined = endpoints;
+            if (!LeastSquaresEndpoints(channels, 3, fit.Indices, weights, weightCount, refined))
+                break;
+
+            ColorBlock candidate = TryColorEndpoints(channels, refined, threeColor, transparent);
+            if (candidate.Error >= fit.Error)
+                break;
+
+            fit = candidate;
+            endpoints = refined;
+        }
+
+        if (fit.Error < best.Error)
+            best = fit;
+    }
+
+    WriteColorBlock(best, output);
+}
+
+// BC4
+
+struct SingleChannelBlock
+{
+    uint8_t Endpoint0;
+    uint8_t Endpoint1;
+    uint8_t Indices[16];
+    float Error;
+};
+
+SingleChannelBlock TrySingleChannelEndpoints(const float* values, int endpoint0, int endpoint1)
+{
+    SingleChannelBlock block;
+    block.Endpoint0 = static_cast<uint8_t>(std::clamp(endpoint0, 0, 255));
+    block.Endpoint1 = static_cast<uint8_t>(std::clamp(endpoint1, 0, 255));
+
+    const float e0 = block.Endpoint0;
+    const float e1 = block.Endpoint1;
+
+    float palette[8][4] = {};
+    palette[0][0] = e0;
+    palette[1][0] = e1;
+
+    if (block.Endpoint0 > block.Endpoint1)
+    {
+        for (uint32_t p = 2; p < 8; ++p)
+            palette[p][0] = e0 + (e1 - e0) * s_BC4Weights8[p];
+    }
+    else
+    {
+        // Six interpolated values plus explicit 0 and 255
+        for (uint32_t p = 2; p < 6; ++p)
+            palette[p][0] = e0 + (e1 - e0) * float(p - 1) / 5.0f;
+
+        palette[6][0] = 0.0f;
+        palette[7][0] = 255.0f;
+    }
+
+    const float* channels[1] = { values };
+    block.Error = FindIndices(channels, 1, palette, 8, block.Indices);
+
+    return block;
+}
+
+void EncodeSingleChannel(const float* values, EncodeQuality quality, uint8_t* output)
+{
+    float minValue = 255.0f, maxValue = 0.0f;
+    float innerMin = 255.0f, innerMax = 0.0f;
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        minValue = std::min(minValue, values[i]);
+        maxValue = std::max(maxValue, values[i]);
+
+        if (values[i] > 0.0f && values[i] < 255.0f)
+        {
+            innerMin = std::min(innerMin, values[i]);
+            innerMax = std::max(innerMax, values[i]);
+        }
+    }
+
+    SingleChannelBlock best = TrySingleChannelEndpoints(values, int(maxValue), int(minValue));
+
+    if (quality != EncodeQuality::Fast)
+    {
+        // Blocks with pure black or white texels fit the six value mode better
+        if (innerMin <= innerMax)
+        {
+            SingleChannelBlock candidate = TrySingleChannelEndpoints(values, int(innerMin), int(innerMax));
+            if (candidate.Error < best.Error)
+                best = candidate;
+        }
+
+        if (best.Endpoint0 > best.Endpoint1)
+        {
+            Endpoints refined;
+            const float* channels[1] = { values };
+
+            if (LeastSquaresEndpoints(channels, 1, best.Indices, s_BC4Weights8, 8, refined))
+            {
+                SingleChannelBlock candidate = TrySingleChannelEndpoints(values, int(refined.A[0] + 0.5f), int(refined.B[0] + 0.5f));
+                if (candidate.Endpoint0 > candidate.Endpoint1 && candidate.Error < best.Error)
+                    best = candidate;
+            }
+        }
+    }
+
+    if (quality == EncodeQuality::High && best.Endpoint0 > best.Endpoint1)
+    {
+        const int center0 = best.Endpoint0;
+        const int center1 = best.Endpoint1;
+
+        for (int delta0 = -2; delta0 <= 2; ++delta0)
+        {
+            for (int delta1 = -2; delta1 <= 2; ++delta1)
+            {
+                if (center0 + delta0 <= center1 + delta1)
+                    continue;
+
+                SingleChannelBlock candidate = TrySingleChannelEndpoints(values, center0 + delta0, center1 + delta1);
+                if (candidate.Error < best.Error)
+                    best = candidate;
+            }
+        }
+    }
+
+    uint64_t indices = 0;
+    for (uint32_t i = 0; i < 16; ++i)
+        indices |= uint64_t(best.Indices[i]) << (i * 3);
+
+    output[0] = best.Endpoint0;
+    output[1] = best.Endpoint1;
+    for (uint32_t i = 0; i < 6; ++i)
+        output[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+}
+
+// BC7
+
+struct Mode6Block
+{
+    uint8_t Endpoint0[4];
+    uint8_t Endpoint1[4];
+    uint8_t PBit0;
+    uint8_t PBit1;
+    uint8_t Indices[16];
+    float Error;
+};
+
+// 7 bit value that, with the shared p bit, lands closest to value
+uint8_t QuantizeWithPBit(float value, uint32_t pbit)
+{
+    const int quantized = static_cast<int>(std::floor((value - float(pbit)) / 2.0f + 0.5f));
+    return static_cast<uint8_t>(std::clamp(quantized, 0, 127));
+}
+
+float PBitError(const float* endpoint, uint32_t pbit)
+{
+    float error = 0.0f;
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        const float decoded = float((QuantizeWithPBit(endpoint[c], pbit) << 1) | pbit);
+        error += (decoded - endpoint[c]) * (decoded - endpoint[c]);
+    }
+
+    return error;
+}
+
+Mode6Block TryMode6(const float* const* channels, const Endpoints& endpoints, uint32_t pbit0, uint32_t pbit1)
+{
+    Mode6Block block;
+    block.PBit0 = static_cast<uint8_t>(pbit0);
+    block.PBit1 = static_cast<uint8_t>(pbit1);
+
+    uint32_t e0[4], e1[4];
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        block.Endpoint0[c] = QuantizeWithPBit(endpoints.A[c], pbit0);
+        block.Endpoint1[c] = QuantizeWithPBit(endpoints.B[c], pbit1);
+
+        e0[c] = (uint32_t(block.Endpoint0[c]) << 1) | pbit0;
+        e1[c] = (uint32_t(block.Endpoint1[c]) << 1) | pbit1;
+    }
+
+    float palette[16][4];
+    for (uint32_t p = 0; p < 16; ++p)
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+            palette[p][c] = float(((64 - s_BC7Weights4[p]) * e0[c] + s_BC7Weights4[p] * e1[c] + 32) >> 6);
+    }
+
+    block.Error = FindIndices(channels, 4, palette, 16, block.Indices);
+
+    return block;
+}
+
+Mode6Block FitMode6(const float* const* channels, const Endpoints& endpoints, bool searchPBits)
+{
+    if (!searchPBits)
+    {
+        const uint32_t pbit0 = PBitError(endpoints.A, 1) < PBitError(endpoints.A, 0) ? 1 : 0;
+        const uint32_t pbit1 = PBitError(endpoints.B, 1) < PBitError(endpoints.B, 0) ? 1 : 0;
+        return TryMode6(channels, endpoints, pbit0, pbit1);
+    }
+
+    Mode6Block best = TryMode6(channels, endpoints, 0, 0);
+    for (uint32_t combination = 1; combination < 4; ++combination)
+    {
+        Mode6Block candidate = TryMode6(channels, endpoints, combination & 1, combination >> 1);
+        if (candidate.Error < best.Error)
+            best = candidate;
+    }
+
+    return best;
+}
+
+struct BitWriter
+{
+    uint8_t* Data;
+    uint32_t Position = 0;
+
+    void Write(uint32_t value, uint32_t bits)
+    {
+        for (uint32_t i = 0; i < bits; ++i, ++Position)
+        {
+            if ((value >> i) & 1)
+                Data[Position >> 3] |= static_cast<uint8_t>(1 << (Position & 7));
+        }
+    }
+};
+
+void WriteMode6Block(Mode6Block block, uint8_t* output)
+{
+    // The anchor texel's index MSB is implicit zero, flip the block if needed
+    if (block.Indices[0] & 8)
+    {
+        std::swap(block.Endpoint0, block.Endpoint1);
+        std::swap(block.PBit0, block.PBit1);
+
+        for (uint8_t& index : block.Indices)
+            index = static_cast<uint8_t>(15 - index);
+    }
+
+    memset(output, 0, 16);
+    BitWriter writer{ output };
+
+    writer.Write(1 << 6, 7);
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        writer.Write(block.Endpoint0[c], 7);
+        writer.Write(block.Endpoint1[c], 7);
+    }
+
+    writer.Write(block.PBit0, 1);
+    writer.Write(block.PBit1, 1);
+
+    writer.Write(block.Indices[0], 3);
+    for (uint32_t i = 1; i < 16; ++i)
+        writer.Write(block.Indices[i], 4);
+}
+}
+
+// Block Compression
+
+void EncodeBlockBC1(const uint8_t* texels, EncodeQuality quality, uint8_t* output)
+{
+    EncodeColor(LoadBlock(texels), true, quality, output);
+}
+
+void EncodeBlockBC3(const uint8_t* texels, EncodeQuality quality, uint8_t* output)
+{
+    const BlockTexels block = LoadBlock(texels);
+
+    // Alpha is stored like a BC4 block, color always uses four color mode
+    EncodeSingleChannel(block.Channels[3], quality, output);
+    EncodeColor(block, false, quality, output + 8);
+}
+
+void EncodeBlockBC4(const uint8_t* texels, EncodeQuality quality, uint8_t* output)
+{
+    const BlockTexels block = LoadBlock(texels);
+    EncodeSingleChannel(block.Channels[0], quality, output);
+}
+
+void EncodeBlockBC5(const uint8_t* texels, EncodeQuality quality, uint8_t* output)
+{
+    const BlockTexels block = LoadBlock(texels);
+    EncodeSingleChannel(block.Channels[0], quality, output);
+    EncodeSingleChannel(block.Channels[1], quality, output + 8);
+}
+
+void EncodeBlockBC7(const uint8_t* texels, EncodeQuality quality, uint8_t* output)
+{
+    const BlockTexels block = LoadBlock(texels);
+    const float* channels[4] = { block.Channels[0], block.Channels[1], block.Channels[2], block.Channels[3] };
+
+    // Like BC1, Fast fits the bounding box and the other presets refine it
+    // and the principal axis, keeping the closer one
+    Endpoints starts[2];
+    uint32_t startCount = 0;
+
+    BoundingBoxEndpoints(channels, 4, starts[startCount++]);
+    if (quality != EncodeQuality::Fast)
+        PrincipalAxisEndpoints(channels, 4, starts[startCount++]);
+
+    const bool searchPBits = quality == EncodeQuality::High;
+
+    const float weights[16] = {
+        0.0f / 64, 4.0f / 64, 9.0f / 64, 13.0f / 64, 17.0f / 64, 21.0f / 64, 26.0f / 64, 30.0f / 64,
+        34.0f / 64, 38.0f / 64, 43.0f / 64, 47.0f / 64, 51.0f / 64, 55.0f / 64, 60.0f / 64, 64.0f / 64
+    };
+
+    const uint32_t iterations = quality == EncodeQuality::Fast ? 0 : (quality == EncodeQuality::Normal ? 1 : 3);
+
+    Mode6Block best = {};
+    best.Error = FLT_MAX;
+
+    for (uint32_t start = 0; start < startCount; ++start)
+    {
+        Endpoints endpoints = starts[start];
+        Mode6Block fit = FitMode6(channels, endpoints, searchPBits);
+
+        for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+        {
+            Endpoints refined = endpoints;
+            if (!LeastSquaresEndpoints(channels, 4, fit.Indices, weights, 16, refined))
+                break;
+
+            Mode6Block candidate = FitMode6(channels, refined, searchPBits);
+            if (candidate.Error >= fit.Error)
+                break;
+
+            fit = candidate;
+            endpoints = refined;
+        }
+
+        if (fit.Error < best.Error)
+            best = fit;
+    }
+
+    WriteMode6Block(best, output);
+}
+
+bool IsEncodableFormat(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1:
+    case TextureFormat::BC1_SRGB:
+    case TextureFormat::BC3:
+    case TextureFormat::BC3_SRGB:
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+    case TextureFormat::BC7:
+    case TextureFormat::BC7_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::vector<uint8_t> CompressImage(const Image& image, TextureFormat format, EncodeQuality quality, ThreadPool& threadPool)
+{
+    void (*encodeBlock)(const uint8_t*, EncodeQuality, uint8_t*) = nullptr;
+
+    switch (format)
+    {
+    case TextureFormat::BC1:
+    case TextureFormat::BC1_SRGB: encodeBlock = EncodeBlockBC1; break;
+    case TextureFormat::BC3:
+    case TextureFormat::BC3_SRGB: encodeBlock = EncodeBlockBC3; break;
+    case TextureFormat::BC4: encodeBlock = EncodeBlockBC4; break;
+    case TextureFormat::BC5: encodeBlock = EncodeBlockBC5; break;
+    case TextureFormat::BC7:
+    case TextureFormat::BC7_SRGB: encodeBlock = EncodeBlockBC7; break;
+    default: throw std::runtime_error("unsupported block compression format!");
+    }
+
+    const uint32_t blockBytes = GetFormatBlockBytes(format);
+    const uint32_t blocksX = std::max((image.Width + 3) / 4, 1u);
+    const uint32_t blocksY = std::max((image.Height + 3) / 4, 1u);
+
+    std::vector<uint8_t> output(size_t(blocksX) * blocksY * blockBytes);
+
+    threadPool.ParallelFor(blocksY, [&](uint32_t begin, uint32_t end) {
+        uint8_t texels[64];
+
+        for (uint32_t blockY = begin; blockY < end; ++blockY)
+        {
+            for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+            {
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    for (uint32_t x = 0; x < 4; ++x)
+                    {
+                        const uint32_t srcX = std::min(blockX * 4 + x, image.Width - 1);
+                        const uint32_t srcY = std::min(blockY * 4 + y, image.Height - 1);
+                        memcpy(&texels[(y * 4 + x) * 4], image.GetTexel(srcX, srcY), 4);
+                    }
+                }
+
+                encodeBlock(texels, quality, &output[(size_t(blockY) * blocksX + blockX) * blockBytes]);
+            }
+        }
+    });
+
+    return output;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Cooker/Image.h"
+#include "Nutcrackz/Renderer/TextureFile.h"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Block Compression
+
+enum class EncodeQuality
+{
+    // Bounding box endpoints, no refinement
+    Fast,
+
+    // Principal axis endpoints with one least squares refinement
+    Normal,
+
+    // Principal axis endpoints, repeated refinement and an endpoint search
+    High
+};
+
+// Encoders for single 4x4 blocks. texels holds 16 RGBA8 texels in row
+// order, output receives 8 (BC1/BC4) or 16 (BC3/BC5/BC7) bytes.
+void EncodeBlockBC1(const uint8_t* texels, EncodeQuality quality, uint8_t* output);
+void EncodeBlockBC3(const uint8_t* texels, EncodeQuality quality, uint8_t* output);
+void EncodeBlockBC4(const uint8_t* texels, EncodeQuality quality, uint8_t* output);
+void EncodeBlockBC5(const uint8_t* texels, EncodeQuality quality, uint8_t* output);
+
+// BC7 blocks are always written as mode 6 (one subset, RGBA endpoints, 4 bit
+// indices), which handles alpha and smooth gradients well at a fraction of
+// the cost of a full mode search.
+void EncodeBlockBC7(const uint8_t* texels, EncodeQuality quality, uint8_t* output);
+
+// Returns true if the format can be produced by CompressImage
+bool IsEncodableFormat(TextureFormat format);
+
+// Compress a whole image, rows of blocks are split across the thread pool.
+// Edge blocks of sizes that aren't a multiple of 4 repeat the last texel.
+std::vector<uint8_t> CompressImage(const Image& image, TextureFormat format, EncodeQuality quality, ThreadPool& threadPool);
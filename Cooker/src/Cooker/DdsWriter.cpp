@@ -0,0 +1,77 @@
+#include "DdsWriter.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// Helper functions
+
+namespace
+{
+uint32_t GetDxgiFormat(TextureFormat format)
+{
+    // Values match the DXGI_FORMAT enum
+    switch (format)
+    {
+    case TextureFormat::RGBA8: return 28;
+    case TextureFormat::RGBA8_SRGB: return 29;
+    case TextureFormat::BC1: return 71;
+    case TextureFormat::BC1_SRGB: return 72;
+    case TextureFormat::BC2: return 74;
+    case TextureFormat::BC2_SRGB: return 75;
+    case TextureFormat::BC3: return 77;
+    case TextureFormat::BC3_SRGB: return 78;
+    case TextureFormat::BC4: return 80;
+    case TextureFormat::BC5: return 83;
+    case TextureFormat::BC6H: return 95;
+    case TextureFormat::BC7: return 98;
+    case TextureFormat::BC7_SRGB: return 99;
+    default: return 0;
+    }
+}
+}
+
+// DDS Output
+
+void WriteDdsFile(const std::string& path, TextureFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& mips)
+{
+    const uint32_t dxgiFormat = GetDxgiFormat(format);
+    if (dxgiFormat == 0)
+        throw std::runtime_error("unsupported output format!");
+
+    // DDS_HEADER laid out as 31 dwords, see ReadDds in TextureFile.cpp
+    uint32_t header[31] = {};
+    header[0] = 124;
+    header[2] = height;
+    header[3] = width;
+    header[4] = static_cast<uint32_t>(mips.empty() ? 0 : mips[0].size());
+    header[6] = static_cast<uint32_t>(mips.size());
+
+    // Caps, height, width, pixel format, mip count and linear size are valid
+    header[1] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+
+    // DDS_PIXELFORMAT with the "DX10" four CC
+    header[18] = 32;
+    header[19] = 0x4;
+    header[20] = 0x30315844;
+
+    header[26] = 0x1000 | 0x8 | 0x400000; // Texture, complex, mipmap
+
+    // DDS_HEADER_DXT10: format, 2D dimension, no flags, one layer
+    const uint32_t dx10[5] = { dxgiFormat, 3, 0, 1, 0 };
+
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open output file!");
+
+    const uint32_t magic = 0x20534444;
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(dx10), sizeof(dx10));
+
+    for (const std::vector<uint8_t>& mip : mips)
+        file.write(reinterpret_cast<const char*>(mip.data()), static_cast<std::streamsize>(mip.size()));
+
+    if (!file)
+        throw std::runtime_error("failed to write output file!");
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Nutcrackz/Renderer/TextureFile.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// DDS Output
+
+// Write a 2D texture as a DDS file with a DX10 header, the container the
+// runtime texture streamer reads. mips holds every level, most detailed
+// first, with tightly packed rows. Throws std::runtime_error on failure.
+void WriteDdsFile(const std::string& path, TextureFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& mips);
@@ -0,0 +1,156 @@
+#include "Image.h"
+
+#include "Nutcrackz/Renderer/TextureFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+// Helper functions
+
+namespace
+{
+#pragma pack(push, 1)
+struct TgaHeader
+{
+    uint8_t IdLength;
+    uint8_t ColorMapType;
+    uint8_t ImageType;
+    uint16_t ColorMapOrigin;
+    uint16_t ColorMapLength;
+    uint8_t ColorMapDepth;
+    uint16_t OriginX;
+    uint16_t OriginY;
+    uint16_t Width;
+    uint16_t Height;
+    uint8_t BitsPerPixel;
+    uint8_t Descriptor;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(TgaHeader) == 18, "TGA header must be 18 bytes");
+
+bool HasExtension(const std::string& path, const char* extension)
+{
+    std::string lower = path;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+
+    const std::string ext = extension;
+    return lower.size() >= ext.size() && lower.compare(lower.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+Image LoadTga(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error("failed to open image!");
+
+    TgaHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    const bool rle = header.ImageType == 10;
+    if (!file || (header.ImageType != 2 && !rle) || header.ColorMapType != 0)
+        throw std::runtime_error("only truecolor TGA images are supported!");
+
+    if (header.BitsPerPixel != 24 && header.BitsPerPixel != 32)
+        throw std::runtime_error("only 24 and 32 bit TGA images are supported!");
+
+    file.seekg(header.IdLength, std::ios::cur);
+
+    Image image;
+    image.Width = header.Width;
+    image.Height = header.Height;
+    image.Texels.resize(size_t(image.Width) * image.Height * 4);
+
+    const uint32_t bytesPerPixel = header.BitsPerPixel / 8;
+    const size_t pixelCount = size_t(image.Width) * image.Height;
+
+    // Read everything as BGR(A) in file order, then fix up order and origin
+    std::vector<uint8_t> pixels(pixelCount * bytesPerPixel);
+
+    if (!rle)
+    {
+        file.read(reinterpret_cast<char*>(pixels.data()), pixels.size());
+    }
+    else
+    {
+        size_t pixel = 0;
+        while (pixel < pixelCount && file)
+        {
+            uint8_t packet = 0;
+            file.read(reinterpret_cast<char*>(&packet), 1);
+
+            const size_t count = std::min<size_t>((packet & 0x7f) + 1, pixelCount - pixel);
+
+            if (packet & 0x80)
+            {
+                uint8_t value[4];
+                file.read(reinterpret_cast<char*>(value), bytesPerPixel);
+
+                for (size_t i = 0; i < count; ++i)
+                    std::copy(value, value + bytesPerPixel, &pixels[(pixel + i) * bytesPerPixel]);
+            }
+            else
+            {
+                file.read(reinterpret_cast<char*>(&pixels[pixel * bytesPerPixel]), count * bytesPerPixel);
+            }
+
+            pixel += count;
+        }
+    }
+
+    if (!file)
+        throw std::runtime_error("unexpected end of TGA image!");
+
+    // Bit 5 of the descriptor is set for top-left origin
+    const bool topDown = (header.Descriptor & 0x20) != 0;
+
+    for (uint32_t y = 0; y < image.Height; ++y)
+    {
+        const uint32_t srcY = topDown ? y : image.Height - 1 - y;
+
+        for (uint32_t x = 0; x < image.Width; ++x)
+        {
+            const uint8_t* src = &pixels[(size_t(srcY) * image.Width + x) * bytesPerPixel];
+            uint8_t* dst = &image.Texels[(size_t(y) * image.Width + x) * 4];
+
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            dst[3] = bytesPerPixel == 4 ? src[3] : 255;
+        }
+    }
+
+    return image;
+}
+
+Image LoadTextureFile(const std::string& path)
+{
+    const TextureFileDesc desc = ReadTextureFileDesc(path);
+
+    if (desc.Format != TextureFormat::RGBA8 && desc.Format != TextureFormat::RGBA8_SRGB)
+        throw std::runtime_error("source textures must be uncompressed RGBA8!");
+
+    Image image;
+    image.Width = desc.Width;
+    image.Height = desc.Height;
+    image.Texels = ReadTextureMips(desc, 0, 0);
+
+    return image;
+}
+}
+
+// Images
+
+Image LoadSourceImage(const std::string& path)
+{
+    if (HasExtension(path, ".tga"))
+        return LoadTga(path);
+
+    if (HasExtension(path, ".dds") || HasExtension(path, ".ktx2"))
+        return LoadTextureFile(path);
+
+    throw std::runtime_error("unsupported image file extension!");
+}
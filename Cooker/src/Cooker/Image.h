@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Images
+
+// An uncompressed 8 bit per channel RGBA image, rows are tightly packed
+struct Image
+{
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    std::vector<uint8_t> Texels;
+
+    const uint8_t* GetTexel(uint32_t x, uint32_t y) const { return &Texels[(size_t(y) * Width + x) * 4]; }
+};
+
+// Load a source image. Supports uncompressed and RLE TGA files, as well as
+// RGBA8 DDS/KTX2 files (only their most detailed mip). Throws
+// std::runtime_error on failure.
+Image LoadSourceImage(const std::string& path);
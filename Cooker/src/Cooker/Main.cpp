@@ -0,0 +1,266 @@
+#include "Cooker/BCDecoder.h"
+#include "Cooker/BCEncoder.h"
+#include "Cooker/DdsWriter.h"
+#include "Cooker/Image.h"
+#include "Cooker/MipGenerator.h"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Helper functions
+
+namespace
+{
+struct CookOptions
+{
+    std::string Input;
+    std::string Output;
+    TextureFormat Format = TextureFormat::BC7;
+    EncodeQuality Quality = EncodeQuality::Normal;
+    MipOptions Mips;
+    uint32_t Threads = 0;
+    uint32_t Iterations = 3;
+    bool Bench = false;
+};
+
+void PrintUsage()
+{
+    std::cout << "Usage:\n"
+                 "  Cooker <input> <output.dds> [options]\n"
+                 "  Cooker --bench <input> [options]\n"
+                 "\n"
+                 "Options:\n"
+                 "  --format bc1|bc3|bc4|bc5|bc7      Output format (default bc7)\n"
+                 "  --quality fast|normal|high        Encoder preset (default normal)\n"
+                 "  --filter box|triangle|kaiser      Mip filter (default kaiser)\n"
+                 "  --linear                          Color data isn't sRGB encoded\n"
+                 "  --threads <count>                 Worker threads (default all cores)\n"
+                 "  --iterations <count>              Benchmark repetitions (default 3)\n";
+}
+
+bool ParseFormat(const std::string& name, TextureFormat& format)
+{
+    if (name == "bc1") format = TextureFormat::BC1;
+    else if (name == "bc3") format = TextureFormat::BC3;
+    else if (name == "bc4") format = TextureFormat::BC4;
+    else if (name == "bc5") format = TextureFormat::BC5;
+    else if (name == "bc7") format = TextureFormat::BC7;
+    else return false;
+
+    return true;
+}
+
+bool ParseQuality(const std::string& name, EncodeQuality& quality)
+{
+    if (name == "fast") quality = EncodeQuality::Fast;
+    else if (name == "normal") quality = EncodeQuality::Normal;
+    else if (name == "high") quality = EncodeQuality::High;
+    else return false;
+
+    return true;
+}
+
+bool ParseFilter(const std::string& name, MipFilter& filter)
+{
+    if (name == "box") filter = MipFilter::Box;
+    else if (name == "triangle") filter = MipFilter::Triangle;
+    else if (name == "kaiser") filter = MipFilter::Kaiser;
+    else return false;
+
+    return true;
+}
+
+bool ParseArguments(int argc, const char** argv, CookOptions& options)
+{
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--bench")
+            options.Bench = true;
+        else if (argument == "--linear")
+            options.Mips.Srgb = false;
+        else if (argument == "--format" && hasValue)
+        {
+            if (!ParseFormat(argv[++i], options.Format))
+                return false;
+        }
+        else if (argument == "--quality" && hasValue)
+        {
+            if (!ParseQuality(argv[++i], options.Quality))
+                return false;
+        }
+        else if (argument == "--filter" && hasValue)
+        {
+            if (!ParseFilter(argv[++i], options.Mips.Filter))
+                return false;
+        }
+        else if (argument == "--threads" && hasValue)
+            options.Threads = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (argument == "--iterations" && hasValue)
+            options.Iterations = std::max(static_cast<uint32_t>(std::atoi(argv[++i])), 1u);
+        else if (argument.rfind("--", 0) == 0)
+            return false;
+        else
+            positional.push_back(argument);
+    }
+
+    if (options.Bench ? positional.size() != 1 : positional.size() != 2)
+        return false;
+
+    options.Input = positional[0];
+    if (!options.Bench)
+        options.Output = positional[1];
+
+    return true;
+}
+
+TextureFormat GetOutputFormat(TextureFormat format, bool srgb)
+{
+    if (!srgb)
+        return format;
+
+    switch (format)
+    {
+    case TextureFormat::BC1: return TextureFormat::BC1_SRGB;
+    case TextureFormat::BC3: return TextureFormat::BC3_SRGB;
+    case TextureFormat::BC7: return TextureFormat::BC7_SRGB;
+    default: return format;
+    }
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int Cook(const CookOptions& options, ThreadPool& threadPool)
+{
+    const Image source = LoadSourceImage(options.Input);
+
+    // BC4/BC5 hold data such as masks and normals, never filter those in
+    // linear light
+    MipOptions mipOptions = options.Mips;
+    if (options.Format == TextureFormat::BC4 || options.Format == TextureFormat::BC5)
+        mipOptions.Srgb = false;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::vector<Image> chain = GenerateMipChain(source, mipOptions, threadPool);
+
+    std::vector<std::vector<uint8_t>> mips;
+    for (const Image& level : chain)
+        mips.push_back(CompressImage(level, options.Format, options.Quality, threadPool));
+
+    const TextureFormat outputFormat = GetOutputFormat(options.Format, mipOptions.Srgb);
+    WriteDdsFile(options.Output, outputFormat, source.Width, source.Height, mips);
+
+    std::cout << "Cooked " << options.Input << " (" << source.Width << "x" << source.Height << ", "
+              << chain.size() << " mips) in " << SecondsSince(start) * 1000.0 << " ms\n";
+
+    return 0;
+}
+
+int Bench(const CookOptions& options, ThreadPool& threadPool)
+{
+    const Image source = LoadSourceImage(options.Input);
+    const double megapixels = double(source.Width) * source.Height / 1e6;
+
+    // BC1 is meant for opaque textures, measuring it against the source's
+    // alpha would just measure the 1 bit alpha cutout.
+    Image opaqueSource = source;
+    for (size_t i = 3; i < opaqueSource.Texels.size(); i += 4)
+        opaqueSource.Texels[i] = 255;
+
+    std::cout << "Benchmarking " << options.Input << " (" << source.Width << "x" << source.Height << ") on "
+              << threadPool.GetWorkerCount() << " threads, best of " << options.Iterations << "\n\n";
+
+    // Mip generation
+    std::printf("%-10s %12s\n", "Filter", "MPix/s");
+
+    const MipFilter filters[] = { MipFilter::Box, MipFilter::Triangle, MipFilter::Kaiser };
+    const char* filterNames[] = { "box", "triangle", "kaiser" };
+
+    for (uint32_t f = 0; f < 3; ++f)
+    {
+        MipOptions mipOptions = options.Mips;
+        mipOptions.Filter = filters[f];
+
+        double best = 1e30;
+        for (uint32_t iteration = 0; iteration < options.Iterations; ++iteration)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            GenerateMipChain(source, mipOptions, threadPool);
+            best = std::min(best, SecondsSince(start));
+        }
+
+        std::printf("%-10s %12.1f\n", filterNames[f], megapixels / best);
+    }
+
+    // Block compression
+    std::printf("\n%-8s %-8s %12s %10s\n", "Format", "Quality", "MPix/s", "PSNR (dB)");
+
+    const TextureFormat formats[] = { TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC4, TextureFormat::BC5, TextureFormat::BC7 };
+    const char* formatNames[] = { "bc1", "bc3", "bc4", "bc5", "bc7" };
+    const EncodeQuality qualities[] = { EncodeQuality::Fast, EncodeQuality::Normal, EncodeQuality::High };
+    const char* qualityNames[] = { "fast", "normal", "high" };
+
+    for (uint32_t f = 0; f < 5; ++f)
+    {
+        const Image& input = formats[f] == TextureFormat::BC1 ? opaqueSource : source;
+
+        for (uint32_t q = 0; q < 3; ++q)
+        {
+            std::vector<uint8_t> compressed;
+
+            double best = 1e30;
+            for (uint32_t iteration = 0; iteration < options.Iterations; ++iteration)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                compressed = CompressImage(input, formats[f], qualities[q], threadPool);
+                best = std::min(best, SecondsSince(start));
+            }
+
+            const Image decoded = DecompressImage(compressed, input.Width, input.Height, formats[f]);
+            const double psnr = ComputePSNR(input, decoded, formats[f]);
+
+            std::printf("%-8s %-8s %12.1f %10.2f\n", formatNames[f], qualityNames[q], megapixels / best, psnr);
+        }
+    }
+
+    return 0;
+}
+}
+
+int main(int argc, const char** argv)
+{
+    CookOptions options;
+
+    if (!ParseArguments(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    try
+    {
+        ThreadPool threadPool(options.Threads);
+
+        return options.Bench ? Bench(options, threadPool) : Cook(options, threadPool);
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,297 @@
+#include "MipGenerator.h"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <emmintrin.h>
+
+// Helper functions
+
+namespace
+{
+const float s_Pi = 3.14159265358979f;
+
+// Linear RGBA image, one __m128 per texel
+struct FloatImage
+{
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    std::vector<float> Texels;
+};
+
+struct FilterTaps
+{
+    // Source texels and their normalized weights for every destination
+    // texel, taps past the edge are clamped to it
+    std::vector<std::vector<uint32_t>> Indices;
+    std::vector<std::vector<float>> Weights;
+};
+
+float BesselI0(float x)
+{
+    // Power series, converges quickly for the small arguments used here
+    float sum = 1.0f;
+    float term = 1.0f;
+    const float halfX = x * 0.5f;
+
+    for (int k = 1; k < 16; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+    }
+
+    return sum;
+}
+
+float FilterRadius(MipFilter filter)
+{
+    switch (filter)
+    {
+    case MipFilter::Box: return 0.5f;
+    case MipFilter::Triangle: return 1.0f;
+    case MipFilter::Kaiser: return 1.5f;
+    }
+
+    return 0.5f;
+}
+
+// Distance is measured in destination texels
+float FilterWeight(MipFilter filter, float distance)
+{
+    const float d = std::fabs(distance);
+
+    switch (filter)
+    {
+    case MipFilter::Box:
+        return d <= 0.5f ? 1.0f : 0.0f;
+    case MipFilter::Triangle:
+        return std::max(1.0f - d, 0.0f);
+    case MipFilter::Kaiser:
+    {
+        const float radius = FilterRadius(filter);
+        if (d >= radius)
+            return 0.0f;
+
+        const float alpha = 4.0f;
+        const float sinc = d < 1e-5f ? 1.0f : std::sin(s_Pi * d) / (s_Pi * d);
+        const float ratio = d / radius;
+        const float window = BesselI0(alpha * std::sqrt(1.0f - ratio * ratio)) / BesselI0(alpha);
+
+        return sinc * window;
+    }
+    }
+
+    return 0.0f;
+}
+
+FilterTaps BuildTaps(MipFilter filter, uint32_t srcSize, uint32_t dstSize)
+{
+    FilterTaps taps;
+    taps.Indices.resize(dstSize);
+    taps.Weights.resize(dstSize);
+
+    const float scale = float(srcSize) / float(dstSize);
+    const float support = FilterRadius(filter) * scale;
+
+    for (uint32_t dst = 0; dst < dstSize; ++dst)
+    {
+        const float center = (dst + 0.5f) * scale;
+        const int first = static_cast<int>(std::floor(center - support));
+        const int last = static_cast<int>(std::ceil(center + support));
+
+        float total = 0.0f;
+        for (int src = first; src <= last; ++src)
+        {
+            const float weight = FilterWeight(filter, ((src + 0.5f) - center) / scale);
+            if (weight == 0.0f)
+                continue;
+
+            taps.Indices[dst].push_back(static_cast<uint32_t>(std::clamp(src, 0, int(srcSize) - 1)));
+            taps.Weights[dst].push_back(weight);
+            total += weight;
+        }
+
+        for (float& weight : taps.Weights[dst])
+            weight /= total;
+    }
+
+    return taps;
+}
+
+float SrgbToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSrgb(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+class ColorTables
+{
+  public:
+    ColorTables()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+            m_ToLinear[i] = SrgbToLinear(i / 255.0f);
+
+        for (uint32_t i = 0; i < s_EncodeSize; ++i)
+            m_ToSrgb[i] = static_cast<uint8_t>(LinearToSrgb(i / float(s_EncodeSize - 1)) * 255.0f + 0.5f);
+    }
+
+    float ToLinear(uint8_t value) const { return m_ToLinear[value]; }
+
+    uint8_t ToSrgb(float value) const
+    {
+        return m_ToSrgb[static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * (s_EncodeSize - 1) + 0.5f)];
+    }
+
+  protected:
+    static const uint32_t s_EncodeSize = 4096;
+
+    float m_ToLinear[256];
+    uint8_t m_ToSrgb[s_EncodeSize];
+};
+
+const ColorTables& GetColorTables()
+{
+    static const ColorTables tables;
+    return tables;
+}
+
+FloatImage ToFloat(const Image& image, bool srgb)
+{
+    const ColorTables& tables = GetColorTables();
+
+    FloatImage result;
+    result.Width = image.Width;
+    result.Height = image.Height;
+    result.Texels.resize(image.Texels.size());
+
+    for (size_t i = 0; i < image.Texels.size(); i += 4)
+    {
+        for (size_t c = 0; c < 3; ++c)
+            result.Texels[i + c] = srgb ? tables.ToLinear(image.Texels[i + c]) : image.Texels[i + c] / 255.0f;
+
+        result.Texels[i + 3] = image.Texels[i + 3] / 255.0f;
+    }
+
+    return result;
+}
+
+Image ToImage(const FloatImage& image, bool srgb, ThreadPool& threadPool)
+{
+    const ColorTables& tables = GetColorTables();
+
+    Image result;
+    result.Width = image.Width;
+    result.Height = image.Height;
+    result.Texels.resize(image.Texels.size());
+
+    threadPool.ParallelFor(image.Height, [&](uint32_t begin, uint32_t end) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(255.0f);
+
+        for (size_t i = size_t(begin) * image.Width * 4; i < size_t(end) * image.Width * 4; i += 4)
+        {
+            const __m128 texel = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&image.Texels[i]), zero), one);
+
+            // Rounds to nearest
+            const __m128i quantized = _mm_cvtps_epi32(_mm_mul_ps(texel, scale));
+            alignas(16) int32_t values[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(values), quantized);
+
+            for (size_t c = 0; c < 3; ++c)
+                result.Texels[i + c] = srgb ? tables.ToSrgb(image.Texels[i + c]) : static_cast<uint8_t>(values[c]);
+
+            result.Texels[i + 3] = static_cast<uint8_t>(values[3]);
+        }
+    });
+
+    return result;
+}
+
+FloatImage Downsample(const FloatImage& src, MipFilter filter, ThreadPool& threadPool)
+{
+    const uint32_t dstWidth = std::max(src.Width / 2, 1u);
+    const uint32_t dstHeight = std::max(src.Height / 2, 1u);
+
+    const FilterTaps horizontal = BuildTaps(filter, src.Width, dstWidth);
+    const FilterTaps vertical = BuildTaps(filter, src.Height, dstHeight);
+
+    // Horizontal pass: src.Height rows of dstWidth texels
+    std::vector<float> temp(size_t(dstWidth) * src.Height * 4);
+
+    threadPool.ParallelFor(src.Height, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; ++y)
+        {
+            const float* srcRow = &src.Texels[size_t(y) * src.Width * 4];
+            float* dstRow = &temp[size_t(y) * dstWidth * 4];
+
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                const std::vector<uint32_t>& indices = horizontal.Indices[x];
+                const std::vector<float>& weights = horizontal.Weights[x];
+
+                __m128 sum = _mm_setzero_ps();
+                for (size_t t = 0; t < indices.size(); ++t)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(srcRow + indices[t] * 4), _mm_set1_ps(weights[t])));
+
+                _mm_storeu_ps(dstRow + x * 4, sum);
+            }
+        }
+    });
+
+    // Vertical pass, accumulating whole rows keeps the reads sequential
+    FloatImage dst;
+    dst.Width = dstWidth;
+    dst.Height = dstHeight;
+    dst.Texels.resize(size_t(dstWidth) * dstHeight * 4);
+
+    threadPool.ParallelFor(dstHeight, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; ++y)
+        {
+            float* dstRow = &dst.Texels[size_t(y) * dstWidth * 4];
+
+            for (size_t t = 0; t < vertical.Indices[y].size(); ++t)
+            {
+                const float* srcRow = &temp[size_t(vertical.Indices[y][t]) * dstWidth * 4];
+                const __m128 weight = _mm_set1_ps(vertical.Weights[y][t]);
+
+                for (uint32_t x = 0; x < dstWidth; ++x)
+                {
+                    const __m128 accumulated = _mm_loadu_ps(dstRow + x * 4);
+                    _mm_storeu_ps(dstRow + x * 4, _mm_add_ps(accumulated, _mm_mul_ps(_mm_loadu_ps(srcRow + x * 4), weight)));
+                }
+            }
+        }
+    });
+
+    return dst;
+}
+}
+
+// Mip Generation
+
+std::vector<Image> GenerateMipChain(const Image& base, const MipOptions& options, ThreadPool& threadPool)
+{
+    std::vector<Image> chain;
+    chain.push_back(base);
+
+    // Levels are filtered from the previous unquantized level so rounding
+    // errors don't accumulate down the chain.
+    FloatImage level = ToFloat(base, options.Srgb);
+    const uint32_t minSize = std::max(options.MinSize, 1u);
+
+    while (level.Width > minSize || level.Height > minSize)
+    {
+        level = Downsample(level, options.Filter, threadPool);
+        chain.push_back(ToImage(level, options.Srgb, threadPool));
+    }
+
+    return chain;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Cooker/Image.h"
+
+#include <vector>
+
+class ThreadPool;
+
+// Mip Generation
+
+enum class MipFilter
+{
+    // 2x2 average, fastest and softest on odd sizes
+    Box,
+
+    // Tent filter over 4x4 source texels
+    Triangle,
+
+    // Kaiser windowed sinc over 6x6 source texels, keeps the most detail
+    Kaiser
+};
+
+struct MipOptions
+{
+    MipFilter Filter = MipFilter::Kaiser;
+
+    // Filter in linear space and convert back, RGB only, alpha is always
+    // linear
+    bool Srgb = true;
+
+    // Stop once both sides reach this size, 1 for a full chain
+    uint32_t MinSize = 1;
+};
+
+// Build the full mip chain of base, including base itself as level 0. Each
+// level is filtered from the previous one with a separable SSE filter, rows
+// are split across the thread pool.
+std::vector<Image> GenerateMipChain(const Image& base, const MipOptions& options, ThreadPool& threadPool);
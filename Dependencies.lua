@@ -12,4 +12,8 @@ Library["WinSock"] = "Ws2_32.lib"
 Library["WinMM"] = "Winmm.lib"
 Library["WinVersion"] = "Version.lib"
 Library["BCrypt"] = "Bcrypt.lib"
-Library["Dbghelp"] = "Dbghelp.lib"
\ No newline at end of file
+Library["Dbghelp"] = "Dbghelp.lib"
+
+-- Linux
+Library["Vulkan"] = "vulkan"
+Library["XCB"] = "xcb"
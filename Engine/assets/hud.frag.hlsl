@@ -0,0 +1,30 @@
+// Must match HudFont::s_AtlasWidth
+#define HUD_ATLAS_WIDTH 96
+
+// One bit per texel, rows of HUD_ATLAS_WIDTH bits
+StructuredBuffer<uint> hudFont : register(t7);
+
+struct SPIRV_Cross_Input
+{
+    float2 inTexel : TEXCOORD0;
+    float4 inColor : COLOR;
+};
+
+struct SPIRV_Cross_Output
+{
+    float4 outFragColor : SV_Target0;
+};
+
+SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
+{
+    // Nearest texel, glyphs are drawn at whole multiples of their size
+    const uint2 texel = uint2(stage_input.inTexel);
+    const uint bit = texel.y * HUD_ATLAS_WIDTH + texel.x;
+
+    if (((hudFont[bit >> 5] >> (bit & 31)) & 1) == 0)
+        discard;
+
+    SPIRV_Cross_Output stage_output;
+    stage_output.outFragColor = stage_input.inColor;
+    return stage_output;
+}
@@ -0,0 +1,46 @@
+// Must match HudQuad, rectangles are x, y, width, height
+struct HudQuad
+{
+    float4 rect;
+    float4 texelRect;
+    uint color;
+    uint3 padding;
+};
+
+// Must match Renderer::HudConstants
+struct HudConstants
+{
+    float2 inverseTargetSize;
+};
+
+// Root constants on DirectX 12, push constants on Vulkan
+#ifdef __spirv__
+[[vk::push_constant]] HudConstants hudConstants;
+#else
+ConstantBuffer<HudConstants> hudConstants : register(b4);
+#endif
+
+StructuredBuffer<HudQuad> hudQuads : register(t6);
+
+struct SPIRV_Cross_Output
+{
+    float2 outTexel : TEXCOORD0;
+    float4 outColor : COLOR;
+    float4 gl_Position : SV_Position;
+};
+
+// Two triangles per quad instance, no vertex buffer needed
+SPIRV_Cross_Output main(uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID)
+{
+    const HudQuad quad = hudQuads[instanceId];
+
+    // Corners 0, 1, 2 and 2, 1, 3 of the quad
+    const float2 corner = float2((0x32 >> vertexId) & 1, (0x2C >> vertexId) & 1);
+    const float2 pixel = quad.rect.xy + corner * quad.rect.zw;
+
+    SPIRV_Cross_Output stage_output;
+    stage_output.outTexel = quad.texelRect.xy + corner * quad.texelRect.zw;
+    stage_output.outColor = float4(quad.color & 0xff, (quad.color >> 8) & 0xff, (quad.color >> 16) & 0xff, quad.color >> 24) / 255.0f;
+    stage_output.gl_Position = float4(pixel * hudConstants.inverseTargetSize * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+    return stage_output;
+}
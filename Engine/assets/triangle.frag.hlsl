@@ -1,9 +1,63 @@
+// Must match MaterialRegistry::s_MaxMaterials
+#define MAX_MATERIALS 4096
+
+// Material parameters, one stream of 16 byte blocks per parameter group
+#define MATERIAL_BASE_COLOR_STREAM 0
+#define MATERIAL_SURFACE_STREAM 1
+#define MATERIAL_TEXTURE_STREAM 2
+
+#define INVALID_INDEX 0xffffffff
+
+// Light reaching surfaces no point light does
+#define AMBIENT_LIGHT 0.35f
+
+ByteAddressBuffer materials : register(t1);
+StructuredBuffer<uint> textureDescriptors : register(t2);
+
+Texture2D bindlessTextures[] : register(t0, space1);
+SamplerState linearSampler : register(s0);
+
+// Matches ClusterConstants
+cbuffer clusterConstants : register(b3)
+{
+    uint tilesX;
+    uint tilesY;
+    uint slices;
+    uint lightCount;
+    float2 tileScale;
+    float sliceScale;
+    float sliceBias;
+};
+
+// Matches ClusterLight, in view space
+struct ClusterLight
+{
+    float3 position;
+    float radius;
+    float3 color;
+    float padding;
+};
+
+StructuredBuffer<ClusterLight> lights : register(t3);
+
+// Offset and count into lightIndices, per cluster
+StructuredBuffer<uint2> clusters : register(t4);
+StructuredBuffer<uint> lightIndices : register(t5);
+
 static float4 outFragColor;
 static float3 inColor;
+static float2 inTexCoord;
+static uint inMaterialIndex;
+static float3 inViewPos;
+static float4 gl_FragCoord;
 
 struct SPIRV_Cross_Input
 {
     float3 inColor : COLOR;
+    float2 inTexCoord : TEXCOORD0;
+    nointerpolation uint inMaterialIndex : MATERIAL;
+    float3 inViewPos : VIEWPOS;
+    float4 gl_FragCoord : SV_Position;
 };
 
 struct SPIRV_Cross_Output
@@ -11,14 +65,71 @@ struct SPIRV_Cross_Output
     float4 outFragColor : SV_Target0;
 };
 
+uint4 loadMaterialBlock(uint stream, uint material)
+{
+    return materials.Load4((stream * MAX_MATERIALS + material) * 16);
+}
+
+uint clusterIndex()
+{
+    uint2 tile = min(uint2(gl_FragCoord.xy * tileScale), uint2(tilesX, tilesY) - 1);
+    int slice = int(floor(log(max(inViewPos.z, 1e-4f)) * sliceScale + sliceBias));
+    uint clampedSlice = uint(clamp(slice, 0, int(slices) - 1));
+
+    return (clampedSlice * tilesY + tile.y) * tilesX + tile.x;
+}
+
+// Only the lights binned into this pixel's cluster are looked at
+float3 clusteredLighting()
+{
+    // Geometry carries no normals yet, use the face normal facing the viewer
+    float3 normal = normalize(cross(ddy(inViewPos), ddx(inViewPos)));
+    if (dot(normal, inViewPos) > 0.0f)
+        normal = -normal;
+
+    float3 lighting = AMBIENT_LIGHT;
+
+    uint2 cluster = clusters[clusterIndex()];
+    for (uint i = 0; i < cluster.y; i++)
+    {
+        ClusterLight light = lights[lightIndices[cluster.x + i]];
+
+        float3 toLight = light.position - inViewPos;
+        float distance = length(toLight);
+        float falloff = saturate(1.0f - distance / light.radius);
+
+        lighting += light.color * (falloff * falloff * saturate(dot(normal, toLight / max(distance, 1e-4f))));
+    }
+
+    return lighting;
+}
+
 void frag_main()
 {
-    outFragColor = float4(inColor, 1.0f);
+    float4 baseColor = asfloat(loadMaterialBlock(MATERIAL_BASE_COLOR_STREAM, inMaterialIndex));
+    float4 surface = asfloat(loadMaterialBlock(MATERIAL_SURFACE_STREAM, inMaterialIndex));
+    uint4 textures = loadMaterialBlock(MATERIAL_TEXTURE_STREAM, inMaterialIndex);
+
+    if (textures.x != INVALID_INDEX)
+    {
+        uint descriptor = textureDescriptors[textures.x];
+        if (descriptor != INVALID_INDEX)
+            baseColor *= bindlessTextures[NonUniformResourceIndex(descriptor)].Sample(linearSampler, inTexCoord);
+    }
+
+    if (baseColor.a < surface.w)
+        discard;
+
+    outFragColor = float4(inColor * baseColor.rgb * clusteredLighting(), baseColor.a);
 }
 
 SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
 {
     inColor = stage_input.inColor;
+    inTexCoord = stage_input.inTexCoord;
+    inMaterialIndex = stage_input.inMaterialIndex;
+    inViewPos = stage_input.inViewPos;
+    gl_FragCoord = stage_input.gl_FragCoord;
     frag_main();
     SPIRV_Cross_Output stage_output;
     stage_output.outFragColor = outFragColor;
@@ -1,40 +1,78 @@
 cbuffer ubo : register(b0)
 {
     row_major float4x4 ubo_projectionMatrix : packoffset(c0);
-    row_major float4x4 ubo_modelMatrix : packoffset(c4);
-    row_major float4x4 ubo_viewMatrix : packoffset(c8);
+    row_major float4x4 ubo_viewMatrix : packoffset(c4);
 };
 
+struct SceneObject
+{
+    row_major float4x4 transform;
+    float3 boundsCenter;
+    float boundsRadius;
+    uint materialIndex;
+    uint3 padding;
+};
+
+StructuredBuffer<SceneObject> sceneObjects : register(t0);
+
+struct DrawConstants
+{
+    uint objectIndex;
+};
+
+// A root constant on DirectX 12, a push constant on Vulkan
+#ifdef __spirv__
+[[vk::push_constant]] DrawConstants drawConstants;
+#else
+ConstantBuffer<DrawConstants> drawConstants : register(b1);
+#endif
+
 static float4 gl_Position;
 static float3 outColor;
+static float2 outTexCoord;
+static uint outMaterialIndex;
+static float3 outViewPos;
 static float3 inColor;
 static float3 inPos;
+static float2 inTexCoord;
 
 struct SPIRV_Cross_Input
 {
     float3 inPos : POSITION;
     float3 inColor : COLOR;
+    float2 inTexCoord : TEXCOORD0;
 };
 
 struct SPIRV_Cross_Output
 {
     float3 outColor : COLOR;
+    float2 outTexCoord : TEXCOORD0;
+    nointerpolation uint outMaterialIndex : MATERIAL;
+    float3 outViewPos : VIEWPOS;
     float4 gl_Position : SV_Position;
 };
 
 void vert_main()
 {
     outColor = inColor;
-    gl_Position = mul(float4(inPos, 1.0f), mul(ubo_modelMatrix, mul(ubo_viewMatrix, ubo_projectionMatrix)));
+    outTexCoord = inTexCoord;
+    outMaterialIndex = sceneObjects[drawConstants.objectIndex].materialIndex;
+    float4 viewPos = mul(float4(inPos, 1.0f), mul(sceneObjects[drawConstants.objectIndex].transform, ubo_viewMatrix));
+    outViewPos = viewPos.xyz;
+    gl_Position = mul(viewPos, ubo_projectionMatrix);
 }
 
 SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
 {
     inColor = stage_input.inColor;
     inPos = stage_input.inPos;
+    inTexCoord = stage_input.inTexCoord;
     vert_main();
     SPIRV_Cross_Output stage_output;
     stage_output.gl_Position = gl_Position;
     stage_output.outColor = outColor;
+    stage_output.outTexCoord = outTexCoord;
+    stage_output.outMaterialIndex = outMaterialIndex;
+    stage_output.outViewPos = outViewPos;
     return stage_output;
 }
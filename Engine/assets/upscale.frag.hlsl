@@ -0,0 +1,37 @@
+// Must match Renderer::UpscaleConstants
+struct UpscaleConstants
+{
+    float2 uvScale;
+    float2 uvMax;
+    uint sourceDescriptor;
+};
+
+// Root constants on DirectX 12, push constants on Vulkan
+#ifdef __spirv__
+[[vk::push_constant]] UpscaleConstants upscaleConstants;
+#else
+ConstantBuffer<UpscaleConstants> upscaleConstants : register(b2);
+#endif
+
+Texture2D bindlessTextures[] : register(t0, space1);
+SamplerState clampSampler : register(s1);
+
+struct SPIRV_Cross_Input
+{
+    float2 inTexCoord : TEXCOORD0;
+};
+
+struct SPIRV_Cross_Output
+{
+    float4 outFragColor : SV_Target0;
+};
+
+SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
+{
+    // The scene only covers the top left of its target, stay inside it
+    float2 uv = min(stage_input.inTexCoord * upscaleConstants.uvScale, upscaleConstants.uvMax);
+
+    SPIRV_Cross_Output stage_output;
+    stage_output.outFragColor = bindlessTextures[upscaleConstants.sourceDescriptor].Sample(clampSampler, uv);
+    return stage_output;
+}
@@ -0,0 +1,14 @@
+struct SPIRV_Cross_Output
+{
+    float2 outTexCoord : TEXCOORD0;
+    float4 gl_Position : SV_Position;
+};
+
+// One triangle covering the whole target, no vertex buffer needed
+SPIRV_Cross_Output main(uint vertexId : SV_VertexID)
+{
+    SPIRV_Cross_Output stage_output;
+    stage_output.outTexCoord = float2((vertexId << 1) & 2, vertexId & 2);
+    stage_output.gl_Position = float4(stage_output.outTexCoord * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+    return stage_output;
+}
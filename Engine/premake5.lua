@@ -16,16 +16,6 @@ project "Engine"
 		"vendor/crosswindow-graphics/src/**.h"
 	}
 
-	defines
-	{
-		"WIN32",
-		"_WINDOWS",
-		"_CRT_SECURE_NO_WARNINGS",
-		"_SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING",
-		"XWIN_WIN32=1",
-		"XGFX_DIRECTX12=1",
-	}
-
 	includedirs
 	{
 		"src",
@@ -41,6 +31,21 @@ project "Engine"
 	
 	filter "system:windows"
 		systemversion "latest"
+
+		defines
+		{
+			"WIN32",
+			"_WINDOWS",
+			"_CRT_SECURE_NO_WARNINGS",
+			"_SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING",
+			"XWIN_WIN32=1",
+			"XGFX_DIRECTX12=1",
+		}
+
+		removefiles
+		{
+			"src/Nutcrackz/Renderer/Vulkan/**"
+		}
 		
 		links
 		{
@@ -51,8 +56,55 @@ project "Engine"
 			"%{Library.Dbghelp}",
 		}
 
+	filter "system:linux"
+		defines
+		{
+			"XWIN_XCB=1",
+			"XGFX_VULKAN=1",
+		}
+
+		-- The DirectX 12 renderer and its subsystems
+		removefiles
+		{
+			"src/Nutcrackz/Renderer/DirectX12*",
+			"src/Nutcrackz/Renderer/BindlessDescriptorHeap.*",
+			"src/Nutcrackz/Renderer/ClusteredLighting.*",
+			"src/Nutcrackz/Renderer/CommandCache.*",
+			"src/Nutcrackz/Renderer/FenceTimeline.*",
+			"src/Nutcrackz/Renderer/FrameReadback.*",
+			"src/Nutcrackz/Renderer/HudRenderer.*",
+			"src/Nutcrackz/Renderer/MaterialRegistry.*",
+			"src/Nutcrackz/Renderer/PersistentBuffer.*",
+			"src/Nutcrackz/Renderer/QueueScheduler.*",
+			"src/Nutcrackz/Renderer/ResidencyManager.*",
+			"src/Nutcrackz/Renderer/TextureStreamer.*",
+		}
+
+		links
+		{
+			"%{Library.Vulkan}",
+			"%{Library.XCB}",
+			"pthread",
+		}
+
+		-- The same HLSL as on Windows, compiled to SPIR-V. t registers move
+		-- to bindings 16 and up, s registers to 32 and up, see VulkanRenderer.
+		prebuildcommands
+		{
+			"dxc -spirv -fvk-t-shift 16 all -fvk-s-shift 32 all -T vs_6_0 -E main -Fo %{prj.location}/assets/triangle.vert.spv %{prj.location}/assets/triangle.vert.hlsl",
+			"dxc -spirv -fvk-t-shift 16 all -fvk-s-shift 32 all -T ps_6_0 -E main -Fo %{prj.location}/assets/triangle.frag.spv %{prj.location}/assets/triangle.frag.hlsl",
+			"dxc -spirv -fvk-t-shift 16 all -fvk-s-shift 32 all -T vs_6_0 -E main -Fo %{prj.location}/assets/upscale.vert.spv %{prj.location}/assets/upscale.vert.hlsl",
+			"dxc -spirv -fvk-t-shift 16 all -fvk-s-shift 32 all -T ps_6_0 -E main -Fo %{prj.location}/assets/upscale.frag.spv %{prj.location}/assets/upscale.frag.hlsl",
+			"dxc -spirv -fvk-t-shift 16 all -fvk-s-shift 32 all -T vs_6_0 -E main -Fo %{prj.location}/assets/hud.vert.spv %{prj.location}/assets/hud.vert.hlsl",
+			"dxc -spirv -fvk-t-shift 16 all -fvk-s-shift 32 all -T ps_6_0 -E main -Fo %{prj.location}/assets/hud.frag.spv %{prj.location}/assets/hud.frag.hlsl",
+		}
+
 	filter "configurations:Debug"
-		defines "SDR_DEBUG"
+		defines
+		{
+			"SDR_DEBUG",
+			"SDR_MEMORY_TRACKING"
+		}
 		runtime "Debug"
 		symbols "on"
 		inlining ("Auto")
@@ -60,7 +112,11 @@ project "Engine"
 		
 
 	filter "configurations:Release"
-		defines "SDR_RELEASE"
+		defines
+		{
+			"SDR_RELEASE",
+			"SDR_MEMORY_TRACKING"
+		}
 		runtime "Release"
 		optimize "on"
 		inlining ("Auto")
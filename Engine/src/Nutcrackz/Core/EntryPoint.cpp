@@ -1,8 +1,169 @@
 #include "CrossWindow/CrossWindow.h"
+#include "Nutcrackz/Core/MemoryTracking.h"
+#include "Nutcrackz/Renderer/LightBinner.h"
 #include "Nutcrackz/Renderer/Renderer.h"
+#include "Nutcrackz/Renderer/RenderThread.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+// Helper functions
+namespace
+{
+// Lights scattered through a box around the origin
+std::vector<PointLight> CreateRandomLights(uint32_t count, const glm::vec3& extent, float minRadius, float maxRadius)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<PointLight> lights(count);
+    for (PointLight& light : lights)
+    {
+        light.Position = (glm::vec3(unit(random), unit(random), unit(random)) * 2.0f - 1.0f) * extent;
+        light.Radius = minRadius + (maxRadius - minRadius) * unit(random);
+        light.Color = glm::vec3(unit(random), unit(random), unit(random));
+        light.Intensity = 1.0f;
+    }
+
+    return lights;
+}
+
+MaterialHandle CreateTriangleMaterial(Renderer& renderer)
+{
+    // Materials are bindless, objects only carry the handle
+    MaterialDesc triangleMaterial;
+    triangleMaterial.BaseColor = glm::vec4(1.0f, 0.9f, 0.8f, 1.0f);
+    return renderer.CreateMaterial(triangleMaterial);
+}
+
+// The spinning triangle among the lights, as seen by a width by height view
+void FillFrame(FrameSnapshot& frame, unsigned width, unsigned height, float rotation, MaterialHandle triangleMaterial, const std::vector<PointLight>& lights)
+{
+    frame.View.Width = width;
+    frame.View.Height = height;
+
+    const float zoom = 2.5f;
+    frame.Constants.ProjectionMatrix = glm::perspective(45.0f, (float)width / (float)height, 0.01f, 1024.0f);
+    frame.Constants.ViewMatrix = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, 0.0f, zoom));
+
+    // The scene buffer keeps objects between frames, only the spinning
+    // triangle has to be sent again
+    SceneObjectUpdate triangleObject;
+    triangleObject.Index = 0;
+    triangleObject.Object.Transform = glm::rotate(glm::identity<glm::mat4>(), rotation, glm::vec3(0.0f, 1.0f, 0.0f));
+    triangleObject.Object.BoundsRadius = 1.5f;
+    triangleObject.Object.MaterialIndex = triangleMaterial;
+    frame.ObjectUpdates.push_back(triangleObject);
+
+    DrawPacket triangle;
+    triangle.IndexCount = 3;
+    triangle.ObjectIndex = triangleObject.Index;
+    frame.Draws.push_back(triangle);
+
+    frame.Lights.assign(lights.begin(), lights.end());
+}
+
+// Render frameCount frames without a window and write each one into
+// outputDirectory as a PNG
+void RunHeadless(uint32_t frameCount, const HeadlessDesc& desc, const std::string& outputDirectory, uint32_t lightCount, bool showHud)
+{
+    std::filesystem::create_directories(outputDirectory);
+
+    Renderer renderer(desc);
+
+    const MaterialHandle triangleMaterialHandle = CreateTriangleMaterial(renderer);
+    const std::vector<PointLight> lights = CreateRandomLights(lightCount, glm::vec3(3.0f, 2.0f, 1.5f), 0.5f, 1.5f);
+
+    FrameSnapshot frame;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < frameCount; ++i)
+    {
+        frame.Clear();
+        frame.FrameNumber = i;
+
+        // A fixed step per frame, so every run writes the same images
+        const float rotation = fmodf(i / 60.0f, 6.283185307179586f);
+        FillFrame(frame, desc.Width, desc.Height, rotation, triangleMaterialHandle, lights);
+        frame.View.ShowHud = showHud;
+
+        char name[32];
+        snprintf(name, sizeof(name), "frame_%05u.png", i);
+        frame.CapturePath = (std::filesystem::path(outputDirectory) / name).string();
+
+        renderer.RenderFrame(frame);
+    }
+
+    // Frames count once their image is on disk
+    renderer.FlushCaptures();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const FrameReadbackStats stats = renderer.GetFrameReadbackStats();
+
+    std::cout << "Rendered " << frameCount << " frames at " << desc.Width << "x" << desc.Height << " in " << seconds
+              << " s, " << frameCount / seconds << " fps\n";
+    std::cout << "Written: " << stats.Written << ", failed: " << stats.Failed << ", readback waits: "
+              << stats.BlockingWaits << ", last PNG write " << stats.LastWriteMs << " ms\n";
+}
+}
+
 
 void xmain(int argc, const char** argv)
 {
+    // Frames the game thread may run ahead of the render thread
+    uint32_t frameLatency = 1;
+
+    // GPU milliseconds per frame dynamic resolution aims for, 0 disables it
+    float frameBudgetMs = 14.0f;
+
+    // Point lights around the triangle
+    uint32_t lightCount = 256;
+
+    // Frames after which a render thread heap allocation is an error, 0
+    // doesn't check. Needs a build with heap tracking.
+    uint32_t heapCheckWarmup = 0;
+
+    // Performance HUD, toggled with F1. Shown in a window and left out of
+    // headless captures unless asked for.
+    int showHud = -1;
+
+    // Frames to render without a window into PNGs, 0 runs normally
+    uint32_t headlessFrameCount = 0;
+    HeadlessDesc headlessDesc;
+    std::string outputDirectory = "frames";
+
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (strcmp(argv[i], "--frame-latency") == 0)
+            frameLatency = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--frame-budget") == 0)
+            frameBudgetMs = static_cast<float>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--lights") == 0)
+            lightCount = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--expect-no-heap") == 0)
+            heapCheckWarmup = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--headless") == 0)
+            headlessFrameCount = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--software") == 0)
+            headlessDesc.UseSoftwareRasterizer = atoi(argv[++i]) != 0;
+        else if (strcmp(argv[i], "--output") == 0)
+            outputDirectory = argv[++i];
+        else if (strcmp(argv[i], "--hud") == 0)
+            showHud = atoi(argv[++i]) != 0 ? 1 : 0;
+    }
+
+    if (headlessFrameCount > 0)
+    {
+        RunHeadless(headlessFrameCount, headlessDesc, outputDirectory, lightCount, showHud == 1);
+        return;
+    }
+
     // 🖼️ Create a window
     xwin::EventQueue eventQueue;
     xwin::Window window;
@@ -16,8 +177,22 @@ void xmain(int argc, const char** argv)
     //windowDesc.fullscreen = true;
     window.create(windowDesc, eventQueue);
 
-    // 📸 Create a renderer
+    // 📸 Create a renderer, it draws on its own thread from here on
     Renderer renderer(window);
+    RenderThread renderThread(renderer, frameLatency);
+    renderThread.ExpectNoHeapAllocations(heapCheckWarmup);
+
+    const MaterialHandle triangleMaterialHandle = CreateTriangleMaterial(renderer);
+
+    const std::vector<PointLight> lights = CreateRandomLights(lightCount, glm::vec3(3.0f, 2.0f, 1.5f), 0.5f, 1.5f);
+
+    unsigned width = windowDesc.width;
+    unsigned height = windowDesc.height;
+
+    float rotation = 0.0f;
+    auto lastTime = std::chrono::steady_clock::now();
+
+    bool hudVisible = showHud != 0;
 
     // 🏁 Engine loop
     bool isRunning = true;
@@ -37,20 +212,96 @@ void xmain(int argc, const char** argv)
                 const xwin::ResizeData data = event.data.resize;
 
                 if (data.width > 0 && data.height > 0)
-                    renderer.Resize(data.width, data.height);
+                {
+                    width = data.width;
+                    height = data.height;
+                }
             }
 
-            if (event.type == xwin::EventType::Close)
+            if (event.type == xwin::EventType::Keyboard)
             {
-                window.close();
-                isRunning = false;
+                const xwin::KeyboardData data = event.data.keyboard;
+
+                if (data.key == xwin::Key::F1 && data.state == xwin::ButtonState::Pressed)
+                    hudVisible = !hudVisible;
             }
 
+            if (event.type == xwin::EventType::Close)
+                isRunning = false;
+
             eventQueue.pop();
         }
 
-        // ✨ Update Visuals
-        renderer.Render();
+        if (!isRunning)
+            break;
+
+        // 🕹️ Update the simulation
+        const auto currentTime = std::chrono::steady_clock::now();
+        const float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
+        lastTime = currentTime;
+
+        rotation = fmodf(rotation + deltaTime, 6.283185307179586f);
+
+        // ✨ Hand this frame to the render thread, this blocks while it is
+        // more than the frame latency behind
+        FrameSnapshot& frame = renderThread.BeginFrame();
+
+        FillFrame(frame, width, height, rotation, triangleMaterialHandle, lights);
+        frame.View.FrameBudgetMs = frameBudgetMs;
+        frame.View.ShowHud = hudVisible;
+
+        renderThread.EndFrame();
     }
 
-}
\ No newline at end of file
+    // Let the render thread finish before the window goes away
+    renderThread.Stop();
+    window.close();
+
+    const RenderThreadStats stats = renderThread.GetStats();
+    if (stats.FramesRendered > 0)
+    {
+        const double frames = static_cast<double>(stats.FramesRendered);
+        std::cout << "Rendered " << stats.FramesRendered << " frames at latency " << renderThread.GetLatency()
+                  << ", average stall per frame: game " << stats.GameStallMs / frames << " ms, render "
+                  << stats.RenderStallMs / frames << " ms, GPU " << stats.GpuStallMs / frames << " ms\n";
+
+        const CommandCacheStats& cacheStats = renderer.GetCommandCacheStats();
+        std::cout << "Draws replayed from bundles: " << cacheStats.TotalCachedDraws << ", recorded: "
+                  << cacheStats.TotalRecordedDraws << "\n";
+
+        const PersistentBufferStats& sceneStats = renderer.GetSceneBufferStats();
+        std::cout << "Scene buffer: " << sceneStats.ElementCount << " objects, " << sceneStats.TotalUploadedBytes / frames
+                  << " bytes uploaded per frame\n";
+
+        const QueueSchedulerStats& queueStats = renderer.GetQueueSchedulerStats();
+        std::cout << "Cross queue waits: " << queueStats.TotalWaits / frames << " per frame\n";
+
+        std::cout << "Resolution scale: " << renderer.GetResolutionScale() << " at " << renderer.GetLastGpuFrameMs()
+                  << " ms GPU\n";
+
+        const LightBinningStats& lightStats = renderer.GetLightBinningStats();
+        std::cout << "Light binning: " << lightStats.LightCount << " lights, " << lightStats.IndexCount << " indices in "
+                  << lightStats.BinningMs << " ms\n";
+
+        const ResidencyStats& residencyStats = renderer.GetResidencyStats();
+        if (residencyStats.BudgetBytes > 0)
+            std::cout << "Video memory: " << residencyStats.UsageBytes / (1024 * 1024) << " of " << residencyStats.BudgetBytes / (1024 * 1024)
+                      << " MiB budget, " << residencyStats.TotalEvictions << " evictions, " << residencyStats.BudgetChanges
+                      << " budget changes\n";
+
+        if (MemoryTracking::IsHeapTrackingEnabled())
+            std::cout << "Render thread heap allocations: " << stats.HeapAllocations << " in " << stats.HeapAllocatingFrames
+                      << " frames\n";
+
+        // Per subsystem, as of the last frame that began
+        const FrameMemoryStats memoryStats = MemoryTracking::GetLastFrame();
+        for (uint32_t i = 0; i < s_MemoryTagCount; ++i)
+        {
+            const MemoryTagStats& tag = memoryStats.Tags[i];
+            if (tag.ArenaAllocations > 0 || tag.HeapAllocations > 0)
+                std::cout << GetMemoryTagName(static_cast<MemoryTag>(i)) << " memory: " << tag.ArenaBytes << " bytes in "
+                          << tag.ArenaAllocations << " arena allocations, " << tag.HeapBytes << " bytes in "
+                          << tag.HeapAllocations << " heap allocations\n";
+        }
+    }
+}
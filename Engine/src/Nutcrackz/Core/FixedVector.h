@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+
+// Fixed Vector
+
+// A vector with its elements stored inline, for short lists that are built
+// every frame and must not touch the heap. Holds at most Capacity elements,
+// adding more throws std::runtime_error.
+template <typename T, uint32_t Capacity>
+class FixedVector
+{
+  public:
+    FixedVector() = default;
+
+    FixedVector(std::initializer_list<T> elements)
+    {
+        for (const T& element : elements)
+            push_back(element);
+    }
+
+    void push_back(const T& element)
+    {
+        if (m_Size == Capacity)
+            throw std::runtime_error("fixed vector is full!");
+
+        m_Elements[m_Size++] = element;
+    }
+
+    void clear() { m_Size = 0; }
+
+    bool empty() const { return m_Size == 0; }
+    size_t size() const { return m_Size; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    T& operator[](size_t index) { return m_Elements[index]; }
+    const T& operator[](size_t index) const { return m_Elements[index]; }
+
+    T* begin() { return m_Elements; }
+    T* end() { return m_Elements + m_Size; }
+    const T* begin() const { return m_Elements; }
+    const T* end() const { return m_Elements + m_Size; }
+
+  protected:
+    T m_Elements[Capacity] = {};
+    uint32_t m_Size = 0;
+};
@@ -0,0 +1,70 @@
+#include "FrameArenas.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Helper functions
+
+namespace
+{
+struct ThreadFrameArenas;
+
+std::mutex s_ThreadsMutex;
+std::vector<ThreadFrameArenas*> s_Threads;
+
+std::atomic<uint64_t> s_FrameNumber = 0;
+
+// Registered for as long as the thread lives, so BeginFrame can reset them
+struct ThreadFrameArenas
+{
+    ThreadFrameArenas()
+    {
+        std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+        s_Threads.push_back(this);
+    }
+
+    ~ThreadFrameArenas()
+    {
+        std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+        s_Threads.erase(std::find(s_Threads.begin(), s_Threads.end(), this));
+    }
+
+    LinearArena Arenas[FrameArenas::s_FrameCount];
+};
+
+ThreadFrameArenas& GetThreadFrameArenas()
+{
+    thread_local ThreadFrameArenas arenas;
+    return arenas;
+}
+}
+
+// Frame Arenas
+
+void FrameArenas::BeginFrame()
+{
+    std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+
+    const uint64_t frameNumber = s_FrameNumber.load(std::memory_order_relaxed);
+
+    // The new frame takes over the arenas of the one before the current
+    // frame, they are reset before any thread sees the new frame number
+    for (ThreadFrameArenas* thread : s_Threads)
+        thread->Arenas[(frameNumber + 1) % s_FrameCount].Reset();
+
+    MemoryTracking::EndFrame(frameNumber);
+
+    s_FrameNumber.store(frameNumber + 1, std::memory_order_release);
+}
+
+LinearArena& FrameArenas::Get()
+{
+    return GetThreadFrameArenas().Arenas[s_FrameNumber.load(std::memory_order_acquire) % s_FrameCount];
+}
+
+uint64_t FrameArenas::GetFrameNumber()
+{
+    return s_FrameNumber.load(std::memory_order_acquire);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Nutcrackz/Core/LinearArena.h"
+
+#include <cstdint>
+
+// Frame Arenas
+
+// Per-thread arenas for data that lives for one frame: draw lists, culling
+// results, sort buffers and the like. Every thread gets one arena per frame
+// in flight, all of a frame's arenas are reset together when the frame after
+// next begins, so data written for frame N is still valid while frame N + 1
+// is being built.
+//
+// Allocating work, on any thread, must be done with its frame before the
+// frame after next begins.
+class FrameArenas
+{
+  public:
+    static const uint32_t s_FrameCount = 2;
+
+    // Reset the arenas of the frame about to begin and close the memory
+    // tracking frame. Called once per frame by the renderer, before any
+    // of the frame's allocations.
+    static void BeginFrame();
+
+    // The calling thread's arena for the current frame
+    static LinearArena& Get();
+
+    // An empty vector in the calling thread's current frame arena, with room
+    // for capacity elements
+    template <typename T>
+    static ArenaVector<T> MakeVector(size_t capacity, MemoryTag tag = MemoryTag::General)
+    {
+        ArenaVector<T> vector(ArenaAllocator<T>(Get(), tag));
+        vector.reserve(capacity);
+        return vector;
+    }
+
+    static uint64_t GetFrameNumber();
+};
@@ -0,0 +1,73 @@
+#include "LinearArena.h"
+
+#include <algorithm>
+
+// Linear Arena
+
+LinearArena::LinearArena(size_t blockSize)
+    : m_BlockSize(blockSize)
+{
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment, MemoryTag tag)
+{
+    // The current block first, then the ones after it that were kept from
+    // before the last Reset
+    for (; m_Current < m_Blocks.size(); ++m_Current, m_Offset = 0)
+    {
+        const Block& block = m_Blocks[m_Current];
+
+        const uintptr_t start = reinterpret_cast<uintptr_t>(block.Data.get());
+        const uintptr_t aligned = (start + m_Offset + alignment - 1) & ~uintptr_t(alignment - 1);
+
+        if (aligned + size <= start + block.Size)
+        {
+            m_Offset = aligned + size - start;
+            MemoryTracking::RecordArenaAllocation(tag, size);
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    // None fits, grow by a block that surely does
+    Block block;
+    block.Size = std::max(m_BlockSize, size + alignment);
+    block.Data.reset(new uint8_t[block.Size]);
+    m_Blocks.push_back(std::move(block));
+
+    m_Current = static_cast<uint32_t>(m_Blocks.size() - 1);
+    m_Offset = 0;
+
+    return Allocate(size, alignment, tag);
+}
+
+void LinearArena::Rewind(const Marker& marker)
+{
+    m_Current = marker.Block;
+    m_Offset = marker.Offset;
+}
+
+size_t LinearArena::GetUsedBytes() const
+{
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < m_Current && i < m_Blocks.size(); ++i)
+        bytes += m_Blocks[i].Size;
+
+    return m_Current < m_Blocks.size() ? bytes + m_Offset : bytes;
+}
+
+size_t LinearArena::GetCapacity() const
+{
+    size_t bytes = 0;
+    for (const Block& block : m_Blocks)
+        bytes += block.Size;
+
+    return bytes;
+}
+
+// Scoped Stack
+
+LinearArena& GetThreadStackArena()
+{
+    thread_local LinearArena arena(64 * 1024);
+    return arena;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "Nutcrackz/Core/MemoryTracking.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Linear Arena
+
+// Hands out memory by bumping an offset through a list of blocks, and frees
+// it all at once with Reset or back to a marker with Rewind. Blocks are kept
+// when freeing, so once an arena has grown to a workload's high water mark it
+// no longer touches the heap. Nothing is destroyed, only use it for types
+// that don't need their destructor run.
+//
+// Not thread safe, every thread works in arenas of its own.
+class LinearArena
+{
+  public:
+    static const size_t s_DefaultBlockSize = 256 * 1024;
+
+    struct Marker
+    {
+        uint32_t Block = 0;
+        size_t Offset = 0;
+    };
+
+    LinearArena(size_t blockSize = s_DefaultBlockSize);
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t), MemoryTag tag = MemoryTag::General);
+
+    // Uninitialized room for count objects of type T
+    template <typename T>
+    T* Allocate(size_t count, MemoryTag tag = MemoryTag::General)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T), tag));
+    }
+
+    // Free everything allocated since marker was taken
+    Marker GetMarker() const { return { m_Current, m_Offset }; }
+    void Rewind(const Marker& marker);
+
+    void Reset() { Rewind(Marker()); }
+
+    // Bytes in use up to the current offset, including alignment padding
+    // and the unused tails of blocks that were skipped
+    size_t GetUsedBytes() const;
+
+    size_t GetCapacity() const;
+
+  protected:
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> Data;
+        size_t Size = 0;
+    };
+
+    size_t m_BlockSize;
+    std::vector<Block> m_Blocks;
+
+    uint32_t m_Current = 0;
+    size_t m_Offset = 0;
+};
+
+// Minimal allocator handing out memory from a LinearArena, for standard
+// containers holding transient data. Deallocating is a no-op, memory comes
+// back when the arena is reset or rewound. Growing a container leaves its
+// old storage behind in the arena, so reserve what is needed up front.
+template <typename T>
+class ArenaAllocator
+{
+  public:
+    typedef T value_type;
+
+    ArenaAllocator(LinearArena& arena, MemoryTag tag = MemoryTag::General)
+        : m_Arena(&arena), m_Tag(tag)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : m_Arena(other.GetArena()), m_Tag(other.GetTag())
+    {
+    }
+
+    T* allocate(size_t count) { return m_Arena->Allocate<T>(count, m_Tag); }
+
+    void deallocate(T*, size_t) {}
+
+    LinearArena* GetArena() const { return m_Arena; }
+
+    MemoryTag GetTag() const { return m_Tag; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return m_Arena == other.GetArena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return m_Arena != other.GetArena();
+    }
+
+  protected:
+    LinearArena* m_Arena;
+    MemoryTag m_Tag;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Scoped Stack
+
+// The calling thread's arena for temporary work. Owned by ScopedStack,
+// which is usually the better way to use it.
+LinearArena& GetThreadStackArena();
+
+// Temporary memory from the calling thread's stack arena, freed when the
+// scope ends. Scopes nest like the call stack does; memory from an inner
+// scope must not outlive it.
+class ScopedStack
+{
+  public:
+    ScopedStack()
+        : m_Arena(GetThreadStackArena()), m_Marker(m_Arena.GetMarker())
+    {
+    }
+
+    ~ScopedStack() { m_Arena.Rewind(m_Marker); }
+
+    ScopedStack(const ScopedStack&) = delete;
+    ScopedStack& operator=(const ScopedStack&) = delete;
+
+    template <typename T>
+    T* Allocate(size_t count, MemoryTag tag = MemoryTag::General)
+    {
+        return m_Arena.Allocate<T>(count, tag);
+    }
+
+    // An empty vector with room for capacity elements
+    template <typename T>
+    ArenaVector<T> MakeVector(size_t capacity, MemoryTag tag = MemoryTag::General)
+    {
+        ArenaVector<T> vector(ArenaAllocator<T>(m_Arena, tag));
+        vector.reserve(capacity);
+        return vector;
+    }
+
+    LinearArena& GetArena() { return m_Arena; }
+
+  protected:
+    LinearArena& m_Arena;
+    LinearArena::Marker m_Marker;
+};
@@ -0,0 +1,107 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Mapped File
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path)
+    : m_Data(nullptr), m_Size(0), m_File(INVALID_HANDLE_VALUE), m_Mapping(nullptr)
+{
+    m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_File == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open " + path + "!");
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_File, &size))
+    {
+        CloseHandle(m_File);
+        throw std::runtime_error("failed to read the size of " + path + "!");
+    }
+
+    m_Size = static_cast<uint64_t>(size.QuadPart);
+
+    // Empty files can't be mapped, there is nothing to read anyway
+    if (m_Size == 0)
+        return;
+
+    m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping)
+        m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!m_Data)
+    {
+        if (m_Mapping)
+            CloseHandle(m_Mapping);
+        CloseHandle(m_File);
+        throw std::runtime_error("failed to map " + path + "!");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+
+    if (m_File != INVALID_HANDLE_VALUE)
+        CloseHandle(m_File);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+    : m_Data(nullptr), m_Size(0), m_File(-1)
+{
+    m_File = open(path.c_str(), O_RDONLY);
+    if (m_File < 0)
+        throw std::runtime_error("failed to open " + path + "!");
+
+    struct stat status;
+    if (fstat(m_File, &status) != 0)
+    {
+        close(m_File);
+        throw std::runtime_error("failed to read the size of " + path + "!");
+    }
+
+    m_Size = static_cast<uint64_t>(status.st_size);
+
+    // Empty files can't be mapped, there is nothing to read anyway
+    if (m_Size == 0)
+        return;
+
+    void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+    if (data == MAP_FAILED)
+    {
+        close(m_File);
+        throw std::runtime_error("failed to map " + path + "!");
+    }
+
+    m_Data = static_cast<const uint8_t*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data)
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+
+    if (m_File >= 0)
+        close(m_File);
+}
+
+#endif
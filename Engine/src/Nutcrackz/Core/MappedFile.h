@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Mapped File
+
+// A whole file mapped read only into the address space. Pages are read from
+// disk as they are first touched, and stay shared with the OS file cache, so
+// opening even a large file costs little more than the system calls.
+class MappedFile
+{
+  public:
+    // Throws std::runtime_error if the file can't be opened or mapped
+    MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // nullptr for an empty file
+    const uint8_t* GetData() const { return m_Data; }
+    uint64_t GetSize() const { return m_Size; }
+
+  protected:
+    const uint8_t* m_Data;
+    uint64_t m_Size;
+
+#if defined(_WIN32)
+    void* m_File;
+    void* m_Mapping;
+#else
+    int m_File;
+#endif
+};
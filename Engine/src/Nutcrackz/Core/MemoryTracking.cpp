@@ -0,0 +1,137 @@
+#include "MemoryTracking.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+// Helper functions
+
+namespace
+{
+struct TagCounters
+{
+    std::atomic<uint64_t> ArenaBytes = 0;
+    std::atomic<uint64_t> ArenaAllocations = 0;
+    std::atomic<uint64_t> HeapBytes = 0;
+    std::atomic<uint64_t> HeapAllocations = 0;
+};
+
+// All constant initialized, operator new may run before any constructor
+TagCounters s_Counters[s_MemoryTagCount];
+
+std::mutex s_LastFrameMutex;
+FrameMemoryStats s_LastFrame;
+
+thread_local MemoryTag s_ThreadTag = MemoryTag::General;
+thread_local uint64_t s_ThreadHeapAllocations = 0;
+
+TagCounters& GetCounters(MemoryTag tag)
+{
+    return s_Counters[static_cast<uint32_t>(tag) < s_MemoryTagCount ? static_cast<uint32_t>(tag) : 0];
+}
+}
+
+const char* GetMemoryTagName(MemoryTag tag)
+{
+    switch (tag)
+    {
+    case MemoryTag::General: return "General";
+    case MemoryTag::Renderer: return "Renderer";
+    case MemoryTag::Textures: return "Textures";
+    case MemoryTag::Lighting: return "Lighting";
+    case MemoryTag::Scene: return "Scene";
+    default: return "Unknown";
+    }
+}
+
+// Memory Tracking
+
+void MemoryTracking::RecordArenaAllocation(MemoryTag tag, size_t bytes)
+{
+    TagCounters& counters = GetCounters(tag);
+    counters.ArenaBytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.ArenaAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryTracking::RecordHeapAllocation(size_t bytes)
+{
+    TagCounters& counters = GetCounters(s_ThreadTag);
+    counters.HeapBytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    s_ThreadHeapAllocations++;
+}
+
+uint64_t MemoryTracking::GetThreadHeapAllocations()
+{
+    return s_ThreadHeapAllocations;
+}
+
+void MemoryTracking::EndFrame(uint64_t frameNumber)
+{
+    FrameMemoryStats frame;
+    frame.FrameNumber = frameNumber;
+
+    for (uint32_t i = 0; i < s_MemoryTagCount; ++i)
+    {
+        TagCounters& counters = s_Counters[i];
+        MemoryTagStats& stats = frame.Tags[i];
+
+        stats.ArenaBytes = counters.ArenaBytes.exchange(0, std::memory_order_relaxed);
+        stats.ArenaAllocations = counters.ArenaAllocations.exchange(0, std::memory_order_relaxed);
+        stats.HeapBytes = counters.HeapBytes.exchange(0, std::memory_order_relaxed);
+        stats.HeapAllocations = counters.HeapAllocations.exchange(0, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(s_LastFrameMutex);
+    s_LastFrame = frame;
+}
+
+FrameMemoryStats MemoryTracking::GetLastFrame()
+{
+    std::lock_guard<std::mutex> lock(s_LastFrameMutex);
+    return s_LastFrame;
+}
+
+// Memory Tag Scope
+
+MemoryTagScope::MemoryTagScope(MemoryTag tag)
+    : m_Previous(s_ThreadTag)
+{
+    s_ThreadTag = tag;
+}
+
+MemoryTagScope::~MemoryTagScope()
+{
+    s_ThreadTag = m_Previous;
+}
+
+// Heap tracking
+
+#if defined(SDR_MEMORY_TRACKING)
+
+// The array and nothrow forms of new and the remaining forms of delete
+// forward to these by default. Over-aligned allocations keep the default
+// implementation and are not counted.
+void* operator new(size_t size)
+{
+    MemoryTracking::RecordHeapAllocation(size);
+
+    if (void* memory = std::malloc(size ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+#endif
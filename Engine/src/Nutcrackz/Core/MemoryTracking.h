@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Memory Tracking
+
+// Subsystems memory is accounted to
+enum class MemoryTag : uint32_t
+{
+    General,
+    Renderer,
+    Textures,
+    Lighting,
+    Scene,
+    Count
+};
+
+static const uint32_t s_MemoryTagCount = static_cast<uint32_t>(MemoryTag::Count);
+
+const char* GetMemoryTagName(MemoryTag tag);
+
+struct MemoryTagStats
+{
+    // Handed out by linear arenas
+    uint64_t ArenaBytes = 0;
+    uint64_t ArenaAllocations = 0;
+
+    // Taken from the general heap, only counted with heap tracking
+    uint64_t HeapBytes = 0;
+    uint64_t HeapAllocations = 0;
+};
+
+struct FrameMemoryStats
+{
+    uint64_t FrameNumber = 0;
+
+    MemoryTagStats Tags[s_MemoryTagCount];
+};
+
+// Counts memory per subsystem per frame. Arena allocations are always
+// counted. Heap allocations are counted in builds defining
+// SDR_MEMORY_TRACKING, which replace the global operator new and delete;
+// they are accounted to the calling thread's MemoryTagScope.
+//
+// Counters are atomics, any thread may allocate while another closes the
+// frame.
+class MemoryTracking
+{
+  public:
+    static constexpr bool IsHeapTrackingEnabled()
+    {
+#if defined(SDR_MEMORY_TRACKING)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static void RecordArenaAllocation(MemoryTag tag, size_t bytes);
+
+    // Called by the replaced operator new
+    static void RecordHeapAllocation(size_t bytes);
+
+    // Heap allocations the calling thread has made since it started. The
+    // difference between two calls covers the code in between, 0 without
+    // heap tracking.
+    static uint64_t GetThreadHeapAllocations();
+
+    // Close the current frame, its counters become the last frame's and
+    // counting starts over. Called once per frame by FrameArenas.
+    static void EndFrame(uint64_t frameNumber);
+
+    static FrameMemoryStats GetLastFrame();
+};
+
+// Accounts the calling thread's heap allocations to tag while alive. Scopes
+// nest, the innermost wins.
+class MemoryTagScope
+{
+  public:
+    MemoryTagScope(MemoryTag tag);
+    ~MemoryTagScope();
+
+    MemoryTagScope(const MemoryTagScope&) = delete;
+    MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+  protected:
+    MemoryTag m_Previous;
+};
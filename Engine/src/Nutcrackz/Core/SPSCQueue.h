@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Single Producer Single Consumer Queue
+
+// A bounded lock-free ring buffer for handing values from exactly one
+// producer thread to exactly one consumer thread. Push and Pop never take a
+// lock, the blocking variants sleep on the index of the other side through
+// C++20 atomic waits instead of spinning.
+//
+// Capacity must be a power of two.
+template <typename T, uint32_t Capacity>
+class SPSCQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+  public:
+    // Producer only. Returns false if the queue is full.
+    bool TryPush(const T& value)
+    {
+        const uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_Head.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        m_Items[tail & (Capacity - 1)] = value;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        m_Tail.notify_one();
+
+        return true;
+    }
+
+    // Producer only. Blocks while the queue is full.
+    void Push(const T& value)
+    {
+        while (!TryPush(value))
+        {
+            const uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+            m_Head.wait(tail - Capacity, std::memory_order_acquire);
+        }
+    }
+
+    // Consumer only. Returns false if the queue is empty.
+    bool TryPop(T& value)
+    {
+        const uint32_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_Tail.load(std::memory_order_acquire))
+            return false;
+
+        value = m_Items[head & (Capacity - 1)];
+        m_Head.store(head + 1, std::memory_order_release);
+        m_Head.notify_one();
+
+        return true;
+    }
+
+    // Consumer only. Blocks while the queue is empty.
+    T Pop()
+    {
+        T value;
+        while (!TryPop(value))
+        {
+            const uint32_t head = m_Head.load(std::memory_order_relaxed);
+            m_Tail.wait(head, std::memory_order_acquire);
+        }
+
+        return value;
+    }
+
+    // Approximate when called from a third thread
+    uint32_t Size() const
+    {
+        return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire);
+    }
+
+  protected:
+    // Keep the indices on separate cache lines so the producer and consumer
+    // don't invalidate each other's line on every operation
+    static const size_t s_CacheLineSize = 64;
+
+    alignas(s_CacheLineSize) std::atomic<uint32_t> m_Head = 0;
+    alignas(s_CacheLineSize) std::atomic<uint32_t> m_Tail = 0;
+    alignas(s_CacheLineSize) T m_Items[Capacity];
+};
@@ -0,0 +1,290 @@
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+// Task Graph
+
+TaskId TaskGraph::Add(const std::string& name, std::initializer_list<TaskId> dependencies, std::function<void()> function, TaskAffinity affinity)
+{
+    const TaskId id = static_cast<TaskId>(m_Tasks.size());
+
+    Task task;
+    task.Name = name;
+    task.Function = std::move(function);
+    task.Affinity = affinity;
+
+    for (TaskId dependency : dependencies)
+    {
+        if (dependency >= id)
+            throw std::runtime_error("Task dependencies must be added first!");
+
+        task.Dependencies.push_back(dependency);
+        m_Tasks[dependency].Dependents.push_back(id);
+    }
+
+    m_Tasks.push_back(std::move(task));
+    return id;
+}
+
+void TaskGraph::Run(ThreadPool& threadPool)
+{
+    const uint32_t taskCount = static_cast<uint32_t>(m_Tasks.size());
+
+    m_Timings.assign(taskCount, TaskTiming());
+    m_PendingDependencies.resize(taskCount);
+    m_Failed.assign(taskCount, false);
+    m_FinishedTasks = 0;
+    m_Error = nullptr;
+    m_ThreadPool = &threadPool;
+
+    m_Threads.clear();
+    m_Threads.push_back(std::this_thread::get_id());
+
+    m_Start = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    for (TaskId task = 0; task < taskCount; ++task)
+    {
+        m_Timings[task].Name = m_Tasks[task].Name;
+        m_PendingDependencies[task] = static_cast<uint32_t>(m_Tasks[task].Dependencies.size());
+
+        if (m_PendingDependencies[task] == 0)
+            MakeReady(task);
+    }
+
+    for (;;)
+    {
+        m_Changed.wait(lock, [this, taskCount] {
+            return !m_ReadyCallerTasks.empty() || !m_ReadyTasks.empty() || (m_FinishedTasks == taskCount && m_OutstandingJobs == 0);
+        });
+
+        std::deque<TaskId>& ready = !m_ReadyCallerTasks.empty() ? m_ReadyCallerTasks : m_ReadyTasks;
+        if (ready.empty())
+            break;
+
+        const TaskId task = ready.front();
+        ready.pop_front();
+
+        lock.unlock();
+        Execute(task);
+        lock.lock();
+    }
+
+    m_ThreadPool = nullptr;
+    m_TotalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+
+    if (m_Error)
+        std::rethrow_exception(m_Error);
+}
+
+double TaskGraph::GetCriticalPathMs(std::vector<TaskId>* path) const
+{
+    const uint32_t taskCount = static_cast<uint32_t>(m_Tasks.size());
+
+    // Dependencies come first, so one pass in order finds the longest chain
+    // ending at every task
+    std::vector<double> chainMs(taskCount, 0.0);
+    std::vector<TaskId> previous(taskCount, taskCount);
+
+    TaskId last = taskCount;
+    double longestMs = 0.0;
+
+    for (TaskId task = 0; task < taskCount; ++task)
+    {
+        for (TaskId dependency : m_Tasks[task].Dependencies)
+        {
+            if (chainMs[dependency] > chainMs[task])
+            {
+                chainMs[task] = chainMs[dependency];
+                previous[task] = dependency;
+            }
+        }
+
+        chainMs[task] += m_Timings[task].EndMs - m_Timings[task].StartMs;
+
+        if (last == taskCount || chainMs[task] > longestMs)
+        {
+            longestMs = chainMs[task];
+            last = task;
+        }
+    }
+
+    if (path)
+    {
+        path->clear();
+        for (TaskId task = last; task != taskCount; task = previous[task])
+            path->push_back(task);
+
+        std::reverse(path->begin(), path->end());
+    }
+
+    return longestMs;
+}
+
+void TaskGraph::WriteReport(std::ostream& stream) const
+{
+    std::vector<TaskId> criticalPath;
+    const double criticalPathMs = GetCriticalPathMs(&criticalPath);
+
+    double serialMs = 0.0;
+    for (const TaskTiming& timing : m_Timings)
+        serialMs += timing.EndMs - timing.StartMs;
+
+    const std::ios::fmtflags flags = stream.flags();
+    const std::streamsize precision = stream.precision();
+    stream << std::fixed << std::setprecision(2);
+
+    for (TaskId task = 0; task < m_Timings.size(); ++task)
+    {
+        const TaskTiming& timing = m_Timings[task];
+        const bool critical = std::find(criticalPath.begin(), criticalPath.end(), task) != criticalPath.end();
+
+        stream << (critical ? "* " : "  ") << std::left << std::setw(28) << timing.Name << std::right << std::setw(9)
+               << timing.StartMs << " ms +" << std::setw(9) << timing.EndMs - timing.StartMs << " ms  thread "
+               << timing.Thread << (timing.Skipped ? "  skipped" : "") << "\n";
+    }
+
+    stream << "Total " << m_TotalMs << " ms, " << serialMs << " ms of work, critical path (*) " << criticalPathMs << " ms\n";
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void TaskGraph::RunReadyTask()
+{
+    TaskId task;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        // The calling thread got to it first
+        if (m_ReadyTasks.empty())
+        {
+            m_OutstandingJobs--;
+            m_Changed.notify_all();
+            return;
+        }
+
+        task = m_ReadyTasks.front();
+        m_ReadyTasks.pop_front();
+    }
+
+    Execute(task);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_OutstandingJobs--;
+    m_Changed.notify_all();
+}
+
+void TaskGraph::Execute(TaskId task)
+{
+    bool skipped;
+    uint32_t thread;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        skipped = m_Failed[task];
+        thread = GetThreadIndex();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    bool failed = skipped;
+
+    if (!skipped)
+    {
+        try
+        {
+            m_Tasks[task].Function();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (!m_Error)
+                m_Error = std::current_exception();
+
+            failed = true;
+        }
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    TaskTiming& timing = m_Timings[task];
+    timing.StartMs = std::chrono::duration<double, std::milli>(start - m_Start).count();
+    timing.EndMs = std::chrono::duration<double, std::milli>(end - m_Start).count();
+    timing.Thread = thread;
+    timing.Skipped = skipped;
+
+    m_FinishedTasks++;
+
+    for (TaskId dependent : m_Tasks[task].Dependents)
+    {
+        if (failed)
+            m_Failed[dependent] = true;
+
+        if (--m_PendingDependencies[dependent] == 0)
+            MakeReady(dependent);
+    }
+
+    m_Changed.notify_all();
+}
+
+void TaskGraph::MakeReady(TaskId task)
+{
+    if (m_Tasks[task].Affinity == TaskAffinity::Caller)
+    {
+        m_ReadyCallerTasks.push_back(task);
+        m_Changed.notify_all();
+        return;
+    }
+
+    m_ReadyTasks.push_back(task);
+    m_OutstandingJobs++;
+    m_Changed.notify_all();
+
+    m_ThreadPool->Submit([this]() { RunReadyTask(); });
+}
+
+uint32_t TaskGraph::GetThreadIndex()
+{
+    const std::thread::id id = std::this_thread::get_id();
+
+    auto it = std::find(m_Threads.begin(), m_Threads.end(), id);
+    if (it != m_Threads.end())
+        return static_cast<uint32_t>(it - m_Threads.begin());
+
+    m_Threads.push_back(id);
+    return static_cast<uint32_t>(m_Threads.size() - 1);
+}
+
+void WriteChromeTrace(std::ostream& stream, const std::vector<TaskTiming>& timings)
+{
+    const std::ios::fmtflags flags = stream.flags();
+    const std::streamsize precision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+
+    stream << "{\"traceEvents\":[\n";
+
+    for (size_t i = 0; i < timings.size(); ++i)
+    {
+        const TaskTiming& timing = timings[i];
+
+        // Complete events, in microseconds
+        stream << "{\"name\":\"" << timing.Name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << timing.Thread
+               << ",\"ts\":" << timing.StartMs * 1000.0 << ",\"dur\":" << (timing.EndMs - timing.StartMs) * 1000.0;
+
+        if (timing.Skipped)
+            stream << ",\"args\":{\"skipped\":true}";
+
+        stream << "}" << (i + 1 < timings.size() ? ",\n" : "\n");
+    }
+
+    stream << "]}\n";
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Nutcrackz/Core/ThreadPool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Task Graph
+
+using TaskId = uint32_t;
+
+enum class TaskAffinity
+{
+    // Whichever thread is free, a worker or the thread running the graph
+    Any,
+
+    // Only the thread running the graph, for work tied to it such as window
+    // and swapchain calls
+    Caller,
+};
+
+struct TaskTiming
+{
+    std::string Name;
+
+    // Since the graph started running
+    double StartMs = 0.0;
+    double EndMs = 0.0;
+
+    // 0 is the thread running the graph, workers are numbered from 1 in the
+    // order they first picked up a task
+    uint32_t Thread = 0;
+
+    // Tasks depending on one that threw are skipped
+    bool Skipped = false;
+};
+
+// Runs tasks in dependency order on a thread pool, each as soon as all of
+// its dependencies are done, and records when and on which thread every
+// task ran.
+//
+// Tasks are added up front, then the graph runs once. The calling thread
+// helps with the work while it waits.
+class TaskGraph
+{
+  public:
+    // Dependencies are tasks added before this one
+    TaskId Add(const std::string& name, std::initializer_list<TaskId> dependencies, std::function<void()> function, TaskAffinity affinity = TaskAffinity::Any);
+
+    // Blocks until every task has run. When a task throws, the tasks
+    // depending on it are skipped and the first exception is rethrown once
+    // the rest are done.
+    void Run(ThreadPool& threadPool);
+
+    // Indexed by TaskId, valid after Run
+    const std::vector<TaskTiming>& GetTimings() const { return m_Timings; }
+
+    // Wall time of Run
+    double GetTotalMs() const { return m_TotalMs; }
+
+    // Longest chain of dependent tasks by their run time, the fastest the
+    // graph could finish on any number of threads. path receives its tasks
+    // in order when given.
+    double GetCriticalPathMs(std::vector<TaskId>* path = nullptr) const;
+
+    // A table of every task, followed by the totals
+    void WriteReport(std::ostream& stream) const;
+
+  protected:
+    struct Task
+    {
+        std::string Name;
+        std::function<void()> Function;
+        TaskAffinity Affinity;
+
+        std::vector<TaskId> Dependencies;
+        std::vector<TaskId> Dependents;
+    };
+
+    // Thread pool job, runs one ready task if the caller hasn't taken it
+    void RunReadyTask();
+
+    void Execute(TaskId task);
+
+    // Called with m_Mutex held
+    void MakeReady(TaskId task);
+    uint32_t GetThreadIndex();
+
+    std::vector<Task> m_Tasks;
+    ThreadPool* m_ThreadPool = nullptr;
+    std::vector<TaskTiming> m_Timings;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+
+    std::deque<TaskId> m_ReadyTasks;
+    std::deque<TaskId> m_ReadyCallerTasks;
+    std::vector<uint32_t> m_PendingDependencies;
+    std::vector<bool> m_Failed;
+    uint32_t m_FinishedTasks = 0;
+
+    // Thread pool jobs submitted and not yet returned, Run waits for them so
+    // none outlives the graph
+    uint32_t m_OutstandingJobs = 0;
+
+    std::exception_ptr m_Error;
+
+    std::vector<std::thread::id> m_Threads;
+    std::chrono::steady_clock::time_point m_Start;
+    double m_TotalMs = 0.0;
+};
+
+// Chrome trace event format, opens in chrome://tracing and Perfetto
+void WriteChromeTrace(std::ostream& stream, const std::vector<TaskTiming>& timings);
@@ -0,0 +1,228 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+// Thread Pool
+
+// Lives on the stack of the thread calling ParallelFor
+struct ThreadPool::ParallelForBatch
+{
+    RangeFunction Function;
+    const void* Context;
+
+    std::mutex Mutex;
+    std::condition_variable Done;
+    uint32_t Remaining = 0;
+
+    // First exception a range threw, rethrown to the caller
+    std::exception_ptr Error;
+};
+
+ThreadPool::ThreadPool(uint32_t workerCount)
+{
+    m_Ranges.Slots.resize(s_InitialJobSlots);
+    m_Jobs.Slots.resize(s_InitialJobSlots);
+
+    if (workerCount == 0)
+    {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    m_Workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i)
+        m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_JobAvailable.notify_all();
+
+    for (std::thread& worker : m_Workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Job queued;
+        queued.Function = std::move(job);
+        m_Jobs.Push(std::move(queued));
+    }
+    m_JobAvailable.notify_one();
+}
+
+void ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Idle.wait(lock, [this] { return m_Ranges.Count == 0 && m_Jobs.Count == 0 && m_ActiveJobs == 0; });
+}
+
+void ThreadPool::ParallelFor(uint32_t count, RangeFunction function, const void* context)
+{
+    if (count == 0)
+        return;
+
+    // A few ranges per worker keeps them busy when ranges differ in cost
+    const uint32_t rangeCount = std::min(count, GetWorkerCount() * 4);
+    const uint32_t rangeSize = (count + rangeCount - 1) / rangeCount;
+
+    ParallelForBatch batch;
+    batch.Function = function;
+    batch.Context = context;
+    batch.Remaining = (count + rangeSize - 1) / rangeSize;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        for (uint32_t begin = 0; begin < count; begin += rangeSize)
+        {
+            Job range;
+            range.Batch = &batch;
+            range.Begin = begin;
+            range.End = std::min(begin + rangeSize, count);
+            m_Ranges.Push(std::move(range));
+        }
+    }
+    m_JobAvailable.notify_all();
+
+    // Help rather than wait, the workers may all be busy with long jobs.
+    // Ranges of other batches are run too, they are just as short.
+    for (;;)
+    {
+        Job range;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Ranges.Count == 0)
+                break;
+
+            range = m_Ranges.Pop();
+            m_ActiveJobs++;
+        }
+
+        Execute(range);
+    }
+
+    std::unique_lock<std::mutex> lock(batch.Mutex);
+    batch.Done.wait(lock, [&batch] { return batch.Remaining == 0; });
+
+    if (batch.Error)
+        std::rethrow_exception(batch.Error);
+}
+
+void ThreadPool::JobRing::Push(Job&& job)
+{
+    // Out of slots, move the queued jobs to the front of a ring twice the size
+    if (Count == Slots.size())
+    {
+        std::vector<Job> slots(Slots.size() * 2);
+        for (size_t i = 0; i < Count; ++i)
+            slots[i] = std::move(Slots[(First + i) % Slots.size()]);
+
+        Slots.swap(slots);
+        First = 0;
+    }
+
+    Slots[(First + Count) % Slots.size()] = std::move(job);
+    Count++;
+}
+
+ThreadPool::Job ThreadPool::JobRing::Pop()
+{
+    // Leave the slot empty, a submitted function's captures are released
+    // with the job rather than when the slot is reused
+    Job job = std::move(Slots[First]);
+    Slots[First] = Job();
+
+    First = (First + 1) % Slots.size();
+    Count--;
+
+    return job;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    for (;;)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobAvailable.wait(lock, [this] { return m_Stopping || m_Ranges.Count > 0 || m_Jobs.Count > 0; });
+
+            // Drain the remaining jobs before shutting down so nobody waits
+            // forever on work that was already submitted.
+            if (m_Ranges.Count == 0 && m_Jobs.Count == 0)
+                return;
+
+            job = m_Ranges.Count > 0 ? m_Ranges.Pop() : m_Jobs.Pop();
+            m_ActiveJobs++;
+        }
+
+        Execute(job);
+    }
+}
+
+void ThreadPool::Execute(Job& job)
+{
+    if (job.Batch)
+    {
+        ParallelForBatch& batch = *job.Batch;
+
+        std::exception_ptr error;
+        try
+        {
+            batch.Function(batch.Context, job.Begin, job.End);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        // The caller returns once Remaining reaches 0, batch is gone after
+        // the lock is released
+        std::lock_guard<std::mutex> lock(batch.Mutex);
+        if (error && !batch.Error)
+            batch.Error = error;
+
+        if (--batch.Remaining == 0)
+            batch.Done.notify_all();
+    }
+    else
+    {
+        // Left to escape, it would end the process
+        try
+        {
+            job.Function();
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Thread pool job failed: " << e.what() << "\n";
+        }
+        catch (...)
+        {
+            std::cerr << "Thread pool job failed\n";
+        }
+
+        // Release the captures before the pool counts as idle
+        job.Function = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_ActiveJobs--;
+
+    if (m_Ranges.Count == 0 && m_Jobs.Count == 0 && m_ActiveJobs == 0)
+        m_Idle.notify_all();
+}
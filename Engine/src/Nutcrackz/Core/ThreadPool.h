@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread Pool
+
+// A small fixed-size pool of worker threads used for background work such as
+// file reads and CPU side asset processing. Jobs are executed in submission
+// order, but may complete in any order.
+//
+// ParallelFor ranges have a lane of their own that workers empty before
+// taking the next job, and the calling thread works through it too while it
+// waits, so a frame's ParallelFor never queues behind long jobs like texture
+// reads, and finishes even while every worker is busy with one.
+//
+// Jobs wait in rings of preallocated slots that only grow when every slot
+// is taken, and ParallelFor queues its ranges without allocating, so a
+// steady workload doesn't touch the heap.
+class ThreadPool
+{
+  public:
+    // Runs one range of a ParallelFor
+    typedef void (*RangeFunction)(const void* context, uint32_t begin, uint32_t end);
+
+    // Pass 0 to use one worker per hardware thread, minus the main thread
+    ThreadPool(uint32_t workerCount = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a job to run on one of the workers. Nothing waits for its
+    // result, an exception it throws is reported and dropped; jobs whose
+    // errors matter catch them, or run a std::packaged_task and hand out its
+    // future.
+    void Submit(std::function<void()> job);
+
+    // Block until every submitted job has finished
+    void WaitIdle();
+
+    // Split [0, count) into ranges and run function(begin, end) for each
+    // across the workers and the calling thread, returns once every range
+    // has been processed. If any range threw, the first exception is
+    // rethrown then.
+    template <typename Function>
+    void ParallelFor(uint32_t count, const Function& function)
+    {
+        ParallelFor(
+            count, [](const void* context, uint32_t begin, uint32_t end) { (*static_cast<const Function*>(context))(begin, end); }, &function);
+    }
+
+    void ParallelFor(uint32_t count, RangeFunction function, const void* context);
+
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+  protected:
+    struct ParallelForBatch;
+
+    // A submitted function, or a range of a ParallelFor when Batch is set
+    struct Job
+    {
+        std::function<void()> Function;
+
+        ParallelForBatch* Batch = nullptr;
+        uint32_t Begin = 0;
+        uint32_t End = 0;
+    };
+
+    // Ring of job slots, Count of them starting at First are queued
+    struct JobRing
+    {
+        std::vector<Job> Slots;
+        size_t First = 0;
+        size_t Count = 0;
+
+        void Push(Job&& job);
+        Job Pop();
+    };
+
+    static const uint32_t s_InitialJobSlots = 256;
+
+    void WorkerLoop();
+
+    // Run a popped job, m_ActiveJobs counts it until it returns
+    void Execute(Job& job);
+
+    std::vector<std::thread> m_Workers;
+
+    // ParallelFor ranges, taken before any job
+    JobRing m_Ranges;
+    JobRing m_Jobs;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_JobAvailable;
+    std::condition_variable m_Idle;
+
+    // Popped from either ring and still running
+    uint32_t m_ActiveJobs = 0;
+    bool m_Stopping = false;
+};
@@ -0,0 +1,87 @@
+#include "BindlessDescriptorHeap.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+#include <stdexcept>
+
+// Bindless Descriptors
+
+BindlessDescriptorHeap::BindlessDescriptorHeap(ID3D12Device* device, FenceTimeline& fenceTimeline, uint32_t capacity)
+    : m_Device(device), m_FenceTimeline(fenceTimeline), m_Heap(nullptr), m_Capacity(capacity)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.NumDescriptors = m_Capacity;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    ThrowIfFailed(m_Device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_Heap)));
+    m_Heap->SetName(L"Bindless Descriptor Heap");
+
+    m_DescriptorSize = m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+BindlessDescriptorHeap::~BindlessDescriptorHeap()
+{
+    // Frames already submitted may still reference the heap
+    m_FenceTimeline.Release(m_Heap);
+    m_Heap = nullptr;
+}
+
+uint32_t BindlessDescriptorHeap::Allocate()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    const UINT64 completed = m_FenceTimeline.GetCompletedValue();
+    while (!m_Retired.empty() && m_Retired.front().FenceValue <= completed)
+    {
+        m_FreeIndices.push_back(m_Retired.front().Index);
+        m_Retired.pop_front();
+    }
+
+    uint32_t index;
+    if (!m_FreeIndices.empty())
+    {
+        index = m_FreeIndices.back();
+        m_FreeIndices.pop_back();
+    }
+    else if (m_NextIndex < m_Capacity)
+    {
+        index = m_NextIndex++;
+    }
+    else
+    {
+        throw std::runtime_error("bindless descriptor heap is full!");
+    }
+
+    m_AllocatedCount++;
+    return index;
+}
+
+void BindlessDescriptorHeap::Free(uint32_t index)
+{
+    if (index == s_InvalidDescriptor)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // Covers every frame that could have been recorded with the slot
+    RetiredSlot retired;
+    retired.Index = index;
+    retired.FenceValue = m_FenceTimeline.GetNextValue();
+    m_Retired.push_back(retired);
+
+    m_AllocatedCount--;
+}
+
+void BindlessDescriptorHeap::Copy(uint32_t index, D3D12_CPU_DESCRIPTOR_HANDLE source)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE destination(m_Heap->GetCPUDescriptorHandleForHeapStart());
+    destination.ptr += SIZE_T(index) * m_DescriptorSize;
+
+    m_Device->CopyDescriptorsSimple(1, destination, source, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+uint32_t BindlessDescriptorHeap::GetAllocatedCount()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_AllocatedCount;
+}
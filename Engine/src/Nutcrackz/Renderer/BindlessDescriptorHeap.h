@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Bindless Descriptors
+
+static const uint32_t s_InvalidDescriptor = ~0u;
+
+// The one shader visible CBV/SRV/UAV heap. Shaders see it as unbounded
+// arrays and index it directly, so nothing rebinds descriptor tables between
+// draws.
+//
+// Descriptors in a shader visible heap can't be rewritten while frames in
+// flight may read them. A changed resource gets a new slot instead, and Free
+// only makes the old slot reusable once the frames recorded so far have
+// completed. Allocate and Free may be called from any thread.
+class BindlessDescriptorHeap
+{
+  public:
+    BindlessDescriptorHeap(ID3D12Device* device, FenceTimeline& fenceTimeline, uint32_t capacity = s_DefaultCapacity);
+
+    ~BindlessDescriptorHeap();
+
+    BindlessDescriptorHeap(const BindlessDescriptorHeap&) = delete;
+    BindlessDescriptorHeap& operator=(const BindlessDescriptorHeap&) = delete;
+
+    uint32_t Allocate();
+
+    void Free(uint32_t index);
+
+    // Copy a descriptor from a non shader visible heap into a slot
+    void Copy(uint32_t index, D3D12_CPU_DESCRIPTOR_HANDLE source);
+
+    ID3D12DescriptorHeap* GetHeap() const { return m_Heap; }
+
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuStart() const { return m_Heap->GetGPUDescriptorHandleForHeapStart(); }
+
+    uint32_t GetAllocatedCount();
+
+    static const uint32_t s_DefaultCapacity = 16384;
+
+  protected:
+    struct RetiredSlot
+    {
+        uint32_t Index;
+        UINT64 FenceValue;
+    };
+
+    ID3D12Device* m_Device;
+    FenceTimeline& m_FenceTimeline;
+
+    ID3D12DescriptorHeap* m_Heap;
+    UINT m_DescriptorSize;
+    uint32_t m_Capacity;
+
+    std::mutex m_Mutex;
+
+    // Slots never handed out start at m_NextIndex
+    uint32_t m_NextIndex = 0;
+    uint32_t m_AllocatedCount = 0;
+    std::vector<uint32_t> m_FreeIndices;
+
+    // Freed slots in fence order, waiting for the GPU to finish with them
+    std::deque<RetiredSlot> m_Retired;
+};
@@ -0,0 +1,74 @@
+#include "ClusteredLighting.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// Clustered Lighting
+
+ClusteredLighting::ClusteredLighting(ID3D12Device* device, FenceTimeline& fenceTimeline, uint32_t frameCount, const ClusterGridDesc& desc)
+    : m_Device(device), m_FenceTimeline(fenceTimeline), m_Binner(desc)
+{
+    m_Frames.resize(frameCount);
+
+    // Root SRVs need a buffer even while there are no lights
+    for (FrameBuffers& frame : m_Frames)
+    {
+        Write(frame.Lights, nullptr, 0, L"Cluster Light Buffer");
+        Write(frame.Clusters, nullptr, 0, L"Cluster Range Buffer");
+        Write(frame.LightIndices, nullptr, 0, L"Cluster Light Index Buffer");
+    }
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+    // Frames already submitted may still read them
+    for (FrameBuffers& frame : m_Frames)
+    {
+        m_FenceTimeline.Release(frame.Lights.Resource);
+        m_FenceTimeline.Release(frame.Clusters.Resource);
+        m_FenceTimeline.Release(frame.LightIndices.Resource);
+    }
+
+    m_Frames.clear();
+}
+
+void ClusteredLighting::Update(uint32_t frame, const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection, ThreadPool& threadPool)
+{
+    m_Binner.Bin(lights, view, projection, threadPool);
+
+    FrameBuffers& buffers = m_Frames[frame];
+
+    const std::vector<ClusterLight>& clusterLights = m_Binner.GetLights();
+    const std::vector<ClusterRange>& ranges = m_Binner.GetClusterRanges();
+    const std::vector<uint32_t>& indices = m_Binner.GetLightIndices();
+
+    Write(buffers.Lights, clusterLights.data(), clusterLights.size() * sizeof(ClusterLight), L"Cluster Light Buffer");
+    Write(buffers.Clusters, ranges.data(), ranges.size() * sizeof(ClusterRange), L"Cluster Range Buffer");
+    Write(buffers.LightIndices, indices.data(), indices.size() * sizeof(uint32_t), L"Cluster Light Index Buffer");
+}
+
+void ClusteredLighting::Write(UploadBuffer& buffer, const void* data, uint64_t size, const wchar_t* name)
+{
+    if (buffer.Resource == nullptr || size > buffer.Capacity)
+    {
+        // The old buffer is still read by the last frame that used it
+        m_FenceTimeline.Release(buffer.Resource);
+
+        const uint64_t minSize = s_MinBufferSize;
+        buffer.Capacity = std::max(std::bit_ceil(size), minSize);
+        buffer.Resource = CreateBufferResource(m_Device, D3D12_HEAP_TYPE_UPLOAD, buffer.Capacity, D3D12_RESOURCE_STATE_GENERIC_READ);
+        buffer.Resource->SetName(name);
+
+        // Upload heaps can stay mapped, nothing is read back
+        D3D12_RANGE readRange;
+        readRange.Begin = 0;
+        readRange.End = 0;
+        ThrowIfFailed(buffer.Resource->Map(0, &readRange, reinterpret_cast<void**>(&buffer.Mapped)));
+    }
+
+    if (size > 0)
+        memcpy(buffer.Mapped, data, size);
+}
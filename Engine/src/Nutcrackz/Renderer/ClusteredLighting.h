@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/LightBinner.h"
+
+#include <vector>
+
+// Clustered Lighting
+
+// Bins the frame's lights with LightBinner and writes the lights, the per
+// cluster ranges and the light index list into upload buffers the pixel
+// shader reads through root SRVs. Everything is rewritten every frame, so
+// each frame in flight gets its own buffers, grown when a frame needs more.
+//
+// Render thread only.
+class ClusteredLighting
+{
+  public:
+    ClusteredLighting(ID3D12Device* device, FenceTimeline& fenceTimeline, uint32_t frameCount, const ClusterGridDesc& desc = ClusterGridDesc());
+
+    ~ClusteredLighting();
+
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    // Bin and write frame's buffers. The last frame that used them must have
+    // completed on the GPU.
+    void Update(uint32_t frame, const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection, ThreadPool& threadPool);
+
+    D3D12_GPU_VIRTUAL_ADDRESS GetLightBufferAddress(uint32_t frame) const { return m_Frames[frame].Lights.Resource->GetGPUVirtualAddress(); }
+    D3D12_GPU_VIRTUAL_ADDRESS GetClusterBufferAddress(uint32_t frame) const { return m_Frames[frame].Clusters.Resource->GetGPUVirtualAddress(); }
+    D3D12_GPU_VIRTUAL_ADDRESS GetLightIndexBufferAddress(uint32_t frame) const { return m_Frames[frame].LightIndices.Resource->GetGPUVirtualAddress(); }
+
+    // Constants for a frame rendered at width by height pixels
+    ClusterConstants GetConstants(uint32_t width, uint32_t height) const { return m_Binner.GetConstants(width, height); }
+
+    const LightBinningStats& GetStats() const { return m_Binner.GetStats(); }
+
+  protected:
+    struct UploadBuffer
+    {
+        ID3D12Resource* Resource = nullptr;
+        UINT8* Mapped = nullptr;
+        uint64_t Capacity = 0;
+    };
+
+    struct FrameBuffers
+    {
+        UploadBuffer Lights;
+        UploadBuffer Clusters;
+        UploadBuffer LightIndices;
+    };
+
+    // Copy data into buffer, replacing it with a larger one if needed
+    void Write(UploadBuffer& buffer, const void* data, uint64_t size, const wchar_t* name);
+
+    ID3D12Device* m_Device;
+    FenceTimeline& m_FenceTimeline;
+
+    LightBinner m_Binner;
+    std::vector<FrameBuffers> m_Frames;
+
+    static const uint64_t s_MinBufferSize = 64 * 1024;
+};
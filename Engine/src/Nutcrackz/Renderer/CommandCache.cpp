@@ -0,0 +1,179 @@
+#include "CommandCache.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+#include <cstring>
+
+// Helper functions
+
+namespace
+{
+// FNV-1a over raw bytes, every hashed field is plain data
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+}
+
+// Command Caching
+
+bool DrawSequenceKey::operator==(const DrawSequenceKey& other) const
+{
+    if (PipelineState != other.PipelineState || RootSignature != other.RootSignature || Topology != other.Topology || ObjectIndexParameter != other.ObjectIndexParameter)
+        return false;
+
+    if (memcmp(&VertexBuffer, &other.VertexBuffer, sizeof(VertexBuffer)) != 0 || memcmp(&IndexBuffer, &other.IndexBuffer, sizeof(IndexBuffer)) != 0)
+        return false;
+
+    if (DrawCount != other.DrawCount)
+        return false;
+
+    for (uint32_t i = 0; i < DrawCount; ++i)
+    {
+        if (Draws[i].IndexCount != other.Draws[i].IndexCount || Draws[i].StartIndex != other.Draws[i].StartIndex || Draws[i].BaseVertex != other.Draws[i].BaseVertex ||
+            Draws[i].ObjectIndex != other.Draws[i].ObjectIndex)
+            return false;
+    }
+
+    return true;
+}
+
+uint64_t DrawSequenceKey::Hash() const
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashBytes(hash, &PipelineState, sizeof(PipelineState));
+    hash = HashBytes(hash, &RootSignature, sizeof(RootSignature));
+    hash = HashBytes(hash, &Topology, sizeof(Topology));
+    hash = HashBytes(hash, &VertexBuffer, sizeof(VertexBuffer));
+    hash = HashBytes(hash, &IndexBuffer, sizeof(IndexBuffer));
+    hash = HashBytes(hash, &ObjectIndexParameter, sizeof(ObjectIndexParameter));
+
+    for (uint32_t i = 0; i < DrawCount; ++i)
+    {
+        const DrawPacket& draw = Draws[i];
+        hash = HashBytes(hash, &draw.IndexCount, sizeof(draw.IndexCount));
+        hash = HashBytes(hash, &draw.StartIndex, sizeof(draw.StartIndex));
+        hash = HashBytes(hash, &draw.BaseVertex, sizeof(draw.BaseVertex));
+        hash = HashBytes(hash, &draw.ObjectIndex, sizeof(draw.ObjectIndex));
+    }
+
+    return hash;
+}
+
+CommandCache::CommandCache(ID3D12Device* device, FenceTimeline& fenceTimeline)
+    : m_Device(device), m_FenceTimeline(fenceTimeline)
+{
+}
+
+CommandCache::~CommandCache()
+{
+    Clear();
+}
+
+void CommandCache::Execute(ID3D12GraphicsCommandList* commandList, const DrawSequenceKey& key)
+{
+    if (key.DrawCount == 0)
+        return;
+
+    const uint32_t drawCount = key.DrawCount;
+    CachedBundle& cached = m_Bundles[key.Hash()];
+
+    // A different key with the same hash just replaces the old bundle
+    if (cached.Bundle && cached.Key == key)
+    {
+        m_Stats.CachedDraws += drawCount;
+        m_Stats.TotalCachedDraws += drawCount;
+    }
+    else
+    {
+        Release(cached);
+        cached.Draws.assign(key.Draws, key.Draws + key.DrawCount);
+        cached.Key = key;
+        cached.Key.Draws = cached.Draws.data();
+        Record(cached);
+
+        m_Stats.RecordedDraws += drawCount;
+        m_Stats.TotalRecordedDraws += drawCount;
+    }
+
+    cached.LastUsedFrame = m_FrameNumber;
+    commandList->ExecuteBundle(cached.Bundle);
+}
+
+void CommandCache::EndFrame()
+{
+    for (auto it = m_Bundles.begin(); it != m_Bundles.end();)
+    {
+        if (m_FrameNumber - it->second.LastUsedFrame >= s_EvictAfterFrames)
+        {
+            Release(it->second);
+            it = m_Bundles.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    m_Stats.CachedBundles = static_cast<uint32_t>(m_Bundles.size());
+    m_Stats.CachedDraws = 0;
+    m_Stats.RecordedDraws = 0;
+
+    m_FrameNumber++;
+}
+
+void CommandCache::Clear()
+{
+    for (auto& entry : m_Bundles)
+        Release(entry.second);
+
+    m_Bundles.clear();
+    m_Stats.CachedBundles = 0;
+}
+
+void CommandCache::Record(CachedBundle& cached)
+{
+    const DrawSequenceKey& key = cached.Key;
+
+    // Bundles get their own allocator, it can only be reset once the GPU is
+    // done with every frame that executed the bundle
+    ThrowIfFailed(m_Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&cached.Allocator)));
+    ThrowIfFailed(m_Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, cached.Allocator, key.PipelineState, IID_PPV_ARGS(&cached.Bundle)));
+    cached.Bundle->SetName(L"Cached Draw Bundle");
+
+    // Must match the caller's root signature, the bundle then inherits the
+    // root arguments bound there
+    cached.Bundle->SetGraphicsRootSignature(key.RootSignature);
+    cached.Bundle->IASetPrimitiveTopology(key.Topology);
+    cached.Bundle->IASetVertexBuffers(0, 1, &key.VertexBuffer);
+    cached.Bundle->IASetIndexBuffer(&key.IndexBuffer);
+
+    for (uint32_t i = 0; i < key.DrawCount; ++i)
+    {
+        const DrawPacket& draw = key.Draws[i];
+
+        if (key.ObjectIndexParameter != ~0u)
+            cached.Bundle->SetGraphicsRoot32BitConstant(key.ObjectIndexParameter, draw.ObjectIndex, 0);
+
+        cached.Bundle->DrawIndexedInstanced(draw.IndexCount, 1, draw.StartIndex, draw.BaseVertex, 0);
+    }
+
+    ThrowIfFailed(cached.Bundle->Close());
+}
+
+void CommandCache::Release(CachedBundle& cached)
+{
+    // Frames already submitted may still execute the bundle
+    m_FenceTimeline.Release(cached.Bundle);
+    m_FenceTimeline.Release(cached.Allocator);
+
+    cached.Bundle = nullptr;
+    cached.Allocator = nullptr;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/FrameSnapshot.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+
+#include <unordered_map>
+#include <vector>
+
+// Command Caching
+
+// Everything a static draw sequence depends on. Two sequences with equal
+// keys record identical commands.
+struct DrawSequenceKey
+{
+    ID3D12PipelineState* PipelineState = nullptr;
+    ID3D12RootSignature* RootSignature = nullptr;
+    D3D12_PRIMITIVE_TOPOLOGY Topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    D3D12_VERTEX_BUFFER_VIEW VertexBuffer = {};
+    D3D12_INDEX_BUFFER_VIEW IndexBuffer = {};
+
+    // Root constant each draw's object index is written to, none if ~0u
+    UINT ObjectIndexParameter = ~0u;
+
+    // Not owned, the caller's draw list is only copied when a bundle is
+    // recorded from it
+    const DrawPacket* Draws = nullptr;
+    uint32_t DrawCount = 0;
+
+    bool operator==(const DrawSequenceKey& other) const;
+
+    uint64_t Hash() const;
+};
+
+// Records static draw sequences into D3D12 bundles once and replays them
+// every frame with ExecuteBundle. Only state a bundle may hold is cached:
+// pipeline, root signature, input assembly, per draw root constants and the
+// draws. Per frame state
+// (render targets, viewport, descriptor tables and barriers) stays in the
+// primary command list, bundles inherit the root arguments set there.
+//
+// A bundle is re-recorded when its key changes, and released through the
+// fence timeline once it hasn't been used for s_EvictAfterFrames frames.
+// Render thread only.
+class CommandCache
+{
+  public:
+    CommandCache(ID3D12Device* device, FenceTimeline& fenceTimeline);
+
+    ~CommandCache();
+
+    CommandCache(const CommandCache&) = delete;
+    CommandCache& operator=(const CommandCache&) = delete;
+
+    // Execute the bundle for key on commandList, recording it first if no
+    // bundle with this key exists yet
+    void Execute(ID3D12GraphicsCommandList* commandList, const DrawSequenceKey& key);
+
+    // Evict stale bundles and reset the per frame counters
+    void EndFrame();
+
+    // Drop every bundle, for when a cached input is recreated in place
+    void Clear();
+
+    const CommandCacheStats& GetStats() const { return m_Stats; }
+
+    static const uint32_t s_EvictAfterFrames = 120;
+
+  protected:
+    struct CachedBundle
+    {
+        // Key.Draws points into Draws
+        DrawSequenceKey Key;
+        std::vector<DrawPacket> Draws;
+
+        ID3D12CommandAllocator* Allocator = nullptr;
+        ID3D12GraphicsCommandList* Bundle = nullptr;
+        uint64_t LastUsedFrame = 0;
+    };
+
+    void Record(CachedBundle& cached);
+
+    void Release(CachedBundle& cached);
+
+    ID3D12Device* m_Device;
+    FenceTimeline& m_FenceTimeline;
+
+    std::unordered_map<uint64_t, CachedBundle> m_Bundles;
+
+    uint64_t m_FrameNumber = 0;
+
+    CommandCacheStats m_Stats;
+};
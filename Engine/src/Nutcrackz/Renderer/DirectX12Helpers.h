@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include <exception>
+
+// Helper functions shared by the DirectX 12 renderer and its subsystems
+
+inline void ThrowIfFailed(HRESULT hr)
+{
+    if (FAILED(hr))
+        throw std::exception();
+}
+
+// Create a committed buffer of the given heap type
+inline ID3D12Resource* CreateBufferResource(ID3D12Device* device, D3D12_HEAP_TYPE heapType, UINT64 size, D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE)
+{
+    D3D12_HEAP_PROPERTIES heapProps;
+    heapProps.Type = heapType;
+    heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProps.CreationNodeMask = 1;
+    heapProps.VisibleNodeMask = 1;
+
+    D3D12_RESOURCE_DESC bufferResourceDesc;
+    bufferResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferResourceDesc.Alignment = 0;
+    bufferResourceDesc.Width = size;
+    bufferResourceDesc.Height = 1;
+    bufferResourceDesc.DepthOrArraySize = 1;
+    bufferResourceDesc.MipLevels = 1;
+    bufferResourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+    bufferResourceDesc.SampleDesc.Count = 1;
+    bufferResourceDesc.SampleDesc.Quality = 0;
+    bufferResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    bufferResourceDesc.Flags = flags;
+
+    ID3D12Resource* buffer = nullptr;
+    ThrowIfFailed(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufferResourceDesc, initialState, nullptr, IID_PPV_ARGS(&buffer)));
+
+    return buffer;
+}
+
+inline D3D12_RESOURCE_BARRIER TransitionBarrier(ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+{
+    D3D12_RESOURCE_BARRIER barrier;
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    barrier.Transition.pResource = resource;
+    barrier.Transition.StateBefore = before;
+    barrier.Transition.StateAfter = after;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+    return barrier;
+}
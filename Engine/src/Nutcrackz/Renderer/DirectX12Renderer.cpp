@@ -0,0 +1,1642 @@
+#include "DirectX12Renderer.h"
+
+#include "Nutcrackz/Core/FrameArenas.h"
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+using namespace glm;
+
+// Helper functions
+
+namespace
+{
+const float s_ClearColor[] = { 0.2f, 0.2f, 0.2f, 1.0f };
+
+#define COMPILESHADERS
+
+// Bytecode of assets\<name>.hlsl, compiled and written next to it as
+// <name>.dxbc, or read from that file when shaders are precompiled
+std::vector<char> CompileShader(const std::string& name, const char* target)
+{
+    char pBuf[1024];
+    _getcwd(pBuf, 1024);
+
+    std::string path = pBuf;
+    path += "\\assets\\" + name;
+
+#ifdef COMPILESHADERS
+#if defined(_DEBUG)
+    // Enable better shader debugging with the graphics debugging tools.
+    UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    UINT compileFlags = 0;
+#endif
+
+    const std::string sourcePath = path + ".hlsl";
+    const std::wstring wsourcePath = std::wstring(sourcePath.begin(), sourcePath.end());
+
+    ID3DBlob* shader = nullptr;
+    ID3DBlob* errors = nullptr;
+
+    if (FAILED(D3DCompileFromFile(wsourcePath.c_str(), nullptr, nullptr, "main", target, compileFlags, 0, &shader, &errors)))
+    {
+        std::string message = "Failed to compile " + name + "!";
+        if (errors)
+        {
+            message += "\n";
+            message += (const char*)errors->GetBufferPointer();
+            errors->Release();
+        }
+
+        throw std::runtime_error(message);
+    }
+
+    if (errors)
+    {
+        errors->Release();
+        errors = nullptr;
+    }
+
+    const char* bytecode = (const char*)shader->GetBufferPointer();
+    std::vector<char> bytecodeData(bytecode, bytecode + shader->GetBufferSize());
+
+    shader->Release();
+    shader = nullptr;
+
+    std::ofstream out(path + ".dxbc", std::ios::out | std::ios::binary);
+    out.write(bytecodeData.data(), bytecodeData.size());
+
+    return bytecodeData;
+#else
+    return ReadFile(path + ".dxbc");
+#endif
+}
+}
+
+// Renderer
+
+Renderer::Renderer(xwin::Window& window)
+{
+    m_Headless = false;
+    m_UseWarp = false;
+
+    Startup(&window);
+}
+
+Renderer::Renderer(const HeadlessDesc& desc)
+{
+    m_Headless = true;
+    m_UseWarp = desc.UseSoftwareRasterizer;
+
+    m_Width = clamp(desc.Width, 1u, 0xffffu);
+    m_Height = clamp(desc.Height, 1u, 0xffffu);
+
+    Startup(nullptr);
+}
+
+void Renderer::Startup(xwin::Window* window)
+{
+    m_Window = nullptr;
+
+    // Initialization
+    m_Factory = nullptr;
+    m_Adapter = nullptr;
+#if defined(_DEBUG)
+    m_DebugController = nullptr;
+    m_DebugDevice = nullptr;
+#endif
+    m_Device = nullptr;
+    m_QueueScheduler = nullptr;
+    m_CommandQueue = nullptr;
+    m_Swapchain = nullptr;
+
+    // Resources
+
+    m_VertexBuffer = nullptr;
+    m_IndexBuffer = nullptr;
+
+	m_UniformBuffer = nullptr;
+	m_MappedUniformBuffer = nullptr;
+
+    m_RootSignature = nullptr;
+    m_PipelineState = nullptr;
+
+    m_TextureStreamer = nullptr;
+    m_TextureBudget = s_DefaultTextureBudget;
+    m_ResidencyManager = nullptr;
+    m_CommandCache = nullptr;
+    m_ClusteredLighting = nullptr;
+    m_SceneBuffer = nullptr;
+    m_BindlessHeap = nullptr;
+    m_MaterialRegistry = nullptr;
+
+    m_SceneColor = nullptr;
+    m_SceneColorSrvHeap = nullptr;
+    m_SceneColorDescriptor = s_InvalidDescriptor;
+    m_UpscalePipelineState = nullptr;
+    m_ResolutionScale = 1.0f;
+
+    m_FrameReadback = nullptr;
+
+    m_HudRenderer = nullptr;
+    m_HudPipelineState = nullptr;
+
+    m_TimestampHeap = nullptr;
+    m_TimestampReadback = nullptr;
+    for (size_t i = 0; i < s_BackbufferCount; ++i)
+        m_TimestampsPending[i] = false;
+    m_TimestampFrequency = 1;
+    m_LastGpuFrameMs = 0.0f;
+
+    m_ResizePending = false;
+
+    // Current Frame
+    m_RtvHeap = nullptr;
+    for (size_t i = 0; i < s_BackbufferCount; ++i)
+        m_RenderTargets[i] = nullptr;
+    
+    // Sync
+    m_FenceTimeline = nullptr;
+    for (size_t i = 0; i < s_BackbufferCount; ++i)
+        m_FrameFenceValues[i] = 0;
+
+    m_LastFenceWait = std::chrono::nanoseconds(0);
+
+    // Startup
+    m_StartupMs = 0.0;
+    m_TimeToFirstFrameMs = 0.0;
+
+    // The game thread provides real constants with every frame
+    UboVS.ProjectionMatrix = glm::identity<mat4>();
+    UboVS.ViewMatrix = glm::identity<mat4>();
+
+    // Startup is a graph of tasks run on the worker threads. Shaders compile
+    // while the device is created, pipeline states build while buffers and
+    // the swapchain are created.
+    TaskGraph startup;
+
+    std::vector<char> triangleVertexShader, trianglePixelShader;
+    std::vector<char> upscaleVertexShader, upscalePixelShader;
+    std::vector<char> hudVertexShader, hudPixelShader;
+
+    const TaskId device = startup.Add("Create Device", {}, [this]() { CreateDevice(); });
+    const TaskId queues = startup.Add("Create Queues", { device }, [this]() { CreateQueues(); });
+
+    // DXGI may message the window while creating the swapchain, which needs
+    // the thread that owns it. Offscreen targets can be created anywhere.
+    const TaskId swapchain = window ? startup.Add("Create Swapchain", { queues }, [this, window]() { CreateSwapchain(window); }, TaskAffinity::Caller)
+                                    : startup.Add("Create Offscreen Targets", { queues }, [this]() { CreateSwapchain(nullptr); });
+
+    const TaskId managers = startup.Add("Create Resource Managers", { queues }, [this]() { CreateResourceManagers(); });
+    const TaskId rootSignature = startup.Add("Create Root Signature", { device }, [this]() { CreateRootSignature(); });
+
+    const TaskId triangleVertex = startup.Add("Compile triangle.vert", {}, [&triangleVertexShader]() {
+        triangleVertexShader = CompileShader("triangle.vert", "vs_5_1");
+    });
+    const TaskId trianglePixel = startup.Add("Compile triangle.frag", {}, [&trianglePixelShader]() {
+        trianglePixelShader = CompileShader("triangle.frag", "ps_5_1");
+    });
+    const TaskId upscaleVertex = startup.Add("Compile upscale.vert", {}, [&upscaleVertexShader]() {
+        upscaleVertexShader = CompileShader("upscale.vert", "vs_5_1");
+    });
+    const TaskId upscalePixel = startup.Add("Compile upscale.frag", {}, [&upscalePixelShader]() {
+        upscalePixelShader = CompileShader("upscale.frag", "ps_5_1");
+    });
+    const TaskId hudVertex = startup.Add("Compile hud.vert", {}, [&hudVertexShader]() {
+        hudVertexShader = CompileShader("hud.vert", "vs_5_1");
+    });
+    const TaskId hudPixel = startup.Add("Compile hud.frag", {}, [&hudPixelShader]() {
+        hudPixelShader = CompileShader("hud.frag", "ps_5_1");
+    });
+
+    startup.Add("Create Pipeline State", { rootSignature, triangleVertex, trianglePixel }, [&, this]() {
+        const D3D12_INPUT_ELEMENT_DESC inputElementDescs[] = {
+            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+        };
+
+        m_PipelineState = CreatePipelineState(triangleVertexShader, trianglePixelShader, { inputElementDescs, _countof(inputElementDescs) });
+        m_PipelineState->SetName(L"Triangle Pipeline State");
+    });
+
+    // The upscale pass draws one triangle over the back buffer without any
+    // vertex input, and shares the root signature and render state
+    startup.Add("Create Upscale Pipeline State", { rootSignature, upscaleVertex, upscalePixel }, [&, this]() {
+        m_UpscalePipelineState = CreatePipelineState(upscaleVertexShader, upscalePixelShader, { nullptr, 0 });
+        m_UpscalePipelineState->SetName(L"Upscale Pipeline State");
+    });
+
+    // The HUD's quads come from a structured buffer, blended over the frame
+    startup.Add("Create HUD Pipeline State", { rootSignature, hudVertex, hudPixel }, [&, this]() {
+        m_HudPipelineState = CreatePipelineState(hudVertexShader, hudPixelShader, { nullptr, 0 }, true);
+        m_HudPipelineState->SetName(L"HUD Pipeline State");
+    });
+
+    startup.Add("Create Geometry Buffers", { device }, [this]() { CreateGeometryBuffers(); });
+
+    // Dynamic resolution
+    startup.Add("Create Scene Color", { swapchain, managers }, [this]() { CreateSceneColor(); });
+
+    startup.Add("Create Timestamp Queries", { queues }, [this]() { CreateTimestampQueries(); });
+
+    m_StartupStart = std::chrono::steady_clock::now();
+
+    // Run waits for every task before rethrowing, so what the others created
+    // is complete. The destructor doesn't run when the constructor throws.
+    try
+    {
+        startup.Run(m_ThreadPool);
+    }
+    catch (...)
+    {
+        Shutdown();
+        throw;
+    }
+
+    m_StartupMs = startup.GetTotalMs();
+    m_StartupTimings = startup.GetTimings();
+
+    std::cout << "Renderer startup:\n";
+    startup.WriteReport(std::cout);
+
+    // Everything above lives in upload heaps, nothing has been submitted to
+    // the GPU that needs waiting for.
+    m_FrameIndex = m_Swapchain ? m_Swapchain->GetCurrentBackBufferIndex() : 0;
+}
+
+Renderer::~Renderer()
+{
+    Shutdown();
+}
+
+void Renderer::Shutdown()
+{
+    if (m_Swapchain != nullptr)
+    {
+        m_Swapchain->SetFullscreenState(false, nullptr);
+        m_Swapchain->Release();
+        m_Swapchain = nullptr;
+    }
+
+    DestroyCommands();
+    DestroyFrameBuffer();
+    DestroyResources();
+    DestroyAPI();
+}
+
+void Renderer::CreateDevice()
+{
+    // Create Factory
+
+    UINT dxgiFactoryFlags = 0;
+#if defined(_DEBUG)
+    ID3D12Debug* debugController;
+    ThrowIfFailed(D3D12GetDebugInterface(IID_PPV_ARGS(&debugController)));
+    ThrowIfFailed(debugController->QueryInterface(IID_PPV_ARGS(&m_DebugController)));
+    m_DebugController->EnableDebugLayer();
+    m_DebugController->SetEnableGPUBasedValidation(true);
+
+    dxgiFactoryFlags |= DXGI_CREATE_FACTORY_DEBUG;
+
+    debugController->Release();
+    debugController = nullptr;
+
+#endif
+    ThrowIfFailed(CreateDXGIFactory2(dxgiFactoryFlags, IID_PPV_ARGS(&m_Factory)));
+
+    // Create Adapter
+    for (UINT adapterIndex = 0; !m_UseWarp && DXGI_ERROR_NOT_FOUND != m_Factory->EnumAdapters1(adapterIndex, &m_Adapter); ++adapterIndex)
+    {
+        DXGI_ADAPTER_DESC1 desc;
+        m_Adapter->GetDesc1(&desc);
+
+        // Don't select the Basic Render Driver adapter.
+        if (desc.Flags & DXGI_ADAPTER_FLAG_SOFTWARE)
+            continue;
+
+        // Check to see if the adapter supports Direct3D 12, but don't create
+        // the actual device yet.
+        if (SUCCEEDED(D3D12CreateDevice(m_Adapter, D3D_FEATURE_LEVEL_12_0, _uuidof(ID3D12Device), nullptr)))
+            break;
+
+        // We won't use this adapter, so release it
+        m_Adapter->Release();
+        m_Adapter = nullptr;
+    }
+
+    // WARP rasterizes on the CPU, for machines without a suitable GPU
+    if (m_Adapter == nullptr)
+    {
+        ThrowIfFailed(m_Factory->EnumWarpAdapter(IID_PPV_ARGS(&m_Adapter)));
+        std::cout << "Rendering with WARP\n";
+    }
+
+    // Create Device
+    ID3D12Device* pDev = nullptr;
+    ThrowIfFailed(D3D12CreateDevice(m_Adapter, D3D_FEATURE_LEVEL_12_0,
+                                    IID_PPV_ARGS(&m_Device)));
+
+    m_Device->SetName(L"Hello Triangle Device");
+
+#if defined(_DEBUG)
+    // Get debug device
+    ThrowIfFailed(m_Device->QueryInterface(&m_DebugDevice));
+#endif
+}
+
+void Renderer::CreateQueues()
+{
+    // Create the direct, compute and copy queues
+    m_QueueScheduler = new QueueScheduler(m_Device);
+    m_CommandQueue = m_QueueScheduler->GetQueue(QueueType::Direct);
+
+    // Sync
+    m_FenceTimeline = new FenceTimeline(m_Device, m_CommandQueue);
+}
+
+void Renderer::CreateSwapchain(xwin::Window* window)
+{
+    if (window)
+    {
+        // The renderer needs the window when resizing the swapchain
+        m_Window = window;
+
+        const xwin::WindowDesc wdesc = window->getDesc();
+        m_Width = clamp(wdesc.width, 1u, 0xffffu);
+        m_Height = clamp(wdesc.height, 1u, 0xffffu);
+    }
+
+    SetupSwapchain(m_Width, m_Height);
+    InitFrameBuffer();
+}
+
+void Renderer::DestroyAPI()
+{
+    // Waits for the GPU and releases everything still deferred
+    if (m_FenceTimeline)
+    {
+        delete m_FenceTimeline;
+        m_FenceTimeline = nullptr;
+    }
+
+    // Owns the queues, waits for all of them first
+    if (m_QueueScheduler)
+    {
+        delete m_QueueScheduler;
+        m_QueueScheduler = nullptr;
+        m_CommandQueue = nullptr;
+    }
+
+    if (m_Device)
+    {
+        m_Device->Release();
+        m_Device = nullptr;
+    }
+
+    if (m_Adapter)
+    {
+        m_Adapter->Release();
+        m_Adapter = nullptr;
+    }
+
+    if (m_Factory)
+    {
+        m_Factory->Release();
+        m_Factory = nullptr;
+    }
+
+#if defined(_DEBUG)
+    if (m_DebugController)
+    {
+        m_DebugController->Release();
+        m_DebugController = nullptr;
+    }
+
+    if (m_DebugDevice)
+    {
+        D3D12_RLDO_FLAGS flags =
+            D3D12_RLDO_SUMMARY | D3D12_RLDO_DETAIL | D3D12_RLDO_IGNORE_INTERNAL;
+
+        m_DebugDevice->ReportLiveDeviceObjects(flags);
+
+        m_DebugDevice->Release();
+        m_DebugDevice = nullptr;
+    }
+#endif
+}
+
+void Renderer::InitFrameBuffer()
+{
+    m_CurrentBuffer = m_Swapchain ? m_Swapchain->GetCurrentBackBufferIndex() : 0;
+
+    // Create descriptor heaps.
+    {
+        // Describe and create a render target view (RTV) descriptor heap.
+        D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
+        rtvHeapDesc.NumDescriptors = s_BackbufferCount + 1;
+        rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+        rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+        ThrowIfFailed(m_Device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_RtvHeap)));
+
+        m_RtvDescriptorSize = m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+    }
+
+    // Create frame resources.
+    CreateRenderTargetViews();
+}
+
+void Renderer::CreateRenderTargetViews()
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle(
+        m_RtvHeap->GetCPUDescriptorHandleForHeapStart());
+
+    // Create a RTV for each frame.
+    for (UINT n = 0; n < s_BackbufferCount; n++)
+    {
+        if (m_Headless)
+            m_RenderTargets[n] = CreateOffscreenTarget();
+        else
+            ThrowIfFailed(m_Swapchain->GetBuffer(n, IID_PPV_ARGS(&m_RenderTargets[n])));
+
+        m_Device->CreateRenderTargetView(m_RenderTargets[n], nullptr, rtvHandle);
+        rtvHandle.ptr += (1 * m_RtvDescriptorSize);
+    }
+}
+
+ID3D12Resource* Renderer::CreateOffscreenTarget()
+{
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heapProps.CreationNodeMask = 1;
+    heapProps.VisibleNodeMask = 1;
+
+    D3D12_RESOURCE_DESC textureDesc = {};
+    textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    textureDesc.Width = m_Width;
+    textureDesc.Height = m_Height;
+    textureDesc.DepthOrArraySize = 1;
+    textureDesc.MipLevels = 1;
+    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    textureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+    // The present state is the common state, frames leave the target in it
+    // like a swapchain buffer
+    ID3D12Resource* target = nullptr;
+    ThrowIfFailed(m_Device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &textureDesc, D3D12_RESOURCE_STATE_PRESENT, nullptr, IID_PPV_ARGS(&target)));
+    target->SetName(L"Offscreen Target");
+
+    return target;
+}
+
+void Renderer::ReleaseRenderTargets()
+{
+    for (size_t i = 0; i < s_BackbufferCount; ++i)
+    {
+        if (m_RenderTargets[i])
+        {
+            m_RenderTargets[i]->Release();
+            m_RenderTargets[i] = 0;
+        }
+    }
+}
+
+void Renderer::CreateSceneColor()
+{
+    if (m_SceneColorSrvHeap == nullptr)
+    {
+        D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
+        srvHeapDesc.NumDescriptors = 1;
+        srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+        srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+        ThrowIfFailed(m_Device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&m_SceneColorSrvHeap)));
+    }
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heapProps.CreationNodeMask = 1;
+    heapProps.VisibleNodeMask = 1;
+
+    D3D12_RESOURCE_DESC textureDesc = {};
+    textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    textureDesc.Width = m_Width;
+    textureDesc.Height = m_Height;
+    textureDesc.DepthOrArraySize = 1;
+    textureDesc.MipLevels = 1;
+    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    textureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+    D3D12_CLEAR_VALUE clearValue = {};
+    clearValue.Format = textureDesc.Format;
+    memcpy(clearValue.Color, s_ClearColor, sizeof(s_ClearColor));
+
+    // Lives in the shader resource state between frames
+    ThrowIfFailed(m_Device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &textureDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &clearValue, IID_PPV_ARGS(&m_SceneColor)));
+    m_SceneColor->SetName(L"Scene Color");
+
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_RtvHeap->GetCPUDescriptorHandleForHeapStart());
+    rtvHandle.ptr += s_SceneColorRtv * m_RtvDescriptorSize;
+    m_Device->CreateRenderTargetView(m_SceneColor, nullptr, rtvHandle);
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = textureDesc.Format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+    m_Device->CreateShaderResourceView(m_SceneColor, &srvDesc, m_SceneColorSrvHeap->GetCPUDescriptorHandleForHeapStart());
+
+    m_SceneColorDescriptor = m_BindlessHeap->Allocate();
+    m_BindlessHeap->Copy(m_SceneColorDescriptor, m_SceneColorSrvHeap->GetCPUDescriptorHandleForHeapStart());
+}
+
+void Renderer::ReleaseSceneColor()
+{
+    if (m_SceneColorDescriptor != s_InvalidDescriptor)
+    {
+        m_BindlessHeap->Free(m_SceneColorDescriptor);
+        m_SceneColorDescriptor = s_InvalidDescriptor;
+    }
+
+    if (m_SceneColor)
+    {
+        m_FenceTimeline->Release(m_SceneColor);
+        m_SceneColor = nullptr;
+    }
+}
+
+void Renderer::DestroyFrameBuffer()
+{
+    ReleaseRenderTargets();
+
+    if (m_RtvHeap)
+    {
+        m_RtvHeap->Release();
+        m_RtvHeap = nullptr;
+    }
+}
+
+void Renderer::CreateResourceManagers()
+{
+    m_BindlessHeap = new BindlessDescriptorHeap(m_Device, *m_FenceTimeline);
+    m_ResidencyManager = new ResidencyManager(m_Device, m_Adapter, *m_FenceTimeline);
+    m_TextureStreamer = new TextureStreamer(m_Device, m_ThreadPool, *m_FenceTimeline, *m_BindlessHeap, *m_ResidencyManager, m_TextureBudget);
+
+    // Listeners run on the render thread with the streamer's lock held
+    m_ResidencyManager->AddBudgetListener([this](const ResidencyBudget&) { UpdateTextureBudget(); });
+    m_CommandCache = new CommandCache(m_Device, *m_FenceTimeline);
+    m_SceneBuffer = new PersistentBuffer(m_Device, *m_FenceTimeline, sizeof(SceneObject), s_InitialSceneCapacity, L"Scene Buffer");
+    m_MaterialRegistry = new MaterialRegistry(m_Device, *m_FenceTimeline);
+    m_ClusteredLighting = new ClusteredLighting(m_Device, *m_FenceTimeline, s_BackbufferCount);
+    m_FrameReadback = new FrameReadback(m_Device, *m_FenceTimeline, m_ThreadPool, s_ReadbackBufferCount);
+    m_HudRenderer = new HudRenderer(m_Device, *m_FenceTimeline, s_BackbufferCount);
+
+    // Material 0 is what objects get unless they ask for something else
+    m_MaterialRegistry->Create(MaterialDesc());
+}
+
+void Renderer::CreateRootSignature()
+{
+    D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
+
+    // This is the highest version the sample supports. If
+    // CheckFeatureSupport succeeds, the HighestVersion returned will not be
+    // greater than this.
+    featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+
+    if (FAILED(m_Device->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(featureData))))
+        featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+
+    // Every texture in the bindless heap, the heap is only partially
+    // filled so the descriptors are volatile
+    D3D12_DESCRIPTOR_RANGE1 ranges[1];
+    ranges[0].BaseShaderRegister = 0;
+    ranges[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    ranges[0].NumDescriptors = UINT_MAX;
+    ranges[0].RegisterSpace = 1;
+    ranges[0].OffsetInDescriptorsFromTableStart = 0;
+    ranges[0].Flags = D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE;
+
+    D3D12_ROOT_PARAMETER1 rootParameters[s_RootParameterCount];
+
+    // Frame constants are bound by address, no descriptor needed
+    rootParameters[s_FrameConstantsParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+    rootParameters[s_FrameConstantsParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+    rootParameters[s_FrameConstantsParameter].Descriptor.ShaderRegister = 0;
+    rootParameters[s_FrameConstantsParameter].Descriptor.RegisterSpace = 0;
+    rootParameters[s_FrameConstantsParameter].Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+
+    // The scene buffer is bound by address, no descriptor needed
+    rootParameters[s_SceneBufferParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    rootParameters[s_SceneBufferParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+    rootParameters[s_SceneBufferParameter].Descriptor.ShaderRegister = 0;
+    rootParameters[s_SceneBufferParameter].Descriptor.RegisterSpace = 0;
+    rootParameters[s_SceneBufferParameter].Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+
+    // Index of the draw's object in the scene buffer
+    rootParameters[s_ObjectIndexParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[s_ObjectIndexParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+    rootParameters[s_ObjectIndexParameter].Constants.ShaderRegister = 1;
+    rootParameters[s_ObjectIndexParameter].Constants.RegisterSpace = 0;
+    rootParameters[s_ObjectIndexParameter].Constants.Num32BitValues = 1;
+
+    // Material parameters, indexed by the object's material
+    rootParameters[s_MaterialBufferParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    rootParameters[s_MaterialBufferParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    rootParameters[s_MaterialBufferParameter].Descriptor.ShaderRegister = 1;
+    rootParameters[s_MaterialBufferParameter].Descriptor.RegisterSpace = 0;
+    rootParameters[s_MaterialBufferParameter].Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+
+    // Texture handle to bindless index
+    rootParameters[s_TextureTableParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    rootParameters[s_TextureTableParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    rootParameters[s_TextureTableParameter].Descriptor.ShaderRegister = 2;
+    rootParameters[s_TextureTableParameter].Descriptor.RegisterSpace = 0;
+    rootParameters[s_TextureTableParameter].Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+
+    rootParameters[s_BindlessTexturesParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParameters[s_BindlessTexturesParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    rootParameters[s_BindlessTexturesParameter].DescriptorTable.NumDescriptorRanges = 1;
+    rootParameters[s_BindlessTexturesParameter].DescriptorTable.pDescriptorRanges = ranges;
+
+    // Source and scale of the upscale pass
+    rootParameters[s_UpscaleConstantsParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[s_UpscaleConstantsParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    rootParameters[s_UpscaleConstantsParameter].Constants.ShaderRegister = 2;
+    rootParameters[s_UpscaleConstantsParameter].Constants.RegisterSpace = 0;
+    rootParameters[s_UpscaleConstantsParameter].Constants.Num32BitValues = sizeof(UpscaleConstants) / sizeof(uint32_t);
+
+    // Cluster grid of the frame's lights
+    rootParameters[s_LightingConstantsParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[s_LightingConstantsParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    rootParameters[s_LightingConstantsParameter].Constants.ShaderRegister = 3;
+    rootParameters[s_LightingConstantsParameter].Constants.RegisterSpace = 0;
+    rootParameters[s_LightingConstantsParameter].Constants.Num32BitValues = sizeof(ClusterConstants) / sizeof(uint32_t);
+
+    // Lights, cluster ranges and light indices, rewritten every frame
+    const UINT lightingParameters[] = { s_LightBufferParameter, s_ClusterBufferParameter, s_LightIndexBufferParameter };
+    for (UINT i = 0; i < _countof(lightingParameters); i++)
+    {
+        D3D12_ROOT_PARAMETER1& parameter = rootParameters[lightingParameters[i]];
+        parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+        parameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+        parameter.Descriptor.ShaderRegister = 3 + i;
+        parameter.Descriptor.RegisterSpace = 0;
+        parameter.Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+    }
+
+    // Target size of the HUD pass
+    rootParameters[s_HudConstantsParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParameters[s_HudConstantsParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+    rootParameters[s_HudConstantsParameter].Constants.ShaderRegister = 4;
+    rootParameters[s_HudConstantsParameter].Constants.RegisterSpace = 0;
+    rootParameters[s_HudConstantsParameter].Constants.Num32BitValues = sizeof(HudConstants) / sizeof(uint32_t);
+
+    // The frame's HUD quads and the font atlas
+    rootParameters[s_HudQuadBufferParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    rootParameters[s_HudQuadBufferParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+    rootParameters[s_HudQuadBufferParameter].Descriptor.ShaderRegister = 6;
+    rootParameters[s_HudQuadBufferParameter].Descriptor.RegisterSpace = 0;
+    rootParameters[s_HudQuadBufferParameter].Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+
+    rootParameters[s_HudFontParameter].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    rootParameters[s_HudFontParameter].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    rootParameters[s_HudFontParameter].Descriptor.ShaderRegister = 7;
+    rootParameters[s_HudFontParameter].Descriptor.RegisterSpace = 0;
+    rootParameters[s_HudFontParameter].Descriptor.Flags = D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC;
+
+    D3D12_STATIC_SAMPLER_DESC samplers[2] = {};
+    D3D12_STATIC_SAMPLER_DESC& sampler = samplers[0];
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler.MipLODBias = 0.0f;
+    sampler.MaxAnisotropy = 1;
+    sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+    sampler.BorderColor = D3D12_STATIC_BORDER_COLOR_OPAQUE_BLACK;
+    sampler.MinLOD = 0.0f;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.RegisterSpace = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    // The upscale pass must not wrap around into the other edge
+    samplers[1] = sampler;
+    samplers[1].AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    samplers[1].AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    samplers[1].AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    samplers[1].ShaderRegister = 1;
+
+    D3D12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+    rootSignatureDesc.Version = D3D_ROOT_SIGNATURE_VERSION_1_1;
+    rootSignatureDesc.Desc_1_1.Flags =
+        D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+    rootSignatureDesc.Desc_1_1.NumParameters = _countof(rootParameters);
+    rootSignatureDesc.Desc_1_1.pParameters = rootParameters;
+    rootSignatureDesc.Desc_1_1.NumStaticSamplers = _countof(samplers);
+    rootSignatureDesc.Desc_1_1.pStaticSamplers = samplers;
+
+    ID3DBlob* signature = nullptr;
+    ID3DBlob* error = nullptr;
+    try
+    {
+        ThrowIfFailed(D3D12SerializeVersionedRootSignature(&rootSignatureDesc, &signature, &error));
+        ThrowIfFailed(m_Device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_RootSignature)));
+        m_RootSignature->SetName(L"Hello Triangle Root Signature");
+    }
+    catch (std::exception e)
+    {
+        if (error)
+        {
+            const char* errStr = (const char*)error->GetBufferPointer();
+            std::cout << errStr;
+            error->Release();
+            error = nullptr;
+        }
+    }
+
+    if (signature)
+    {
+        signature->Release();
+        signature = nullptr;
+    }
+
+    // The pipeline states depend on it
+    if (m_RootSignature == nullptr)
+        throw std::runtime_error("Failed to create Root Signature!");
+}
+
+ID3D12PipelineState* Renderer::CreatePipelineState(const std::vector<char>& vertexShader, const std::vector<char>& pixelShader, const D3D12_INPUT_LAYOUT_DESC& inputLayout, bool alphaBlend)
+{
+    // Describe and create the graphics pipeline state object (PSO).
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.InputLayout = inputLayout;
+    psoDesc.pRootSignature = m_RootSignature;
+
+    psoDesc.VS.pShaderBytecode = vertexShader.data();
+    psoDesc.VS.BytecodeLength = vertexShader.size();
+
+    psoDesc.PS.pShaderBytecode = pixelShader.data();
+    psoDesc.PS.BytecodeLength = pixelShader.size();
+
+    D3D12_RASTERIZER_DESC rasterDesc;
+    rasterDesc.FillMode = D3D12_FILL_MODE_SOLID;
+    rasterDesc.CullMode = D3D12_CULL_MODE_NONE;
+    rasterDesc.FrontCounterClockwise = FALSE;
+    rasterDesc.DepthBias = D3D12_DEFAULT_DEPTH_BIAS;
+    rasterDesc.DepthBiasClamp = D3D12_DEFAULT_DEPTH_BIAS_CLAMP;
+    rasterDesc.SlopeScaledDepthBias = D3D12_DEFAULT_SLOPE_SCALED_DEPTH_BIAS;
+    rasterDesc.DepthClipEnable = TRUE;
+    rasterDesc.MultisampleEnable = FALSE;
+    rasterDesc.AntialiasedLineEnable = FALSE;
+    rasterDesc.ForcedSampleCount = 0;
+    rasterDesc.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
+
+    psoDesc.RasterizerState = rasterDesc;
+
+    D3D12_BLEND_DESC blendDesc;
+    blendDesc.AlphaToCoverageEnable = FALSE;
+    blendDesc.IndependentBlendEnable = FALSE;
+    const D3D12_RENDER_TARGET_BLEND_DESC defaultRenderTargetBlendDesc = {
+        FALSE,
+        FALSE,
+        D3D12_BLEND_ONE,
+        D3D12_BLEND_ZERO,
+        D3D12_BLEND_OP_ADD,
+        D3D12_BLEND_ONE,
+        D3D12_BLEND_ZERO,
+        D3D12_BLEND_OP_ADD,
+        D3D12_LOGIC_OP_NOOP,
+        D3D12_COLOR_WRITE_ENABLE_ALL,
+    };
+
+    for (UINT i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+        blendDesc.RenderTarget[i] = defaultRenderTargetBlendDesc;
+
+    if (alphaBlend)
+    {
+        blendDesc.RenderTarget[0].BlendEnable = TRUE;
+        blendDesc.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
+        blendDesc.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+        blendDesc.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
+        blendDesc.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+    }
+
+    psoDesc.BlendState = blendDesc;
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.DepthStencilState.StencilEnable = FALSE;
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+    psoDesc.SampleDesc.Count = 1;
+
+    ID3D12PipelineState* pipelineState = nullptr;
+    if (FAILED(m_Device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pipelineState))))
+        throw std::runtime_error("Failed to create Graphics Pipeline!");
+
+    return pipelineState;
+}
+
+void Renderer::CreateGeometryBuffers()
+{
+    // Create the UBO.
+    {
+        // Note: using upload heaps to transfer static data like vert
+        // buffers is not recommended. Every time the GPU needs it, the
+        // upload heap will be marshalled over. Please read up on Default
+        // Heap usage. An upload heap is used here for code simplicity and
+        // because there are very few verts to actually transfer.
+        D3D12_HEAP_PROPERTIES heapProps;
+        heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+        heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heapProps.CreationNodeMask = 1;
+        heapProps.VisibleNodeMask = 1;
+
+        D3D12_RESOURCE_DESC uboResourceDesc;
+        uboResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        uboResourceDesc.Alignment = 0;
+        uboResourceDesc.Width = s_UniformSliceSize * s_BackbufferCount;
+        uboResourceDesc.Height = 1;
+        uboResourceDesc.DepthOrArraySize = 1;
+        uboResourceDesc.MipLevels = 1;
+        uboResourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+        uboResourceDesc.SampleDesc.Count = 1;
+        uboResourceDesc.SampleDesc.Quality = 0;
+        uboResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        uboResourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        ThrowIfFailed(m_Device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &uboResourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_UniformBuffer)));
+        m_UniformBuffer->SetName(L"Constant Buffer Upload Resource");
+
+        // We do not intend to read from this resource on the CPU. (End is
+        // less than or equal to begin)
+        D3D12_RANGE readRange;
+        readRange.Begin = 0;
+        readRange.End = 0;
+
+        ThrowIfFailed(m_UniformBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_MappedUniformBuffer)));
+        for (UINT n = 0; n < s_BackbufferCount; ++n)
+            memcpy(m_MappedUniformBuffer + n * s_UniformSliceSize, &UboVS, sizeof(UboVS));
+        m_UniformBuffer->Unmap(0, &readRange);
+    }
+
+    // Create the vertex buffer.
+    {
+        const UINT vertexBufferSize = sizeof(m_VertexBufferData);
+
+        // Note: using upload heaps to transfer static data like vert buffers is
+        // not recommended. Every time the GPU needs it, the upload heap will be
+        // marshalled over. Please read up on Default Heap usage. An upload heap
+        // is used here for code simplicity and because there are very few verts
+        // to actually transfer.
+        D3D12_HEAP_PROPERTIES heapProps;
+        heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+        heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heapProps.CreationNodeMask = 1;
+        heapProps.VisibleNodeMask = 1;
+
+        D3D12_RESOURCE_DESC vertexBufferResourceDesc;
+        vertexBufferResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        vertexBufferResourceDesc.Alignment = 0;
+        vertexBufferResourceDesc.Width = vertexBufferSize;
+        vertexBufferResourceDesc.Height = 1;
+        vertexBufferResourceDesc.DepthOrArraySize = 1;
+        vertexBufferResourceDesc.MipLevels = 1;
+        vertexBufferResourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+        vertexBufferResourceDesc.SampleDesc.Count = 1;
+        vertexBufferResourceDesc.SampleDesc.Quality = 0;
+        vertexBufferResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        vertexBufferResourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        ThrowIfFailed(m_Device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &vertexBufferResourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_VertexBuffer)));
+
+        // Copy the triangle data to the vertex buffer.
+        UINT8* pVertexDataBegin;
+
+        // We do not intend to read from this resource on the CPU.
+        D3D12_RANGE readRange;
+        readRange.Begin = 0;
+        readRange.End = 0;
+
+        ThrowIfFailed(m_VertexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pVertexDataBegin)));
+        memcpy(pVertexDataBegin, m_VertexBufferData, sizeof(m_VertexBufferData));
+        m_VertexBuffer->Unmap(0, nullptr);
+
+        // Initialize the vertex buffer view.
+        m_VertexBufferView.BufferLocation = m_VertexBuffer->GetGPUVirtualAddress();
+        m_VertexBufferView.StrideInBytes = sizeof(Vertex);
+        m_VertexBufferView.SizeInBytes = vertexBufferSize;
+    }
+
+    // Create the index buffer.
+    {
+        const UINT indexBufferSize = sizeof(m_IndexBufferData);
+
+        // Note: using upload heaps to transfer static data like vert buffers is
+        // not recommended. Every time the GPU needs it, the upload heap will be
+        // marshalled over. Please read up on Default Heap usage. An upload heap
+        // is used here for code simplicity and because there are very few verts
+        // to actually transfer.
+        D3D12_HEAP_PROPERTIES heapProps;
+        heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+        heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heapProps.CreationNodeMask = 1;
+        heapProps.VisibleNodeMask = 1;
+
+        D3D12_RESOURCE_DESC vertexBufferResourceDesc;
+        vertexBufferResourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        vertexBufferResourceDesc.Alignment = 0;
+        vertexBufferResourceDesc.Width = indexBufferSize;
+        vertexBufferResourceDesc.Height = 1;
+        vertexBufferResourceDesc.DepthOrArraySize = 1;
+        vertexBufferResourceDesc.MipLevels = 1;
+        vertexBufferResourceDesc.Format = DXGI_FORMAT_UNKNOWN;
+        vertexBufferResourceDesc.SampleDesc.Count = 1;
+        vertexBufferResourceDesc.SampleDesc.Quality = 0;
+        vertexBufferResourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        vertexBufferResourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        ThrowIfFailed(m_Device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &vertexBufferResourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_IndexBuffer)));
+
+        // Copy the triangle data to the vertex buffer.
+        UINT8* pVertexDataBegin;
+
+        // We do not intend to read from this resource on the CPU.
+        D3D12_RANGE readRange;
+        readRange.Begin = 0;
+        readRange.End = 0;
+
+        ThrowIfFailed(m_IndexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pVertexDataBegin)));
+        memcpy(pVertexDataBegin, m_IndexBufferData, sizeof(m_IndexBufferData));
+        m_IndexBuffer->Unmap(0, nullptr);
+
+        // Initialize the vertex buffer view.
+        m_IndexBufferView.BufferLocation = m_IndexBuffer->GetGPUVirtualAddress();
+        m_IndexBufferView.Format = DXGI_FORMAT_R32_UINT;
+        m_IndexBufferView.SizeInBytes = indexBufferSize;
+    }
+}
+
+void Renderer::CreateTimestampQueries()
+{
+    // GPU frame times for the resolution controller, two timestamps per back
+    // buffer resolved into a readback buffer
+    D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    queryHeapDesc.Count = 2 * s_BackbufferCount;
+    ThrowIfFailed(m_Device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_TimestampHeap)));
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_READBACK;
+    heapProps.CreationNodeMask = 1;
+    heapProps.VisibleNodeMask = 1;
+
+    D3D12_RESOURCE_DESC readbackDesc = {};
+    readbackDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    readbackDesc.Width = queryHeapDesc.Count * sizeof(UINT64);
+    readbackDesc.Height = 1;
+    readbackDesc.DepthOrArraySize = 1;
+    readbackDesc.MipLevels = 1;
+    readbackDesc.Format = DXGI_FORMAT_UNKNOWN;
+    readbackDesc.SampleDesc.Count = 1;
+    readbackDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    ThrowIfFailed(m_Device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &readbackDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_TimestampReadback)));
+    m_TimestampReadback->SetName(L"Timestamp Readback");
+
+    ThrowIfFailed(m_CommandQueue->GetTimestampFrequency(&m_TimestampFrequency));
+}
+
+void Renderer::DestroyResources()
+{
+    // Waits for the captures still being written
+    if (m_FrameReadback)
+    {
+        delete m_FrameReadback;
+        m_FrameReadback = nullptr;
+    }
+
+    if (m_TextureStreamer)
+    {
+        delete m_TextureStreamer;
+        m_TextureStreamer = nullptr;
+    }
+
+    if (m_HudRenderer)
+    {
+        delete m_HudRenderer;
+        m_HudRenderer = nullptr;
+    }
+
+    if (m_ResidencyManager)
+    {
+        delete m_ResidencyManager;
+        m_ResidencyManager = nullptr;
+    }
+
+    if (m_CommandCache)
+    {
+        delete m_CommandCache;
+        m_CommandCache = nullptr;
+    }
+
+    if (m_ClusteredLighting)
+    {
+        delete m_ClusteredLighting;
+        m_ClusteredLighting = nullptr;
+    }
+
+    if (m_SceneBuffer)
+    {
+        delete m_SceneBuffer;
+        m_SceneBuffer = nullptr;
+    }
+
+    if (m_MaterialRegistry)
+    {
+        delete m_MaterialRegistry;
+        m_MaterialRegistry = nullptr;
+    }
+
+    ReleaseSceneColor();
+
+    if (m_SceneColorSrvHeap)
+    {
+        m_SceneColorSrvHeap->Release();
+        m_SceneColorSrvHeap = nullptr;
+    }
+
+    if (m_TimestampHeap)
+    {
+        m_TimestampHeap->Release();
+        m_TimestampHeap = nullptr;
+    }
+
+    if (m_TimestampReadback)
+    {
+        m_TimestampReadback->Release();
+        m_TimestampReadback = nullptr;
+    }
+
+    // After the streamer and the scene color, which free their descriptors
+    // into it
+    if (m_BindlessHeap)
+    {
+        delete m_BindlessHeap;
+        m_BindlessHeap = nullptr;
+    }
+
+    if (m_PipelineState)
+    {
+        m_PipelineState->Release();
+        m_PipelineState = nullptr;
+    }
+
+    if (m_UpscalePipelineState)
+    {
+        m_UpscalePipelineState->Release();
+        m_UpscalePipelineState = nullptr;
+    }
+
+    if (m_HudPipelineState)
+    {
+        m_HudPipelineState->Release();
+        m_HudPipelineState = nullptr;
+    }
+
+    if (m_RootSignature)
+    {
+        m_RootSignature->Release();
+        m_RootSignature = nullptr;
+    }
+
+    if (m_VertexBuffer)
+    {
+        m_VertexBuffer->Release();
+        m_VertexBuffer = nullptr;
+    }
+
+    if (m_IndexBuffer)
+    {
+        m_IndexBuffer->Release();
+        m_IndexBuffer = nullptr;
+    }
+
+    if (m_UniformBuffer)
+    {
+        m_UniformBuffer->Release();
+        m_UniformBuffer = nullptr;
+    }
+}
+
+void Renderer::SetupCommands(const FrameSnapshot& frame, ID3D12GraphicsCommandList* commandList)
+{
+    // GPU time of the whole frame, read back once this back buffer is reused
+    commandList->EndQuery(m_TimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_FrameIndex * 2);
+
+    // Stream texture mips in and out before anything samples them. Replaced
+    // resources are released once this frame's fence value completes.
+    {
+        std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+
+        // A changed budget resizes the texture budget before streaming
+        m_ResidencyManager->UpdateBudget();
+
+        for (const TextureRequest& request : frame.TextureRequests)
+            m_TextureStreamer->RequestScreenSize(request.Texture, request.ScreenPixels);
+
+        m_TextureStreamer->Update(commandList);
+
+        // What this command list references is resident before it executes
+        m_ResidencyManager->PrepareSubmit();
+    }
+
+    // The scene covers the top left of the scene color target at the current
+    // resolution scale
+    const UINT sceneWidth = std::max(1u, static_cast<UINT>(m_Width * m_ResolutionScale + 0.5f));
+    const UINT sceneHeight = std::max(1u, static_cast<UINT>(m_Height * m_ResolutionScale + 0.5f));
+
+    D3D12_VIEWPORT sceneViewport = m_Viewport;
+    sceneViewport.Width = static_cast<float>(sceneWidth);
+    sceneViewport.Height = static_cast<float>(sceneHeight);
+
+    D3D12_RECT sceneRect = m_SurfaceSize;
+    sceneRect.right = static_cast<LONG>(sceneWidth);
+    sceneRect.bottom = static_cast<LONG>(sceneHeight);
+
+    // Set necessary state.
+    commandList->SetPipelineState(m_PipelineState);
+    commandList->SetGraphicsRootSignature(m_RootSignature);
+    commandList->RSSetViewports(1, &sceneViewport);
+    commandList->RSSetScissorRects(1, &sceneRect);
+
+    ID3D12DescriptorHeap* pDescriptorHeaps[] = { m_BindlessHeap->GetHeap() };
+    commandList->SetDescriptorHeaps(_countof(pDescriptorHeaps), pDescriptorHeaps);
+
+    // Everything is bound once per frame, draws only change the object index
+    commandList->SetGraphicsRootConstantBufferView(s_FrameConstantsParameter, m_UniformBuffer->GetGPUVirtualAddress() + UINT64(m_FrameIndex) * s_UniformSliceSize);
+    commandList->SetGraphicsRootShaderResourceView(s_SceneBufferParameter, m_SceneBuffer->GetGpuAddress());
+    commandList->SetGraphicsRootShaderResourceView(s_MaterialBufferParameter, m_MaterialRegistry->GetGpuAddress());
+    commandList->SetGraphicsRootShaderResourceView(s_TextureTableParameter, m_TextureStreamer->GetDescriptorTableAddress());
+    commandList->SetGraphicsRootDescriptorTable(s_BindlessTexturesParameter, m_BindlessHeap->GetGpuStart());
+
+    const ClusterConstants clusterConstants = m_ClusteredLighting->GetConstants(sceneWidth, sceneHeight);
+    commandList->SetGraphicsRoot32BitConstants(s_LightingConstantsParameter, sizeof(ClusterConstants) / sizeof(uint32_t), &clusterConstants, 0);
+    commandList->SetGraphicsRootShaderResourceView(s_LightBufferParameter, m_ClusteredLighting->GetLightBufferAddress(m_FrameIndex));
+    commandList->SetGraphicsRootShaderResourceView(s_ClusterBufferParameter, m_ClusteredLighting->GetClusterBufferAddress(m_FrameIndex));
+    commandList->SetGraphicsRootShaderResourceView(s_LightIndexBufferParameter, m_ClusteredLighting->GetLightIndexBufferAddress(m_FrameIndex));
+
+    // Draw the scene into the scene color target
+    D3D12_RESOURCE_BARRIER sceneBarrier = TransitionBarrier(m_SceneColor, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    commandList->ResourceBarrier(1, &sceneBarrier);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE sceneRtvHandle(m_RtvHeap->GetCPUDescriptorHandleForHeapStart());
+    sceneRtvHandle.ptr = sceneRtvHandle.ptr + (s_SceneColorRtv * m_RtvDescriptorSize);
+    commandList->OMSetRenderTargets(1, &sceneRtvHandle, FALSE, nullptr);
+
+    // Record commands, only the rendered area needs clearing
+    commandList->ClearRenderTargetView(sceneRtvHandle, s_ClearColor, 1, &sceneRect);
+
+    // The draws themselves rarely change, replay them from a cached bundle
+    m_DrawSequence.PipelineState = m_PipelineState;
+    m_DrawSequence.RootSignature = m_RootSignature;
+    m_DrawSequence.Topology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    m_DrawSequence.VertexBuffer = m_VertexBufferView;
+    m_DrawSequence.IndexBuffer = m_IndexBufferView;
+    m_DrawSequence.ObjectIndexParameter = s_ObjectIndexParameter;
+    m_DrawSequence.Draws = frame.Draws.data();
+    m_DrawSequence.DrawCount = static_cast<uint32_t>(frame.Draws.size());
+
+    m_CommandCache->Execute(commandList, m_DrawSequence);
+
+    // Upscale into the back buffer, which covers all of it so nothing is
+    // cleared
+    D3D12_RESOURCE_BARRIER upscaleBarriers[] = {
+        TransitionBarrier(m_SceneColor, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+        TransitionBarrier(m_RenderTargets[m_FrameIndex], D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET),
+    };
+    commandList->ResourceBarrier(_countof(upscaleBarriers), upscaleBarriers);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_RtvHeap->GetCPUDescriptorHandleForHeapStart());
+    rtvHandle.ptr = rtvHandle.ptr + (m_FrameIndex * m_RtvDescriptorSize);
+    commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+    commandList->RSSetViewports(1, &m_Viewport);
+    commandList->RSSetScissorRects(1, &m_SurfaceSize);
+
+    UpscaleConstants upscale;
+    upscale.UVScale[0] = static_cast<float>(sceneWidth) / m_Width;
+    upscale.UVScale[1] = static_cast<float>(sceneHeight) / m_Height;
+    upscale.UVMax[0] = (sceneWidth - 0.5f) / m_Width;
+    upscale.UVMax[1] = (sceneHeight - 0.5f) / m_Height;
+    upscale.SourceDescriptor = m_SceneColorDescriptor;
+
+    commandList->SetPipelineState(m_UpscalePipelineState);
+    commandList->SetGraphicsRoot32BitConstants(s_UpscaleConstantsParameter, sizeof(UpscaleConstants) / sizeof(uint32_t), &upscale, 0);
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    commandList->DrawInstanced(3, 1, 0, 0);
+
+    // The HUD goes on top at native resolution, every glyph and graph bar in
+    // one instanced draw of six vertices per quad
+    if (frame.View.ShowHud)
+    {
+        const uint32_t quadCount = m_HudRenderer->Write(m_FrameIndex, m_Width, m_Height);
+
+        HudConstants hud;
+        hud.InverseTargetSize[0] = 1.0f / m_Width;
+        hud.InverseTargetSize[1] = 1.0f / m_Height;
+
+        commandList->SetPipelineState(m_HudPipelineState);
+        commandList->SetGraphicsRoot32BitConstants(s_HudConstantsParameter, sizeof(HudConstants) / sizeof(uint32_t), &hud, 0);
+        commandList->SetGraphicsRootShaderResourceView(s_HudQuadBufferParameter, m_HudRenderer->GetQuadBufferAddress(m_FrameIndex));
+        commandList->SetGraphicsRootShaderResourceView(s_HudFontParameter, m_HudRenderer->GetFontBufferAddress());
+        commandList->DrawInstanced(6, quadCount, 0, 0);
+    }
+
+    if (frame.CapturePath.empty())
+    {
+        // Indicate that the back buffer will now be used to present.
+        D3D12_RESOURCE_BARRIER presentBarrier = TransitionBarrier(m_RenderTargets[m_FrameIndex], D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+        commandList->ResourceBarrier(1, &presentBarrier);
+    }
+    else
+    {
+        // Copy the finished frame into a readback buffer on the way
+        D3D12_RESOURCE_BARRIER copyBarrier = TransitionBarrier(m_RenderTargets[m_FrameIndex], D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        commandList->ResourceBarrier(1, &copyBarrier);
+
+        m_FrameReadback->Capture(commandList, m_RenderTargets[m_FrameIndex], frame.CapturePath);
+
+        D3D12_RESOURCE_BARRIER presentBarrier = TransitionBarrier(m_RenderTargets[m_FrameIndex], D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_PRESENT);
+        commandList->ResourceBarrier(1, &presentBarrier);
+    }
+
+    commandList->EndQuery(m_TimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_FrameIndex * 2 + 1);
+    commandList->ResolveQueryData(m_TimestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, m_FrameIndex * 2, 2, m_TimestampReadback, m_FrameIndex * 2 * sizeof(UINT64));
+    m_TimestampsPending[m_FrameIndex] = true;
+}
+
+void Renderer::DestroyCommands()
+{
+    if (m_QueueScheduler)
+    {
+        // Shutdown is the one place that has to wait for the GPU to finish
+        m_QueueScheduler->WaitForIdle();
+    }
+
+    if (m_FenceTimeline)
+        m_FenceTimeline->WaitForIdle();
+}
+
+void Renderer::SetupSwapchain(unsigned width, unsigned height)
+{
+    m_SurfaceSize.left = 0;
+    m_SurfaceSize.top = 0;
+    m_SurfaceSize.right = static_cast<LONG>(m_Width);
+    m_SurfaceSize.bottom = static_cast<LONG>(m_Height);
+
+    m_Viewport.TopLeftX = 0.0f;
+    m_Viewport.TopLeftY = 0.0f;
+    m_Viewport.Width = static_cast<float>(m_Width);
+    m_Viewport.Height = static_cast<float>(m_Height);
+    m_Viewport.MinDepth = .1f;
+    m_Viewport.MaxDepth = 1000.f;
+
+    // Offscreen targets are recreated at the new size along with their views
+    if (m_Headless)
+        return;
+
+    if (m_Swapchain != nullptr)
+    {
+        ThrowIfFailed(m_Swapchain->ResizeBuffers(s_BackbufferCount, m_Width, m_Height, DXGI_FORMAT_R8G8B8A8_UNORM, 0));
+    }
+    else
+    {
+        DXGI_SWAP_CHAIN_DESC1 swapchainDesc = {};
+        swapchainDesc.BufferCount = s_BackbufferCount;
+        swapchainDesc.Width = width;
+        swapchainDesc.Height = height;
+        swapchainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        swapchainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        swapchainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+        swapchainDesc.SampleDesc.Count = 1;
+
+        IDXGISwapChain1* swapchain = xgfx::createSwapchain(m_Window, m_Factory, m_CommandQueue, &swapchainDesc);
+        HRESULT swapchainSupport = swapchain->QueryInterface(__uuidof(IDXGISwapChain3), (void**)&swapchain);
+
+        if (SUCCEEDED(swapchainSupport))
+            m_Swapchain = (IDXGISwapChain3*)swapchain;
+    }
+    m_FrameIndex = m_Swapchain->GetCurrentBackBufferIndex();
+}
+
+void Renderer::Resize(unsigned width, unsigned height)
+{
+    // Dragging a window edge sends dozens of these per frame, only remember
+    // the latest size and rebuild the swapchain once in ApplyPendingResize.
+    m_PendingWidth = width;
+    m_PendingHeight = height;
+    m_ResizePending = true;
+}
+
+void Renderer::ApplyPendingResize()
+{
+    if (!m_ResizePending)
+        return;
+
+    const unsigned width = clamp(m_PendingWidth, 1u, 0xffffu);
+    const unsigned height = clamp(m_PendingHeight, 1u, 0xffffu);
+
+    if (width == m_Width && height == m_Height)
+    {
+        m_ResizePending = false;
+        return;
+    }
+
+    // ResizeBuffers fails while the GPU still uses any back buffer, so wait
+    // for the last frame that rendered to one, the newest of the back
+    // buffers' fence values. Uploads and streaming signaled after it keep
+    // running, and the scene color it also used is released on the timeline.
+    UINT64 lastFrameFenceValue = 0;
+    for (size_t i = 0; i < s_BackbufferCount; ++i)
+        lastFrameFenceValue = std::max(lastFrameFenceValue, m_FrameFenceValues[i]);
+
+    m_FenceTimeline->WaitFor(lastFrameFenceValue);
+
+    m_ResizePending = false;
+    m_Width = width;
+    m_Height = height;
+
+    // Keep the RTV heap, only the views are rewritten for the new buffers
+    ReleaseRenderTargets();
+    ReleaseSceneColor();
+    SetupSwapchain(width, height);
+    CreateRenderTargetViews();
+    CreateSceneColor();
+
+    // Frame times measured at the old size say little about the new one
+    m_ResolutionController.Reset(m_ResolutionScale);
+}
+
+void Renderer::RenderFrame(const FrameSnapshot& frame)
+{
+    // Transient allocations of the frame before last are done with
+    FrameArenas::BeginFrame();
+
+    const auto frameStart = std::chrono::steady_clock::now();
+
+    // Release resources and run callbacks of frames the GPU has finished
+    m_FenceTimeline->Poll();
+
+    for (const SceneObjectUpdate& update : frame.ObjectUpdates)
+        m_SceneBuffer->Update(update.Index, update.Object);
+
+    if (frame.View.Width > 0 && frame.View.Height > 0)
+        Resize(frame.View.Width, frame.View.Height);
+
+    // Resizes requested since the last frame are applied here, once. Their
+    // wait for the frames in flight counts as fence wait.
+    const auto waitStart = std::chrono::steady_clock::now();
+    ApplyPendingResize();
+
+    // The allocator and uniform slice of this back buffer are reused, wait
+    // for the frame that last used them. With vsync this is where the render
+    // thread is paced.
+    m_FenceTimeline->WaitFor(m_FrameFenceValues[m_FrameIndex]);
+    m_LastFenceWait = std::chrono::steady_clock::now() - waitStart;
+
+    // Pick this frame's resolution from the GPU time of the last frame that
+    // used this back buffer. The measurement lags the scale by the frames in
+    // flight, the controller's smoothing and step limits absorb that.
+    ReadGpuFrameTime();
+
+    if (frame.View.FrameBudgetMs > 0.0f)
+    {
+        if (frame.View.FrameBudgetMs != m_ResolutionController.GetDesc().TargetFrameMs)
+            m_ResolutionController.SetTargetFrameMs(frame.View.FrameBudgetMs);
+
+        if (m_LastGpuFrameMs > 0.0f)
+            m_ResolutionScale = m_ResolutionController.Update(m_LastGpuFrameMs);
+    }
+    else if (m_ResolutionScale != 1.0f)
+    {
+        m_ResolutionScale = 1.0f;
+        m_ResolutionController.Reset(m_ResolutionScale);
+    }
+
+    UpdateHudStats(frame);
+    m_LastFrameStart = frameStart;
+
+    {
+        // Update Uniforms
+        UboVS = frame.Constants;
+
+        D3D12_RANGE readRange;
+        readRange.Begin = 0;
+        readRange.End = 0;
+
+        ThrowIfFailed(m_UniformBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_MappedUniformBuffer)));
+        memcpy(m_MappedUniformBuffer + m_FrameIndex * s_UniformSliceSize, &UboVS, sizeof(UboVS));
+        m_UniformBuffer->Unmap(0, &readRange);
+    }
+
+    // Bin the lights into this back buffer's cluster buffers, on the worker
+    // threads
+    m_ClusteredLighting->Update(m_FrameIndex, frame.Lights, frame.Constants.ViewMatrix, frame.Constants.ProjectionMatrix, m_ThreadPool);
+
+    // Only objects and materials that changed since the last upload are
+    // copied, on the copy queue. Main waits for the copies, and the copies
+    // wait for earlier frames still reading the old contents. Neither the
+    // passes nor their record functions touch the heap.
+    auto recordUploads = [this](ID3D12GraphicsCommandList* commandList) {
+        m_SceneBuffer->Upload(commandList);
+
+        std::lock_guard<std::mutex> lock(m_MaterialMutex);
+        m_MaterialRegistry->Upload(commandList);
+    };
+
+    m_QueueScheduler->AddPass("Uploads", QueueType::Copy,
+                              {
+                                  WriteAccess(m_SceneBuffer),
+                                  WriteAccess(m_MaterialRegistry),
+                              },
+                              recordUploads);
+
+    auto recordMain = [this, &frame](ID3D12GraphicsCommandList* commandList) { SetupCommands(frame, commandList); };
+
+    m_QueueScheduler->AddPass("Main", QueueType::Direct,
+                              {
+                                  WriteAccess(m_RenderTargets[m_FrameIndex]),
+                                  WriteAccess(m_SceneColor),
+                                  ReadAccess(m_SceneBuffer),
+                                  ReadAccess(m_MaterialRegistry),
+                                  WriteAccess(m_TextureStreamer),
+                              },
+                              recordMain);
+
+    m_QueueScheduler->Execute();
+    if (m_Swapchain)
+        m_Swapchain->Present(1, 0);
+
+    if (m_TimeToFirstFrameMs == 0.0)
+        ReportFirstFrame();
+
+    // Don't wait for the frame, the next use of this back buffer does
+    m_FrameFenceValues[m_FrameIndex] = m_FenceTimeline->Signal();
+
+    m_CommandCache->EndFrame();
+
+    // Offscreen targets take turns like the swapchain's buffers
+    m_FrameIndex = m_Swapchain ? m_Swapchain->GetCurrentBackBufferIndex() : (m_FrameIndex + 1) % s_BackbufferCount;
+}
+
+void Renderer::FlushCaptures()
+{
+    m_FrameReadback->WaitIdle();
+}
+
+void Renderer::ReportFirstFrame()
+{
+    m_TimeToFirstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_StartupStart).count();
+
+    // From the end of startup until the first frame was presented, on the
+    // row of the thread that ran startup
+    TaskTiming firstFrame;
+    firstFrame.Name = "First Frame";
+    firstFrame.StartMs = m_StartupMs;
+    firstFrame.EndMs = m_TimeToFirstFrameMs;
+    m_StartupTimings.push_back(firstFrame);
+
+    std::cout << "Time to first frame: " << m_TimeToFirstFrameMs << " ms\n";
+
+    // Open it in chrome://tracing or Perfetto
+    std::ofstream trace("startup_trace.json");
+    WriteChromeTrace(trace, m_StartupTimings);
+}
+
+void Renderer::ReadGpuFrameTime()
+{
+    // A sample is only used once, the controller never sees it twice
+    m_LastGpuFrameMs = 0.0f;
+
+    if (!m_TimestampsPending[m_FrameIndex])
+        return;
+
+    m_TimestampsPending[m_FrameIndex] = false;
+
+    D3D12_RANGE readRange;
+    readRange.Begin = m_FrameIndex * 2 * sizeof(UINT64);
+    readRange.End = readRange.Begin + 2 * sizeof(UINT64);
+
+    UINT8* mappedTimestamps = nullptr;
+    ThrowIfFailed(m_TimestampReadback->Map(0, &readRange, reinterpret_cast<void**>(&mappedTimestamps)));
+
+    UINT64 timestamps[2];
+    memcpy(timestamps, mappedTimestamps + readRange.Begin, sizeof(timestamps));
+
+    D3D12_RANGE writeRange;
+    writeRange.Begin = 0;
+    writeRange.End = 0;
+    m_TimestampReadback->Unmap(0, &writeRange);
+
+    if (timestamps[1] > timestamps[0])
+        m_LastGpuFrameMs = static_cast<float>(double(timestamps[1] - timestamps[0]) * 1000.0 / double(m_TimestampFrequency));
+}
+
+void Renderer::UpdateHudStats(const FrameSnapshot& frame)
+{
+    HudFrameStats stats;
+
+    if (m_LastFrameStart != std::chrono::steady_clock::time_point())
+        stats.CpuFrameMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_LastFrameStart).count();
+
+    stats.GpuFrameMs = m_LastGpuFrameMs;
+    stats.ResolutionScale = m_ResolutionScale;
+
+    stats.Draws = static_cast<uint32_t>(frame.Draws.size());
+    for (const DrawPacket& draw : frame.Draws)
+        stats.Triangles += draw.IndexCount / 3;
+
+    {
+        std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+
+        const TextureStreamingStats& textures = m_TextureStreamer->GetStats();
+        stats.TextureResidentBytes = textures.ResidentBytes;
+        stats.TextureBudgetBytes = textures.BudgetBytes;
+
+        const ResidencyStats& residency = m_ResidencyManager->GetStats();
+        stats.VideoMemoryUsageBytes = residency.UsageBytes;
+        stats.VideoMemoryBudgetBytes = residency.BudgetBytes;
+    }
+
+    stats.Memory = MemoryTracking::GetLastFrame();
+
+    m_HudRenderer->AddFrame(stats);
+}
+
+TextureHandle Renderer::LoadTexture(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+    return m_TextureStreamer->Load(path);
+}
+
+void Renderer::UnloadTexture(TextureHandle texture)
+{
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+    m_TextureStreamer->Unload(texture);
+}
+
+void Renderer::SetTextureBudget(uint64_t budgetBytes)
+{
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+    m_TextureBudget = budgetBytes;
+    UpdateTextureBudget();
+}
+
+void Renderer::UpdateTextureBudget()
+{
+    uint64_t budgetBytes = m_TextureBudget;
+
+    // Textures get what the OS budget leaves after everything else
+    const ResidencyStats& residency = m_ResidencyManager->GetStats();
+    if (residency.BudgetBytes > 0)
+    {
+        const uint64_t textureBytes = m_TextureStreamer->GetStats().ResidentBytes;
+        const uint64_t otherBytes = residency.UsageBytes > textureBytes ? residency.UsageBytes - textureBytes : 0;
+        const uint64_t availableBytes = residency.BudgetBytes > otherBytes ? residency.BudgetBytes - otherBytes : 0;
+
+        budgetBytes = std::min(budgetBytes, availableBytes);
+    }
+
+    m_TextureStreamer->SetBudget(budgetBytes);
+}
+
+TextureStreamingStats Renderer::GetTextureStreamingStats()
+{
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+    return m_TextureStreamer->GetStats();
+}
+
+MaterialHandle Renderer::CreateMaterial(const MaterialDesc& desc)
+{
+    std::lock_guard<std::mutex> lock(m_MaterialMutex);
+    return m_MaterialRegistry->Create(desc);
+}
+
+void Renderer::UpdateMaterial(MaterialHandle material, const MaterialDesc& desc)
+{
+    std::lock_guard<std::mutex> lock(m_MaterialMutex);
+    m_MaterialRegistry->Update(material, desc);
+}
+
+void Renderer::DestroyMaterial(MaterialHandle material)
+{
+    std::lock_guard<std::mutex> lock(m_MaterialMutex);
+    m_MaterialRegistry->Destroy(material);
+}
@@ -0,0 +1,417 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#define GLM_FORCE_SSE42 1
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 1
+#define GLM_FORCE_LEFT_HANDED
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Nutcrackz/Core/TaskGraph.h"
+#include "Nutcrackz/Core/ThreadPool.h"
+#include "Nutcrackz/Renderer/BindlessDescriptorHeap.h"
+#include "Nutcrackz/Renderer/ClusteredLighting.h"
+#include "Nutcrackz/Renderer/CommandCache.h"
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/FrameReadback.h"
+#include "Nutcrackz/Renderer/FrameSnapshot.h"
+#include "Nutcrackz/Renderer/HudRenderer.h"
+#include "Nutcrackz/Renderer/MaterialRegistry.h"
+#include "Nutcrackz/Renderer/PersistentBuffer.h"
+#include "Nutcrackz/Renderer/QueueScheduler.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+#include "Nutcrackz/Renderer/ResidencyManager.h"
+#include "Nutcrackz/Renderer/ResolutionController.h"
+#include "Nutcrackz/Renderer/TextureStreamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <direct.h>
+
+// Renderer
+
+// DirectX 12 implementation, see Renderer.h
+class Renderer
+{
+  public:
+    Renderer(xwin::Window& window);
+
+    // Frames are rendered into offscreen targets instead of a swapchain and
+    // only leave the GPU through FrameSnapshot::CapturePath
+    Renderer(const HeadlessDesc& desc);
+
+    ~Renderer();
+
+    // Render a frame snapshot onto the render target. Called on the render
+    // thread, see RenderThread.
+    void RenderFrame(const FrameSnapshot& frame);
+
+    // Request a new surface size. Any number of requests within a frame are
+    // applied once, at the start of the next rendered frame. Render thread
+    // only, the game thread passes its size through FrameSnapshot::View.
+    void Resize(unsigned width, unsigned height);
+
+    // Block until every frame captured so far has been written. Render thread
+    // only.
+    void FlushCaptures();
+
+    // Time the last RenderFrame spent waiting on the GPU
+    std::chrono::nanoseconds GetLastFenceWait() const { return m_LastFenceWait; }
+
+    // Load a DDS/KTX2 texture, only its low resolution mips are uploaded
+    // until a FrameSnapshot::TextureRequests entry asks for more detail.
+    // Safe to call from the game thread.
+    TextureHandle LoadTexture(const std::string& path);
+
+    // Release the texture once frames already submitted are done with it
+    void UnloadTexture(TextureHandle texture);
+
+    // Limit the memory used by streamed texture mips. The video memory
+    // budget of the OS may lower it further.
+    void SetTextureBudget(uint64_t budgetBytes);
+
+    TextureStreamingStats GetTextureStreamingStats();
+
+    // Materials are referenced by SceneObject::MaterialIndex. Edits reach the
+    // GPU with the next rendered frame. Safe to call from the game thread.
+    MaterialHandle CreateMaterial(const MaterialDesc& desc);
+
+    void UpdateMaterial(MaterialHandle material, const MaterialDesc& desc);
+
+    void DestroyMaterial(MaterialHandle material);
+
+    // Draws replayed from cached bundles versus recorded. Read it on the
+    // render thread, or after it has stopped.
+    const CommandCacheStats& GetCommandCacheStats() const { return m_CommandCache->GetStats(); }
+
+    // Scene buffer uploads of the last frame and in total. Read it on the
+    // render thread, or after it has stopped.
+    const PersistentBufferStats& GetSceneBufferStats() const { return m_SceneBuffer->GetStats(); }
+
+    // Passes, cross queue waits and submissions of the last frame. Read it
+    // on the render thread, or after it has stopped.
+    const QueueSchedulerStats& GetQueueSchedulerStats() const { return m_QueueScheduler->GetStats(); }
+
+    // Fraction of the surface size the scene was last rendered at along each
+    // axis, and the GPU time of the latest frame that has finished. Read
+    // them on the render thread, or after it has stopped.
+    float GetResolutionScale() const { return m_ResolutionScale; }
+
+    float GetLastGpuFrameMs() const { return m_LastGpuFrameMs; }
+
+    // Lights, clusters and time spent binning the last frame's lights. Read
+    // it on the render thread, or after it has stopped.
+    const LightBinningStats& GetLightBinningStats() const { return m_ClusteredLighting->GetStats(); }
+
+    // When each startup task ran and on which thread, followed by a "First
+    // Frame" entry once a frame has been presented. Times are since startup
+    // began. Also written to startup_trace.json in the working directory
+    // after the first frame. Read them on the render thread, or after it has
+    // stopped.
+    const std::vector<TaskTiming>& GetStartupTimings() const { return m_StartupTimings; }
+
+    // From the start of the constructor until the first Present, 0 before
+    double GetTimeToFirstFrameMs() const { return m_TimeToFirstFrameMs; }
+
+    // Video memory budget, usage and evictions. Read it on the render
+    // thread, or after it has stopped.
+    const ResidencyStats& GetResidencyStats() const { return m_ResidencyManager->GetStats(); }
+
+    // Frames captured and written. Safe to call from any thread.
+    FrameReadbackStats GetFrameReadbackStats() { return m_FrameReadback->GetStats(); }
+
+  protected:
+    // Build and run the startup task graph, without a window when headless
+    void Startup(xwin::Window* window);
+
+    // Wait for the GPU and release everything, also what a failed Startup
+    // got to create
+    void Shutdown();
+
+    // Startup tasks, run by the constructor as a task graph. Each may only
+    // touch what the tasks it depends on created.
+
+    // Factory, adapter and device
+    void CreateDevice();
+
+    // Queue scheduler and fence timeline
+    void CreateQueues();
+
+    // Swapchain and its render target views, on the window's thread, or the
+    // offscreen targets when headless
+    void CreateSwapchain(xwin::Window* window);
+
+    // Bindless heap, residency manager, texture streamer, command cache, scene
+    // buffer, materials and lighting
+    void CreateResourceManagers();
+
+    // The texture budget is the lower of SetTextureBudget's and what the
+    // video memory budget leaves. Called with the streamer's lock held.
+    void UpdateTextureBudget();
+
+    void CreateRootSignature();
+
+    // A pipeline state with the shared root signature and render state,
+    // blending by source alpha when alphaBlend is set
+    ID3D12PipelineState* CreatePipelineState(const std::vector<char>& vertexShader, const std::vector<char>& pixelShader, const D3D12_INPUT_LAYOUT_DESC& inputLayout, bool alphaBlend = false);
+
+    // Uniform, vertex and index buffers
+    void CreateGeometryBuffers();
+
+    void CreateTimestampQueries();
+
+    // Destroy any Graphics API data structures used in this example
+    void DestroyAPI();
+
+    // Destroy any resources used in this example
+    void DestroyResources();
+
+    // Record the commands that draw the frame
+    void SetupCommands(const FrameSnapshot& frame, ID3D12GraphicsCommandList* commandList);
+
+    // Wait for all submitted commands
+    void DestroyCommands();
+
+    // Set up the FrameBuffer
+    void InitFrameBuffer();
+
+    void DestroyFrameBuffer();
+
+    // (Re)create the render target views of the swapchain buffers in the
+    // existing RTV heap
+    void CreateRenderTargetViews();
+
+    // A render target in place of a swapchain buffer, when headless
+    ID3D12Resource* CreateOffscreenTarget();
+
+    void ReleaseRenderTargets();
+
+    // (Re)create the offscreen target the scene is drawn into at the current
+    // surface size, with its RTV and bindless SRV
+    void CreateSceneColor();
+
+    void ReleaseSceneColor();
+
+    // Read the timestamps of the frame that last used this back buffer
+    void ReadGpuFrameTime();
+
+    // Hand the frame's timings, counts and memory use to the HUD
+    void UpdateHudStats(const FrameSnapshot& frame);
+
+    // Record the time to first frame and write the startup trace
+    void ReportFirstFrame();
+
+    // Rebuild the swapchain if a resize was requested since the last frame.
+    // Waits once for the frames still using the old buffers, the frame
+    // itself is always rendered.
+    void ApplyPendingResize();
+
+    // Set up the RenderPass
+    void CreateRenderPass();
+
+    void CreateSynchronization();
+
+    // Set up the swapchain
+    void SetupSwapchain(unsigned width, unsigned height);
+
+    struct Vertex
+    {
+        float Position[3];
+        float Color[3];
+        float TexCoord[2];
+    };
+
+    Vertex m_VertexBufferData[3] = {
+        { {  1.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f } },
+        { { -1.0f, -1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } },
+        { {  0.0f,  1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.5f, 0.0f } }
+    };
+
+    uint32_t m_IndexBufferData[3] = {0, 1, 2};
+
+    // Uniform data
+    FrameConstants UboVS;
+
+    static const UINT s_BackbufferCount = 2;
+
+    // Root signature layout, shared by every draw
+    static const UINT s_FrameConstantsParameter = 0;
+    static const UINT s_SceneBufferParameter = 1;
+    static const UINT s_ObjectIndexParameter = 2;
+    static const UINT s_MaterialBufferParameter = 3;
+    static const UINT s_TextureTableParameter = 4;
+    static const UINT s_BindlessTexturesParameter = 5;
+    static const UINT s_UpscaleConstantsParameter = 6;
+    static const UINT s_LightingConstantsParameter = 7;
+    static const UINT s_LightBufferParameter = 8;
+    static const UINT s_ClusterBufferParameter = 9;
+    static const UINT s_LightIndexBufferParameter = 10;
+    static const UINT s_HudConstantsParameter = 11;
+    static const UINT s_HudQuadBufferParameter = 12;
+    static const UINT s_HudFontParameter = 13;
+    static const UINT s_RootParameterCount = 14;
+
+    // Matches the upscale shader's root constants
+    struct UpscaleConstants
+    {
+        float UVScale[2];
+
+        // Last texel center inside the rendered area, keeps bilinear
+        // filtering from reading past it
+        float UVMax[2];
+
+        uint32_t SourceDescriptor;
+    };
+
+    // Matches the HUD shader's root constants
+    struct HudConstants
+    {
+        float InverseTargetSize[2];
+    };
+
+    // The scene color RTV follows the back buffers in the RTV heap
+    static const UINT s_SceneColorRtv = s_BackbufferCount;
+
+    // Each back buffer gets its own slice of the uniform buffer, CBVs must be
+    // 256 byte aligned
+    static const UINT s_UniformSliceSize = (sizeof(FrameConstants) + 255) & ~255;
+
+    static const uint64_t s_DefaultTextureBudget = 256ull * 1024 * 1024;
+
+    // Captured frames on their way to the CPU before Capture has to wait
+    static const uint32_t s_ReadbackBufferCount = 4;
+
+    // Scene objects the scene buffer holds before it first grows
+    static const uint32_t s_InitialSceneCapacity = 1024;
+
+    xwin::Window* m_Window;
+    unsigned m_Width, m_Height;
+
+    // No window, see HeadlessDesc
+    bool m_Headless;
+    bool m_UseWarp;
+
+    // Latest size requested through Resize
+    unsigned m_PendingWidth, m_PendingHeight;
+    bool m_ResizePending;
+
+    // Initialization
+    IDXGIFactory4* m_Factory;
+    IDXGIAdapter1* m_Adapter;
+#if defined(_DEBUG)
+    ID3D12Debug1* m_DebugController;
+    ID3D12DebugDevice* m_DebugDevice;
+#endif
+    ID3D12Device* m_Device;
+
+    // Owns the queues and their command lists, frames are submitted as passes
+    QueueScheduler* m_QueueScheduler;
+
+    // The scheduler's direct queue, presents and the fence timeline use it
+    ID3D12CommandQueue* m_CommandQueue;
+
+    // Current Frame
+    UINT m_CurrentBuffer;
+    ID3D12DescriptorHeap* m_RtvHeap;
+    ID3D12Resource* m_RenderTargets[s_BackbufferCount];
+    IDXGISwapChain3* m_Swapchain;
+
+    // Resources
+    D3D12_VIEWPORT m_Viewport;
+    D3D12_RECT m_SurfaceSize;
+
+    ID3D12Resource* m_VertexBuffer;
+    ID3D12Resource* m_IndexBuffer;
+
+    // Bound as a root CBV, one slice per back buffer
+    ID3D12Resource* m_UniformBuffer;
+    UINT8* m_MappedUniformBuffer;
+
+    // Every shader visible descriptor lives here
+    BindlessDescriptorHeap* m_BindlessHeap;
+
+    // Per object data, persistent across frames
+    PersistentBuffer* m_SceneBuffer;
+
+    // Edited from the game thread, uploaded on the render thread
+    MaterialRegistry* m_MaterialRegistry;
+    std::mutex m_MaterialMutex;
+
+    D3D12_VERTEX_BUFFER_VIEW m_VertexBufferView;
+    D3D12_INDEX_BUFFER_VIEW m_IndexBufferView;
+
+    UINT m_RtvDescriptorSize;
+    ID3D12RootSignature* m_RootSignature;
+    ID3D12PipelineState* m_PipelineState;
+
+    // Dynamic resolution. The scene is drawn into the top left of an
+    // offscreen target the size of the surface, then upscaled into the back
+    // buffer, so changing the scale never reallocates anything.
+    ID3D12Resource* m_SceneColor;
+    ID3D12DescriptorHeap* m_SceneColorSrvHeap;
+    uint32_t m_SceneColorDescriptor;
+    ID3D12PipelineState* m_UpscalePipelineState;
+    ResolutionController m_ResolutionController;
+    float m_ResolutionScale;
+
+    // A timestamp at the start and end of each back buffer's last frame
+    ID3D12QueryHeap* m_TimestampHeap;
+    ID3D12Resource* m_TimestampReadback;
+    bool m_TimestampsPending[s_BackbufferCount];
+    UINT64 m_TimestampFrequency;
+    float m_LastGpuFrameMs;
+
+    // Lights binned into view clusters for the pixel shader
+    ClusteredLighting* m_ClusteredLighting;
+
+    // Frames copied back and written as PNGs
+    FrameReadback* m_FrameReadback;
+
+    // Drawn over the upscaled frame when FrameSnapshot::View asks for it
+    HudRenderer* m_HudRenderer;
+    ID3D12PipelineState* m_HudPipelineState;
+
+    // Start of the last RenderFrame, for the HUD's CPU frame time
+    std::chrono::steady_clock::time_point m_LastFrameStart;
+
+    // Static draws are recorded into bundles once
+    CommandCache* m_CommandCache;
+    DrawSequenceKey m_DrawSequence;
+
+    // Background work such as texture reads
+    ThreadPool m_ThreadPool;
+    TextureStreamer* m_TextureStreamer;
+
+    // The streamer is updated on the render thread while the game thread
+    // may load textures
+    std::mutex m_TextureStreamerMutex;
+
+    // Set through SetTextureBudget
+    uint64_t m_TextureBudget;
+
+    // Streamed textures are evicted when over the OS budget. Used under the
+    // texture streamer's lock.
+    ResidencyManager* m_ResidencyManager;
+
+    // Sync
+    UINT m_FrameIndex;
+    FenceTimeline* m_FenceTimeline;
+
+    // Fence value of the last frame that used each back buffer's uniform
+    // buffer slice
+    UINT64 m_FrameFenceValues[s_BackbufferCount];
+    std::chrono::nanoseconds m_LastFenceWait;
+
+    // Startup
+    std::chrono::steady_clock::time_point m_StartupStart;
+    double m_StartupMs;
+    double m_TimeToFirstFrameMs;
+    std::vector<TaskTiming> m_StartupTimings;
+};
\ No newline at end of file
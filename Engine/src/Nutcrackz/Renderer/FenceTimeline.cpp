@@ -0,0 +1,148 @@
+#include "FenceTimeline.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+#include <algorithm>
+
+// Fence Timeline
+
+FenceTimeline::FenceTimeline(ID3D12Device* device, ID3D12CommandQueue* queue)
+    : m_Queue(queue), m_Fence(nullptr), m_Event(nullptr), m_NextValue(1)
+{
+    ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_Fence)));
+    m_Fence->SetName(L"Fence Timeline");
+
+    m_Event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_Event == nullptr)
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+}
+
+FenceTimeline::~FenceTimeline()
+{
+    WaitForIdle();
+
+    if (m_Fence)
+    {
+        m_Fence->Release();
+        m_Fence = nullptr;
+    }
+
+    if (m_Event)
+    {
+        CloseHandle(m_Event);
+        m_Event = nullptr;
+    }
+}
+
+UINT64 FenceTimeline::Signal()
+{
+    const UINT64 value = m_NextValue.load(std::memory_order_relaxed);
+    ThrowIfFailed(m_Queue->Signal(m_Fence, value));
+    m_NextValue.store(value + 1, std::memory_order_release);
+
+    return value;
+}
+
+void FenceTimeline::ReleaseAfter(IUnknown* object, UINT64 fenceValue)
+{
+    if (object == nullptr)
+        return;
+
+    PendingWork work;
+    work.FenceValue = fenceValue;
+    work.Object = object;
+    Enqueue(std::move(work));
+}
+
+void FenceTimeline::OnComplete(UINT64 fenceValue, std::function<void()> callback)
+{
+    PendingWork work;
+    work.FenceValue = fenceValue;
+    work.Object = nullptr;
+    work.Callback = std::move(callback);
+    Enqueue(std::move(work));
+}
+
+void FenceTimeline::Poll()
+{
+    const UINT64 completed = GetCompletedValue();
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        while (!m_Pending.empty() && m_Pending.front().FenceValue <= completed)
+        {
+            m_Ready.push_back(std::move(m_Pending.front()));
+            m_Pending.pop_front();
+        }
+    }
+
+    if (m_Ready.empty())
+        return;
+
+    // Run outside the lock, callbacks may queue more work
+    uint64_t released = 0;
+    uint64_t callbacks = 0;
+
+    for (PendingWork& work : m_Ready)
+    {
+        if (work.Object)
+        {
+            work.Object->Release();
+            released++;
+        }
+
+        if (work.Callback)
+        {
+            work.Callback();
+            callbacks++;
+        }
+    }
+
+    m_Ready.clear();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.PendingReleases -= static_cast<uint32_t>(released);
+    m_Stats.PendingCallbacks -= static_cast<uint32_t>(callbacks);
+    m_Stats.ReleasedObjects += released;
+    m_Stats.CallbacksRun += callbacks;
+}
+
+void FenceTimeline::WaitFor(UINT64 fenceValue)
+{
+    if (IsComplete(fenceValue))
+        return;
+
+    ThrowIfFailed(m_Fence->SetEventOnCompletion(fenceValue, m_Event));
+    WaitForSingleObject(m_Event, INFINITE);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.BlockingWaits++;
+}
+
+void FenceTimeline::WaitForIdle()
+{
+    WaitFor(Signal());
+    Poll();
+}
+
+FenceTimelineStats FenceTimeline::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void FenceTimeline::Enqueue(PendingWork work)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (work.Object)
+        m_Stats.PendingReleases++;
+    if (work.Callback)
+        m_Stats.PendingCallbacks++;
+
+    // Work nearly always arrives in fence order, so this is an append
+    auto position = std::upper_bound(m_Pending.begin(), m_Pending.end(), work.FenceValue,
+                                     [](UINT64 value, const PendingWork& pending) { return value < pending.FenceValue; });
+    m_Pending.insert(position, std::move(work));
+}
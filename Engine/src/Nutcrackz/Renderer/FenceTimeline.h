@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Fence Timeline
+
+struct FenceTimelineStats
+{
+    // Objects and callbacks waiting for their fence value
+    uint32_t PendingReleases = 0;
+    uint32_t PendingCallbacks = 0;
+
+    uint64_t ReleasedObjects = 0;
+    uint64_t CallbacksRun = 0;
+
+    // Times WaitFor actually had to block the calling thread
+    uint64_t BlockingWaits = 0;
+};
+
+// Owns a queue's fence and the monotonically increasing values signalled on
+// it. Instead of waiting for the GPU whenever something has to be released
+// or reused, work is tied to the fence value of its last GPU use:
+//
+// - ReleaseAfter / Release defer an object's final Release until that value
+//   has completed.
+// - OnComplete runs a callback once a value has completed.
+//
+// Both are serviced by Poll, which never blocks and is called once per frame
+// by the render thread. Releases and callbacks may be queued from any thread.
+class FenceTimeline
+{
+  public:
+    FenceTimeline(ID3D12Device* device, ID3D12CommandQueue* queue);
+
+    // Waits for the queue to go idle and releases everything still pending
+    ~FenceTimeline();
+
+    FenceTimeline(const FenceTimeline&) = delete;
+    FenceTimeline& operator=(const FenceTimeline&) = delete;
+
+    // Signal the next value on the queue and return it. Everything submitted
+    // to the queue before this call has completed once the value has.
+    UINT64 Signal();
+
+    // The value the next Signal will use, i.e. the value that covers work
+    // being recorded right now
+    UINT64 GetNextValue() const { return m_NextValue.load(std::memory_order_acquire); }
+
+    UINT64 GetLastSignaledValue() const { return GetNextValue() - 1; }
+
+    UINT64 GetCompletedValue() const { return m_Fence->GetCompletedValue(); }
+
+    bool IsComplete(UINT64 fenceValue) const { return GetCompletedValue() >= fenceValue; }
+
+    // Release object once fenceValue has completed
+    void ReleaseAfter(IUnknown* object, UINT64 fenceValue);
+
+    // Release object once the work recorded so far has completed
+    void Release(IUnknown* object) { ReleaseAfter(object, GetNextValue()); }
+
+    // Run callback from Poll once fenceValue has completed
+    void OnComplete(UINT64 fenceValue, std::function<void()> callback);
+
+    // Release objects and run callbacks whose fence value has completed.
+    // Never blocks, call it from one thread only.
+    void Poll();
+
+    // Block until fenceValue has completed. Only for reusing per-frame
+    // resources and shutdown, everything else should use the deferred path.
+    void WaitFor(UINT64 fenceValue);
+
+    // Signal, wait for it and run everything that was pending
+    void WaitForIdle();
+
+    ID3D12Fence* GetFence() const { return m_Fence; }
+
+    FenceTimelineStats GetStats();
+
+  protected:
+    struct PendingWork
+    {
+        UINT64 FenceValue;
+        IUnknown* Object;
+        std::function<void()> Callback;
+    };
+
+    // Keeps m_Pending sorted by fence value
+    void Enqueue(PendingWork work);
+
+    ID3D12CommandQueue* m_Queue;
+    ID3D12Fence* m_Fence;
+    HANDLE m_Event;
+
+    std::atomic<UINT64> m_NextValue;
+
+    std::mutex m_Mutex;
+    std::deque<PendingWork> m_Pending;
+
+    // Poll only, reused so steady state polling doesn't allocate
+    std::vector<PendingWork> m_Ready;
+
+    FenceTimelineStats m_Stats;
+};
@@ -0,0 +1,185 @@
+#include "FrameReadback.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+#include "Nutcrackz/Renderer/ImageFile.h"
+
+#include <chrono>
+#include <iostream>
+
+// Frame Readback
+
+FrameReadback::FrameReadback(ID3D12Device* device, FenceTimeline& fenceTimeline, ThreadPool& threadPool, uint32_t bufferCount)
+    : m_Device(device), m_FenceTimeline(fenceTimeline), m_ThreadPool(threadPool), m_Buffers(bufferCount)
+{
+}
+
+FrameReadback::~FrameReadback()
+{
+    WaitIdle();
+
+    for (Buffer& buffer : m_Buffers)
+    {
+        if (buffer.Resource)
+        {
+            buffer.Resource->Unmap(0, nullptr);
+            buffer.Resource->Release();
+            buffer.Resource = nullptr;
+        }
+    }
+}
+
+void FrameReadback::Capture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* texture, const std::string& path)
+{
+    const uint32_t index = WaitForBuffers(false);
+    Buffer& buffer = m_Buffers[index];
+
+    const D3D12_RESOURCE_DESC textureDesc = texture->GetDesc();
+
+    UINT64 size = 0;
+    m_Device->GetCopyableFootprints(&textureDesc, 0, 1, 0, &buffer.Footprint, nullptr, nullptr, &size);
+
+    // Free buffers are done on the GPU and with the workers, a small one can
+    // be replaced right away
+    if (buffer.Capacity < size)
+    {
+        if (buffer.Resource)
+        {
+            buffer.Resource->Unmap(0, nullptr);
+            buffer.Resource->Release();
+        }
+
+        buffer.Resource = CreateBufferResource(m_Device, D3D12_HEAP_TYPE_READBACK, size, D3D12_RESOURCE_STATE_COPY_DEST);
+        buffer.Resource->SetName(L"Frame Readback");
+        buffer.Capacity = size;
+
+        ThrowIfFailed(buffer.Resource->Map(0, nullptr, reinterpret_cast<void**>(&buffer.Mapped)));
+    }
+
+    D3D12_TEXTURE_COPY_LOCATION destination = {};
+    destination.pResource = buffer.Resource;
+    destination.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    destination.PlacedFootprint = buffer.Footprint;
+
+    D3D12_TEXTURE_COPY_LOCATION source = {};
+    source.pResource = texture;
+    source.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    source.SubresourceIndex = 0;
+
+    commandList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+
+    const UINT64 fenceValue = m_FenceTimeline.GetNextValue();
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        buffer.Path = path;
+        buffer.FenceValue = fenceValue;
+        buffer.State = BufferState::Copying;
+        m_Stats.Captures++;
+    }
+
+    m_FenceTimeline.OnComplete(fenceValue, [this, index]() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Buffers[index].State = BufferState::Writing;
+        }
+
+        m_ThreadPool.Submit([this, index]() { Write(index); });
+    });
+}
+
+void FrameReadback::WaitIdle()
+{
+    WaitForBuffers(true);
+}
+
+FrameReadbackStats FrameReadback::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+uint32_t FrameReadback::WaitForBuffers(bool all)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    bool waited = false;
+
+    for (;;)
+    {
+        uint32_t free = ~0u;
+        uint32_t oldestCopy = ~0u;
+        bool writing = false;
+
+        for (uint32_t i = 0; i < m_Buffers.size(); ++i)
+        {
+            const Buffer& buffer = m_Buffers[i];
+
+            if (buffer.State == BufferState::Free && free == ~0u)
+                free = i;
+            else if (buffer.State == BufferState::Copying && (oldestCopy == ~0u || buffer.FenceValue < m_Buffers[oldestCopy].FenceValue))
+                oldestCopy = i;
+            else if (buffer.State == BufferState::Writing)
+                writing = true;
+        }
+
+        if (free != ~0u && (!all || (oldestCopy == ~0u && !writing)))
+        {
+            if (waited && !all)
+                m_Stats.BlockingWaits++;
+
+            return free;
+        }
+
+        waited = true;
+
+        // Hand the oldest finished copy to a worker. Polling runs the
+        // callback, which is what moves buffers on to writing.
+        if (oldestCopy != ~0u)
+        {
+            const UINT64 fenceValue = m_Buffers[oldestCopy].FenceValue;
+
+            lock.unlock();
+            m_FenceTimeline.WaitFor(fenceValue);
+            m_FenceTimeline.Poll();
+            lock.lock();
+            continue;
+        }
+
+        m_BufferFreed.wait(lock);
+    }
+}
+
+void FrameReadback::Write(uint32_t index)
+{
+    Buffer& buffer = m_Buffers[index];
+
+    const auto start = std::chrono::steady_clock::now();
+    bool failed = false;
+
+    // Every buffer written here is an RGBA8 texture copied by Capture
+    const D3D12_SUBRESOURCE_FOOTPRINT& footprint = buffer.Footprint.Footprint;
+
+    try
+    {
+        WritePng(buffer.Path, buffer.Mapped + buffer.Footprint.Offset, footprint.Width, footprint.Height, footprint.RowPitch);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << "\n";
+        failed = true;
+    }
+
+    const float writeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    buffer.State = BufferState::Free;
+
+    if (failed)
+        m_Stats.Failed++;
+    else
+        m_Stats.Written++;
+
+    m_Stats.LastWriteMs = writeMs;
+
+    m_BufferFreed.notify_all();
+}
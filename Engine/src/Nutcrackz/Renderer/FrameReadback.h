@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Frame Readback
+
+// Copies rendered frames back to the CPU and writes them as PNGs, without
+// the GPU ever waiting on the CPU.
+//
+// Capture records a copy of a texture into one of a ring of readback
+// buffers. The buffer is handed to a worker once the fence value of the
+// frame has completed, which encodes the pixels straight from the mapped
+// buffer and writes the file, then returns the buffer to the ring. Only
+// when every buffer is still in use does Capture wait, on the CPU side.
+class FrameReadback
+{
+  public:
+    FrameReadback(ID3D12Device* device, FenceTimeline& fenceTimeline, ThreadPool& threadPool, uint32_t bufferCount);
+
+    // Waits for every capture to be written
+    ~FrameReadback();
+
+    FrameReadback(const FrameReadback&) = delete;
+    FrameReadback& operator=(const FrameReadback&) = delete;
+
+    // Record a copy of an RGBA8 texture, in the copy source state, that is
+    // written to path once the work recorded so far has completed. Render
+    // thread only.
+    void Capture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* texture, const std::string& path);
+
+    // Block until every capture so far has been written. Render thread only.
+    void WaitIdle();
+
+    FrameReadbackStats GetStats();
+
+  protected:
+    enum class BufferState
+    {
+        Free,
+
+        // Waiting for the GPU to finish the copy
+        Copying,
+
+        // With a worker
+        Writing,
+    };
+
+    struct Buffer
+    {
+        ID3D12Resource* Resource = nullptr;
+
+        // Persistently mapped, readback heaps allow it
+        uint8_t* Mapped = nullptr;
+        UINT64 Capacity = 0;
+
+        // Layout of the copied texture within the buffer
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT Footprint = {};
+
+        std::string Path;
+        UINT64 FenceValue = 0;
+        BufferState State = BufferState::Free;
+    };
+
+    // Wait until a buffer is free, or until all are when all is set.
+    // Returns a free buffer.
+    uint32_t WaitForBuffers(bool all);
+
+    // Runs on a worker
+    void Write(uint32_t buffer);
+
+    ID3D12Device* m_Device;
+    FenceTimeline& m_FenceTimeline;
+    ThreadPool& m_ThreadPool;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_BufferFreed;
+    std::vector<Buffer> m_Buffers;
+
+    FrameReadbackStats m_Stats;
+};
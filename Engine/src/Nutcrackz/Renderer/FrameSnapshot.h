@@ -0,0 +1,110 @@
+#pragma once
+
+#define GLM_FORCE_SSE42 1
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 1
+#define GLM_FORCE_LEFT_HANDED
+#include "glm/glm.hpp"
+
+#include "Nutcrackz/Renderer/LightBinner.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frame Snapshot
+
+// Everything the render thread needs to draw one frame, written by the game
+// thread and read by the render thread once it has been handed over. Nothing
+// in here may point at game state that keeps changing after EndFrame.
+
+struct RenderView
+{
+    // Size of the surface the frame is rendered to, the swapchain follows it
+    unsigned Width = 0;
+    unsigned Height = 0;
+
+    // GPU time per frame dynamic resolution aims for in milliseconds, 0
+    // renders at full resolution
+    float FrameBudgetMs = 0.0f;
+
+    // Draw the performance HUD over the frame
+    bool ShowHud = false;
+};
+
+// Matches the uniform buffer layout the shaders read
+struct FrameConstants
+{
+    glm::mat4 ProjectionMatrix;
+    glm::mat4 ViewMatrix;
+};
+
+// Per object data, matches the scene buffer element the shaders read
+struct SceneObject
+{
+    glm::mat4 Transform;
+
+    // Bounding sphere in world space. Plain floats, the aligned glm::vec3
+    // would pad the center to 16 bytes.
+    float BoundsCenter[3] = {};
+    float BoundsRadius = 0.0f;
+
+    uint32_t MaterialIndex = 0;
+    uint32_t Padding[3] = {};
+};
+
+static_assert(sizeof(SceneObject) == 96, "SceneObject must match the shader's structured buffer stride");
+
+// Objects live in the scene buffer until overwritten, only send the ones
+// that changed this frame
+struct SceneObjectUpdate
+{
+    uint32_t Index = 0;
+    SceneObject Object;
+};
+
+struct DrawPacket
+{
+    uint32_t IndexCount = 0;
+    uint32_t StartIndex = 0;
+    int32_t BaseVertex = 0;
+
+    // Scene buffer element the draw reads its transform from
+    uint32_t ObjectIndex = 0;
+};
+
+struct TextureRequest
+{
+    TextureHandle Texture = s_InvalidTexture;
+    float ScreenPixels = 0.0f;
+};
+
+struct FrameSnapshot
+{
+    uint64_t FrameNumber = 0;
+
+    RenderView View;
+    FrameConstants Constants;
+    std::vector<SceneObjectUpdate> ObjectUpdates;
+    std::vector<DrawPacket> Draws;
+
+    // On screen sizes forwarded to the texture streamer
+    std::vector<TextureRequest> TextureRequests;
+
+    // Binned into clusters on the render thread every frame
+    std::vector<PointLight> Lights;
+
+    // The rendered frame is written there as a PNG, without stalling the GPU.
+    // Empty captures nothing.
+    std::string CapturePath;
+
+    // Keeps the vectors' capacity so steady state frames don't allocate
+    void Clear()
+    {
+        ObjectUpdates.clear();
+        Draws.clear();
+        TextureRequests.clear();
+        Lights.clear();
+        CapturePath.clear();
+    }
+};
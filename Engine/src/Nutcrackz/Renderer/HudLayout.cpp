@@ -0,0 +1,247 @@
+#include "HudLayout.h"
+
+#include <algorithm>
+
+// Helper functions
+
+namespace
+{
+// Seven rows per glyph, the leftmost texel in bit 4
+const uint8_t s_Glyphs[HudFont::s_GlyphCount][HudFont::s_GlyphHeight] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // !
+    { 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 }, // "
+    { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // #
+    { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // $
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+    { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // &
+    { 0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 }, // '
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+    { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // *
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // +
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ,
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ;
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // <
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // =
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // >
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // ?
+    { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // @
+    { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // A
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // Y
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+    { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // [
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // backslash
+    { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ]
+    { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // _
+    { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00 }, // `
+    { 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F }, // a
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E }, // b
+    { 0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E }, // c
+    { 0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F }, // d
+    { 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E }, // e
+    { 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08 }, // f
+    { 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // g
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11 }, // h
+    { 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E }, // i
+    { 0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C }, // j
+    { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12 }, // k
+    { 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // l
+    { 0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11 }, // m
+    { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11 }, // n
+    { 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E }, // o
+    { 0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10 }, // p
+    { 0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01 }, // q
+    { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10 }, // r
+    { 0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E }, // s
+    { 0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06 }, // t
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D }, // u
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // v
+    { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A }, // w
+    { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11 }, // x
+    { 0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // y
+    { 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F }, // z
+    { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02 }, // {
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // |
+    { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08 }, // }
+    { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00 }, // ~
+    { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F }, // solid
+};
+}
+
+// HUD Font
+
+std::vector<uint32_t> HudFont::BuildAtlas()
+{
+    static_assert(s_AtlasWidth % 32 == 0, "atlas rows must be whole words");
+
+    std::vector<uint32_t> atlas(s_AtlasWidth * s_AtlasHeight / 32, 0u);
+
+    for (uint32_t glyph = 0; glyph < s_GlyphCount; ++glyph)
+    {
+        const uint32_t originX = glyph % s_Columns * s_CellWidth;
+        const uint32_t originY = glyph / s_Columns * s_CellHeight;
+
+        for (uint32_t row = 0; row < s_GlyphHeight; ++row)
+        {
+            for (uint32_t column = 0; column < s_GlyphWidth; ++column)
+            {
+                if ((s_Glyphs[glyph][row] >> (s_GlyphWidth - 1 - column) & 1) == 0)
+                    continue;
+
+                const uint32_t texel = (originY + row) * s_AtlasWidth + originX + column;
+                atlas[texel / 32] |= 1u << (texel % 32);
+            }
+        }
+    }
+
+    return atlas;
+}
+
+void HudFont::GetGlyphOrigin(char character, float& x, float& y)
+{
+    // Anything outside the atlas shows up as a question mark
+    uint32_t glyph = static_cast<uint8_t>(character);
+    if (glyph < s_FirstCharacter || glyph >= s_FirstCharacter + s_GlyphCount)
+        glyph = '?';
+
+    glyph -= s_FirstCharacter;
+
+    x = float(glyph % s_Columns * s_CellWidth);
+    y = float(glyph / s_Columns * s_CellHeight);
+}
+
+// HUD Layout
+
+HudLayout::HudLayout(uint32_t scale)
+    : m_Scale(scale)
+{
+    // Allocated once, building a frame's HUD never allocates
+    m_Quads.reserve(s_MaxQuads);
+}
+
+void HudLayout::Clear()
+{
+    m_Quads.clear();
+    m_DroppedQuads = 0;
+}
+
+float HudLayout::AddText(float x, float y, const char* text, uint32_t color)
+{
+    const float characterWidth = GetCharacterWidth();
+    const float glyphWidth = float(HudFont::s_GlyphWidth * m_Scale);
+    const float glyphHeight = float(HudFont::s_GlyphHeight * m_Scale);
+
+    float penX = x;
+    float penY = y;
+    float width = 0.0f;
+
+    for (const char* character = text; *character != '\0'; ++character)
+    {
+        if (*character == '\n')
+        {
+            penX = x;
+            penY += GetLineHeight();
+            continue;
+        }
+
+        // Spaces only advance
+        if (*character != ' ')
+        {
+            float texelX, texelY;
+            HudFont::GetGlyphOrigin(*character, texelX, texelY);
+            AddQuad(penX, penY, glyphWidth, glyphHeight, texelX, texelY, float(HudFont::s_GlyphWidth), float(HudFont::s_GlyphHeight), color);
+        }
+
+        penX += characterWidth;
+        width = std::max(width, penX - x);
+    }
+
+    return width;
+}
+
+void HudLayout::AddRect(float x, float y, float width, float height, uint32_t color)
+{
+    // Every pixel samples the middle of the solid glyph
+    float texelX, texelY;
+    HudFont::GetGlyphOrigin(char(HudFont::s_SolidCharacter), texelX, texelY);
+    AddQuad(x, y, width, height, texelX + 2.5f, texelY + 3.5f, 0.0f, 0.0f, color);
+}
+
+void HudLayout::AddGraph(float x, float y, float width, float height, const float* values, uint32_t count, uint32_t first, float maxValue, uint32_t color)
+{
+    if (count == 0 || maxValue <= 0.0f)
+        return;
+
+    const float barWidth = width / count;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float value = values[(first + i) % count];
+        const float barHeight = std::min(value / maxValue, 1.0f) * height;
+
+        if (barHeight > 0.0f)
+            AddRect(x + i * barWidth, y + height - barHeight, barWidth, barHeight, color);
+    }
+}
+
+void HudLayout::AddQuad(float x, float y, float width, float height, float texelX, float texelY, float texelWidth, float texelHeight, uint32_t color)
+{
+    if (m_Quads.size() >= s_MaxQuads)
+    {
+        m_DroppedQuads++;
+        return;
+    }
+
+    HudQuad& quad = m_Quads.emplace_back();
+    quad.Rect[0] = x;
+    quad.Rect[1] = y;
+    quad.Rect[2] = width;
+    quad.Rect[3] = height;
+    quad.TexelRect[0] = texelX;
+    quad.TexelRect[1] = texelY;
+    quad.TexelRect[2] = texelWidth;
+    quad.TexelRect[3] = texelHeight;
+    quad.Color = color;
+    quad.Padding[0] = 0;
+    quad.Padding[1] = 0;
+    quad.Padding[2] = 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// HUD Layout
+
+// Text and graph quads of the performance HUD. Nothing in here depends on a
+// graphics API, the renderer copies the quads into a buffer and draws all of
+// them with a single instanced draw.
+
+// One tinted screen rectangle, matches the HUD shaders' structured buffer
+// element. Rectangles are x, y, width and height, in pixels from the top
+// left of the target and in font atlas texels.
+struct HudQuad
+{
+    float Rect[4];
+    float TexelRect[4];
+
+    // RGBA8, red in the lowest byte
+    uint32_t Color;
+    uint32_t Padding[3];
+};
+
+static_assert(sizeof(HudQuad) == 48, "HudQuad must match the HUD shaders' structured buffer stride");
+
+constexpr uint32_t HudColor(uint32_t r, uint32_t g, uint32_t b, uint32_t a = 255)
+{
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+// Prebaked 5x7 bitmap font of printable ASCII. The atlas is one bit per
+// texel, which the HUD shaders read from a buffer, so there is no texture to
+// upload or transition.
+struct HudFont
+{
+    static const uint32_t s_GlyphWidth = 5;
+    static const uint32_t s_GlyphHeight = 7;
+
+    // A texel of space right and below every glyph
+    static const uint32_t s_CellWidth = s_GlyphWidth + 1;
+    static const uint32_t s_CellHeight = s_GlyphHeight + 1;
+
+    // Characters 32 to 127, 127 is a solid block untextured quads sample
+    static const uint32_t s_FirstCharacter = 32;
+    static const uint32_t s_GlyphCount = 96;
+    static const uint32_t s_SolidCharacter = 127;
+
+    // Must match the HUD pixel shader
+    static const uint32_t s_Columns = 16;
+    static const uint32_t s_AtlasWidth = s_Columns * s_CellWidth;
+    static const uint32_t s_AtlasHeight = s_GlyphCount / s_Columns * s_CellHeight;
+
+    // Rows of s_AtlasWidth bits, the first texel in the lowest bit of the
+    // first word
+    static std::vector<uint32_t> BuildAtlas();
+
+    // Atlas texel of the top left of character's glyph
+    static void GetGlyphOrigin(char character, float& x, float& y);
+};
+
+// Builds the quads of a frame's HUD. Quads are drawn in the order they were
+// added, later ones on top.
+class HudLayout
+{
+  public:
+    // The GPU buffers hold this many per frame, more are dropped
+    static const uint32_t s_MaxQuads = 4096;
+
+    // Glyphs are drawn scale pixels per atlas texel
+    HudLayout(uint32_t scale = 2);
+
+    // Start over, keeps the capacity
+    void Clear();
+
+    void SetScale(uint32_t scale) { m_Scale = scale; }
+
+    uint32_t GetScale() const { return m_Scale; }
+
+    // Glyph quads of text with its top left at x, y. A newline starts a new
+    // line. Returns the width of the widest line in pixels.
+    float AddText(float x, float y, const char* text, uint32_t color);
+
+    void AddRect(float x, float y, float width, float height, uint32_t color);
+
+    // A bar per value, bottom aligned, count values from values[first]
+    // wrapping around, oldest first. Values at or above maxValue fill the
+    // height.
+    void AddGraph(float x, float y, float width, float height, const float* values, uint32_t count, uint32_t first, float maxValue, uint32_t color);
+
+    float GetCharacterWidth() const { return float(HudFont::s_CellWidth * m_Scale); }
+    float GetLineHeight() const { return float(HudFont::s_CellHeight * m_Scale); }
+
+    const std::vector<HudQuad>& GetQuads() const { return m_Quads; }
+
+    // Quads that didn't fit since the last Clear
+    uint32_t GetDroppedQuads() const { return m_DroppedQuads; }
+
+  protected:
+    void AddQuad(float x, float y, float width, float height, float texelX, float texelY, float texelWidth, float texelHeight, uint32_t color);
+
+    uint32_t m_Scale;
+    std::vector<HudQuad> m_Quads;
+    uint32_t m_DroppedQuads = 0;
+};
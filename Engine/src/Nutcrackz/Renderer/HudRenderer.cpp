@@ -0,0 +1,47 @@
+#include "HudRenderer.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+#include <cstring>
+
+// HUD Renderer
+
+HudRenderer::HudRenderer(ID3D12Device* device, FenceTimeline& fenceTimeline, uint32_t frameCount)
+    : m_FenceTimeline(fenceTimeline), m_FontBuffer(nullptr), m_QuadBuffer(nullptr), m_MappedQuads(nullptr)
+{
+    // Upload heaps can stay mapped, nothing is read back
+    D3D12_RANGE readRange;
+    readRange.Begin = 0;
+    readRange.End = 0;
+
+    // A few hundred bytes, read straight from the upload heap
+    const std::vector<uint32_t> atlas = HudFont::BuildAtlas();
+    const UINT64 atlasSize = atlas.size() * sizeof(uint32_t);
+
+    m_FontBuffer = CreateBufferResource(device, D3D12_HEAP_TYPE_UPLOAD, atlasSize, D3D12_RESOURCE_STATE_GENERIC_READ);
+    m_FontBuffer->SetName(L"HUD Font Buffer");
+
+    UINT8* mappedFont = nullptr;
+    ThrowIfFailed(m_FontBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mappedFont)));
+    memcpy(mappedFont, atlas.data(), atlasSize);
+    m_FontBuffer->Unmap(0, nullptr);
+
+    m_QuadBuffer = CreateBufferResource(device, D3D12_HEAP_TYPE_UPLOAD, s_QuadSliceSize * frameCount, D3D12_RESOURCE_STATE_GENERIC_READ);
+    m_QuadBuffer->SetName(L"HUD Quad Buffer");
+    ThrowIfFailed(m_QuadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_MappedQuads)));
+}
+
+HudRenderer::~HudRenderer()
+{
+    // Frames already submitted may still read them
+    m_FenceTimeline.Release(m_FontBuffer);
+    m_FenceTimeline.Release(m_QuadBuffer);
+}
+
+uint32_t HudRenderer::Write(uint32_t frame, uint32_t width, uint32_t height)
+{
+    const std::vector<HudQuad>& quads = m_Hud.Build(width, height).GetQuads();
+    memcpy(m_MappedQuads + frame * s_QuadSliceSize, quads.data(), quads.size() * sizeof(HudQuad));
+
+    return static_cast<uint32_t>(quads.size());
+}
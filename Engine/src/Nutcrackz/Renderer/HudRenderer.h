@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/PerformanceHud.h"
+
+// HUD Renderer
+
+// GPU side of the performance HUD. The font atlas is written into an upload
+// buffer once, the frame's quads into that frame's slice of a persistently
+// mapped upload ring. The renderer reads both through root SRVs and draws
+// every quad with one instanced draw.
+//
+// Render thread only.
+class HudRenderer
+{
+  public:
+    HudRenderer(ID3D12Device* device, FenceTimeline& fenceTimeline, uint32_t frameCount);
+
+    ~HudRenderer();
+
+    HudRenderer(const HudRenderer&) = delete;
+    HudRenderer& operator=(const HudRenderer&) = delete;
+
+    // Record a frame's stats, every frame whether the HUD is shown or not
+    void AddFrame(const HudFrameStats& stats) { m_Hud.AddFrame(stats); }
+
+    // Lay the HUD out for a width by height target and write its quads into
+    // frame's slice. The last frame that used it must have completed on the
+    // GPU. Returns the number of quads to draw.
+    uint32_t Write(uint32_t frame, uint32_t width, uint32_t height);
+
+    D3D12_GPU_VIRTUAL_ADDRESS GetQuadBufferAddress(uint32_t frame) const { return m_QuadBuffer->GetGPUVirtualAddress() + frame * s_QuadSliceSize; }
+    D3D12_GPU_VIRTUAL_ADDRESS GetFontBufferAddress() const { return m_FontBuffer->GetGPUVirtualAddress(); }
+
+  protected:
+    static const uint64_t s_QuadSliceSize = HudLayout::s_MaxQuads * sizeof(HudQuad);
+
+    FenceTimeline& m_FenceTimeline;
+
+    PerformanceHud m_Hud;
+
+    ID3D12Resource* m_FontBuffer;
+
+    ID3D12Resource* m_QuadBuffer;
+    UINT8* m_MappedQuads;
+};
@@ -0,0 +1,372 @@
+#include "ImageFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// Helper functions
+
+namespace
+{
+// Deflate
+
+const uint32_t s_WindowSize = 32768;
+const uint32_t s_MinMatch = 3;
+const uint32_t s_MaxMatch = 258;
+
+// Candidates tried per position, more compresses slightly better but slower
+const uint32_t s_MaxChainLength = 16;
+
+const uint32_t s_HashBits = 15;
+
+const uint16_t s_LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t s_LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+const uint16_t s_DistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t s_DistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Deflate packs bits starting from the least significant one
+class BitWriter
+{
+  public:
+    BitWriter(std::vector<uint8_t>& out) : m_Out(out) {}
+
+    void Write(uint32_t value, uint32_t count)
+    {
+        m_Bits |= static_cast<uint64_t>(value) << m_Count;
+        m_Count += count;
+
+        while (m_Count >= 8)
+        {
+            m_Out.push_back(static_cast<uint8_t>(m_Bits));
+            m_Bits >>= 8;
+            m_Count -= 8;
+        }
+    }
+
+    // Huffman codes are stored most significant bit first
+    void WriteCode(uint32_t code, uint32_t length)
+    {
+        uint32_t reversed = 0;
+        for (uint32_t i = 0; i < length; ++i)
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+
+        Write(reversed, length);
+    }
+
+    void Flush()
+    {
+        if (m_Count > 0)
+            m_Out.push_back(static_cast<uint8_t>(m_Bits));
+
+        m_Bits = 0;
+        m_Count = 0;
+    }
+
+  protected:
+    std::vector<uint8_t>& m_Out;
+    uint64_t m_Bits = 0;
+    uint32_t m_Count = 0;
+};
+
+void WriteLiteralLength(BitWriter& writer, uint32_t symbol)
+{
+    if (symbol < 144)
+        writer.WriteCode(0x30 + symbol, 8);
+    else if (symbol < 256)
+        writer.WriteCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        writer.WriteCode(symbol - 256, 7);
+    else
+        writer.WriteCode(0xc0 + symbol - 280, 8);
+}
+
+void WriteMatch(BitWriter& writer, uint32_t length, uint32_t distance)
+{
+    const uint32_t lengthCode = static_cast<uint32_t>(std::upper_bound(s_LengthBase, s_LengthBase + 29, length) - s_LengthBase) - 1;
+    WriteLiteralLength(writer, 257 + lengthCode);
+    writer.Write(length - s_LengthBase[lengthCode], s_LengthExtra[lengthCode]);
+
+    // Fixed distance codes are all 5 bits
+    const uint32_t distanceCode = static_cast<uint32_t>(std::upper_bound(s_DistanceBase, s_DistanceBase + 30, distance) - s_DistanceBase) - 1;
+    writer.WriteCode(distanceCode, 5);
+    writer.Write(distance - s_DistanceBase[distanceCode], s_DistanceExtra[distanceCode]);
+}
+
+uint32_t Hash(const uint8_t* data)
+{
+    const uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+    return (value * 2654435761u) >> (32 - s_HashBits);
+}
+
+// One final block with fixed Huffman codes, greedy LZ77 matches found
+// through hash chains
+void Deflate(const std::vector<uint8_t>& data, std::vector<uint8_t>& out)
+{
+    BitWriter writer(out);
+
+    // Final block, fixed codes
+    writer.Write(1, 1);
+    writer.Write(1, 2);
+
+    const uint32_t size = static_cast<uint32_t>(data.size());
+
+    std::vector<int32_t> head(1u << s_HashBits, -1);
+    std::vector<int32_t> previous(s_WindowSize, -1);
+
+    auto insert = [&](uint32_t position) {
+        const uint32_t hash = Hash(&data[position]);
+        previous[position % s_WindowSize] = head[hash];
+        head[hash] = static_cast<int32_t>(position);
+    };
+
+    uint32_t position = 0;
+    while (position < size)
+    {
+        uint32_t bestLength = 0;
+        uint32_t bestDistance = 0;
+
+        if (position + s_MinMatch <= size)
+        {
+            const uint32_t maxLength = std::min(s_MaxMatch, size - position);
+
+            int32_t candidate = head[Hash(&data[position])];
+            for (uint32_t chain = 0; chain < s_MaxChainLength && candidate >= 0; ++chain)
+            {
+                const uint32_t distance = position - static_cast<uint32_t>(candidate);
+                if (distance > s_WindowSize)
+                    break;
+
+                uint32_t length = 0;
+                while (length < maxLength && data[candidate + length] == data[position + length])
+                    length++;
+
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestDistance = distance;
+
+                    if (length == maxLength)
+                        break;
+                }
+
+                // Older entries of this slot were overwritten by newer
+                // positions, stop before following a stale link
+                const int32_t next = previous[candidate % s_WindowSize];
+                if (next >= candidate)
+                    break;
+
+                candidate = next;
+            }
+
+            insert(position);
+        }
+
+        if (bestLength >= s_MinMatch)
+        {
+            WriteMatch(writer, bestLength, bestDistance);
+
+            for (uint32_t i = 1; i < bestLength; ++i)
+            {
+                if (position + i + s_MinMatch <= size)
+                    insert(position + i);
+            }
+
+            position += bestLength;
+        }
+        else
+        {
+            WriteLiteralLength(writer, data[position]);
+            position++;
+        }
+    }
+
+    // End of block
+    WriteLiteralLength(writer, 256);
+    writer.Flush();
+}
+
+// Checksums
+
+uint32_t Adler32(const std::vector<uint8_t>& data)
+{
+    uint32_t a = 1, b = 0;
+
+    // Sums can't overflow within this many bytes before the modulo
+    const size_t chunk = 5552;
+    for (size_t begin = 0; begin < data.size(); begin += chunk)
+    {
+        const size_t end = std::min(data.size(), begin + chunk);
+        for (size_t i = begin; i < end; ++i)
+        {
+            a += data[i];
+            b += a;
+        }
+
+        a %= 65521;
+        b %= 65521;
+    }
+
+    return (b << 16) | a;
+}
+
+uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> values;
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+                value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+
+            values[i] = value;
+        }
+        return values;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+// PNG
+
+void WriteBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void WriteChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+    WriteBigEndian(out, static_cast<uint32_t>(data.size()));
+
+    const size_t typeOffset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+
+    // Covers the type and the data
+    WriteBigEndian(out, Crc32(out.data() + typeOffset, out.size() - typeOffset));
+}
+
+uint8_t Paeth(uint8_t left, uint8_t up, uint8_t upLeft)
+{
+    const int estimate = left + up - upLeft;
+    const int distanceLeft = abs(estimate - left);
+    const int distanceUp = abs(estimate - up);
+    const int distanceUpLeft = abs(estimate - upLeft);
+
+    if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft)
+        return left;
+
+    return distanceUp <= distanceUpLeft ? up : upLeft;
+}
+
+// Filter a row with each of the five PNG filters and keep the one whose
+// bytes, read as signed, sum up smallest, the usual heuristic for what
+// deflates best
+void FilterRow(const uint8_t* row, const uint8_t* previousRow, uint32_t rowBytes, uint8_t* out, std::vector<uint8_t>& scratch)
+{
+    const uint32_t bytesPerPixel = 4;
+    scratch.resize(rowBytes);
+
+    uint64_t bestCost = ~0ull;
+
+    for (uint8_t filter = 0; filter < 5; ++filter)
+    {
+        uint64_t cost = 0;
+
+        for (uint32_t i = 0; i < rowBytes; ++i)
+        {
+            const uint8_t left = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+            const uint8_t up = previousRow ? previousRow[i] : 0;
+            const uint8_t upLeft = previousRow && i >= bytesPerPixel ? previousRow[i - bytesPerPixel] : 0;
+
+            uint8_t predicted = 0;
+            switch (filter)
+            {
+            case 1:
+                predicted = left;
+                break;
+            case 2:
+                predicted = up;
+                break;
+            case 3:
+                predicted = static_cast<uint8_t>((left + up) / 2);
+                break;
+            case 4:
+                predicted = Paeth(left, up, upLeft);
+                break;
+            }
+
+            scratch[i] = static_cast<uint8_t>(row[i] - predicted);
+            cost += abs(static_cast<int8_t>(scratch[i]));
+        }
+
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            out[0] = filter;
+            memcpy(out + 1, scratch.data(), rowBytes);
+        }
+    }
+}
+}
+
+// Image Files
+
+std::vector<uint8_t> EncodePng(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t rowPitch)
+{
+    const uint32_t rowBytes = width * 4;
+
+    // Every row starts with its filter type
+    std::vector<uint8_t> filtered(static_cast<size_t>(rowBytes + 1) * height);
+    std::vector<uint8_t> scratch;
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * rowPitch;
+        const uint8_t* previousRow = y > 0 ? row - rowPitch : nullptr;
+        FilterRow(row, previousRow, rowBytes, &filtered[static_cast<size_t>(y) * (rowBytes + 1)], scratch);
+    }
+
+    // zlib stream, 32K window, no preset dictionary
+    std::vector<uint8_t> compressed = { 0x78, 0x01 };
+    Deflate(filtered, compressed);
+    WriteBigEndian(compressed, Adler32(filtered));
+
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+    // 8 bits per channel RGBA, deflate, adaptive filtering, not interlaced
+    std::vector<uint8_t> header;
+    WriteBigEndian(header, width);
+    WriteBigEndian(header, height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });
+
+    WriteChunk(png, "IHDR", header);
+    WriteChunk(png, "IDAT", compressed);
+    WriteChunk(png, "IEND", {});
+
+    return png;
+}
+
+void WritePng(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t rowPitch)
+{
+    const std::vector<uint8_t> png = EncodePng(pixels, width, height, rowPitch);
+
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("failed to open " + path + " for writing!");
+
+    file.write(reinterpret_cast<const char*>(png.data()), png.size());
+    if (!file)
+        throw std::runtime_error("failed to write " + path + "!");
+}
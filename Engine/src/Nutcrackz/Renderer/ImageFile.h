@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Image Files
+
+// Encode 8 bit RGBA pixels as a PNG. Rows are rowPitch bytes apart, which may
+// be more than width * 4, as in GPU readback buffers. Each row gets the PNG
+// filter that suits it best, the result is deflated with fixed Huffman codes,
+// which is fast and compresses rendered images well enough.
+std::vector<uint8_t> EncodePng(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t rowPitch);
+
+// EncodePng and write the result to path. Throws std::runtime_error if the
+// file can't be written.
+void WritePng(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t rowPitch);
@@ -0,0 +1,319 @@
+#include "LightBinner.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define NUTCRACKZ_LIGHT_BINNER_SSE 1
+#endif
+
+// Helper functions
+
+namespace
+{
+// Padding lights sit far outside of every cluster
+const float s_PaddingPosition = 1e18f;
+
+// Calls onHit with the index of every sphere touching the box [min, max].
+// count must be a multiple of four.
+template <typename Function>
+void ForEachTouching(const float* x, const float* y, const float* z, const float* radius, uint32_t count, const float min[3], const float max[3], Function&& onHit)
+{
+#if defined(NUTCRACKZ_LIGHT_BINNER_SSE)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 minX = _mm_set1_ps(min[0]), minY = _mm_set1_ps(min[1]), minZ = _mm_set1_ps(min[2]);
+    const __m128 maxX = _mm_set1_ps(max[0]), maxY = _mm_set1_ps(max[1]), maxZ = _mm_set1_ps(max[2]);
+
+    for (uint32_t i = 0; i < count; i += 4)
+    {
+        const __m128 centerX = _mm_loadu_ps(x + i);
+        const __m128 centerY = _mm_loadu_ps(y + i);
+        const __m128 centerZ = _mm_loadu_ps(z + i);
+        const __m128 r = _mm_loadu_ps(radius + i);
+
+        // Distance from the center to the box along each axis, 0 inside
+        const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, centerX), _mm_sub_ps(centerX, maxX)), zero);
+        const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, centerY), _mm_sub_ps(centerY, maxY)), zero);
+        const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, centerZ), _mm_sub_ps(centerZ, maxZ)), zero);
+
+        const __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+        unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(distanceSquared, _mm_mul_ps(r, r))));
+        while (mask != 0)
+        {
+            onHit(i + std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+#else
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float dx = std::max(std::max(min[0] - x[i], x[i] - max[0]), 0.0f);
+        const float dy = std::max(std::max(min[1] - y[i], y[i] - max[1]), 0.0f);
+        const float dz = std::max(std::max(min[2] - z[i], z[i] - max[2]), 0.0f);
+
+        if (dx * dx + dy * dy + dz * dz <= radius[i] * radius[i])
+            onHit(i);
+    }
+#endif
+}
+}
+
+// Light Binning
+
+void LightBinner::LightSoA::Clear()
+{
+    X.clear();
+    Y.clear();
+    Z.clear();
+    Radius.clear();
+    Index.clear();
+}
+
+void LightBinner::LightSoA::Push(float x, float y, float z, float radius, uint32_t index)
+{
+    X.push_back(x);
+    Y.push_back(y);
+    Z.push_back(z);
+    Radius.push_back(radius);
+    Index.push_back(index);
+}
+
+void LightBinner::LightSoA::Pad()
+{
+    while (Index.size() % 4 != 0)
+        Push(s_PaddingPosition, s_PaddingPosition, s_PaddingPosition, 0.0f, ~0u);
+}
+
+LightBinner::LightBinner(const ClusterGridDesc& desc)
+    : m_Desc(desc)
+{
+    const float logDepthRange = std::log(m_Desc.Far / m_Desc.Near);
+    m_SliceScale = m_Desc.Slices / logDepthRange;
+    m_SliceBias = -static_cast<float>(m_Desc.Slices) * std::log(m_Desc.Near) / logDepthRange;
+
+    m_SliceLights.resize(m_Desc.Slices);
+    m_Rows.resize(m_Desc.Slices * m_Desc.TilesY);
+    m_ClusterRanges.resize(GetClusterCount());
+}
+
+void LightBinner::Bin(const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection, ThreadPool& threadPool)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    UpdateClusterBounds(projection[0][0], projection[1][1]);
+
+    // Transform into view space, the shaders light in view space too
+    const uint32_t lightCount = static_cast<uint32_t>(lights.size());
+    const uint32_t paddedCount = (lightCount + 3) & ~3u;
+
+    m_Lights.resize(lightCount);
+    m_ViewLights.X.resize(paddedCount);
+    m_ViewLights.Y.resize(paddedCount);
+    m_ViewLights.Z.resize(paddedCount);
+    m_ViewLights.Radius.resize(paddedCount);
+    m_ViewLights.Index.resize(paddedCount);
+
+    threadPool.ParallelFor(lightCount, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const PointLight& light = lights[i];
+            const glm::vec4 position = view * glm::vec4(light.Position, 1.0f);
+            const glm::vec3 color = light.Color * light.Intensity;
+
+            ClusterLight& clusterLight = m_Lights[i];
+            clusterLight.Position[0] = position.x;
+            clusterLight.Position[1] = position.y;
+            clusterLight.Position[2] = position.z;
+            clusterLight.Radius = light.Radius;
+            clusterLight.Color[0] = color.x;
+            clusterLight.Color[1] = color.y;
+            clusterLight.Color[2] = color.z;
+            clusterLight.Padding = 0.0f;
+
+            m_ViewLights.X[i] = position.x;
+            m_ViewLights.Y[i] = position.y;
+            m_ViewLights.Z[i] = position.z;
+            m_ViewLights.Radius[i] = light.Radius;
+            m_ViewLights.Index[i] = i;
+        }
+    });
+
+    for (uint32_t i = lightCount; i < paddedCount; ++i)
+    {
+        m_ViewLights.X[i] = m_ViewLights.Y[i] = m_ViewLights.Z[i] = s_PaddingPosition;
+        m_ViewLights.Radius[i] = 0.0f;
+        m_ViewLights.Index[i] = ~0u;
+    }
+
+    // Narrow down per slice first, then per row of tiles, so the per
+    // cluster tests only see lights that are close
+    threadPool.ParallelFor(m_Desc.Slices, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t slice = begin; slice < end; ++slice)
+            Cull(m_ViewLights, m_SliceBounds[slice], m_SliceLights[slice]);
+    });
+
+    threadPool.ParallelFor(m_Desc.Slices * m_Desc.TilesY, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t row = begin; row < end; ++row)
+            BinRow(row / m_Desc.TilesY, row % m_Desc.TilesY);
+    });
+
+    // Rows are in cluster order, stitch their index lists together
+    uint32_t indexCount = 0;
+    uint32_t maxLightsPerCluster = 0;
+
+    for (uint32_t row = 0; row < m_Rows.size(); ++row)
+    {
+        const RowScratch& scratch = m_Rows[row];
+
+        for (uint32_t tileX = 0; tileX < m_Desc.TilesX; ++tileX)
+        {
+            ClusterRange range = scratch.Ranges[tileX];
+            range.Offset += indexCount;
+            m_ClusterRanges[row * m_Desc.TilesX + tileX] = range;
+
+            maxLightsPerCluster = std::max(maxLightsPerCluster, range.Count);
+        }
+
+        indexCount += static_cast<uint32_t>(scratch.LightIndices.size());
+    }
+
+    m_LightIndices.resize(indexCount);
+
+    uint32_t offset = 0;
+    for (const RowScratch& scratch : m_Rows)
+    {
+        if (!scratch.LightIndices.empty())
+            memcpy(m_LightIndices.data() + offset, scratch.LightIndices.data(), scratch.LightIndices.size() * sizeof(uint32_t));
+
+        offset += static_cast<uint32_t>(scratch.LightIndices.size());
+    }
+
+    m_Stats.LightCount = lightCount;
+    m_Stats.ClusterCount = GetClusterCount();
+    m_Stats.IndexCount = indexCount;
+    m_Stats.MaxLightsPerCluster = maxLightsPerCluster;
+    m_Stats.BinningMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ClusterConstants LightBinner::GetConstants(uint32_t width, uint32_t height) const
+{
+    ClusterConstants constants;
+    constants.TilesX = m_Desc.TilesX;
+    constants.TilesY = m_Desc.TilesY;
+    constants.Slices = m_Desc.Slices;
+    constants.LightCount = m_Stats.LightCount;
+    constants.TileScaleX = static_cast<float>(m_Desc.TilesX) / std::max(width, 1u);
+    constants.TileScaleY = static_cast<float>(m_Desc.TilesY) / std::max(height, 1u);
+    constants.SliceScale = m_SliceScale;
+    constants.SliceBias = m_SliceBias;
+
+    return constants;
+}
+
+void LightBinner::UpdateClusterBounds(float projectionX, float projectionY)
+{
+    if (projectionX == m_ProjectionX && projectionY == m_ProjectionY && !m_ClusterBounds.empty())
+        return;
+
+    m_ProjectionX = projectionX;
+    m_ProjectionY = projectionY;
+
+    m_ClusterBounds.resize(GetClusterCount());
+    m_RowBounds.resize(m_Desc.Slices * m_Desc.TilesY);
+    m_SliceBounds.resize(m_Desc.Slices);
+
+    const float depthRatio = m_Desc.Far / m_Desc.Near;
+
+    for (uint32_t slice = 0; slice < m_Desc.Slices; ++slice)
+    {
+        // Pixels closer than Near use the first slice, so it starts at the eye
+        const float nearZ = slice == 0 ? 0.0f : m_Desc.Near * std::pow(depthRatio, float(slice) / m_Desc.Slices);
+        const float farZ = m_Desc.Near * std::pow(depthRatio, float(slice + 1) / m_Desc.Slices);
+
+        Bounds& sliceBounds = m_SliceBounds[slice];
+
+        for (uint32_t tileY = 0; tileY < m_Desc.TilesY; ++tileY)
+        {
+            // Tile rows start at the top of the screen, where NDC y is 1
+            const float bottomY = 1.0f - 2.0f * (tileY + 1) / m_Desc.TilesY;
+            const float topY = 1.0f - 2.0f * tileY / m_Desc.TilesY;
+
+            Bounds& rowBounds = m_RowBounds[slice * m_Desc.TilesY + tileY];
+
+            for (uint32_t tileX = 0; tileX < m_Desc.TilesX; ++tileX)
+            {
+                const float leftX = -1.0f + 2.0f * tileX / m_Desc.TilesX;
+                const float rightX = -1.0f + 2.0f * (tileX + 1) / m_Desc.TilesX;
+
+                // The tile's frustum between both depths, NDC times depth over
+                // the projection scale gives view space
+                Bounds& bounds = m_ClusterBounds[(slice * m_Desc.TilesY + tileY) * m_Desc.TilesX + tileX];
+                bounds.Min[0] = std::min(leftX * nearZ, leftX * farZ) / projectionX;
+                bounds.Max[0] = std::max(rightX * nearZ, rightX * farZ) / projectionX;
+                bounds.Min[1] = std::min(bottomY * nearZ, bottomY * farZ) / projectionY;
+                bounds.Max[1] = std::max(topY * nearZ, topY * farZ) / projectionY;
+                bounds.Min[2] = nearZ;
+                bounds.Max[2] = farZ;
+
+                if (tileX == 0)
+                    rowBounds = bounds;
+
+                for (uint32_t axis = 0; axis < 3; ++axis)
+                {
+                    rowBounds.Min[axis] = std::min(rowBounds.Min[axis], bounds.Min[axis]);
+                    rowBounds.Max[axis] = std::max(rowBounds.Max[axis], bounds.Max[axis]);
+                }
+            }
+
+            if (tileY == 0)
+                sliceBounds = rowBounds;
+
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                sliceBounds.Min[axis] = std::min(sliceBounds.Min[axis], rowBounds.Min[axis]);
+                sliceBounds.Max[axis] = std::max(sliceBounds.Max[axis], rowBounds.Max[axis]);
+            }
+        }
+    }
+}
+
+void LightBinner::Cull(const LightSoA& source, const Bounds& bounds, LightSoA& destination)
+{
+    destination.Clear();
+
+    ForEachTouching(source.X.data(), source.Y.data(), source.Z.data(), source.Radius.data(), source.GetCount(), bounds.Min, bounds.Max, [&](uint32_t i) {
+        destination.Push(source.X[i], source.Y[i], source.Z[i], source.Radius[i], source.Index[i]);
+    });
+
+    destination.Pad();
+}
+
+void LightBinner::BinRow(uint32_t slice, uint32_t tileY)
+{
+    const uint32_t row = slice * m_Desc.TilesY + tileY;
+    RowScratch& scratch = m_Rows[row];
+
+    Cull(m_SliceLights[slice], m_RowBounds[row], scratch.Candidates);
+
+    scratch.LightIndices.clear();
+    scratch.Ranges.resize(m_Desc.TilesX);
+
+    const LightSoA& candidates = scratch.Candidates;
+
+    for (uint32_t tileX = 0; tileX < m_Desc.TilesX; ++tileX)
+    {
+        const Bounds& bounds = m_ClusterBounds[row * m_Desc.TilesX + tileX];
+        const uint32_t offset = static_cast<uint32_t>(scratch.LightIndices.size());
+
+        ForEachTouching(candidates.X.data(), candidates.Y.data(), candidates.Z.data(), candidates.Radius.data(), candidates.GetCount(), bounds.Min, bounds.Max,
+                        [&](uint32_t i) { scratch.LightIndices.push_back(candidates.Index[i]); });
+
+        scratch.Ranges[tileX].Offset = offset;
+        scratch.Ranges[tileX].Count = static_cast<uint32_t>(scratch.LightIndices.size()) - offset;
+    }
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#define GLM_FORCE_SSE42 1
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 1
+#define GLM_FORCE_LEFT_HANDED
+#include "glm/glm.hpp"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+// Light Binning
+
+struct PointLight
+{
+    // World space
+    glm::vec3 Position = glm::vec3(0.0f);
+
+    // Nothing is lit beyond it
+    float Radius = 1.0f;
+
+    glm::vec3 Color = glm::vec3(1.0f);
+    float Intensity = 1.0f;
+};
+
+// The view frustum is split into TilesX * TilesY screen tiles and Slices
+// depth slices between Near and Far, spaced exponentially so clusters stay
+// roughly cube shaped. Pixels closer than Near use the first slice, pixels
+// beyond Far the last one, which only holds the lights reaching into it.
+struct ClusterGridDesc
+{
+    uint32_t TilesX = 16;
+    uint32_t TilesY = 9;
+    uint32_t Slices = 24;
+
+    float Near = 0.1f;
+    float Far = 256.0f;
+};
+
+// Matches the light buffer the shaders read, in view space. Plain floats,
+// the aligned glm::vec3 would pad each to 16 bytes.
+struct ClusterLight
+{
+    float Position[3];
+    float Radius;
+
+    // Color times intensity
+    float Color[3];
+    float Padding;
+};
+
+static_assert(sizeof(ClusterLight) == 32, "ClusterLight must match the shader's structured buffer stride");
+
+// Matches the cluster buffer the shaders read
+struct ClusterRange
+{
+    // Into the light index list
+    uint32_t Offset;
+    uint32_t Count;
+};
+
+// Matches the lighting constants the shaders read
+struct ClusterConstants
+{
+    uint32_t TilesX;
+    uint32_t TilesY;
+    uint32_t Slices;
+    uint32_t LightCount;
+
+    // Tiles per pixel of the rendered area
+    float TileScaleX;
+    float TileScaleY;
+
+    float SliceScale;
+    float SliceBias;
+};
+
+struct LightBinningStats
+{
+    uint32_t LightCount = 0;
+    uint32_t ClusterCount = 0;
+
+    // Entries in the light index list, each a light in a cluster
+    uint32_t IndexCount = 0;
+    uint32_t MaxLightsPerCluster = 0;
+
+    float BinningMs = 0.0f;
+};
+
+// Bins point lights into the clusters of a view on the CPU, for clustered
+// forward shading: a pixel finds its cluster from its screen position and
+// depth and only loops over that cluster's lights.
+//
+// Lights are transformed into view space as structure-of-arrays, then each
+// depth slice keeps the lights overlapping it. Rows of tiles within a slice
+// are binned in parallel on the thread pool, testing four light spheres at
+// once against each cluster's view space bounding box with SSE. Every row
+// writes its own part of the index list, so workers never share output.
+class LightBinner
+{
+  public:
+    LightBinner(const ClusterGridDesc& desc = ClusterGridDesc());
+
+    // projection is only used for the x and y scale of a symmetric
+    // perspective projection
+    void Bin(const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection, ThreadPool& threadPool);
+
+    const std::vector<ClusterLight>& GetLights() const { return m_Lights; }
+
+    // Indexed by (slice * TilesY + tileY) * TilesX + tileX, tile 0 is the
+    // top left of the screen
+    const std::vector<ClusterRange>& GetClusterRanges() const { return m_ClusterRanges; }
+
+    const std::vector<uint32_t>& GetLightIndices() const { return m_LightIndices; }
+
+    // A view depth z lies in slice log(z) * GetSliceScale() + GetSliceBias()
+    float GetSliceScale() const { return m_SliceScale; }
+    float GetSliceBias() const { return m_SliceBias; }
+
+    // Constants for the last binned lights, in a frame rendered at width by
+    // height pixels
+    ClusterConstants GetConstants(uint32_t width, uint32_t height) const;
+
+    uint32_t GetClusterCount() const { return m_Desc.TilesX * m_Desc.TilesY * m_Desc.Slices; }
+
+    const ClusterGridDesc& GetDesc() const { return m_Desc; }
+
+    const LightBinningStats& GetStats() const { return m_Stats; }
+
+  protected:
+    struct Bounds
+    {
+        float Min[3];
+        float Max[3];
+    };
+
+    // Lights as structure-of-arrays, padded to a multiple of four with
+    // spheres far away from every cluster
+    struct LightSoA
+    {
+        std::vector<float> X, Y, Z, Radius;
+        std::vector<uint32_t> Index;
+
+        void Clear();
+        void Push(float x, float y, float z, float radius, uint32_t index);
+        void Pad();
+        uint32_t GetCount() const { return static_cast<uint32_t>(Index.size()); }
+    };
+
+    struct RowScratch
+    {
+        LightSoA Candidates;
+        std::vector<uint32_t> LightIndices;
+
+        // Offsets relative to the row's first index
+        std::vector<ClusterRange> Ranges;
+    };
+
+    // Rebuild the cluster bounds when the projection changes
+    void UpdateClusterBounds(float projectionX, float projectionY);
+
+    // Keep the lights that touch bounds, four at a time
+    static void Cull(const LightSoA& source, const Bounds& bounds, LightSoA& destination);
+
+    void BinRow(uint32_t slice, uint32_t tileY);
+
+    ClusterGridDesc m_Desc;
+
+    float m_SliceScale;
+    float m_SliceBias;
+
+    float m_ProjectionX = 0.0f;
+    float m_ProjectionY = 0.0f;
+    std::vector<Bounds> m_ClusterBounds;
+    std::vector<Bounds> m_RowBounds;
+    std::vector<Bounds> m_SliceBounds;
+
+    LightSoA m_ViewLights;
+    std::vector<LightSoA> m_SliceLights;
+    std::vector<RowScratch> m_Rows;
+
+    std::vector<ClusterLight> m_Lights;
+    std::vector<ClusterRange> m_ClusterRanges;
+    std::vector<uint32_t> m_LightIndices;
+
+    LightBinningStats m_Stats;
+};
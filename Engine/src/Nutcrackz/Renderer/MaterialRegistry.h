@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#define GLM_FORCE_SSE42 1
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 1
+#define GLM_FORCE_LEFT_HANDED
+#include "glm/glm.hpp"
+
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/PersistentBuffer.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+
+#include <vector>
+
+// Materials
+
+// Owns the parameters of every material and the GPU buffer the shaders read
+// them from, indexed by material handle. Draws only carry an index, so any
+// number of materials share one root signature and one set of bindings.
+//
+// Parameters are packed structure-of-arrays: the buffer holds one stream of
+// 16 byte blocks per parameter group, each s_MaxMaterials long. A shader
+// that only needs the base color touches one tightly packed stream, and an
+// edit that only changes the base color uploads one 16 byte block. Textures
+// are stored as texture handles, the streamer's descriptor table turns them
+// into bindless indices.
+//
+// Not thread safe, the Renderer serializes access.
+class MaterialRegistry
+{
+  public:
+    MaterialRegistry(ID3D12Device* device, FenceTimeline& fenceTimeline);
+
+    MaterialHandle Create(const MaterialDesc& desc);
+
+    // Only the streams whose contents change are uploaded again
+    void Update(MaterialHandle material, const MaterialDesc& desc);
+
+    // The handle may be reused by a later Create
+    void Destroy(MaterialHandle material);
+
+    // Record the copies of everything changed since the last upload
+    void Upload(ID3D12GraphicsCommandList* commandList) { m_Buffer.Upload(commandList); }
+
+    // Raw buffer of s_StreamCount streams of s_MaxMaterials blocks each
+    D3D12_GPU_VIRTUAL_ADDRESS GetGpuAddress() const { return m_Buffer.GetGpuAddress(); }
+
+    const PersistentBufferStats& GetStats() const { return m_Buffer.GetStats(); }
+
+    // Must match MAX_MATERIALS in the shaders
+    static const uint32_t s_MaxMaterials = 4096;
+
+  protected:
+    // One 16 byte block per material in each stream
+    enum Stream : uint32_t
+    {
+        BaseColorStream = 0,       // float4 base color
+        SurfaceStream,             // roughness, metallic, normal scale, alpha cutoff
+        TextureStream,             // base color, normal, roughness/metallic texture, unused
+        StreamCount
+    };
+
+    void WriteStreams(MaterialHandle material, const MaterialDesc& desc, bool onlyChanged);
+
+    // Write one stream's block, unless onlyChanged and the block is already
+    // what the GPU has
+    void WriteBlock(MaterialHandle material, Stream stream, const void* block, bool onlyChanged);
+
+    PersistentBuffer m_Buffer;
+
+    uint32_t m_MaterialCount = 0;
+    std::vector<MaterialHandle> m_FreeHandles;
+};
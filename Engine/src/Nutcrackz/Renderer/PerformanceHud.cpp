@@ -0,0 +1,170 @@
+#include "PerformanceHud.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// Helper functions
+
+namespace
+{
+// Panel size in characters and lines
+const uint32_t s_PanelColumns = 40;
+const uint32_t s_TextLines = 6;
+const uint32_t s_GraphLines = 3;
+
+// Graphs go at least up to two 60 Hz frames, the line marks one
+const float s_GraphMinMs = 1000.0f / 30.0f;
+const float s_TargetFrameMs = 1000.0f / 60.0f;
+
+const uint32_t s_TextColor = HudColor(235, 235, 235);
+const uint32_t s_PanelColor = HudColor(0, 0, 0, 170);
+const uint32_t s_GraphColor = HudColor(255, 255, 255, 24);
+const uint32_t s_TargetColor = HudColor(255, 255, 255, 110);
+const uint32_t s_CpuColor = HudColor(90, 210, 120);
+const uint32_t s_GpuColor = HudColor(90, 160, 255);
+
+double ToMiB(uint64_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+// Average of the non zero values and the largest one
+void Summarize(const float* values, uint32_t count, float& average, float& maximum)
+{
+    float sum = 0.0f;
+    uint32_t samples = 0;
+    maximum = 0.0f;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (values[i] <= 0.0f)
+            continue;
+
+        sum += values[i];
+        samples++;
+        maximum = std::max(maximum, values[i]);
+    }
+
+    average = samples > 0 ? sum / samples : 0.0f;
+}
+}
+
+// Performance HUD
+
+PerformanceHud::PerformanceHud()
+    : m_HistoryStart(0), m_LastGpuFrameMs(0.0f)
+{
+    std::fill(std::begin(m_CpuHistory), std::end(m_CpuHistory), 0.0f);
+    std::fill(std::begin(m_GpuHistory), std::end(m_GpuHistory), 0.0f);
+}
+
+void PerformanceHud::AddFrame(const HudFrameStats& stats)
+{
+    m_Last = stats;
+
+    if (stats.GpuFrameMs > 0.0f)
+        m_LastGpuFrameMs = stats.GpuFrameMs;
+
+    // The oldest sample makes room for the newest
+    m_CpuHistory[m_HistoryStart] = stats.CpuFrameMs;
+    m_GpuHistory[m_HistoryStart] = m_LastGpuFrameMs;
+    m_HistoryStart = (m_HistoryStart + 1) % s_HistoryLength;
+}
+
+const HudLayout& PerformanceHud::Build(uint32_t width, uint32_t height)
+{
+    m_Layout.Clear();
+
+    // Twice the font size once there is room for it
+    m_Layout.SetScale(height >= 600 ? 2 : 1);
+
+    const float characterWidth = m_Layout.GetCharacterWidth();
+    const float lineHeight = m_Layout.GetLineHeight();
+    const float padding = characterWidth;
+
+    const float contentWidth = s_PanelColumns * characterWidth;
+    const float graphHeight = s_GraphLines * lineHeight;
+    const float panelWidth = contentWidth + 2.0f * padding;
+    const float panelHeight = s_TextLines * lineHeight + 2.0f * graphHeight + 4.0f * padding;
+
+    // Top right, out of the way of the scene's center
+    const float panelX = std::max(0.0f, float(width) - panelWidth - padding);
+    const float panelY = padding;
+
+    m_Layout.AddRect(panelX, panelY, panelWidth, panelHeight, s_PanelColor);
+
+    float cpuAverage, cpuMaximum, gpuAverage, gpuMaximum;
+    Summarize(m_CpuHistory, s_HistoryLength, cpuAverage, cpuMaximum);
+    Summarize(m_GpuHistory, s_HistoryLength, gpuAverage, gpuMaximum);
+
+    uint64_t arenaBytes = 0;
+    uint64_t heapAllocations = 0;
+    for (const MemoryTagStats& tag : m_Last.Memory.Tags)
+    {
+        arenaBytes += tag.ArenaBytes;
+        heapAllocations += tag.HeapAllocations;
+    }
+
+    char videoMemory[64];
+    if (m_Last.VideoMemoryBudgetBytes > 0)
+        snprintf(videoMemory, sizeof(videoMemory), "%.0f / %.0f MiB", ToMiB(m_Last.VideoMemoryUsageBytes), ToMiB(m_Last.VideoMemoryBudgetBytes));
+    else
+        snprintf(videoMemory, sizeof(videoMemory), "no budget");
+
+    char heap[32];
+    if (MemoryTracking::IsHeapTrackingEnabled())
+        snprintf(heap, sizeof(heap), "%llu", static_cast<unsigned long long>(heapAllocations));
+    else
+        snprintf(heap, sizeof(heap), "untracked");
+
+    char text[512];
+    snprintf(text, sizeof(text),
+             "CPU %6.2f ms  GPU %6.2f ms  %4.0f FPS\n"
+             "Draws %u  Triangles %llu\n"
+             "Resolution %3.0f%%\n"
+             "Textures %.1f / %.1f MiB\n"
+             "Video memory %s\n"
+             "Frame arenas %.1f KiB  Heap allocs %s",
+             cpuAverage, gpuAverage, cpuAverage > 0.0f ? 1000.0f / cpuAverage : 0.0f,
+             m_Last.Draws, static_cast<unsigned long long>(m_Last.Triangles),
+             m_Last.ResolutionScale * 100.0f,
+             ToMiB(m_Last.TextureResidentBytes), ToMiB(m_Last.TextureBudgetBytes),
+             videoMemory,
+             arenaBytes / 1024.0, heap);
+
+    const float contentX = panelX + padding;
+    float y = panelY + padding;
+
+    m_Layout.AddText(contentX, y, text, s_TextColor);
+    y += s_TextLines * lineHeight + padding;
+
+    // Both graphs share a scale so they can be compared
+    const float graphMaxMs = std::max({ s_GraphMinMs, cpuMaximum, gpuMaximum });
+    const float targetY = graphHeight * (1.0f - s_TargetFrameMs / graphMaxMs);
+
+    const struct
+    {
+        const char* Label;
+        const float* History;
+        float Maximum;
+        uint32_t Color;
+    } graphs[] = {
+        { "CPU", m_CpuHistory, cpuMaximum, s_CpuColor },
+        { "GPU", m_GpuHistory, gpuMaximum, s_GpuColor },
+    };
+
+    for (const auto& graph : graphs)
+    {
+        m_Layout.AddRect(contentX, y, contentWidth, graphHeight, s_GraphColor);
+        m_Layout.AddGraph(contentX, y, contentWidth, graphHeight, graph.History, s_HistoryLength, m_HistoryStart, graphMaxMs, graph.Color);
+        m_Layout.AddRect(contentX, y + targetY, contentWidth, float(m_Layout.GetScale()), s_TargetColor);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%s max %.1f ms", graph.Label, graph.Maximum);
+        m_Layout.AddText(contentX + padding / 2.0f, y + padding / 2.0f, label, s_TextColor);
+
+        y += graphHeight + padding;
+    }
+
+    return m_Layout;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Nutcrackz/Core/MemoryTracking.h"
+#include "Nutcrackz/Renderer/HudLayout.h"
+
+#include <cstdint>
+
+// Performance HUD
+
+// What the renderer measured for one frame
+struct HudFrameStats
+{
+    // Render thread time from the start of the last frame to this one's
+    float CpuFrameMs = 0.0f;
+
+    // Latest GPU frame time read back, 0 when there is no new one
+    float GpuFrameMs = 0.0f;
+
+    uint32_t Draws = 0;
+    uint64_t Triangles = 0;
+
+    float ResolutionScale = 1.0f;
+
+    uint64_t TextureResidentBytes = 0;
+    uint64_t TextureBudgetBytes = 0;
+
+    // 0 when the device doesn't report a video memory budget
+    uint64_t VideoMemoryUsageBytes = 0;
+    uint64_t VideoMemoryBudgetBytes = 0;
+
+    // Arena and heap use of the last completed frame
+    FrameMemoryStats Memory;
+};
+
+// Keeps a history of frame stats and lays out the HUD that shows them: CPU
+// and GPU frame time graphs, draw and triangle counts, and texture, video
+// and frame memory. No graphics API involved, the renderer draws the quads.
+//
+// Building the layout formats into stack buffers and reuses the layout's
+// quads, so it never allocates. Render thread only.
+class PerformanceHud
+{
+  public:
+    // Frames the graphs show
+    static const uint32_t s_HistoryLength = 120;
+
+    PerformanceHud();
+
+    // Record a frame, whether the HUD is shown or not
+    void AddFrame(const HudFrameStats& stats);
+
+    // Lay out the HUD for a width by height target
+    const HudLayout& Build(uint32_t width, uint32_t height);
+
+  protected:
+    HudLayout m_Layout;
+    HudFrameStats m_Last;
+
+    // Rings of frame times, m_HistoryStart is the oldest
+    float m_CpuHistory[s_HistoryLength];
+    float m_GpuHistory[s_HistoryLength];
+    uint32_t m_HistoryStart;
+
+    // GPU times arrive a few frames late and not every frame, repeated until
+    // the next one
+    float m_LastGpuFrameMs;
+};
@@ -0,0 +1,173 @@
+#include "PersistentBuffer.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// Persistent Buffer
+
+PersistentBuffer::PersistentBuffer(ID3D12Device* device, FenceTimeline& fenceTimeline, uint32_t elementSize, uint32_t capacity, const wchar_t* name)
+    : m_Device(device), m_FenceTimeline(fenceTimeline), m_ElementSize(elementSize), m_Name(name), m_Buffer(nullptr)
+{
+    Grow(std::max(capacity, 64u));
+}
+
+PersistentBuffer::~PersistentBuffer()
+{
+    // Frames already submitted may still read the buffer or copy from a page
+    m_FenceTimeline.Release(m_Buffer);
+    m_Buffer = nullptr;
+
+    for (UploadPage& page : m_UploadPages)
+        m_FenceTimeline.Release(page.Buffer);
+
+    m_UploadPages.clear();
+}
+
+void PersistentBuffer::Write(uint32_t index, const void* element)
+{
+    if (index >= m_Stats.Capacity)
+        Grow(std::max(m_Stats.Capacity * 2, index + 1));
+
+    memcpy(&m_Elements[size_t(index) * m_ElementSize], element, m_ElementSize);
+    MarkDirty(index);
+
+    m_Stats.ElementCount = std::max(m_Stats.ElementCount, index + 1);
+}
+
+void PersistentBuffer::Upload(ID3D12GraphicsCommandList* commandList)
+{
+    m_Stats.DirtyElements = 0;
+    m_Stats.UploadedRanges = 0;
+    m_Stats.UploadedBytes = 0;
+
+    // Turn the set bits into ranges. Runs crossing a word boundary continue
+    // the previous range, so adjacent elements always end up in one copy.
+    m_Ranges.clear();
+    uint32_t dirtyElements = 0;
+
+    for (size_t word = 0; word < m_DirtyWords.size(); ++word)
+    {
+        uint64_t bits = m_DirtyWords[word];
+        m_DirtyWords[word] = 0;
+
+        while (bits != 0)
+        {
+            const uint32_t start = std::countr_zero(bits);
+            const uint32_t length = std::countr_one(bits >> start);
+            const uint32_t first = static_cast<uint32_t>(word * 64) + start;
+
+            if (!m_Ranges.empty() && m_Ranges.back().First + m_Ranges.back().Count == first)
+                m_Ranges.back().Count += length;
+            else
+                m_Ranges.push_back({first, length});
+
+            dirtyElements += length;
+
+            if (start + length == 64)
+                bits = 0;
+            else
+                bits &= ~(((1ull << length) - 1) << start);
+        }
+    }
+
+    if (dirtyElements == 0)
+        return;
+
+    const uint64_t uploadSize = uint64_t(dirtyElements) * m_ElementSize;
+    UploadPage& page = AcquireUploadPage(uploadSize);
+
+    // Copies decay the buffer to COMMON after every frame, the first copy
+    // promotes it to COPY_DEST without a barrier
+    uint64_t offset = 0;
+    for (const DirtyRange& range : m_Ranges)
+    {
+        const uint64_t rangeSize = uint64_t(range.Count) * m_ElementSize;
+        memcpy(page.Mapped + offset, &m_Elements[size_t(range.First) * m_ElementSize], rangeSize);
+
+        commandList->CopyBufferRegion(m_Buffer, uint64_t(range.First) * m_ElementSize, page.Buffer, offset, rangeSize);
+        offset += rangeSize;
+    }
+
+    page.FenceValue = m_FenceTimeline.GetNextValue();
+
+    // Any shader stage may read it. Copy queues can't transition to shader
+    // states, there the buffer decays to COMMON once the copies complete and
+    // the first read on the direct queue promotes it.
+    if (commandList->GetType() != D3D12_COMMAND_LIST_TYPE_COPY)
+    {
+        const D3D12_RESOURCE_STATES shaderResource = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        D3D12_RESOURCE_BARRIER barrier = TransitionBarrier(m_Buffer, D3D12_RESOURCE_STATE_COPY_DEST, shaderResource);
+        commandList->ResourceBarrier(1, &barrier);
+    }
+
+    m_Stats.DirtyElements = dirtyElements;
+    m_Stats.UploadedRanges = static_cast<uint32_t>(m_Ranges.size());
+    m_Stats.UploadedBytes = uploadSize;
+    m_Stats.TotalUploadedBytes += uploadSize;
+}
+
+void PersistentBuffer::Grow(uint32_t capacity)
+{
+    // Whole words of the dirty bitset
+    capacity = (capacity + 63) & ~63u;
+
+    if (m_Buffer)
+        m_FenceTimeline.Release(m_Buffer);
+
+    m_Buffer = CreateBufferResource(m_Device, D3D12_HEAP_TYPE_DEFAULT, uint64_t(capacity) * m_ElementSize, D3D12_RESOURCE_STATE_COMMON);
+    m_Buffer->SetName(m_Name);
+
+    m_Elements.resize(size_t(capacity) * m_ElementSize, 0);
+    m_DirtyWords.resize(capacity / 64, 0);
+    m_Stats.Capacity = capacity;
+
+    // The new buffer starts out empty, everything written so far goes up
+    // again with the next upload
+    for (uint32_t index = 0; index < m_Stats.ElementCount; ++index)
+        MarkDirty(index);
+}
+
+PersistentBuffer::UploadPage& PersistentBuffer::AcquireUploadPage(uint64_t size)
+{
+    UploadPage* slot = nullptr;
+
+    for (UploadPage& page : m_UploadPages)
+    {
+        if (!m_FenceTimeline.IsComplete(page.FenceValue))
+            continue;
+
+        if (page.Size >= size)
+            return page;
+
+        slot = &page;
+    }
+
+    // Replace a retired page that is too small rather than adding another
+    if (slot)
+    {
+        m_FenceTimeline.Release(slot->Buffer);
+        *slot = UploadPage();
+    }
+    else
+    {
+        m_UploadPages.emplace_back();
+        slot = &m_UploadPages.back();
+    }
+
+    UploadPage& page = *slot;
+    const uint64_t minSize = s_MinUploadPageSize;
+    page.Size = std::max(std::bit_ceil(size), minSize);
+    page.Buffer = CreateBufferResource(m_Device, D3D12_HEAP_TYPE_UPLOAD, page.Size, D3D12_RESOURCE_STATE_GENERIC_READ);
+    page.Buffer->SetName(L"Persistent Buffer Upload Page");
+
+    // Upload heaps may stay mapped for their whole lifetime
+    D3D12_RANGE readRange;
+    readRange.Begin = 0;
+    readRange.End = 0;
+    ThrowIfFailed(page.Buffer->Map(0, &readRange, reinterpret_cast<void**>(&page.Mapped)));
+
+    return page;
+}
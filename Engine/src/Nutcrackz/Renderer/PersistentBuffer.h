@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+
+#include <type_traits>
+#include <vector>
+
+// Persistent Buffer
+
+// GPU resident array of fixed size elements, read by the shaders as a
+// structured or raw buffer. Elements stay on the GPU between frames: Write
+// only changes the CPU copy and sets the element's bit in a dirty bitset.
+// Upload turns the set bits into ranges, merging runs of adjacent elements,
+// and copies just those slices from an upload page into the default heap
+// buffer.
+//
+// Upload pages are reused once the fence value of their last copy has
+// completed, so steady state frames don't create resources. Not thread safe,
+// uploads happen on the render thread.
+class PersistentBuffer
+{
+  public:
+    PersistentBuffer(ID3D12Device* device, FenceTimeline& fenceTimeline, uint32_t elementSize, uint32_t capacity, const wchar_t* name);
+
+    ~PersistentBuffer();
+
+    PersistentBuffer(const PersistentBuffer&) = delete;
+    PersistentBuffer& operator=(const PersistentBuffer&) = delete;
+
+    // Copy elementSize bytes into an element, growing the buffer if index is
+    // past its end
+    void Write(uint32_t index, const void* element);
+
+    template<typename T>
+    void Update(uint32_t index, const T& element)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "elements are copied as bytes");
+        Write(index, &element);
+    }
+
+    // The CPU copy of an element, what the GPU sees after the next Upload
+    const void* Read(uint32_t index) const { return &m_Elements[size_t(index) * m_ElementSize]; }
+
+    // Record the copies of every element changed since the last upload. The
+    // buffer is ready to be read by shaders after this, or when recorded on
+    // a copy queue, once the reading queue waited for it.
+    void Upload(ID3D12GraphicsCommandList* commandList);
+
+    D3D12_GPU_VIRTUAL_ADDRESS GetGpuAddress() const { return m_Buffer->GetGPUVirtualAddress(); }
+
+    uint32_t GetElementSize() const { return m_ElementSize; }
+
+    const PersistentBufferStats& GetStats() const { return m_Stats; }
+
+    // Upload pages are at least this large so small updates share one
+    static const uint64_t s_MinUploadPageSize = 64 * 1024;
+
+  protected:
+    struct DirtyRange
+    {
+        uint32_t First;
+        uint32_t Count;
+    };
+
+    struct UploadPage
+    {
+        ID3D12Resource* Buffer = nullptr;
+        UINT8* Mapped = nullptr;
+        uint64_t Size = 0;
+
+        // Fence value of the last frame that copied from this page
+        UINT64 FenceValue = 0;
+    };
+
+    void Grow(uint32_t capacity);
+
+    // A page of at least size bytes the GPU is no longer reading
+    UploadPage& AcquireUploadPage(uint64_t size);
+
+    void MarkDirty(uint32_t index) { m_DirtyWords[index / 64] |= 1ull << (index % 64); }
+
+    ID3D12Device* m_Device;
+    FenceTimeline& m_FenceTimeline;
+
+    uint32_t m_ElementSize;
+    const wchar_t* m_Name;
+
+    ID3D12Resource* m_Buffer;
+
+    // CPU copy of every element, the source of the uploads
+    std::vector<uint8_t> m_Elements;
+
+    // One bit per element
+    std::vector<uint64_t> m_DirtyWords;
+
+    // Upload only, reused so steady state frames don't allocate
+    std::vector<DirtyRange> m_Ranges;
+
+    std::vector<UploadPage> m_UploadPages;
+
+    PersistentBufferStats m_Stats;
+};
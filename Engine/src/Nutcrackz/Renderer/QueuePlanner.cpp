@@ -0,0 +1,455 @@
+#include "QueuePlanner.h"
+
+#include "Nutcrackz/Core/LinearArena.h"
+
+#include <algorithm>
+
+// Helper functions
+
+namespace
+{
+void MergeClock(QueueClock& clock, const QueueClock& other)
+{
+    for (uint32_t queue = 0; queue < s_QueueCount; ++queue)
+        clock[queue] = std::max(clock[queue], other[queue]);
+}
+
+struct SignalPoint
+{
+    uint64_t Value;
+    uint32_t Pass;
+};
+
+// First signal on a queue that satisfies a wait for value, signals are in
+// value order
+const SignalPoint* FindSignal(const SignalPoint* signals, size_t count, uint64_t value)
+{
+    const SignalPoint* it = std::lower_bound(signals, signals + count, value,
+                                             [](const SignalPoint& signal, uint64_t wanted) { return signal.Value < wanted; });
+
+    return it != signals + count ? it : nullptr;
+}
+
+// Earlier plans signalled their last value on every queue they used
+bool IsFromEarlierPlan(const SchedulePlan& plan, QueueType queue, uint64_t value)
+{
+    const uint64_t first = plan.FirstValues[uint32_t(queue)];
+    return first == 0 || value < first;
+}
+}
+
+// Queue Planning
+
+const char* GetQueueName(QueueType queue)
+{
+    switch (queue)
+    {
+    case QueueType::Direct: return "direct";
+    case QueueType::Compute: return "compute";
+    case QueueType::Copy: return "copy";
+    default: return "unknown";
+    }
+}
+
+QueuePlanner::QueuePlanner()
+{
+    for (QueueClock& clock : m_Clocks)
+        clock.fill(0);
+
+    m_NextValues.fill(1);
+    m_CompletedValues.fill(0);
+}
+
+void QueuePlanner::SetCompletedValue(QueueType queue, uint64_t value)
+{
+    const uint32_t index = uint32_t(queue);
+    m_CompletedValues[index] = std::max(m_CompletedValues[index], value);
+
+    // Finished work is ordered before anything that starts from now on
+    for (QueueClock& clock : m_Clocks)
+        clock[index] = std::max(clock[index], m_CompletedValues[index]);
+}
+
+const SchedulePlan& QueuePlanner::Plan(const std::vector<PassDesc>& passes)
+{
+    PruneHistory();
+
+    SchedulePlan& plan = m_Plan;
+    plan.Passes.clear();
+    plan.Dependencies.clear();
+    plan.InitialClocks = m_Clocks;
+    plan.FirstValues.fill(0);
+    plan.WaitCount = 0;
+    plan.SignalCount = 0;
+    plan.ElidedWaits = 0;
+
+    // Clock of each queue right after each of this plan's passes, for waits
+    // that also carry what the producer knew
+    std::vector<QueueClock>& passClocks = m_PassClocks;
+    passClocks.clear();
+
+    // Planned pass index by queue and value, this plan only
+    std::array<std::vector<uint32_t>, s_QueueCount>& queuePasses = m_QueuePasses;
+    for (std::vector<uint32_t>& queue : queuePasses)
+        queue.clear();
+
+    for (uint32_t passIndex = 0; passIndex < passes.size(); ++passIndex)
+    {
+        const PassDesc& pass = passes[passIndex];
+        const uint32_t queue = uint32_t(pass.Queue);
+
+        PlannedPass planned;
+        planned.Queue = pass.Queue;
+        planned.Value = m_NextValues[queue]++;
+
+        if (plan.FirstValues[queue] == 0)
+            plan.FirstValues[queue] = planned.Value;
+
+        // Latest value on each other queue this pass depends on
+        QueueClock required = {};
+
+        auto depend = [&](QueueType producer, uint64_t value, uint64_t resource) {
+            if (producer == pass.Queue || value == 0)
+                return;
+
+            required[uint32_t(producer)] = std::max(required[uint32_t(producer)], value);
+
+            PassDependency dependency;
+            dependency.ProducerQueue = producer;
+            dependency.ProducerValue = value;
+            dependency.Consumer = passIndex;
+            dependency.Resource = resource;
+            plan.Dependencies.push_back(dependency);
+        };
+
+        for (const ResourceUse& use : pass.Uses)
+        {
+            const ResourceHistory& history = GetHistory(use.Resource);
+
+            // Reads wait for the last write, writes also for every read since
+            if (history.HasWriter)
+                depend(history.WriteQueue, history.WriteValue, use.Resource);
+
+            if (use.Write)
+            {
+                for (uint32_t reader = 0; reader < s_QueueCount; ++reader)
+                    depend(QueueType(reader), history.Reads[reader], use.Resource);
+            }
+        }
+
+        // Record the accesses after collecting dependencies, a pass that
+        // reads and writes a resource doesn't depend on itself
+        for (const ResourceUse& use : pass.Uses)
+        {
+            ResourceHistory& history = GetHistory(use.Resource);
+
+            if (use.Write)
+            {
+                history.HasWriter = true;
+                history.WriteQueue = pass.Queue;
+                history.WriteValue = planned.Value;
+                history.Reads.fill(0);
+            }
+            else
+            {
+                history.Reads[queue] = std::max(history.Reads[queue], planned.Value);
+            }
+        }
+
+        QueueClock& clock = m_Clocks[queue];
+
+        for (uint32_t producer = 0; producer < s_QueueCount; ++producer)
+        {
+            if (required[producer] == 0)
+                continue;
+
+            // Already ordered by an earlier wait on this queue
+            if (clock[producer] >= required[producer])
+            {
+                plan.ElidedWaits++;
+                continue;
+            }
+
+            QueueWait wait;
+            wait.Queue = QueueType(producer);
+            wait.Value = required[producer];
+            planned.Waits.push_back(wait);
+            plan.WaitCount++;
+
+            clock[producer] = required[producer];
+
+            // Waiting for a pass of this plan also orders everything that
+            // pass was ordered after
+            if (!IsFromEarlierPlan(plan, QueueType(producer), required[producer]))
+            {
+                const uint32_t producerPass = queuePasses[producer][required[producer] - plan.FirstValues[producer]];
+                plan.Passes[producerPass].Signal = true;
+                MergeClock(clock, passClocks[producerPass]);
+            }
+        }
+
+        clock[queue] = planned.Value;
+
+        passClocks.push_back(clock);
+        queuePasses[queue].push_back(passIndex);
+        plan.Passes.push_back(planned);
+    }
+
+    // Later plans may depend on anything of this one
+    for (uint32_t queue = 0; queue < s_QueueCount; ++queue)
+    {
+        if (!queuePasses[queue].empty())
+            plan.Passes[queuePasses[queue].back()].Signal = true;
+    }
+
+    for (const PlannedPass& planned : plan.Passes)
+    {
+        if (planned.Signal)
+            plan.SignalCount++;
+    }
+
+    return plan;
+}
+
+QueueWaitList QueuePlanner::Join(QueueType queue)
+{
+    QueueWaitList waits;
+    QueueClock& clock = m_Clocks[uint32_t(queue)];
+
+    // Every plan signalled the last value of each queue it used
+    for (uint32_t producer = 0; producer < s_QueueCount; ++producer)
+    {
+        const uint64_t lastValue = m_NextValues[producer] - 1;
+        if (QueueType(producer) == queue || clock[producer] >= lastValue)
+            continue;
+
+        QueueWait wait;
+        wait.Queue = QueueType(producer);
+        wait.Value = lastValue;
+        waits.push_back(wait);
+
+        clock[producer] = lastValue;
+    }
+
+    return waits;
+}
+
+void QueuePlanner::PruneHistory()
+{
+    auto isFinished = [this](const ResourceHistory& history) {
+        bool finished = !history.HasWriter || history.WriteValue <= m_CompletedValues[uint32_t(history.WriteQueue)];
+        for (uint32_t queue = 0; queue < s_QueueCount && finished; ++queue)
+            finished = history.Reads[queue] <= m_CompletedValues[queue];
+
+        return finished;
+    };
+
+    // Keeps the order, and the capacity for the next plan
+    m_Resources.erase(std::remove_if(m_Resources.begin(), m_Resources.end(), isFinished), m_Resources.end());
+}
+
+QueuePlanner::ResourceHistory& QueuePlanner::GetHistory(uint64_t resource)
+{
+    auto it = std::lower_bound(m_Resources.begin(), m_Resources.end(), resource,
+                               [](const ResourceHistory& history, uint64_t wanted) { return history.Resource < wanted; });
+
+    if (it == m_Resources.end() || it->Resource != resource)
+    {
+        ResourceHistory history;
+        history.Resource = resource;
+        it = m_Resources.insert(it, history);
+    }
+
+    return *it;
+}
+
+std::vector<std::string> ValidateSchedule(const SchedulePlan& plan, const std::vector<PassDesc>& passes)
+{
+    std::vector<std::string> hazards;
+
+    if (plan.Passes.size() != passes.size())
+    {
+        hazards.push_back("plan has " + std::to_string(plan.Passes.size()) + " passes, expected " + std::to_string(passes.size()));
+        return hazards;
+    }
+
+    // Scratch comes from the thread's stack arena, a valid schedule is
+    // checked without touching the heap
+    ScopedStack stack;
+
+    // Only dependencies on earlier plans are taken from the planner, those
+    // within the plan are derived from the passes again
+    ArenaVector<PassDependency> dependencies = stack.MakeVector<PassDependency>(plan.Dependencies.size() + passes.size());
+    for (const PassDependency& dependency : plan.Dependencies)
+    {
+        if (IsFromEarlierPlan(plan, dependency.ProducerQueue, dependency.ProducerValue))
+            dependencies.push_back(dependency);
+    }
+
+    for (uint32_t consumer = 0; consumer < passes.size(); ++consumer)
+    {
+        for (uint32_t producer = 0; producer < consumer; ++producer)
+        {
+            if (passes[producer].Queue == passes[consumer].Queue)
+                continue;
+
+            for (const ResourceUse& consumerUse : passes[consumer].Uses)
+            {
+                for (const ResourceUse& producerUse : passes[producer].Uses)
+                {
+                    if (consumerUse.Resource != producerUse.Resource || (!consumerUse.Write && !producerUse.Write))
+                        continue;
+
+                    PassDependency dependency;
+                    dependency.ProducerQueue = passes[producer].Queue;
+                    dependency.ProducerValue = plan.Passes[producer].Value;
+                    dependency.Consumer = consumer;
+                    dependency.Resource = consumerUse.Resource;
+                    dependencies.push_back(dependency);
+                }
+            }
+        }
+    }
+
+    // Replay the waits and signals, tracking what each queue is ordered after
+    std::array<QueueClock, s_QueueCount> clocks = plan.InitialClocks;
+    QueueClock* passClocks = stack.Allocate<QueueClock>(passes.size());
+
+    // Signals of each queue so far, in value order
+    SignalPoint* signals[s_QueueCount];
+    size_t signalCounts[s_QueueCount] = {};
+    for (uint32_t queue = 0; queue < s_QueueCount; ++queue)
+        signals[queue] = stack.Allocate<SignalPoint>(passes.size());
+
+    for (uint32_t passIndex = 0; passIndex < plan.Passes.size(); ++passIndex)
+    {
+        const PlannedPass& planned = plan.Passes[passIndex];
+        QueueClock& clock = clocks[uint32_t(planned.Queue)];
+
+        if (planned.Queue != passes[passIndex].Queue)
+            hazards.push_back(std::string(passes[passIndex].Name) + " was planned on the " + GetQueueName(planned.Queue) + " queue");
+
+        for (const QueueWait& wait : planned.Waits)
+        {
+            const uint32_t producer = uint32_t(wait.Queue);
+
+            if (IsFromEarlierPlan(plan, wait.Queue, wait.Value))
+            {
+                clock[producer] = std::max(clock[producer], wait.Value);
+                continue;
+            }
+
+            // Only signals submitted before the wait can satisfy it, anything
+            // else would stall the queue or deadlock
+            const SignalPoint* signal = FindSignal(signals[producer], signalCounts[producer], wait.Value);
+            if (signal == nullptr)
+            {
+                hazards.push_back(std::string(passes[passIndex].Name) + " waits for " + GetQueueName(wait.Queue) + " value " + std::to_string(wait.Value) +
+                                  ", which is not signalled before it");
+                continue;
+            }
+
+            MergeClock(clock, passClocks[signal->Pass]);
+        }
+
+        clock[uint32_t(planned.Queue)] = planned.Value;
+        passClocks[passIndex] = clock;
+
+        if (planned.Signal)
+        {
+            const uint32_t queue = uint32_t(planned.Queue);
+            signals[queue][signalCounts[queue]++] = {planned.Value, passIndex};
+        }
+    }
+
+    for (const PassDependency& dependency : dependencies)
+    {
+        const QueueClock& consumerClock = passClocks[dependency.Consumer];
+        if (consumerClock[uint32_t(dependency.ProducerQueue)] >= dependency.ProducerValue)
+            continue;
+
+        hazards.push_back(std::string(passes[dependency.Consumer].Name) + " on the " + GetQueueName(passes[dependency.Consumer].Queue) + " queue may run before " +
+                          GetQueueName(dependency.ProducerQueue) + " value " + std::to_string(dependency.ProducerValue) + " finishes with resource " +
+                          std::to_string(dependency.Resource));
+    }
+
+    return hazards;
+}
+
+SimulatedTimeline SimulateSchedule(const SchedulePlan& plan, const std::vector<double>& durations)
+{
+    SimulatedTimeline timeline;
+    timeline.Passes.resize(plan.Passes.size());
+
+    // Each queue works through its passes in submission order
+    std::array<std::vector<uint32_t>, s_QueueCount> queuePasses;
+    for (uint32_t passIndex = 0; passIndex < plan.Passes.size(); ++passIndex)
+        queuePasses[uint32_t(plan.Passes[passIndex].Queue)].push_back(passIndex);
+
+    std::array<size_t, s_QueueCount> cursors = {};
+    std::array<double, s_QueueCount> queueTimes = {};
+    std::array<std::vector<SignalPoint>, s_QueueCount> signals;
+
+    size_t remaining = plan.Passes.size();
+
+    while (remaining > 0)
+    {
+        bool progress = false;
+
+        for (uint32_t queue = 0; queue < s_QueueCount; ++queue)
+        {
+            if (cursors[queue] == queuePasses[queue].size())
+                continue;
+
+            const uint32_t passIndex = queuePasses[queue][cursors[queue]];
+            const PlannedPass& planned = plan.Passes[passIndex];
+
+            double start = queueTimes[queue];
+            bool blocked = false;
+
+            for (const QueueWait& wait : planned.Waits)
+            {
+                if (IsFromEarlierPlan(plan, wait.Queue, wait.Value))
+                    continue;
+
+                const std::vector<SignalPoint>& queueSignals = signals[uint32_t(wait.Queue)];
+                const SignalPoint* signal = FindSignal(queueSignals.data(), queueSignals.size(), wait.Value);
+                if (signal == nullptr)
+                {
+                    blocked = true;
+                    break;
+                }
+
+                start = std::max(start, timeline.Passes[signal->Pass].End);
+            }
+
+            if (blocked)
+                continue;
+
+            const double duration = passIndex < durations.size() ? durations[passIndex] : 0.0;
+
+            timeline.Passes[passIndex].Start = start;
+            timeline.Passes[passIndex].End = start + duration;
+            queueTimes[queue] = start + duration;
+
+            if (planned.Signal)
+                signals[queue].push_back({planned.Value, passIndex});
+
+            cursors[queue]++;
+            remaining--;
+            progress = true;
+        }
+
+        // Every queue waits for a signal that never comes
+        if (!progress)
+        {
+            timeline.Deadlocked = true;
+            break;
+        }
+    }
+
+    for (double queueTime : queueTimes)
+        timeline.Duration = std::max(timeline.Duration, queueTime);
+
+    return timeline;
+}
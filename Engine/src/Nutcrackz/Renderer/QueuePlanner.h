@@ -0,0 +1,221 @@
+#pragma once
+
+#include "Nutcrackz/Core/FixedVector.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Queue Planning
+
+// Everything here is plain C++ without any D3D12 types, so schedules can be
+// planned, checked and simulated without a GPU. QueueScheduler executes them.
+
+enum class QueueType : uint32_t
+{
+    Direct = 0,
+    Compute,
+    Copy,
+    Count
+};
+
+static const uint32_t s_QueueCount = static_cast<uint32_t>(QueueType::Count);
+
+const char* GetQueueName(QueueType queue);
+
+// Per queue, the highest value known to have finished. Values are the
+// positions of passes on their queue, starting at 1, and double as the
+// queue's fence values.
+typedef std::array<uint64_t, s_QueueCount> QueueClock;
+
+struct ResourceUse
+{
+    // Any identity that stays the same for the resource, usually its pointer
+    uint64_t Resource = 0;
+    bool Write = false;
+};
+
+inline ResourceUse ReadAccess(const void* resource)
+{
+    ResourceUse use;
+    use.Resource = reinterpret_cast<uint64_t>(resource);
+    use.Write = false;
+    return use;
+}
+
+inline ResourceUse WriteAccess(const void* resource)
+{
+    ResourceUse use;
+    use.Resource = reinterpret_cast<uint64_t>(resource);
+    use.Write = true;
+    return use;
+}
+
+// Resources a single pass may declare
+static const uint32_t s_MaxPassResources = 16;
+
+typedef FixedVector<ResourceUse, s_MaxPassResources> ResourceUseList;
+
+struct PassDesc
+{
+    // Not copied, usually a string literal
+    const char* Name = "";
+
+    QueueType Queue = QueueType::Direct;
+    ResourceUseList Uses;
+};
+
+struct QueueWait
+{
+    QueueType Queue;
+    uint64_t Value;
+};
+
+// A queue waits at most once for each other queue
+typedef FixedVector<QueueWait, s_QueueCount - 1> QueueWaitList;
+
+struct PlannedPass
+{
+    QueueType Queue;
+    uint64_t Value;
+
+    // Executed on the pass's queue before it starts
+    QueueWaitList Waits;
+
+    // Signal Value on the pass's queue once it is done
+    bool Signal = false;
+};
+
+// An order the plan has to guarantee between passes on different queues
+struct PassDependency
+{
+    QueueType ProducerQueue;
+    uint64_t ProducerValue;
+
+    // Index into the planned passes
+    uint32_t Consumer;
+
+    uint64_t Resource;
+};
+
+struct SchedulePlan
+{
+    // One per pass, in submission order
+    std::vector<PlannedPass> Passes;
+
+    // Cross queue dependencies, including those on earlier plans
+    std::vector<PassDependency> Dependencies;
+
+    // What each queue already knew about the others before this plan
+    std::array<QueueClock, s_QueueCount> InitialClocks = {};
+
+    // First value planned on each queue, 0 for queues without passes.
+    // Smaller values belong to earlier plans, which signalled their last
+    // value on every queue they used.
+    QueueClock FirstValues = {};
+
+    uint32_t WaitCount = 0;
+    uint32_t SignalCount = 0;
+
+    // Cross queue dependencies that needed no wait, because the consumer's
+    // queue already waited for something later
+    uint32_t ElidedWaits = 0;
+};
+
+struct SimulatedPass
+{
+    double Start = 0.0;
+    double End = 0.0;
+};
+
+struct SimulatedTimeline
+{
+    std::vector<SimulatedPass> Passes;
+
+    // Time the last queue went idle
+    double Duration = 0.0;
+
+    bool Deadlocked = false;
+};
+
+// Turns passes, each bound to a queue, into per queue work with the fewest
+// cross queue waits that keep every resource access in order:
+//
+// - Passes on one queue run in submission order and never wait on each other.
+// - A pass waits on another queue only for the latest pass there it depends
+//   on, and not at all if its queue already waited for that pass or a later
+//   one, directly or through a third queue.
+// - Only passes another queue waits for signal, plus the last pass of each
+//   queue so later plans can depend on it.
+//
+// Resource accesses are remembered across plans, so a pass also waits for
+// work of an earlier frame that is not known to have finished.
+class QueuePlanner
+{
+  public:
+    QueuePlanner();
+
+    // Everything up to value has finished on queue, nothing waits for it
+    void SetCompletedValue(QueueType queue, uint64_t value);
+
+    // The plan stays valid until the next call. Its storage is reused, so
+    // once the pass count settles planning no longer touches the heap.
+    const SchedulePlan& Plan(const std::vector<PassDesc>& passes);
+
+    const SchedulePlan& GetLastPlan() const { return m_Plan; }
+
+    // Waits that order everything planned on the other queues before the
+    // next pass on queue, skipping what it is already ordered after
+    QueueWaitList Join(QueueType queue);
+
+    // Value of the last pass planned on queue, 0 if there was none
+    uint64_t GetLastValue(QueueType queue) const { return m_NextValues[uint32_t(queue)] - 1; }
+
+  protected:
+    struct ResourceHistory
+    {
+        uint64_t Resource = 0;
+
+        bool HasWriter = false;
+        QueueType WriteQueue = QueueType::Direct;
+        uint64_t WriteValue = 0;
+
+        // Latest read on each queue since the last write
+        QueueClock Reads = {};
+    };
+
+    // Forget resources whose accesses have all finished
+    void PruneHistory();
+
+    ResourceHistory& GetHistory(uint64_t resource);
+
+    // m_Clocks[q][p] is the latest value of queue p ordered before the next
+    // pass on queue q
+    std::array<QueueClock, s_QueueCount> m_Clocks;
+
+    QueueClock m_NextValues;
+    QueueClock m_CompletedValues;
+
+    // Sorted by resource. Only resources with unfinished accesses are kept,
+    // which are few, so this stays small and its capacity is reused.
+    std::vector<ResourceHistory> m_Resources;
+
+    SchedulePlan m_Plan;
+
+    // Scratch of Plan: the clock of each queue right after each pass, and
+    // the planned pass index by queue and value
+    std::vector<QueueClock> m_PassClocks;
+    std::array<std::vector<uint32_t>, s_QueueCount> m_QueuePasses;
+};
+
+// Check a plan for hazards: conflicting accesses to a resource from different
+// queues that the plan's waits don't order, and waits for values nothing
+// signals. Dependencies within the plan are derived from the passes again
+// rather than trusted. Returns one description per hazard, empty if none.
+// Only allocates from the heap when there are hazards.
+std::vector<std::string> ValidateSchedule(const SchedulePlan& plan, const std::vector<PassDesc>& passes);
+
+// Run a plan on simulated queues, durations holds each pass's run time in
+// any unit. Work of earlier plans counts as finished at time 0.
+SimulatedTimeline SimulateSchedule(const SchedulePlan& plan, const std::vector<double>& durations);
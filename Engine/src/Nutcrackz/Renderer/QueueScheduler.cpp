@@ -0,0 +1,229 @@
+#include "QueueScheduler.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+#include <stdexcept>
+
+// Helper functions
+
+namespace
+{
+D3D12_COMMAND_LIST_TYPE GetCommandListType(QueueType queue)
+{
+    switch (queue)
+    {
+    case QueueType::Compute: return D3D12_COMMAND_LIST_TYPE_COMPUTE;
+    case QueueType::Copy: return D3D12_COMMAND_LIST_TYPE_COPY;
+    default: return D3D12_COMMAND_LIST_TYPE_DIRECT;
+    }
+}
+
+const wchar_t* GetQueueDebugName(QueueType queue)
+{
+    switch (queue)
+    {
+    case QueueType::Compute: return L"Compute Queue";
+    case QueueType::Copy: return L"Copy Queue";
+    default: return L"Direct Queue";
+    }
+}
+}
+
+// Queue Scheduler
+
+QueueScheduler::QueueScheduler(ID3D12Device* device)
+    : m_Device(device), m_Event(nullptr)
+{
+    for (uint32_t index = 0; index < s_QueueCount; ++index)
+    {
+        const QueueType type = QueueType(index);
+        Queue& queue = m_Queues[index];
+
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        queueDesc.Type = GetCommandListType(type);
+        ThrowIfFailed(m_Device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&queue.Queue)));
+        queue.Queue->SetName(GetQueueDebugName(type));
+
+        // Values start at 1, nothing has completed yet
+        ThrowIfFailed(m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&queue.Fence)));
+
+        // Command lists are created in the recording state, BeginRecording
+        // expects them closed
+        ThrowIfFailed(m_Device->CreateCommandAllocator(queueDesc.Type, IID_PPV_ARGS(&queue.Current.Allocator)));
+        ThrowIfFailed(m_Device->CreateCommandList(0, queueDesc.Type, queue.Current.Allocator, nullptr, IID_PPV_ARGS(&queue.CommandList)));
+        ThrowIfFailed(queue.CommandList->Close());
+
+        queue.Allocators.push_back(queue.Current);
+        queue.Current = CommandAllocator();
+    }
+
+    m_Event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_Event == nullptr)
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+}
+
+QueueScheduler::~QueueScheduler()
+{
+    WaitForIdle();
+
+    for (Queue& queue : m_Queues)
+    {
+        for (CommandAllocator& allocator : queue.Allocators)
+            allocator.Allocator->Release();
+        queue.Allocators.clear();
+
+        if (queue.Current.Allocator)
+        {
+            queue.Current.Allocator->Release();
+            queue.Current.Allocator = nullptr;
+        }
+
+        if (queue.CommandList)
+        {
+            queue.CommandList->Release();
+            queue.CommandList = nullptr;
+        }
+
+        if (queue.Fence)
+        {
+            queue.Fence->Release();
+            queue.Fence = nullptr;
+        }
+
+        if (queue.Queue)
+        {
+            queue.Queue->Release();
+            queue.Queue = nullptr;
+        }
+    }
+
+    if (m_Event)
+    {
+        CloseHandle(m_Event);
+        m_Event = nullptr;
+    }
+}
+
+void QueueScheduler::AddPass(const char* name, QueueType queue, std::initializer_list<ResourceUse> uses, RecordFunction record, void* context)
+{
+    PassDesc pass;
+    pass.Name = name;
+    pass.Queue = queue;
+    pass.Uses = uses;
+
+    m_Passes.push_back(pass);
+    m_Records.push_back({ record, context });
+}
+
+void QueueScheduler::Execute()
+{
+    // Work the GPU already finished never needs a wait
+    for (uint32_t index = 0; index < s_QueueCount; ++index)
+        m_Planner.SetCompletedValue(QueueType(index), m_Queues[index].Fence->GetCompletedValue());
+
+    const SchedulePlan& plan = m_Planner.Plan(m_Passes);
+
+#if defined(_DEBUG)
+    const std::vector<std::string> hazards = ValidateSchedule(plan, m_Passes);
+    if (!hazards.empty())
+        throw std::runtime_error("queue schedule hazard: " + hazards.front() + "!");
+#endif
+
+    m_Stats.Passes = uint32_t(m_Passes.size());
+    m_Stats.Waits = plan.WaitCount;
+    m_Stats.ElidedWaits = plan.ElidedWaits;
+    m_Stats.Signals = plan.SignalCount;
+    m_Stats.Submissions = 0;
+
+    for (size_t passIndex = 0; passIndex < plan.Passes.size(); ++passIndex)
+    {
+        const PlannedPass& planned = plan.Passes[passIndex];
+        Queue& queue = m_Queues[uint32_t(planned.Queue)];
+
+        // A wait only holds back work submitted after it
+        if (!planned.Waits.empty() && queue.Recording)
+            Submit(planned.Queue, planned.Value - 1);
+
+        for (const QueueWait& wait : planned.Waits)
+            ThrowIfFailed(queue.Queue->Wait(m_Queues[uint32_t(wait.Queue)].Fence, wait.Value));
+
+        if (!queue.Recording)
+            BeginRecording(planned.Queue);
+
+        const Record& record = m_Records[passIndex];
+        record.Function(record.Context, queue.CommandList);
+
+        // The last pass of each queue always signals, nothing stays unsubmitted
+        if (planned.Signal)
+        {
+            Submit(planned.Queue, planned.Value);
+            ThrowIfFailed(queue.Queue->Signal(queue.Fence, planned.Value));
+        }
+    }
+
+    // Deferred releases and per frame resources are tracked on the direct
+    // queue, join the other queues back into it
+    for (const QueueWait& wait : m_Planner.Join(QueueType::Direct))
+    {
+        ThrowIfFailed(GetQueue(QueueType::Direct)->Wait(m_Queues[uint32_t(wait.Queue)].Fence, wait.Value));
+        m_Stats.Waits++;
+    }
+
+    m_Stats.TotalWaits += m_Stats.Waits;
+
+    m_Passes.clear();
+    m_Records.clear();
+}
+
+void QueueScheduler::BeginRecording(QueueType type)
+{
+    Queue& queue = m_Queues[uint32_t(type)];
+
+    // Reuse the oldest allocator if the GPU is done with it
+    if (!queue.Allocators.empty() && queue.Allocators.front().FenceValue <= queue.Fence->GetCompletedValue())
+    {
+        queue.Current = queue.Allocators.front();
+        queue.Allocators.erase(queue.Allocators.begin());
+        ThrowIfFailed(queue.Current.Allocator->Reset());
+    }
+    else
+    {
+        ThrowIfFailed(m_Device->CreateCommandAllocator(GetCommandListType(type), IID_PPV_ARGS(&queue.Current.Allocator)));
+    }
+
+    ThrowIfFailed(queue.CommandList->Reset(queue.Current.Allocator, nullptr));
+    queue.Recording = true;
+}
+
+void QueueScheduler::Submit(QueueType type, UINT64 fenceValue)
+{
+    Queue& queue = m_Queues[uint32_t(type)];
+
+    ThrowIfFailed(queue.CommandList->Close());
+
+    ID3D12CommandList* ppCommandLists[] = { queue.CommandList };
+    queue.Queue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+    m_Stats.Submissions++;
+
+    // Every value is signalled eventually, the queue's last pass always signals
+    queue.Current.FenceValue = fenceValue;
+    queue.Allocators.push_back(queue.Current);
+    queue.Current = CommandAllocator();
+    queue.Recording = false;
+}
+
+void QueueScheduler::WaitForIdle()
+{
+    for (uint32_t index = 0; index < s_QueueCount; ++index)
+    {
+        Queue& queue = m_Queues[index];
+
+        const UINT64 lastValue = m_Planner.GetLastValue(QueueType(index));
+        if (queue.Fence == nullptr || queue.Fence->GetCompletedValue() >= lastValue)
+            continue;
+
+        ThrowIfFailed(queue.Fence->SetEventOnCompletion(lastValue, m_Event));
+        WaitForSingleObject(m_Event, INFINITE);
+    }
+}
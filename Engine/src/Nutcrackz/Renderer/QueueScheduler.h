@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Renderer/QueuePlanner.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+
+#include <array>
+#include <initializer_list>
+#include <vector>
+
+// Queue Scheduler
+
+// Owns the direct, compute and copy queues. Passes are added with the queue
+// they run on and the resources they read and write, Execute plans them with
+// QueuePlanner and records each into its queue's command list. The cross
+// queue Wait/Signal pairs come from the plan, passes between two sync points
+// on a queue share one ExecuteCommandLists.
+//
+// Passes only declare ordering. State transitions stay with the pass, and
+// resources shared across queues are expected to be in states both queue
+// types support, usually COMMON for buffers.
+//
+// Render thread only.
+class QueueScheduler
+{
+  public:
+    typedef void (*RecordFunction)(void* context, ID3D12GraphicsCommandList* commandList);
+
+    QueueScheduler(ID3D12Device* device);
+
+    // Waits for every queue to go idle
+    ~QueueScheduler();
+
+    QueueScheduler(const QueueScheduler&) = delete;
+    QueueScheduler& operator=(const QueueScheduler&) = delete;
+
+    ID3D12CommandQueue* GetQueue(QueueType queue) const { return m_Queues[uint32_t(queue)].Queue; }
+
+    // Passes are submitted in the order they are added. record is called
+    // from Execute with the command list of the pass's queue. Neither record
+    // nor name are copied, both have to outlive the call to Execute.
+    template <typename Function>
+    void AddPass(const char* name, QueueType queue, std::initializer_list<ResourceUse> uses, Function& record)
+    {
+        AddPass(
+            name, queue, uses, [](void* context, ID3D12GraphicsCommandList* commandList) { (*static_cast<Function*>(context))(commandList); }, &record);
+    }
+
+    void AddPass(const char* name, QueueType queue, std::initializer_list<ResourceUse> uses, RecordFunction record, void* context);
+
+    // Plan, check and submit everything added since the last call. The
+    // direct queue then waits for the other queues' work, so a value
+    // signalled on it afterwards covers everything submitted so far.
+    void Execute();
+
+    // Block until every queue has finished all submitted work
+    void WaitForIdle();
+
+    const SchedulePlan& GetLastPlan() const { return m_Planner.GetLastPlan(); }
+
+    const QueueSchedulerStats& GetStats() const { return m_Stats; }
+
+  protected:
+    struct CommandAllocator
+    {
+        ID3D12CommandAllocator* Allocator = nullptr;
+
+        // Reusable once the queue's fence reaches it
+        UINT64 FenceValue = 0;
+    };
+
+    struct Queue
+    {
+        ID3D12CommandQueue* Queue = nullptr;
+        ID3D12Fence* Fence = nullptr;
+        ID3D12GraphicsCommandList* CommandList = nullptr;
+
+        // Submitted allocators, in fence value order. Only a few are in
+        // flight, a vector keeps them without allocating per submission.
+        std::vector<CommandAllocator> Allocators;
+
+        CommandAllocator Current;
+        bool Recording = false;
+    };
+
+    void BeginRecording(QueueType type);
+
+    // Execute what was recorded, it is done once the queue's fence reaches
+    // fenceValue
+    void Submit(QueueType type, UINT64 fenceValue);
+
+    ID3D12Device* m_Device;
+    std::array<Queue, s_QueueCount> m_Queues;
+    HANDLE m_Event;
+
+    struct Record
+    {
+        RecordFunction Function;
+        void* Context;
+    };
+
+    QueuePlanner m_Planner;
+
+    // Cleared after every Execute, their capacity is kept for the next frame
+    std::vector<PassDesc> m_Passes;
+    std::vector<Record> m_Records;
+
+    QueueSchedulerStats m_Stats;
+};
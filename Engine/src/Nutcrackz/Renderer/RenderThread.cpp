@@ -0,0 +1,173 @@
+#include "RenderThread.h"
+
+#include "Nutcrackz/Core/MemoryTracking.h"
+#include "Nutcrackz/Renderer/Renderer.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+// Helper functions
+
+namespace
+{
+uint64_t NanosecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+uint32_t ClampLatency(uint32_t latency)
+{
+    if (latency < 1)
+        return 1;
+
+    return latency > RenderThread::s_MaxLatency ? RenderThread::s_MaxLatency : latency;
+}
+}
+
+// Render Thread
+
+RenderThread::RenderThread(Renderer& renderer, uint32_t latency)
+    : m_Renderer(renderer)
+{
+    m_Latency = ClampLatency(latency);
+
+    // Every snapshot starts out free for the game thread
+    for (uint32_t i = 0; i < s_SnapshotCount; ++i)
+        m_FreeQueue.TryPush(i);
+
+    m_Thread = std::thread(&RenderThread::RenderLoop, this);
+}
+
+RenderThread::~RenderThread()
+{
+    Stop();
+}
+
+FrameSnapshot& RenderThread::BeginFrame()
+{
+    if (m_WritingIndex != s_NoSnapshot)
+        return m_Snapshots[m_WritingIndex];
+
+    // Wait until the render thread is less than latency frames behind
+    const auto start = std::chrono::steady_clock::now();
+
+    uint32_t framesInFlight = m_FramesInFlight.load(std::memory_order_acquire);
+    while (framesInFlight >= m_Latency.load(std::memory_order_relaxed) && !m_Failed.load(std::memory_order_acquire))
+    {
+        m_FramesInFlight.wait(framesInFlight, std::memory_order_acquire);
+        framesInFlight = m_FramesInFlight.load(std::memory_order_acquire);
+    }
+
+    m_GameStallNs.fetch_add(NanosecondsSince(start), std::memory_order_relaxed);
+
+    if (m_Failed.load(std::memory_order_acquire))
+        std::rethrow_exception(m_Error);
+
+    // Fewer frames than snapshots are in flight, so one is always free here
+    m_WritingIndex = m_FreeQueue.Pop();
+
+    FrameSnapshot& frame = m_Snapshots[m_WritingIndex];
+    frame.Clear();
+    frame.FrameNumber = ++m_FrameNumber;
+
+    return frame;
+}
+
+void RenderThread::EndFrame()
+{
+    if (m_WritingIndex == s_NoSnapshot)
+        return;
+
+    m_FramesInFlight.fetch_add(1, std::memory_order_release);
+    m_SubmitQueue.Push(m_WritingIndex);
+    m_WritingIndex = s_NoSnapshot;
+
+    m_FramesSubmitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RenderThread::Stop()
+{
+    if (!m_Thread.joinable())
+        return;
+
+    // Queued frames are rendered before the stop index is reached
+    m_SubmitQueue.Push(s_StopIndex);
+    m_Thread.join();
+}
+
+void RenderThread::SetLatency(uint32_t latency)
+{
+    m_Latency.store(ClampLatency(latency), std::memory_order_relaxed);
+}
+
+RenderThreadStats RenderThread::GetStats() const
+{
+    RenderThreadStats stats;
+    stats.FramesSubmitted = m_FramesSubmitted.load(std::memory_order_relaxed);
+    stats.FramesRendered = m_FramesRendered.load(std::memory_order_relaxed);
+    stats.GameStallMs = m_GameStallNs.load(std::memory_order_relaxed) / 1e6;
+    stats.RenderStallMs = m_RenderStallNs.load(std::memory_order_relaxed) / 1e6;
+    stats.GpuStallMs = m_GpuStallNs.load(std::memory_order_relaxed) / 1e6;
+    stats.HeapAllocations = m_HeapAllocations.load(std::memory_order_relaxed);
+    stats.HeapAllocatingFrames = m_HeapAllocatingFrames.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+void RenderThread::ExpectNoHeapAllocations(uint64_t warmupFrames)
+{
+    // Frame numbers start at 1
+    m_HeapCheckFrame.store(warmupFrames > 0 ? warmupFrames + 1 : 0, std::memory_order_relaxed);
+}
+
+void RenderThread::RenderLoop()
+{
+    for (;;)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const uint32_t index = m_SubmitQueue.Pop();
+        m_RenderStallNs.fetch_add(NanosecondsSince(start), std::memory_order_relaxed);
+
+        if (index == s_StopIndex)
+            break;
+
+        try
+        {
+            const FrameSnapshot& frame = m_Snapshots[index];
+            const uint64_t heapAllocations = MemoryTracking::GetThreadHeapAllocations();
+
+            m_Renderer.RenderFrame(frame);
+
+            const uint64_t frameAllocations = MemoryTracking::GetThreadHeapAllocations() - heapAllocations;
+            if (frameAllocations > 0)
+            {
+                m_HeapAllocations.fetch_add(frameAllocations, std::memory_order_relaxed);
+                m_HeapAllocatingFrames.fetch_add(1, std::memory_order_relaxed);
+
+                const uint64_t checkFrame = m_HeapCheckFrame.load(std::memory_order_relaxed);
+                if (checkFrame > 0 && frame.FrameNumber >= checkFrame)
+                    throw std::runtime_error("frame " + std::to_string(frame.FrameNumber) + " made " + std::to_string(frameAllocations) + " heap allocations!");
+            }
+        }
+        catch (...)
+        {
+            // Hand the error to the game thread, BeginFrame rethrows it. Changing
+            // the frame count wakes a game thread waiting on it.
+            m_Error = std::current_exception();
+            m_Failed.store(true, std::memory_order_release);
+            m_FramesInFlight.store(0, std::memory_order_release);
+            m_FramesInFlight.notify_all();
+            return;
+        }
+
+        m_GpuStallNs.fetch_add(static_cast<uint64_t>(m_Renderer.GetLastFenceWait().count()), std::memory_order_relaxed);
+        m_FramesRendered.fetch_add(1, std::memory_order_relaxed);
+
+        // Return the snapshot before the frame count drops, so a woken game
+        // thread always finds a free one
+        m_FreeQueue.Push(index);
+        m_FramesInFlight.fetch_sub(1, std::memory_order_release);
+        m_FramesInFlight.notify_one();
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Nutcrackz/Core/SPSCQueue.h"
+#include "Nutcrackz/Renderer/FrameSnapshot.h"
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+class Renderer;
+
+// Render Thread
+
+struct RenderThreadStats
+{
+    uint64_t FramesSubmitted = 0;
+    uint64_t FramesRendered = 0;
+
+    // Total time the game thread waited in BeginFrame for a free snapshot
+    double GameStallMs = 0.0;
+
+    // Total time the render thread waited for the game thread to submit
+    double RenderStallMs = 0.0;
+
+    // Total time the render thread waited on GPU fences
+    double GpuStallMs = 0.0;
+
+    // Heap allocations the render thread made while rendering, and the
+    // number of frames that made any. Always 0 without heap tracking.
+    uint64_t HeapAllocations = 0;
+    uint64_t HeapAllocatingFrames = 0;
+};
+
+// Runs the Renderer on its own thread. The game thread fills a FrameSnapshot
+// between BeginFrame and EndFrame, which hands it to the render thread over a
+// lock-free queue. The render thread draws it while the game thread builds
+// the next one.
+//
+// Latency is the number of submitted frames the game thread may be ahead of
+// the render thread. With the default of 1 two snapshots alternate: the game
+// thread writes frame N + 1 while frame N is rendered. Higher latency absorbs
+// more jitter on either side at the cost of input lag.
+class RenderThread
+{
+  public:
+    RenderThread(Renderer& renderer, uint32_t latency = 1);
+
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Blocks while latency frames are already queued, then returns a cleared
+    // snapshot for the game thread to fill
+    FrameSnapshot& BeginFrame();
+
+    // Hand the snapshot returned by BeginFrame to the render thread
+    void EndFrame();
+
+    // Finish the queued frames and join the render thread. Called by the
+    // destructor, but should be called before the window goes away.
+    void Stop();
+
+    // Clamped to [1, s_MaxLatency], takes effect on the next BeginFrame
+    void SetLatency(uint32_t latency);
+
+    uint32_t GetLatency() const { return m_Latency.load(std::memory_order_relaxed); }
+
+    RenderThreadStats GetStats() const;
+
+    // Fail like any other render error when a frame after the first
+    // warmupFrames allocates from the heap on the render thread. Needs a
+    // build with SDR_MEMORY_TRACKING, 0 turns the check off.
+    void ExpectNoHeapAllocations(uint64_t warmupFrames);
+
+    static const uint32_t s_MaxLatency = 3;
+
+  protected:
+    void RenderLoop();
+
+    // One snapshot per frame in flight plus the one being written
+    static const uint32_t s_SnapshotCount = s_MaxLatency + 1;
+
+    // Pushed through the submit queue to end the render loop
+    static const uint32_t s_StopIndex = ~0u;
+
+    static const uint32_t s_NoSnapshot = ~0u;
+
+    Renderer& m_Renderer;
+    std::thread m_Thread;
+
+    FrameSnapshot m_Snapshots[s_SnapshotCount];
+
+    // Snapshot indices, submitted frames one way and rendered ones back
+    SPSCQueue<uint32_t, 8> m_SubmitQueue;
+    SPSCQueue<uint32_t, 8> m_FreeQueue;
+
+    // Game thread only
+    uint32_t m_WritingIndex = s_NoSnapshot;
+    uint64_t m_FrameNumber = 0;
+
+    std::atomic<uint32_t> m_Latency;
+    std::atomic<uint32_t> m_FramesInFlight = 0;
+    std::atomic<bool> m_Failed = false;
+    std::exception_ptr m_Error;
+
+    // Instrumentation, in nanoseconds
+    std::atomic<uint64_t> m_FramesSubmitted = 0;
+    std::atomic<uint64_t> m_FramesRendered = 0;
+    std::atomic<uint64_t> m_GameStallNs = 0;
+    std::atomic<uint64_t> m_RenderStallNs = 0;
+    std::atomic<uint64_t> m_GpuStallNs = 0;
+    std::atomic<uint64_t> m_HeapAllocations = 0;
+    std::atomic<uint64_t> m_HeapAllocatingFrames = 0;
+
+    // First frame the heap check applies to, 0 when it is off
+    std::atomic<uint64_t> m_HeapCheckFrame = 0;
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+#define GLM_FORCE_SSE42 1
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 1
+#define GLM_FORCE_LEFT_HANDED
+#include "glm/glm.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Types and utilities shared by every rendering backend. Nothing in here may
+// depend on a graphics API, the public interface of Renderer is built from
+// them on every platform.
+
+// Common Utils
+
+inline std::vector<char> ReadFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    bool exists = (bool)file;
+
+    if (!exists || !file.is_open())
+    {
+        throw std::runtime_error("failed to open file!");
+    }
+
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+
+    file.close();
+
+    return buffer;
+};
+
+// Texture Streaming
+
+typedef uint32_t TextureHandle;
+
+static const TextureHandle s_InvalidTexture = ~0u;
+
+struct TextureStreamingStats
+{
+    // Bytes of texel data currently resident, or on their way to the GPU
+    uint64_t ResidentBytes = 0;
+
+    // Bytes that would be resident if every texture had exactly the mips
+    // demanded this frame
+    uint64_t RequestedBytes = 0;
+
+    uint64_t BudgetBytes = 0;
+
+    // Disk reads that haven't been uploaded yet
+    uint32_t PendingRequests = 0;
+
+    // Mip levels dropped this frame to stay within the budget
+    uint32_t EvictedMips = 0;
+
+    // Requested / budget, anything above 1 means demand can't be met
+    float BudgetPressure = 0.0f;
+};
+
+// Residency
+
+struct ResidencyStats
+{
+    // Video memory the OS lets the process use and what it uses, as of the
+    // start of the frame. Both 0 when the adapter can't tell.
+    uint64_t BudgetBytes = 0;
+    uint64_t UsageBytes = 0;
+
+    // Objects under residency management and how much of them is evicted
+    uint32_t TrackedObjects = 0;
+    uint64_t TrackedBytes = 0;
+    uint64_t EvictedBytes = 0;
+
+    // Last submission, and in total
+    uint32_t Evictions = 0;
+    uint32_t MadeResident = 0;
+    uint64_t TotalEvictions = 0;
+    uint64_t TotalMadeResident = 0;
+
+    // Budget change notifications raised
+    uint32_t BudgetChanges = 0;
+
+    // Still over budget after evicting everything the GPU was done with
+    bool OverBudget = false;
+};
+
+// Materials
+
+typedef uint32_t MaterialHandle;
+
+static const MaterialHandle s_InvalidMaterial = ~0u;
+
+struct MaterialDesc
+{
+    glm::vec4 BaseColor = glm::vec4(1.0f);
+
+    float Roughness = 0.5f;
+    float Metallic = 0.0f;
+    float NormalScale = 1.0f;
+
+    // Pixels with less base color alpha are discarded, 0 keeps everything
+    float AlphaCutoff = 0.0f;
+
+    TextureHandle BaseColorTexture = s_InvalidTexture;
+    TextureHandle NormalTexture = s_InvalidTexture;
+    TextureHandle RoughnessMetallicTexture = s_InvalidTexture;
+};
+
+// Persistent Buffer
+
+struct PersistentBufferStats
+{
+    // Highest element index written so far, plus one
+    uint32_t ElementCount = 0;
+    uint32_t Capacity = 0;
+
+    // Elements and copy commands uploaded this frame
+    uint32_t DirtyElements = 0;
+    uint32_t UploadedRanges = 0;
+
+    uint64_t UploadedBytes = 0;
+    uint64_t TotalUploadedBytes = 0;
+};
+
+// Command Caching
+
+struct CommandCacheStats
+{
+    // Draws executed from an already recorded bundle, this frame and in total
+    uint32_t CachedDraws = 0;
+    uint64_t TotalCachedDraws = 0;
+
+    // Draws that had to be recorded into a new bundle
+    uint32_t RecordedDraws = 0;
+    uint64_t TotalRecordedDraws = 0;
+
+    uint32_t CachedBundles = 0;
+};
+
+// Queue Scheduler
+
+struct QueueSchedulerStats
+{
+    // Last executed frame
+    uint32_t Passes = 0;
+    uint32_t Waits = 0;
+    uint32_t ElidedWaits = 0;
+    uint32_t Signals = 0;
+    uint32_t Submissions = 0;
+
+    uint64_t TotalWaits = 0;
+};
+
+// Frame Readback
+
+struct FrameReadbackStats
+{
+    uint64_t Captures = 0;
+    uint64_t Written = 0;
+
+    // Captures that failed to encode or write
+    uint64_t Failed = 0;
+
+    // Times Capture found every readback buffer in use and had to wait
+    uint64_t BlockingWaits = 0;
+
+    // Encoding and writing the last image on its worker
+    float LastWriteMs = 0.0f;
+};
+
+// Headless Rendering
+
+// Rendering without a window or swapchain, for batch jobs such as thumbnails
+// and regression images
+struct HeadlessDesc
+{
+    unsigned Width = 1280;
+    unsigned Height = 720;
+
+    // Rasterize on the CPU even when a GPU is present: WARP with DirectX 12,
+    // a CPU device such as lavapipe with Vulkan. It is picked regardless when
+    // there is no suitable GPU.
+    bool UseSoftwareRasterizer = false;
+};
@@ -0,0 +1,99 @@
+#include "ResidencyManager.h"
+
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+// Residency Manager
+
+ResidencyManager::ResidencyManager(ID3D12Device* device, IDXGIAdapter1* adapter, FenceTimeline& fenceTimeline)
+    : m_Device(device), m_Adapter(nullptr), m_FenceTimeline(fenceTimeline)
+{
+    if (FAILED(adapter->QueryInterface(IID_PPV_ARGS(&m_Adapter))))
+        m_Adapter = nullptr;
+}
+
+ResidencyManager::~ResidencyManager()
+{
+    if (m_Adapter)
+    {
+        m_Adapter->Release();
+        m_Adapter = nullptr;
+    }
+}
+
+ResidencyHandle ResidencyManager::Track(ID3D12Pageable* object, uint64_t size)
+{
+    const ResidencyHandle handle = m_Planner.Add(size);
+
+    if (handle >= m_Objects.size())
+        m_Objects.resize(handle + 1, nullptr);
+
+    m_Objects[handle] = object;
+
+    return handle;
+}
+
+void ResidencyManager::Untrack(ResidencyHandle handle)
+{
+    if (handle >= m_Objects.size())
+        return;
+
+    m_Planner.Remove(handle);
+    m_Objects[handle] = nullptr;
+}
+
+void ResidencyManager::Use(ResidencyHandle handle)
+{
+    m_Planner.MarkUsed(handle, m_FenceTimeline.GetNextValue());
+}
+
+void ResidencyManager::MakeResident(ResidencyHandle handle)
+{
+    if (m_Planner.IsResident(handle))
+        return;
+
+    ID3D12Pageable* object = m_Objects[handle];
+    ThrowIfFailed(m_Device->MakeResident(1, &object));
+
+    m_Planner.SetResident(handle);
+}
+
+void ResidencyManager::UpdateBudget()
+{
+    ResidencyBudget budget;
+
+    if (m_Adapter)
+    {
+        DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+        if (SUCCEEDED(m_Adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+        {
+            budget.Budget = info.Budget;
+            budget.Usage = info.CurrentUsage;
+        }
+    }
+
+    m_Planner.UpdateBudget(budget);
+}
+
+void ResidencyManager::PrepareSubmit()
+{
+    const ResidencyPlan& plan = m_Planner.Plan(m_FenceTimeline.GetNextValue(), m_FenceTimeline.GetCompletedValue());
+
+    // Evict first, it makes room for what comes back
+    if (!plan.Evict.empty())
+    {
+        m_Batch.clear();
+        for (ResidencyHandle handle : plan.Evict)
+            m_Batch.push_back(m_Objects[handle]);
+
+        ThrowIfFailed(m_Device->Evict(static_cast<UINT>(m_Batch.size()), m_Batch.data()));
+    }
+
+    if (!plan.MakeResident.empty())
+    {
+        m_Batch.clear();
+        for (ResidencyHandle handle : plan.MakeResident)
+            m_Batch.push_back(m_Objects[handle]);
+
+        ThrowIfFailed(m_Device->MakeResident(static_cast<UINT>(m_Batch.size()), m_Batch.data()));
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/ResidencyPlanner.h"
+
+#include <vector>
+
+// Residency Manager
+
+// Keeps video memory use within the budget the OS gives the process. The
+// budget is queried once per frame; objects the frame's command list
+// references are made resident before it executes, and when that goes over
+// budget the least recently used objects the GPU is done with are evicted.
+// Budget listeners let streaming systems shrink or grow what they keep
+// resident before eviction has to step in.
+//
+// Objects only count as used when they are passed to Use, so anything that
+// may be referenced without it, such as through a bindless descriptor, must
+// not be tracked or must be used every frame.
+//
+// Not thread safe, the renderer calls it under the texture streamer's lock.
+class ResidencyManager
+{
+  public:
+    ResidencyManager(ID3D12Device* device, IDXGIAdapter1* adapter, FenceTimeline& fenceTimeline);
+
+    ~ResidencyManager();
+
+    ResidencyManager(const ResidencyManager&) = delete;
+    ResidencyManager& operator=(const ResidencyManager&) = delete;
+
+    // Manage a newly created object of size bytes
+    ResidencyHandle Track(ID3D12Pageable* object, uint64_t size);
+
+    // Stop managing the object, before it is released
+    void Untrack(ResidencyHandle handle);
+
+    // The object is referenced by the commands being recorded, the work the
+    // fence timeline's next value covers
+    void Use(ResidencyHandle handle);
+
+    // Make the object resident right away, for uses outside of the recorded
+    // frame such as copying out of an object about to be replaced
+    void MakeResident(ResidencyHandle handle);
+
+    // Query the budget and notify listeners when it changed. Once per frame,
+    // before recording.
+    void UpdateBudget();
+
+    // Evict and make resident what the plan for the recorded commands asks
+    // for. Before they are executed, MakeResident blocks until the objects
+    // are back in video memory.
+    void PrepareSubmit();
+
+    // Called from UpdateBudget with the new budget
+    void AddBudgetListener(ResidencyPlanner::BudgetListener listener) { m_Planner.AddBudgetListener(std::move(listener)); }
+
+    const ResidencyStats& GetStats() const { return m_Planner.GetStats(); }
+
+  protected:
+    ID3D12Device* m_Device;
+
+    // Null when the adapter can't report its budget, nothing is evicted then
+    IDXGIAdapter3* m_Adapter;
+
+    FenceTimeline& m_FenceTimeline;
+
+    ResidencyPlanner m_Planner;
+
+    // By residency handle
+    std::vector<ID3D12Pageable*> m_Objects;
+
+    // Reused so steady state frames don't allocate
+    std::vector<ID3D12Pageable*> m_Batch;
+};
@@ -0,0 +1,195 @@
+#include "ResidencyPlanner.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Residency Planning
+
+ResidencyHandle ResidencyPlanner::Add(uint64_t size)
+{
+    ResidencyHandle handle;
+    if (!m_FreeHandles.empty())
+    {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<ResidencyHandle>(m_Entries.size());
+        m_Entries.emplace_back();
+    }
+
+    Entry& entry = m_Entries[handle];
+    entry = Entry();
+    entry.Size = size;
+    entry.Resident = true;
+    entry.Alive = true;
+
+    Append(handle);
+
+    m_Usage += size;
+    m_Stats.TrackedObjects++;
+    m_Stats.TrackedBytes += size;
+
+    return handle;
+}
+
+void ResidencyPlanner::Remove(ResidencyHandle handle)
+{
+    if (handle >= m_Entries.size() || !m_Entries[handle].Alive)
+        return;
+
+    Entry& entry = m_Entries[handle];
+    Unlink(handle);
+
+    // The object's memory is freed once its last use completes, counting
+    // it out now errs on the side of evicting less
+    if (entry.Resident)
+        m_Usage -= std::min(m_Usage, entry.Size);
+    else
+        m_Stats.EvictedBytes -= entry.Size;
+
+    m_Stats.TrackedObjects--;
+    m_Stats.TrackedBytes -= entry.Size;
+
+    entry = Entry();
+    m_FreeHandles.push_back(handle);
+}
+
+void ResidencyPlanner::MarkUsed(ResidencyHandle handle, uint64_t fenceValue)
+{
+    Entry& entry = m_Entries[handle];
+    if (entry.LastUsedFence == fenceValue)
+        return;
+
+    // Marks for a submission that was never planned are dropped
+    if (fenceValue != m_UsedFence)
+    {
+        m_Used.clear();
+        m_UsedFence = fenceValue;
+    }
+
+    entry.LastUsedFence = fenceValue;
+    m_Used.push_back(handle);
+
+    Unlink(handle);
+    Append(handle);
+}
+
+void ResidencyPlanner::SetResident(ResidencyHandle handle)
+{
+    Entry& entry = m_Entries[handle];
+    if (entry.Resident)
+        return;
+
+    entry.Resident = true;
+    m_Usage += entry.Size;
+    m_Stats.EvictedBytes -= entry.Size;
+    m_Stats.TotalMadeResident++;
+}
+
+void ResidencyPlanner::UpdateBudget(const ResidencyBudget& budget)
+{
+    m_Budget = budget;
+    m_Usage = budget.Usage;
+
+    m_Stats.BudgetBytes = budget.Budget;
+    m_Stats.UsageBytes = budget.Usage;
+
+    const double change = std::fabs(double(budget.Budget) - double(m_NotifiedBudget));
+    if (m_Notified && change <= double(m_NotifiedBudget) * s_NotifyThreshold)
+        return;
+
+    m_Notified = true;
+    m_NotifiedBudget = budget.Budget;
+    m_Stats.BudgetChanges++;
+
+    for (const BudgetListener& listener : m_Listeners)
+        listener(budget);
+}
+
+void ResidencyPlanner::AddBudgetListener(BudgetListener listener)
+{
+    m_Listeners.push_back(std::move(listener));
+}
+
+const ResidencyPlan& ResidencyPlanner::Plan(uint64_t submitFence, uint64_t completedFence)
+{
+    m_Plan.Evict.clear();
+    m_Plan.MakeResident.clear();
+
+    // Everything the submission references has to be resident
+    if (m_UsedFence == submitFence)
+    {
+        for (ResidencyHandle handle : m_Used)
+        {
+            Entry& entry = m_Entries[handle];
+            if (!entry.Alive || entry.Resident)
+                continue;
+
+            entry.Resident = true;
+            m_Usage += entry.Size;
+            m_Stats.EvictedBytes -= entry.Size;
+            m_Plan.MakeResident.push_back(handle);
+        }
+    }
+
+    m_Used.clear();
+
+    // Then make room, oldest first. Objects still in use by the GPU or by
+    // this submission are skipped, not waited for.
+    if (m_Budget.Budget > 0)
+    {
+        for (ResidencyHandle handle = m_Oldest; handle != s_InvalidResidency && m_Usage > m_Budget.Budget; handle = m_Entries[handle].Next)
+        {
+            Entry& entry = m_Entries[handle];
+            if (!entry.Resident || entry.LastUsedFence > completedFence)
+                continue;
+
+            entry.Resident = false;
+            m_Usage -= std::min(m_Usage, entry.Size);
+            m_Stats.EvictedBytes += entry.Size;
+            m_Plan.Evict.push_back(handle);
+        }
+    }
+
+    m_Stats.Evictions = static_cast<uint32_t>(m_Plan.Evict.size());
+    m_Stats.MadeResident = static_cast<uint32_t>(m_Plan.MakeResident.size());
+    m_Stats.TotalEvictions += m_Plan.Evict.size();
+    m_Stats.TotalMadeResident += m_Plan.MakeResident.size();
+    m_Stats.OverBudget = m_Budget.Budget > 0 && m_Usage > m_Budget.Budget;
+
+    return m_Plan;
+}
+
+void ResidencyPlanner::Unlink(ResidencyHandle handle)
+{
+    Entry& entry = m_Entries[handle];
+
+    if (entry.Previous != s_InvalidResidency)
+        m_Entries[entry.Previous].Next = entry.Next;
+    else if (m_Oldest == handle)
+        m_Oldest = entry.Next;
+
+    if (entry.Next != s_InvalidResidency)
+        m_Entries[entry.Next].Previous = entry.Previous;
+    else if (m_Newest == handle)
+        m_Newest = entry.Previous;
+
+    entry.Previous = s_InvalidResidency;
+    entry.Next = s_InvalidResidency;
+}
+
+void ResidencyPlanner::Append(ResidencyHandle handle)
+{
+    Entry& entry = m_Entries[handle];
+    entry.Previous = m_Newest;
+    entry.Next = s_InvalidResidency;
+
+    if (m_Newest != s_InvalidResidency)
+        m_Entries[m_Newest].Next = handle;
+    else
+        m_Oldest = handle;
+
+    m_Newest = handle;
+}
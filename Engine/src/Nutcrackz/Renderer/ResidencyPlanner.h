@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Nutcrackz/Renderer/RendererCommon.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Residency Planning
+
+// Decides which objects to evict from and bring back into video memory.
+// Plain C++ without any D3D12 types like the queue planner, so the policy
+// can be run against a simulated budget. ResidencyManager applies it.
+
+typedef uint32_t ResidencyHandle;
+
+static const ResidencyHandle s_InvalidResidency = ~0u;
+
+// What the OS lets the process use and what it uses, in bytes. A budget of
+// 0 means it isn't known, nothing is evicted then.
+struct ResidencyBudget
+{
+    uint64_t Budget = 0;
+    uint64_t Usage = 0;
+};
+
+struct ResidencyPlan
+{
+    std::vector<ResidencyHandle> Evict;
+    std::vector<ResidencyHandle> MakeResident;
+};
+
+// Objects are kept in least recently used order by the fence value of the
+// last work that referenced them. Plan is called once per submission: what
+// the submission references is made resident, and while that leaves usage
+// over budget, objects the GPU is done with are evicted oldest first.
+class ResidencyPlanner
+{
+  public:
+    typedef std::function<void(const ResidencyBudget&)> BudgetListener;
+
+    // Fraction the budget has to move by before listeners hear about it
+    static constexpr double s_NotifyThreshold = 0.05;
+
+    // Objects start out resident, as newly created ones are
+    ResidencyHandle Add(uint64_t size);
+
+    void Remove(ResidencyHandle handle);
+
+    // The object is referenced by work that completes with fenceValue.
+    // Values only grow, a new value starts a new submission.
+    void MarkUsed(ResidencyHandle handle, uint64_t fenceValue);
+
+    bool IsResident(ResidencyHandle handle) const { return m_Entries[handle].Resident; }
+
+    // Mark an evicted object resident outside of a plan, the caller makes
+    // it resident right away
+    void SetResident(ResidencyHandle handle);
+
+    // New figures from the OS, once per frame. Listeners are called the
+    // first time and whenever the budget moved by more than the threshold
+    // since they were last called.
+    void UpdateBudget(const ResidencyBudget& budget);
+
+    void AddBudgetListener(BudgetListener listener);
+
+    // Plan the submission of the work marked with submitFence. Objects last
+    // used at or before completedFence may be evicted. The plan is already
+    // reflected in the planner, the caller only applies it to the objects.
+    const ResidencyPlan& Plan(uint64_t submitFence, uint64_t completedFence);
+
+    const ResidencyStats& GetStats() const { return m_Stats; }
+
+  protected:
+    struct Entry
+    {
+        uint64_t Size = 0;
+        uint64_t LastUsedFence = 0;
+
+        // Neighbours in the least recently used list
+        ResidencyHandle Previous = s_InvalidResidency;
+        ResidencyHandle Next = s_InvalidResidency;
+
+        bool Resident = false;
+        bool Alive = false;
+    };
+
+    void Unlink(ResidencyHandle handle);
+    void Append(ResidencyHandle handle);
+
+    std::vector<Entry> m_Entries;
+    std::vector<ResidencyHandle> m_FreeHandles;
+
+    // Least and most recently used
+    ResidencyHandle m_Oldest = s_InvalidResidency;
+    ResidencyHandle m_Newest = s_InvalidResidency;
+
+    // Marked for the submission being recorded
+    std::vector<ResidencyHandle> m_Used;
+    uint64_t m_UsedFence = 0;
+
+    ResidencyBudget m_Budget;
+
+    // The OS figure plus what was added and planned since it was taken
+    uint64_t m_Usage = 0;
+
+    std::vector<BudgetListener> m_Listeners;
+    uint64_t m_NotifiedBudget = 0;
+    bool m_Notified = false;
+
+    ResidencyPlan m_Plan;
+    ResidencyStats m_Stats;
+};
@@ -0,0 +1,92 @@
+#include "ResolutionController.h"
+
+#include <algorithm>
+
+// Dynamic Resolution
+
+ResolutionController::ResolutionController(const ResolutionControllerDesc& desc)
+    : m_Desc(desc), m_Scale(desc.MaxScale)
+{
+}
+
+float ResolutionController::Update(float frameMs)
+{
+    if (!(frameMs > 0.0f) || !(m_Desc.TargetFrameMs > 0.0f))
+        return m_Scale;
+
+    // Smooth out single slow frames, they should not cost resolution
+    if (m_HasSample)
+        m_FilteredFrameMs += m_Desc.Smoothing * (frameMs - m_FilteredFrameMs);
+    else
+        m_FilteredFrameMs = frameMs;
+
+    const float error = (m_Desc.TargetFrameMs - m_FilteredFrameMs) / m_Desc.TargetFrameMs;
+    const float derivative = m_HasSample ? error - m_PreviousError : 0.0f;
+
+    m_PreviousError = error;
+    m_HasSample = true;
+
+    // A little under the target is close enough, hold the scale and don't
+    // let the integral drift. Anything over it always costs resolution, so
+    // the scale never settles above the target.
+    if (error >= 0.0f && error < m_Desc.Hysteresis)
+        return m_Scale;
+
+    // Anti windup, stop integrating while the scale is pinned at a limit
+    const bool pinnedHigh = m_Scale >= m_Desc.MaxScale && error > 0.0f;
+    const bool pinnedLow = m_Scale <= m_Desc.MinScale && error < 0.0f;
+    if (!pinnedHigh && !pinnedLow)
+        m_IntegralError = std::clamp(m_IntegralError + error, -1.0f, 1.0f);
+
+    const float output = m_Desc.Proportional * error + m_Desc.Integral * m_IntegralError + m_Desc.Derivative * derivative;
+    const float step = std::clamp(output, -m_Desc.MaxStepDown, m_Desc.MaxStepUp);
+
+    m_Scale = std::clamp(m_Scale + step, m_Desc.MinScale, m_Desc.MaxScale);
+    return m_Scale;
+}
+
+void ResolutionController::SetTargetFrameMs(float targetFrameMs)
+{
+    m_Desc.TargetFrameMs = targetFrameMs;
+    m_IntegralError = 0.0f;
+}
+
+void ResolutionController::Reset(float scale)
+{
+    m_Scale = std::clamp(scale, m_Desc.MinScale, m_Desc.MaxScale);
+    m_FilteredFrameMs = 0.0f;
+    m_IntegralError = 0.0f;
+    m_PreviousError = 0.0f;
+    m_HasSample = false;
+}
+
+ResolutionSimulation SimulateResolution(ResolutionController controller, const std::vector<float>& fullResolutionFrameMs, float fixedMs)
+{
+    ResolutionSimulation simulation;
+    simulation.Scales.reserve(fullResolutionFrameMs.size());
+    simulation.FrameMs.reserve(fullResolutionFrameMs.size());
+
+    double scaleSum = 0.0;
+
+    for (float fullMs : fullResolutionFrameMs)
+    {
+        const float scale = controller.GetScale();
+        const float pixelMs = std::max(fullMs - fixedMs, 0.0f);
+        const float frameMs = std::min(fixedMs, fullMs) + pixelMs * scale * scale;
+
+        simulation.Scales.push_back(scale);
+        simulation.FrameMs.push_back(frameMs);
+        scaleSum += scale;
+
+        if (frameMs > controller.GetDesc().TargetFrameMs)
+            simulation.FramesOverTarget++;
+
+        if (controller.Update(frameMs) != scale)
+            simulation.ScaleChanges++;
+    }
+
+    if (!fullResolutionFrameMs.empty())
+        simulation.MeanScale = static_cast<float>(scaleSum / fullResolutionFrameMs.size());
+
+    return simulation;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Dynamic Resolution
+
+struct ResolutionControllerDesc
+{
+    // GPU time per frame the controller steers toward, in milliseconds
+    float TargetFrameMs = 14.0f;
+
+    // Fraction of the output size rendered along each axis
+    float MinScale = 0.5f;
+    float MaxScale = 1.0f;
+
+    // Gains on the error as a fraction of the target, positive when there
+    // is headroom. The output is a change of scale per frame.
+    float Proportional = 0.15f;
+    float Integral = 0.02f;
+    float Derivative = 0.05f;
+
+    // Largest change of scale per frame. Dropping resolution has to be
+    // quick to save frames, raising it again can take its time.
+    float MaxStepDown = 0.08f;
+    float MaxStepUp = 0.02f;
+
+    // Frame times under the target by less than this fraction of it leave
+    // the scale alone, so noise doesn't make the resolution shimmer. Frame
+    // times over the target always lower the scale.
+    float Hysteresis = 0.05f;
+
+    // Weight of the newest frame time in the exponential moving average the
+    // controller works on
+    float Smoothing = 0.3f;
+};
+
+// PID controller from measured frame times to a resolution scale. Plain C++
+// so it can be driven by synthetic frame time traces, see
+// SimulateResolution.
+class ResolutionController
+{
+  public:
+    ResolutionController(const ResolutionControllerDesc& desc = ResolutionControllerDesc());
+
+    // Feed the frame time of a frame rendered at the current scale, returns
+    // the scale for the next one
+    float Update(float frameMs);
+
+    float GetScale() const { return m_Scale; }
+
+    // Frame time the controller currently works on
+    float GetFilteredFrameMs() const { return m_FilteredFrameMs; }
+
+    const ResolutionControllerDesc& GetDesc() const { return m_Desc; }
+
+    // Keeps the scale, the new target only changes where it goes from here
+    void SetTargetFrameMs(float targetFrameMs);
+
+    // Forget the history, for example after a resize
+    void Reset(float scale);
+
+  protected:
+    ResolutionControllerDesc m_Desc;
+
+    float m_Scale;
+    float m_FilteredFrameMs = 0.0f;
+    float m_IntegralError = 0.0f;
+    float m_PreviousError = 0.0f;
+    bool m_HasSample = false;
+};
+
+struct ResolutionSimulation
+{
+    // Per frame, the scale it was rendered at and the time it took
+    std::vector<float> Scales;
+    std::vector<float> FrameMs;
+
+    uint32_t FramesOverTarget = 0;
+    uint32_t ScaleChanges = 0;
+    float MeanScale = 0.0f;
+};
+
+// Run a controller over a trace of frame times measured at full resolution.
+// Each frame costs fixedMs plus the rest of its trace time scaled by the
+// rendered pixel count, scale squared.
+ResolutionSimulation SimulateResolution(ResolutionController controller, const std::vector<float>& fullResolutionFrameMs, float fixedMs = 0.0f);
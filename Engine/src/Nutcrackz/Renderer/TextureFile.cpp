@@ -0,0 +1,444 @@
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// Helper functions
+
+namespace
+{
+// DDS
+
+const uint32_t s_DdsMagic = 0x20534444; // "DDS "
+
+const uint32_t s_DdpfFourCC = 0x4;
+const uint32_t s_DdpfRGB = 0x40;
+const uint32_t s_DdsCaps2Cubemap = 0x200;
+const uint32_t s_DdsCaps2Volume = 0x200000;
+
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+{
+    return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+}
+
+struct DdsPixelFormat
+{
+    uint32_t Size;
+    uint32_t Flags;
+    uint32_t FourCC;
+    uint32_t RGBBitCount;
+    uint32_t RBitMask;
+    uint32_t GBitMask;
+    uint32_t BBitMask;
+    uint32_t ABitMask;
+};
+
+struct DdsHeader
+{
+    uint32_t Size;
+    uint32_t Flags;
+    uint32_t Height;
+    uint32_t Width;
+    uint32_t PitchOrLinearSize;
+    uint32_t Depth;
+    uint32_t MipMapCount;
+    uint32_t Reserved1[11];
+    DdsPixelFormat PixelFormat;
+    uint32_t Caps;
+    uint32_t Caps2;
+    uint32_t Caps3;
+    uint32_t Caps4;
+    uint32_t Reserved2;
+};
+
+struct DdsHeaderDX10
+{
+    uint32_t DxgiFormat;
+    uint32_t ResourceDimension;
+    uint32_t MiscFlag;
+    uint32_t ArraySize;
+    uint32_t MiscFlags2;
+};
+
+static_assert(sizeof(DdsHeader) == 124, "DDS header must be 124 bytes");
+static_assert(sizeof(DdsHeaderDX10) == 20, "DDS DX10 header must be 20 bytes");
+
+TextureFormat FormatFromDxgi(uint32_t dxgiFormat)
+{
+    // Values match the DXGI_FORMAT enum, kept numeric so this file doesn't
+    // depend on the graphics API headers.
+    switch (dxgiFormat)
+    {
+    case 28: return TextureFormat::RGBA8;
+    case 29: return TextureFormat::RGBA8_SRGB;
+    case 71: return TextureFormat::BC1;
+    case 72: return TextureFormat::BC1_SRGB;
+    case 74: return TextureFormat::BC2;
+    case 75: return TextureFormat::BC2_SRGB;
+    case 77: return TextureFormat::BC3;
+    case 78: return TextureFormat::BC3_SRGB;
+    case 80: return TextureFormat::BC4;
+    case 83: return TextureFormat::BC5;
+    case 95: return TextureFormat::BC6H;
+    case 98: return TextureFormat::BC7;
+    case 99: return TextureFormat::BC7_SRGB;
+    default: return TextureFormat::Unknown;
+    }
+}
+
+TextureFormat FormatFromDdsPixelFormat(const DdsPixelFormat& pf)
+{
+    if (pf.Flags & s_DdpfFourCC)
+    {
+        switch (pf.FourCC)
+        {
+        case MakeFourCC('D', 'X', 'T', '1'): return TextureFormat::BC1;
+        case MakeFourCC('D', 'X', 'T', '3'): return TextureFormat::BC2;
+        case MakeFourCC('D', 'X', 'T', '5'): return TextureFormat::BC3;
+        case MakeFourCC('A', 'T', 'I', '1'):
+        case MakeFourCC('B', 'C', '4', 'U'): return TextureFormat::BC4;
+        case MakeFourCC('A', 'T', 'I', '2'):
+        case MakeFourCC('B', 'C', '5', 'U'): return TextureFormat::BC5;
+        default: return TextureFormat::Unknown;
+        }
+    }
+
+    if ((pf.Flags & s_DdpfRGB) && pf.RGBBitCount == 32 && pf.RBitMask == 0x000000ff &&
+        pf.GBitMask == 0x0000ff00 && pf.BBitMask == 0x00ff0000)
+        return TextureFormat::RGBA8;
+
+    return TextureFormat::Unknown;
+}
+
+// KTX2
+
+const uint8_t s_Ktx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+struct Ktx2Header
+{
+    uint8_t Identifier[12];
+    uint32_t VkFormat;
+    uint32_t TypeSize;
+    uint32_t PixelWidth;
+    uint32_t PixelHeight;
+    uint32_t PixelDepth;
+    uint32_t LayerCount;
+    uint32_t FaceCount;
+    uint32_t LevelCount;
+    uint32_t SupercompressionScheme;
+    uint32_t DfdByteOffset;
+    uint32_t DfdByteLength;
+    uint32_t KvdByteOffset;
+    uint32_t KvdByteLength;
+    uint64_t SgdByteOffset;
+    uint64_t SgdByteLength;
+};
+
+struct Ktx2LevelIndex
+{
+    uint64_t ByteOffset;
+    uint64_t ByteLength;
+    uint64_t UncompressedByteLength;
+};
+
+static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must be 80 bytes");
+
+TextureFormat FormatFromVk(uint32_t vkFormat)
+{
+    // Values match the VkFormat enum.
+    switch (vkFormat)
+    {
+    case 37: return TextureFormat::RGBA8;
+    case 43: return TextureFormat::RGBA8_SRGB;
+    case 131:
+    case 133: return TextureFormat::BC1;
+    case 132:
+    case 134: return TextureFormat::BC1_SRGB;
+    case 135: return TextureFormat::BC2;
+    case 136: return TextureFormat::BC2_SRGB;
+    case 137: return TextureFormat::BC3;
+    case 138: return TextureFormat::BC3_SRGB;
+    case 139: return TextureFormat::BC4;
+    case 141: return TextureFormat::BC5;
+    case 143: return TextureFormat::BC6H;
+    case 145: return TextureFormat::BC7;
+    case 146: return TextureFormat::BC7_SRGB;
+    default: return TextureFormat::Unknown;
+    }
+}
+
+// Shared
+
+// Largest side accepted, the D3D12 limit. Also keeps row pitches within 32
+// bits.
+const uint32_t s_MaxTextureSize = 16384;
+
+void CheckSize(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0)
+        throw std::runtime_error("texture has no texels!");
+
+    if (width > s_MaxTextureSize || height > s_MaxTextureSize)
+        throw std::runtime_error("texture is too large!");
+}
+
+// Mips in the full chain down to 1x1
+uint32_t GetMaxMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t mipCount = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+        mipCount++;
+
+    return mipCount;
+}
+
+// Bytes of a mip with tightly packed rows
+uint64_t GetMipSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+    return uint64_t(GetRowPitch(format, width)) * GetRowCount(format, height);
+}
+
+void CheckMipInFile(const TextureMip& level, uint64_t fileSize)
+{
+    if (level.Offset > fileSize || level.Size > fileSize - level.Offset)
+        throw std::runtime_error("texture mip runs past the end of the file!");
+}
+
+template <typename T>
+void ReadStruct(std::ifstream& file, T& value)
+{
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+
+    if (!file)
+        throw std::runtime_error("unexpected end of texture file!");
+}
+
+void ReadDds(std::ifstream& file, uint64_t fileSize, TextureFileDesc& desc)
+{
+    DdsHeader header;
+    ReadStruct(file, header);
+
+    if (header.Size != sizeof(DdsHeader) || header.PixelFormat.Size != sizeof(DdsPixelFormat))
+        throw std::runtime_error("malformed DDS header!");
+
+    if ((header.Caps2 & s_DdsCaps2Cubemap) || (header.Caps2 & s_DdsCaps2Volume))
+        throw std::runtime_error("only 2D DDS textures are supported!");
+
+    uint64_t dataOffset = sizeof(uint32_t) + sizeof(DdsHeader);
+
+    if ((header.PixelFormat.Flags & s_DdpfFourCC) && header.PixelFormat.FourCC == MakeFourCC('D', 'X', '1', '0'))
+    {
+        DdsHeaderDX10 dx10;
+        ReadStruct(file, dx10);
+
+        // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+        if (dx10.ResourceDimension != 3 || dx10.ArraySize > 1)
+            throw std::runtime_error("only 2D DDS textures are supported!");
+
+        desc.Format = FormatFromDxgi(dx10.DxgiFormat);
+        dataOffset += sizeof(DdsHeaderDX10);
+    }
+    else
+    {
+        desc.Format = FormatFromDdsPixelFormat(header.PixelFormat);
+    }
+
+    if (desc.Format == TextureFormat::Unknown)
+        throw std::runtime_error("unsupported DDS pixel format!");
+
+    desc.Width = header.Width;
+    desc.Height = header.Height;
+    CheckSize(desc.Width, desc.Height);
+
+    const uint32_t mipCount = std::max(header.MipMapCount, 1u);
+    if (mipCount > GetMaxMipCount(desc.Width, desc.Height))
+        throw std::runtime_error("DDS has more mips than its size allows!");
+
+    // Mips are stored back to back, most detailed first.
+    uint64_t offset = dataOffset;
+
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        TextureMip level;
+        level.Width = std::max(desc.Width >> mip, 1u);
+        level.Height = std::max(desc.Height >> mip, 1u);
+        level.Offset = offset;
+        level.Size = GetMipSize(desc.Format, level.Width, level.Height);
+        CheckMipInFile(level, fileSize);
+
+        desc.Mips.push_back(level);
+        offset += level.Size;
+    }
+}
+
+void ReadKtx2(std::ifstream& file, uint64_t fileSize, TextureFileDesc& desc)
+{
+    Ktx2Header header;
+    ReadStruct(file, header);
+
+    if (memcmp(header.Identifier, s_Ktx2Identifier, sizeof(s_Ktx2Identifier)) != 0)
+        throw std::runtime_error("malformed KTX2 header!");
+
+    if (header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1)
+        throw std::runtime_error("only 2D KTX2 textures are supported!");
+
+    if (header.SupercompressionScheme != 0)
+        throw std::runtime_error("supercompressed KTX2 textures are not supported!");
+
+    desc.Format = FormatFromVk(header.VkFormat);
+
+    if (desc.Format == TextureFormat::Unknown)
+        throw std::runtime_error("unsupported KTX2 pixel format!");
+
+    desc.Width = header.PixelWidth;
+    desc.Height = std::max(header.PixelHeight, 1u);
+    CheckSize(desc.Width, desc.Height);
+
+    const uint32_t mipCount = std::max(header.LevelCount, 1u);
+    if (mipCount > GetMaxMipCount(desc.Width, desc.Height))
+        throw std::runtime_error("KTX2 has more levels than its size allows!");
+
+    // The level index directly follows the header, most detailed level first.
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        Ktx2LevelIndex index;
+        ReadStruct(file, index);
+
+        TextureMip level;
+        level.Width = std::max(desc.Width >> mip, 1u);
+        level.Height = std::max(desc.Height >> mip, 1u);
+        level.Offset = index.ByteOffset;
+        level.Size = GetMipSize(desc.Format, level.Width, level.Height);
+
+        // The uploads copy whole rows of the mip, a shorter level would be
+        // read past its end. Padding after the rows is skipped.
+        if (index.ByteLength < level.Size)
+            throw std::runtime_error("KTX2 level is smaller than its mip!");
+
+        CheckMipInFile(level, fileSize);
+
+        desc.Mips.push_back(level);
+    }
+}
+}
+
+// Texture Files
+
+bool IsBlockCompressed(TextureFormat format)
+{
+    return format != TextureFormat::Unknown && format != TextureFormat::RGBA8 && format != TextureFormat::RGBA8_SRGB;
+}
+
+uint32_t GetFormatBlockBytes(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8:
+    case TextureFormat::RGBA8_SRGB:
+        return 4;
+    case TextureFormat::BC1:
+    case TextureFormat::BC1_SRGB:
+    case TextureFormat::BC4:
+        return 8;
+    case TextureFormat::BC2:
+    case TextureFormat::BC2_SRGB:
+    case TextureFormat::BC3:
+    case TextureFormat::BC3_SRGB:
+    case TextureFormat::BC5:
+    case TextureFormat::BC6H:
+    case TextureFormat::BC7:
+    case TextureFormat::BC7_SRGB:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+uint32_t GetRowPitch(TextureFormat format, uint32_t width)
+{
+    if (IsBlockCompressed(format))
+        return std::max((width + 3) / 4, 1u) * GetFormatBlockBytes(format);
+
+    return width * GetFormatBlockBytes(format);
+}
+
+uint32_t GetRowCount(TextureFormat format, uint32_t height)
+{
+    if (IsBlockCompressed(format))
+        return std::max((height + 3) / 4, 1u);
+
+    return height;
+}
+
+TextureFileDesc ReadTextureFileDesc(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error("failed to open texture file!");
+
+    file.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    TextureFileDesc desc;
+    desc.Path = path;
+
+    uint8_t magic[12] = {};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+
+    uint32_t ddsMagic;
+    memcpy(&ddsMagic, magic, sizeof(ddsMagic));
+
+    if (file && memcmp(magic, s_Ktx2Identifier, sizeof(s_Ktx2Identifier)) == 0)
+    {
+        file.seekg(0);
+        ReadKtx2(file, fileSize, desc);
+    }
+    else if (ddsMagic == s_DdsMagic)
+    {
+        file.clear();
+        file.seekg(sizeof(uint32_t));
+        ReadDds(file, fileSize, desc);
+    }
+    else
+    {
+        throw std::runtime_error("unknown texture file format!");
+    }
+
+    return desc;
+}
+
+std::vector<uint8_t> ReadTextureMips(const TextureFileDesc& desc, uint32_t firstMip, uint32_t lastMip)
+{
+    std::ifstream file(desc.Path, std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error("failed to open texture file!");
+
+    uint64_t totalSize = 0;
+    for (uint32_t mip = firstMip; mip <= lastMip; ++mip)
+        totalSize += desc.Mips[mip].Size;
+
+    std::vector<uint8_t> data(totalSize);
+    uint64_t writeOffset = 0;
+
+    // KTX2 stores the smallest level first, so read level by level rather
+    // than assuming the range is contiguous on disk.
+    for (uint32_t mip = firstMip; mip <= lastMip; ++mip)
+    {
+        const TextureMip& level = desc.Mips[mip];
+
+        file.seekg(static_cast<std::streamoff>(level.Offset));
+        file.read(reinterpret_cast<char*>(data.data() + writeOffset), static_cast<std::streamsize>(level.Size));
+
+        if (!file)
+            throw std::runtime_error("failed to read texture mip!");
+
+        writeOffset += level.Size;
+    }
+
+    return data;
+}
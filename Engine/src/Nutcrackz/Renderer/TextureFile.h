@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Texture Files
+
+// Pixel formats understood by the texture loader. These are API agnostic, the
+// renderer maps them to DXGI formats when creating resources.
+enum class TextureFormat : uint32_t
+{
+    Unknown = 0,
+    RGBA8,
+    RGBA8_SRGB,
+    BC1,
+    BC1_SRGB,
+    BC2,
+    BC2_SRGB,
+    BC3,
+    BC3_SRGB,
+    BC4,
+    BC5,
+    BC6H,
+    BC7,
+    BC7_SRGB
+};
+
+// Returns true for block compressed formats (4x4 texel blocks)
+bool IsBlockCompressed(TextureFormat format);
+
+// Bytes per 4x4 block for compressed formats, bytes per texel otherwise
+uint32_t GetFormatBlockBytes(TextureFormat format);
+
+// Size in bytes of one row of blocks (or texels) and the number of such rows
+uint32_t GetRowPitch(TextureFormat format, uint32_t width);
+uint32_t GetRowCount(TextureFormat format, uint32_t height);
+
+// Where a single mip level lives inside the file
+struct TextureMip
+{
+    uint64_t Offset;
+    uint64_t Size;
+    uint32_t Width;
+    uint32_t Height;
+};
+
+// Everything needed to stream a texture without keeping the file contents
+// in memory. Mip 0 is the most detailed level.
+struct TextureFileDesc
+{
+    std::string Path;
+    TextureFormat Format = TextureFormat::Unknown;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    std::vector<TextureMip> Mips;
+};
+
+// Parse the header of a DDS or KTX2 file. Only 2D, single layer textures
+// without supercompression are supported. Throws std::runtime_error if the
+// file can't be read or isn't supported.
+TextureFileDesc ReadTextureFileDesc(const std::string& path);
+
+// Read the contiguous mip range [firstMip, lastMip] from disk. The returned
+// buffer holds the mips back to back, most detailed first, with tightly
+// packed rows.
+std::vector<uint8_t> ReadTextureMips(const TextureFileDesc& desc, uint32_t firstMip, uint32_t lastMip);
@@ -0,0 +1,543 @@
+#include "TextureStreamer.h"
+
+#include "Nutcrackz/Core/FrameArenas.h"
+#include "Nutcrackz/Renderer/DirectX12Helpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// Helper functions
+
+namespace
+{
+DXGI_FORMAT GetDxgiFormat(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8: return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case TextureFormat::RGBA8_SRGB: return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+    case TextureFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+    case TextureFormat::BC1_SRGB: return DXGI_FORMAT_BC1_UNORM_SRGB;
+    case TextureFormat::BC2: return DXGI_FORMAT_BC2_UNORM;
+    case TextureFormat::BC2_SRGB: return DXGI_FORMAT_BC2_UNORM_SRGB;
+    case TextureFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+    case TextureFormat::BC3_SRGB: return DXGI_FORMAT_BC3_UNORM_SRGB;
+    case TextureFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+    case TextureFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+    case TextureFormat::BC6H: return DXGI_FORMAT_BC6H_UF16;
+    case TextureFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+    case TextureFormat::BC7_SRGB: return DXGI_FORMAT_BC7_UNORM_SRGB;
+    default: return DXGI_FORMAT_UNKNOWN;
+    }
+}
+}
+
+// Texture Streaming
+
+TextureStreamer::TextureStreamer(ID3D12Device* device, ThreadPool& threadPool, FenceTimeline& fenceTimeline, BindlessDescriptorHeap& bindlessHeap, ResidencyManager& residencyManager, uint64_t budgetBytes)
+    : m_Device(device), m_ThreadPool(threadPool), m_FenceTimeline(fenceTimeline), m_BindlessHeap(bindlessHeap), m_ResidencyManager(residencyManager),
+      m_DescriptorTable(device, fenceTimeline, sizeof(uint32_t), s_MaxTextures, L"Texture Descriptor Table"), m_BudgetBytes(budgetBytes)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.NumDescriptors = s_MaxTextures;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    ThrowIfFailed(m_Device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_SrvHeap)));
+    m_SrvHeap->SetName(L"Texture Streaming SRV Heap");
+
+    m_SrvDescriptorSize = m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    m_Textures.reserve(s_MaxTextures);
+    m_Stats.BudgetBytes = m_BudgetBytes;
+
+    // Handles that were never loaded must not index the heap
+    for (TextureHandle handle = 0; handle < s_MaxTextures; ++handle)
+        m_DescriptorTable.Update(handle, s_InvalidDescriptor);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    // Reads in flight still reference this streamer
+    m_ThreadPool.WaitIdle();
+
+    for (StreamedTexture& texture : m_Textures)
+    {
+        if (texture.Residency != s_InvalidResidency)
+            m_ResidencyManager.Untrack(texture.Residency);
+
+        m_FenceTimeline.Release(texture.Resource);
+        texture.Resource = nullptr;
+
+        m_BindlessHeap.Free(texture.BindlessIndex);
+        texture.BindlessIndex = s_InvalidDescriptor;
+    }
+
+    if (m_SrvHeap)
+    {
+        m_SrvHeap->Release();
+        m_SrvHeap = nullptr;
+    }
+}
+
+TextureHandle TextureStreamer::Load(const std::string& path)
+{
+    if (m_FreeHandles.empty() && m_Textures.size() >= s_MaxTextures)
+        throw std::runtime_error("too many streamed textures!");
+
+    StreamedTexture texture;
+    texture.Desc = ReadTextureFileDesc(path);
+
+    if (GetDxgiFormat(texture.Desc.Format) == DXGI_FORMAT_UNKNOWN)
+        throw std::runtime_error("unsupported texture format!");
+
+    const uint32_t mipCount = static_cast<uint32_t>(texture.Desc.Mips.size());
+
+    // The tail starts at the first mip that is small enough to always keep
+    texture.TailMip = mipCount - 1;
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        const TextureMip& level = texture.Desc.Mips[mip];
+
+        if (std::max(level.Width, level.Height) <= s_TailMipSize)
+        {
+            texture.TailMip = mip;
+            break;
+        }
+    }
+
+    texture.ResidentMip = mipCount;
+    texture.DesiredMip = texture.TailMip;
+    texture.Loaded = true;
+
+    TextureHandle handle;
+    if (!m_FreeHandles.empty())
+    {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+
+        texture.Generation = m_Textures[handle].Generation;
+        m_Textures[handle] = std::move(texture);
+    }
+    else
+    {
+        handle = static_cast<TextureHandle>(m_Textures.size());
+        m_Textures.push_back(std::move(texture));
+    }
+
+    WriteDescriptor(handle);
+
+    // The tail is needed no matter what, so it bypasses the budget
+    QueueRead(handle, m_Textures[handle].TailMip, mipCount - 1);
+
+    return handle;
+}
+
+void TextureStreamer::Unload(TextureHandle texture)
+{
+    if (texture >= m_Textures.size() || !m_Textures[texture].Loaded)
+        return;
+
+    StreamedTexture& streamed = m_Textures[texture];
+
+    // A read still in flight is dropped when it completes, its bytes are
+    // given back now
+    m_Stats.ResidentBytes -= GetChainBytes(streamed, streamed.ResidentMip) + streamed.PendingBytes;
+
+    if (streamed.Residency != s_InvalidResidency)
+        m_ResidencyManager.Untrack(streamed.Residency);
+
+    // Frames recorded so far may still sample it
+    m_FenceTimeline.Release(streamed.Resource);
+    m_BindlessHeap.Free(streamed.BindlessIndex);
+
+    StreamedTexture unloaded;
+    unloaded.Generation = streamed.Generation + 1;
+    streamed = std::move(unloaded);
+
+    WriteDescriptor(texture);
+    m_FreeHandles.push_back(texture);
+}
+
+void TextureStreamer::RequestScreenSize(TextureHandle texture, float screenPixels)
+{
+    if (texture >= m_Textures.size() || !m_Textures[texture].Loaded)
+        return;
+
+    StreamedTexture& streamed = m_Textures[texture];
+
+    // One texel per pixel: every mip above that is wasted on this frame.
+    uint32_t mip = streamed.TailMip;
+    if (screenPixels > 0.0f)
+    {
+        const float texels = static_cast<float>(std::max(streamed.Desc.Width, streamed.Desc.Height));
+        const float level = std::floor(std::log2(std::max(texels / screenPixels, 1.0f)));
+        mip = std::min(static_cast<uint32_t>(level), streamed.TailMip);
+    }
+
+    if (streamed.LastUsedFrame != m_FrameNumber)
+    {
+        streamed.LastUsedFrame = m_FrameNumber;
+        streamed.DesiredMip = mip;
+    }
+    else
+    {
+        streamed.DesiredMip = std::min(streamed.DesiredMip, mip);
+    }
+}
+
+void TextureStreamer::Update(ID3D12GraphicsCommandList* commandList)
+{
+    m_Stats.EvictedMips = 0;
+
+    // Upload mips that finished reading
+    {
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        m_Uploading.swap(m_Completed);
+    }
+
+    for (CompletedRead& read : m_Uploading)
+    {
+        StreamedTexture& texture = m_Textures[read.Texture];
+        m_Stats.PendingRequests--;
+
+        // The texture was unloaded while reading, Unload gave the bytes back
+        if (read.Generation != texture.Generation)
+            continue;
+
+        texture.Pending = false;
+
+        if (!read.Error.empty())
+        {
+            std::cout << "Failed to stream " << texture.Desc.Path << ": " << read.Error << "\n";
+            m_Stats.ResidentBytes -= texture.PendingBytes;
+            texture.PendingBytes = 0;
+            texture.Failed = true;
+            continue;
+        }
+
+        texture.PendingBytes = 0;
+
+        Reallocate(commandList, read.Texture, read.FirstMip, &read.Data);
+    }
+
+    m_Uploading.clear();
+
+    // Gather textures that want more detail than they have, biggest deficit
+    // first so the most visibly blurry textures are served before the rest.
+    ArenaVector<TextureHandle> requests = FrameArenas::MakeVector<TextureHandle>(m_Textures.size(), MemoryTag::Textures);
+    uint64_t requestedBytes = 0;
+
+    for (TextureHandle handle = 0; handle < m_Textures.size(); ++handle)
+    {
+        const StreamedTexture& texture = m_Textures[handle];
+        if (!texture.Loaded)
+            continue;
+
+        const uint32_t demanded = GetDemandedMip(texture);
+
+        requestedBytes += GetChainBytes(texture, demanded);
+
+        if (!texture.Pending && !texture.Failed && demanded < texture.ResidentMip)
+            requests.push_back(handle);
+    }
+
+    std::sort(requests.begin(), requests.end(), [this](TextureHandle a, TextureHandle b) {
+        const StreamedTexture& ta = m_Textures[a];
+        const StreamedTexture& tb = m_Textures[b];
+        return ta.ResidentMip - GetDemandedMip(ta) > tb.ResidentMip - GetDemandedMip(tb);
+    });
+
+    for (TextureHandle handle : requests)
+    {
+        const StreamedTexture& texture = m_Textures[handle];
+        const uint64_t residentBytes = GetChainBytes(texture, texture.ResidentMip);
+
+        // If the budget can't fit the whole request, settle for fewer mips
+        for (uint32_t mip = GetDemandedMip(texture); mip < texture.ResidentMip; ++mip)
+        {
+            if (MakeRoom(commandList, GetChainBytes(texture, mip) - residentBytes, handle))
+            {
+                QueueRead(handle, mip, texture.ResidentMip - 1);
+                break;
+            }
+        }
+    }
+
+    // Requested textures are what this frame samples, the rest may be evicted
+    for (const StreamedTexture& texture : m_Textures)
+    {
+        if (texture.Residency != s_InvalidResidency && texture.LastUsedFrame == m_FrameNumber)
+            m_ResidencyManager.Use(texture.Residency);
+    }
+
+    // Shaders see this frame's descriptors
+    m_DescriptorTable.Upload(commandList);
+
+    m_Stats.RequestedBytes = requestedBytes;
+    m_Stats.BudgetBytes = m_BudgetBytes;
+    m_Stats.BudgetPressure = m_BudgetBytes > 0 ? static_cast<float>(double(requestedBytes) / double(m_BudgetBytes)) : 0.0f;
+
+    m_FrameNumber++;
+}
+
+void TextureStreamer::SetBudget(uint64_t budgetBytes)
+{
+    m_BudgetBytes = budgetBytes;
+    m_Stats.BudgetBytes = budgetBytes;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE TextureStreamer::GetDescriptor(TextureHandle texture) const
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE handle(m_SrvHeap->GetCPUDescriptorHandleForHeapStart());
+    handle.ptr += SIZE_T(texture) * m_SrvDescriptorSize;
+
+    return handle;
+}
+
+uint32_t TextureStreamer::GetResidentMip(TextureHandle texture) const
+{
+    return m_Textures[texture].ResidentMip;
+}
+
+uint64_t TextureStreamer::GetChainBytes(const StreamedTexture& texture, uint32_t mip) const
+{
+    uint64_t bytes = 0;
+    for (size_t level = mip; level < texture.Desc.Mips.size(); ++level)
+        bytes += texture.Desc.Mips[level].Size;
+
+    return bytes;
+}
+
+uint32_t TextureStreamer::GetDemandedMip(const StreamedTexture& texture) const
+{
+    return texture.LastUsedFrame == m_FrameNumber ? texture.DesiredMip : texture.TailMip;
+}
+
+void TextureStreamer::QueueRead(TextureHandle texture, uint32_t firstMip, uint32_t lastMip)
+{
+    StreamedTexture& streamed = m_Textures[texture];
+    streamed.Pending = true;
+    streamed.PendingBytes = GetChainBytes(streamed, firstMip) - GetChainBytes(streamed, lastMip + 1);
+
+    m_Stats.ResidentBytes += streamed.PendingBytes;
+    m_Stats.PendingRequests++;
+
+    // The read gets its own copy of the description, the texture array may
+    // grow while the job runs.
+    m_ThreadPool.Submit([this, texture, generation = streamed.Generation, firstMip, lastMip, desc = streamed.Desc]() {
+        CompletedRead read;
+        read.Texture = texture;
+        read.Generation = generation;
+        read.FirstMip = firstMip;
+        read.LastMip = lastMip;
+
+        try
+        {
+            read.Data = ReadTextureMips(desc, firstMip, lastMip);
+        }
+        catch (std::exception& e)
+        {
+            read.Error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        m_Completed.push_back(std::move(read));
+    });
+}
+
+bool TextureStreamer::MakeRoom(ID3D12GraphicsCommandList* commandList, uint64_t bytes, TextureHandle requester)
+{
+    if (m_Stats.ResidentBytes + bytes <= m_BudgetBytes)
+        return true;
+
+    // Candidates hold more detail than this frame asks of them
+    ArenaVector<TextureHandle> victims = FrameArenas::MakeVector<TextureHandle>(m_Textures.size(), MemoryTag::Textures);
+    for (TextureHandle handle = 0; handle < m_Textures.size(); ++handle)
+    {
+        const StreamedTexture& texture = m_Textures[handle];
+
+        if (handle != requester && texture.Loaded && !texture.Pending && texture.ResidentMip < GetDemandedMip(texture))
+            victims.push_back(handle);
+    }
+
+    std::sort(victims.begin(), victims.end(), [this](TextureHandle a, TextureHandle b) {
+        return m_Textures[a].LastUsedFrame < m_Textures[b].LastUsedFrame;
+    });
+
+    for (TextureHandle handle : victims)
+    {
+        if (m_Stats.ResidentBytes + bytes <= m_BudgetBytes)
+            break;
+
+        const StreamedTexture& texture = m_Textures[handle];
+        const uint32_t demanded = GetDemandedMip(texture);
+
+        m_Stats.EvictedMips += demanded - texture.ResidentMip;
+        Reallocate(commandList, handle, demanded, nullptr);
+    }
+
+    return m_Stats.ResidentBytes + bytes <= m_BudgetBytes;
+}
+
+void TextureStreamer::Reallocate(ID3D12GraphicsCommandList* commandList, TextureHandle texture, uint32_t residentMip, const std::vector<uint8_t>* data)
+{
+    StreamedTexture& streamed = m_Textures[texture];
+    const TextureFileDesc& desc = streamed.Desc;
+    const uint32_t mipCount = static_cast<uint32_t>(desc.Mips.size());
+    const uint32_t oldResidentMip = streamed.ResidentMip;
+    ID3D12Resource* oldResource = streamed.Resource;
+
+    // Evicting only changes the accounting here, streamed in mips were
+    // accounted for when their read was queued.
+    if (residentMip > oldResidentMip)
+        m_Stats.ResidentBytes -= GetChainBytes(streamed, oldResidentMip) - GetChainBytes(streamed, residentMip);
+
+    D3D12_HEAP_PROPERTIES heapProps;
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProps.CreationNodeMask = 1;
+    heapProps.VisibleNodeMask = 1;
+
+    D3D12_RESOURCE_DESC textureDesc = {};
+    textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    textureDesc.Alignment = 0;
+    textureDesc.Width = desc.Mips[residentMip].Width;
+    textureDesc.Height = desc.Mips[residentMip].Height;
+    textureDesc.DepthOrArraySize = 1;
+    textureDesc.MipLevels = static_cast<UINT16>(mipCount - residentMip);
+    textureDesc.Format = GetDxgiFormat(desc.Format);
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+    ID3D12Resource* resource = nullptr;
+    ThrowIfFailed(m_Device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &textureDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&resource)));
+    resource->SetName(L"Streamed Texture");
+
+    // The copies below read the old resource, it may have been evicted
+    if (streamed.Residency != s_InvalidResidency)
+    {
+        m_ResidencyManager.MakeResident(streamed.Residency);
+        m_ResidencyManager.Untrack(streamed.Residency);
+    }
+
+    streamed.Residency = m_ResidencyManager.Track(resource, m_Device->GetResourceAllocationInfo(0, 1, &textureDesc).SizeInBytes);
+    m_ResidencyManager.Use(streamed.Residency);
+
+    // Keep the mips both copies share
+    if (oldResource)
+    {
+        D3D12_RESOURCE_BARRIER barrier = TransitionBarrier(oldResource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        commandList->ResourceBarrier(1, &barrier);
+
+        for (uint32_t mip = std::max(residentMip, oldResidentMip); mip < mipCount; ++mip)
+        {
+            D3D12_TEXTURE_COPY_LOCATION dst = {};
+            dst.pResource = resource;
+            dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            dst.SubresourceIndex = mip - residentMip;
+
+            D3D12_TEXTURE_COPY_LOCATION src = {};
+            src.pResource = oldResource;
+            src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            src.SubresourceIndex = mip - oldResidentMip;
+
+            commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+        }
+
+        m_FenceTimeline.Release(oldResource);
+    }
+
+    // Upload the newly read mips, data holds [residentMip, oldResidentMip)
+    if (data && residentMip < oldResidentMip)
+    {
+        const UINT uploadCount = oldResidentMip - residentMip;
+
+        ScopedStack stack;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT* layouts = stack.Allocate<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>(uploadCount, MemoryTag::Textures);
+        UINT* rowCounts = stack.Allocate<UINT>(uploadCount, MemoryTag::Textures);
+        UINT64* rowSizes = stack.Allocate<UINT64>(uploadCount, MemoryTag::Textures);
+        UINT64 uploadSize = 0;
+
+        m_Device->GetCopyableFootprints(&textureDesc, 0, uploadCount, 0, layouts, rowCounts, rowSizes, &uploadSize);
+
+        ID3D12Resource* uploadBuffer = CreateBufferResource(m_Device, D3D12_HEAP_TYPE_UPLOAD, uploadSize, D3D12_RESOURCE_STATE_GENERIC_READ);
+
+        UINT8* mapped = nullptr;
+        D3D12_RANGE readRange;
+        readRange.Begin = 0;
+        readRange.End = 0;
+        ThrowIfFailed(uploadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+
+        const uint8_t* src = data->data();
+        for (UINT i = 0; i < uploadCount; ++i)
+        {
+            const TextureMip& level = desc.Mips[residentMip + i];
+            const uint32_t srcRowPitch = GetRowPitch(desc.Format, level.Width);
+
+            // File rows are tightly packed, upload rows are 256 byte aligned
+            for (UINT row = 0; row < rowCounts[i]; ++row)
+                memcpy(mapped + layouts[i].Offset + UINT64(row) * layouts[i].Footprint.RowPitch, src + UINT64(row) * srcRowPitch, srcRowPitch);
+
+            src += level.Size;
+
+            D3D12_TEXTURE_COPY_LOCATION dst = {};
+            dst.pResource = resource;
+            dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            dst.SubresourceIndex = i;
+
+            D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+            srcLocation.pResource = uploadBuffer;
+            srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            srcLocation.PlacedFootprint = layouts[i];
+
+            commandList->CopyTextureRegion(&dst, 0, 0, 0, &srcLocation, nullptr);
+        }
+
+        uploadBuffer->Unmap(0, nullptr);
+        m_FenceTimeline.Release(uploadBuffer);
+    }
+
+    D3D12_RESOURCE_BARRIER barrier = TransitionBarrier(resource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    commandList->ResourceBarrier(1, &barrier);
+
+    streamed.Resource = resource;
+    streamed.ResidentMip = residentMip;
+
+    WriteDescriptor(texture);
+}
+
+void TextureStreamer::WriteDescriptor(TextureHandle texture)
+{
+    StreamedTexture& streamed = m_Textures[texture];
+
+    if (!streamed.Loaded)
+    {
+        m_DescriptorTable.Update(texture, s_InvalidDescriptor);
+        return;
+    }
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = GetDxgiFormat(streamed.Desc.Format);
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.MipLevels = streamed.Resource ? UINT(streamed.Desc.Mips.size() - streamed.ResidentMip) : 1;
+    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+
+    // A null resource gives a valid descriptor that samples as black until
+    // the tail arrives.
+    m_Device->CreateShaderResourceView(streamed.Resource, &srvDesc, GetDescriptor(texture));
+
+    // Frames in flight keep reading the old slot, this frame's table points
+    // at the new one
+    m_BindlessHeap.Free(streamed.BindlessIndex);
+    streamed.BindlessIndex = m_BindlessHeap.Allocate();
+    m_BindlessHeap.Copy(streamed.BindlessIndex, GetDescriptor(texture));
+
+    m_DescriptorTable.Update(texture, streamed.BindlessIndex);
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+#include "CrossWindow/Graphics.h"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+#include "Nutcrackz/Renderer/BindlessDescriptorHeap.h"
+#include "Nutcrackz/Renderer/FenceTimeline.h"
+#include "Nutcrackz/Renderer/PersistentBuffer.h"
+#include "Nutcrackz/Renderer/ResidencyManager.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+#include "Nutcrackz/Renderer/TextureFile.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Texture Streaming
+
+// Loads DDS/KTX2 textures with only their low resolution mip tail resident,
+// then streams finer mips in and out based on how large each texture is on
+// screen. The most detailed mips are read from disk on the thread pool and
+// uploaded on the render thread. When resident memory would exceed the budget
+// the least recently used textures give up their finest mips first.
+//
+// Residency changes reallocate the texture with the new mip count and copy
+// the mips that stay resident, so the memory saved is real rather than just
+// a clamped view. Replaced and unloaded resources are released through the
+// fence timeline once the GPU is done with them.
+//
+// Every reallocation also moves the texture to a new bindless descriptor.
+// Shaders find it through the descriptor table, a buffer indexed by texture
+// handle that holds each texture's current bindless index.
+//
+// Texture resources are under residency management. A texture without a
+// screen size request this frame counts as unused and may be evicted from
+// video memory when the OS budget runs short, so every texture a frame
+// samples has to be requested.
+class TextureStreamer
+{
+  public:
+    TextureStreamer(ID3D12Device* device, ThreadPool& threadPool, FenceTimeline& fenceTimeline, BindlessDescriptorHeap& bindlessHeap, ResidencyManager& residencyManager, uint64_t budgetBytes);
+
+    ~TextureStreamer();
+
+    // Read the texture's header and queue its mip tail for upload
+    TextureHandle Load(const std::string& path);
+
+    // Free the texture's memory once the GPU stops using it, the handle may
+    // be reused by a later Load
+    void Unload(TextureHandle texture);
+
+    // Report the texture's on screen size (in pixels along its largest axis)
+    // for this frame. The largest report of the frame wins.
+    void RequestScreenSize(TextureHandle texture, float screenPixels);
+
+    // Upload finished reads, evict over budget, queue new reads and upload the
+    // changed descriptor table entries. Copies are recorded into commandList,
+    // which must be submitted before the fence timeline's next signal.
+    void Update(ID3D12GraphicsCommandList* commandList);
+
+    void SetBudget(uint64_t budgetBytes);
+
+    // Non shader visible SRV describing the resident mips of the texture
+    D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptor(TextureHandle texture) const;
+
+    // Most detailed mip currently resident, mip count if nothing is
+    uint32_t GetResidentMip(TextureHandle texture) const;
+
+    // Buffer of s_MaxTextures bindless indices, s_InvalidDescriptor for
+    // handles without a texture
+    D3D12_GPU_VIRTUAL_ADDRESS GetDescriptorTableAddress() const { return m_DescriptorTable.GetGpuAddress(); }
+
+    const TextureStreamingStats& GetStats() const { return m_Stats; }
+
+    static const uint32_t s_MaxTextures = 1024;
+
+    // Mips whose largest side is at or below this are loaded up front and
+    // never evicted
+    static const uint32_t s_TailMipSize = 64;
+
+  protected:
+    struct StreamedTexture
+    {
+        TextureFileDesc Desc;
+        ID3D12Resource* Resource = nullptr;
+
+        uint32_t ResidentMip = 0;
+        uint32_t TailMip = 0;
+        uint32_t DesiredMip = 0;
+        uint64_t LastUsedFrame = 0;
+
+        // Bytes accounted for by the read in flight
+        uint64_t PendingBytes = 0;
+
+        // Slot in the bindless heap holding the current descriptor
+        uint32_t BindlessIndex = s_InvalidDescriptor;
+
+        ResidencyHandle Residency = s_InvalidResidency;
+
+        // Incremented on unload so reads for a previous texture in this slot
+        // are recognised
+        uint32_t Generation = 0;
+
+        bool Loaded = false;
+        bool Pending = false;
+        bool Failed = false;
+    };
+
+    struct CompletedRead
+    {
+        TextureHandle Texture;
+        uint32_t Generation;
+        uint32_t FirstMip;
+        uint32_t LastMip;
+        std::vector<uint8_t> Data;
+        std::string Error;
+    };
+
+    // Bytes of the mip chain starting at mip
+    uint64_t GetChainBytes(const StreamedTexture& texture, uint32_t mip) const;
+
+    // The mip this frame's demand asks for, the tail if it wasn't used
+    uint32_t GetDemandedMip(const StreamedTexture& texture) const;
+
+    void QueueRead(TextureHandle texture, uint32_t firstMip, uint32_t lastMip);
+
+    // Evict least recently used mips until bytes more fit in the budget
+    bool MakeRoom(ID3D12GraphicsCommandList* commandList, uint64_t bytes, TextureHandle requester);
+
+    // Recreate the texture holding mips [residentMip, mip count), copying mips
+    // that stay resident and uploading the rest from data
+    void Reallocate(ID3D12GraphicsCommandList* commandList, TextureHandle texture, uint32_t residentMip, const std::vector<uint8_t>* data);
+
+    void WriteDescriptor(TextureHandle texture);
+
+    ID3D12Device* m_Device;
+    ThreadPool& m_ThreadPool;
+    FenceTimeline& m_FenceTimeline;
+    BindlessDescriptorHeap& m_BindlessHeap;
+    ResidencyManager& m_ResidencyManager;
+
+    // Texture handle to bindless index
+    PersistentBuffer m_DescriptorTable;
+
+    ID3D12DescriptorHeap* m_SrvHeap;
+    UINT m_SrvDescriptorSize;
+
+    std::vector<StreamedTexture> m_Textures;
+    std::vector<TextureHandle> m_FreeHandles;
+
+    std::mutex m_CompletedMutex;
+    std::vector<CompletedRead> m_Completed;
+
+    // Swapped with m_Completed by Update, the two keep their capacity
+    std::vector<CompletedRead> m_Uploading;
+
+    uint64_t m_BudgetBytes;
+    uint64_t m_FrameNumber = 1;
+
+    TextureStreamingStats m_Stats;
+};
@@ -0,0 +1,65 @@
+#include "VulkanClusteredLighting.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// Clustered Lighting
+
+VulkanClusteredLighting::VulkanClusteredLighting(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline, uint32_t frameCount, const ClusterGridDesc& desc)
+    : m_Device(device), m_PhysicalDevice(physicalDevice), m_FenceTimeline(fenceTimeline), m_Binner(desc)
+{
+    m_Frames.resize(frameCount);
+
+    // Descriptors need a buffer even while there are no lights
+    for (FrameBuffers& frame : m_Frames)
+    {
+        Write(frame.Lights, nullptr, 0);
+        Write(frame.Clusters, nullptr, 0);
+        Write(frame.LightIndices, nullptr, 0);
+    }
+}
+
+VulkanClusteredLighting::~VulkanClusteredLighting()
+{
+    // Frames already submitted may still read them
+    for (FrameBuffers& frame : m_Frames)
+    {
+        m_FenceTimeline.Release(frame.Lights);
+        m_FenceTimeline.Release(frame.Clusters);
+        m_FenceTimeline.Release(frame.LightIndices);
+    }
+
+    m_Frames.clear();
+}
+
+void VulkanClusteredLighting::Update(uint32_t frame, const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection, ThreadPool& threadPool)
+{
+    m_Binner.Bin(lights, view, projection, threadPool);
+
+    FrameBuffers& buffers = m_Frames[frame];
+
+    const std::vector<ClusterLight>& clusterLights = m_Binner.GetLights();
+    const std::vector<ClusterRange>& ranges = m_Binner.GetClusterRanges();
+    const std::vector<uint32_t>& indices = m_Binner.GetLightIndices();
+
+    Write(buffers.Lights, clusterLights.data(), clusterLights.size() * sizeof(ClusterLight));
+    Write(buffers.Clusters, ranges.data(), ranges.size() * sizeof(ClusterRange));
+    Write(buffers.LightIndices, indices.data(), indices.size() * sizeof(uint32_t));
+}
+
+void VulkanClusteredLighting::Write(VulkanBuffer& buffer, const void* data, uint64_t size)
+{
+    if (buffer.Buffer == VK_NULL_HANDLE || size > buffer.Size)
+    {
+        // The old buffer is still read by the last frame that used it
+        m_FenceTimeline.Release(buffer);
+
+        const uint64_t minSize = s_MinBufferSize;
+        buffer = CreateBuffer(m_Device, m_PhysicalDevice, std::max(std::bit_ceil(size), minSize), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    }
+
+    if (size > 0)
+        memcpy(buffer.Mapped, data, size);
+}
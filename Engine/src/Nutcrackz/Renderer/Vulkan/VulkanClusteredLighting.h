@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Nutcrackz/Core/ThreadPool.h"
+#include "Nutcrackz/Renderer/LightBinner.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanFenceTimeline.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanHelpers.h"
+
+#include <vector>
+
+// Clustered Lighting
+
+// The Vulkan counterpart of ClusteredLighting. Bins the frame's lights with
+// LightBinner and writes the lights, the per cluster ranges and the light
+// index list into host visible storage buffers the fragment shader reads.
+// Everything is rewritten every frame, so each frame in flight gets its own
+// buffers, grown when a frame needs more.
+//
+// Render thread only.
+class VulkanClusteredLighting
+{
+  public:
+    VulkanClusteredLighting(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline, uint32_t frameCount, const ClusterGridDesc& desc = ClusterGridDesc());
+
+    ~VulkanClusteredLighting();
+
+    VulkanClusteredLighting(const VulkanClusteredLighting&) = delete;
+    VulkanClusteredLighting& operator=(const VulkanClusteredLighting&) = delete;
+
+    // Bin and write frame's buffers. The last frame that used them must have
+    // completed on the GPU.
+    void Update(uint32_t frame, const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection, ThreadPool& threadPool);
+
+    // Change when a frame's buffer grows, descriptors have to be written
+    // again
+    const VulkanBuffer& GetLightBuffer(uint32_t frame) const { return m_Frames[frame].Lights; }
+    const VulkanBuffer& GetClusterBuffer(uint32_t frame) const { return m_Frames[frame].Clusters; }
+    const VulkanBuffer& GetLightIndexBuffer(uint32_t frame) const { return m_Frames[frame].LightIndices; }
+
+    // Constants for a frame rendered at width by height pixels
+    ClusterConstants GetConstants(uint32_t width, uint32_t height) const { return m_Binner.GetConstants(width, height); }
+
+    const LightBinningStats& GetStats() const { return m_Binner.GetStats(); }
+
+  protected:
+    struct FrameBuffers
+    {
+        VulkanBuffer Lights;
+        VulkanBuffer Clusters;
+        VulkanBuffer LightIndices;
+    };
+
+    // Copy data into buffer, replacing it with a larger one if needed
+    void Write(VulkanBuffer& buffer, const void* data, uint64_t size);
+
+    VkDevice m_Device;
+    VkPhysicalDevice m_PhysicalDevice;
+    VulkanFenceTimeline& m_FenceTimeline;
+
+    LightBinner m_Binner;
+    std::vector<FrameBuffers> m_Frames;
+
+    static const uint64_t s_MinBufferSize = 64 * 1024;
+};
@@ -0,0 +1,189 @@
+#include "VulkanFenceTimeline.h"
+
+#include <algorithm>
+
+// Fence Timeline
+
+VulkanFenceTimeline::VulkanFenceTimeline(VkDevice device, VkQueue queue)
+    : m_Device(device), m_Queue(queue), m_Semaphore(VK_NULL_HANDLE), m_NextValue(1)
+{
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    ThrowIfFailed(vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_Semaphore));
+}
+
+VulkanFenceTimeline::~VulkanFenceTimeline()
+{
+    WaitForIdle();
+
+    if (m_Semaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_Device, m_Semaphore, nullptr);
+        m_Semaphore = VK_NULL_HANDLE;
+    }
+}
+
+uint64_t VulkanFenceTimeline::Submit(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStage, VkSemaphore signalSemaphore)
+{
+    const uint64_t value = m_NextValue.load(std::memory_order_relaxed);
+
+    // Binary semaphores ignore their entry in the value arrays
+    const VkSemaphore signalSemaphores[] = { m_Semaphore, signalSemaphore };
+    const uint64_t signalValues[] = { value, 0 };
+    const uint64_t waitValue = 0;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+    timelineInfo.pWaitSemaphoreValues = &waitValue;
+    timelineInfo.signalSemaphoreValueCount = signalSemaphore != VK_NULL_HANDLE ? 2 : 1;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = timelineInfo.waitSemaphoreValueCount;
+    submitInfo.pWaitSemaphores = &waitSemaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = commandBuffer != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = timelineInfo.signalSemaphoreValueCount;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+
+    ThrowIfFailed(vkQueueSubmit(m_Queue, 1, &submitInfo, VK_NULL_HANDLE));
+    m_NextValue.store(value + 1, std::memory_order_release);
+
+    return value;
+}
+
+uint64_t VulkanFenceTimeline::GetCompletedValue() const
+{
+    uint64_t value = 0;
+    ThrowIfFailed(vkGetSemaphoreCounterValue(m_Device, m_Semaphore, &value));
+    return value;
+}
+
+void VulkanFenceTimeline::ReleaseAfter(VulkanBuffer buffer, uint64_t fenceValue)
+{
+    if (buffer.Buffer == VK_NULL_HANDLE)
+        return;
+
+    PendingWork work;
+    work.FenceValue = fenceValue;
+    work.Buffer = buffer;
+    Enqueue(std::move(work));
+}
+
+void VulkanFenceTimeline::ReleaseAfter(VulkanImage image, uint64_t fenceValue)
+{
+    if (image.Image == VK_NULL_HANDLE)
+        return;
+
+    PendingWork work;
+    work.FenceValue = fenceValue;
+    work.Image = image;
+    Enqueue(std::move(work));
+}
+
+void VulkanFenceTimeline::OnComplete(uint64_t fenceValue, std::function<void()> callback)
+{
+    PendingWork work;
+    work.FenceValue = fenceValue;
+    work.Callback = std::move(callback);
+    Enqueue(std::move(work));
+}
+
+void VulkanFenceTimeline::Poll()
+{
+    const uint64_t completed = GetCompletedValue();
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        while (!m_Pending.empty() && m_Pending.front().FenceValue <= completed)
+        {
+            m_Ready.push_back(std::move(m_Pending.front()));
+            m_Pending.pop_front();
+        }
+    }
+
+    if (m_Ready.empty())
+        return;
+
+    // Run outside the lock, callbacks may queue more work
+    uint64_t released = 0;
+    uint64_t callbacks = 0;
+
+    for (PendingWork& work : m_Ready)
+    {
+        if (work.HasObject())
+        {
+            DestroyBuffer(m_Device, work.Buffer);
+            DestroyImage(m_Device, work.Image);
+            released++;
+        }
+
+        if (work.Callback)
+        {
+            work.Callback();
+            callbacks++;
+        }
+    }
+
+    m_Ready.clear();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.PendingReleases -= static_cast<uint32_t>(released);
+    m_Stats.PendingCallbacks -= static_cast<uint32_t>(callbacks);
+    m_Stats.ReleasedObjects += released;
+    m_Stats.CallbacksRun += callbacks;
+}
+
+void VulkanFenceTimeline::WaitFor(uint64_t fenceValue)
+{
+    if (IsComplete(fenceValue))
+        return;
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_Semaphore;
+    waitInfo.pValues = &fenceValue;
+    ThrowIfFailed(vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX));
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.BlockingWaits++;
+}
+
+void VulkanFenceTimeline::WaitForIdle()
+{
+    WaitFor(Signal());
+    Poll();
+}
+
+FenceTimelineStats VulkanFenceTimeline::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void VulkanFenceTimeline::Enqueue(PendingWork work)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (work.HasObject())
+        m_Stats.PendingReleases++;
+    if (work.Callback)
+        m_Stats.PendingCallbacks++;
+
+    // Work nearly always arrives in fence order, so this is an append
+    auto position = std::upper_bound(m_Pending.begin(), m_Pending.end(), work.FenceValue,
+                                     [](uint64_t value, const PendingWork& pending) { return value < pending.FenceValue; });
+    m_Pending.insert(position, std::move(work));
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Nutcrackz/Renderer/Vulkan/VulkanHelpers.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Fence Timeline
+
+struct FenceTimelineStats
+{
+    // Objects and callbacks waiting for their fence value
+    uint32_t PendingReleases = 0;
+    uint32_t PendingCallbacks = 0;
+
+    uint64_t ReleasedObjects = 0;
+    uint64_t CallbacksRun = 0;
+
+    // Times WaitFor actually had to block the calling thread
+    uint64_t BlockingWaits = 0;
+};
+
+// The Vulkan counterpart of FenceTimeline, on a timeline semaphore. Owns the
+// semaphore and the monotonically increasing values signalled on it by
+// every submission to the queue. Instead of waiting for the GPU whenever
+// something has to be destroyed or reused, work is tied to the fence value
+// of its last GPU use:
+//
+// - Release defers destroying buffers and images until that value has
+//   completed.
+// - OnComplete runs a callback once a value has completed.
+//
+// Both are serviced by Poll, which never blocks and is called once per frame
+// by the render thread. Releases and callbacks may be queued from any thread.
+class VulkanFenceTimeline
+{
+  public:
+    VulkanFenceTimeline(VkDevice device, VkQueue queue);
+
+    // Waits for the queue to go idle and destroys everything still pending
+    ~VulkanFenceTimeline();
+
+    VulkanFenceTimeline(const VulkanFenceTimeline&) = delete;
+    VulkanFenceTimeline& operator=(const VulkanFenceTimeline&) = delete;
+
+    // Submit commandBuffer, or nothing when it is null, and signal the next
+    // value once it has completed. The submission waits for waitSemaphore at
+    // waitStage and signals signalSemaphore too when they are given, for
+    // swapchain images. Returns the signalled value. Render thread only.
+    uint64_t Submit(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore = VK_NULL_HANDLE, VkPipelineStageFlags waitStage = 0, VkSemaphore signalSemaphore = VK_NULL_HANDLE);
+
+    // Signal the next value on the queue and return it. Everything submitted
+    // to the queue before this call has completed once the value has.
+    uint64_t Signal() { return Submit(VK_NULL_HANDLE); }
+
+    // The value the next Signal will use, i.e. the value that covers work
+    // being recorded right now
+    uint64_t GetNextValue() const { return m_NextValue.load(std::memory_order_acquire); }
+
+    uint64_t GetLastSignaledValue() const { return GetNextValue() - 1; }
+
+    uint64_t GetCompletedValue() const;
+
+    bool IsComplete(uint64_t fenceValue) const { return GetCompletedValue() >= fenceValue; }
+
+    // Destroy the buffer or image once fenceValue has completed
+    void ReleaseAfter(VulkanBuffer buffer, uint64_t fenceValue);
+    void ReleaseAfter(VulkanImage image, uint64_t fenceValue);
+
+    // Destroy the buffer or image once the work recorded so far has completed
+    void Release(const VulkanBuffer& buffer) { ReleaseAfter(buffer, GetNextValue()); }
+    void Release(const VulkanImage& image) { ReleaseAfter(image, GetNextValue()); }
+
+    // Run callback from Poll once fenceValue has completed
+    void OnComplete(uint64_t fenceValue, std::function<void()> callback);
+
+    // Destroy objects and run callbacks whose fence value has completed.
+    // Never blocks, call it from one thread only.
+    void Poll();
+
+    // Block until fenceValue has completed. Only for reusing per-frame
+    // resources and shutdown, everything else should use the deferred path.
+    void WaitFor(uint64_t fenceValue);
+
+    // Signal, wait for it and run everything that was pending
+    void WaitForIdle();
+
+    VkSemaphore GetSemaphore() const { return m_Semaphore; }
+
+    FenceTimelineStats GetStats();
+
+  protected:
+    struct PendingWork
+    {
+        uint64_t FenceValue;
+        VulkanBuffer Buffer;
+        VulkanImage Image;
+        std::function<void()> Callback;
+
+        bool HasObject() const { return Buffer.Buffer != VK_NULL_HANDLE || Image.Image != VK_NULL_HANDLE; }
+    };
+
+    // Keeps m_Pending sorted by fence value
+    void Enqueue(PendingWork work);
+
+    VkDevice m_Device;
+    VkQueue m_Queue;
+    VkSemaphore m_Semaphore;
+
+    std::atomic<uint64_t> m_NextValue;
+
+    std::mutex m_Mutex;
+    std::deque<PendingWork> m_Pending;
+
+    // Poll only, reused so steady state polling doesn't allocate
+    std::vector<PendingWork> m_Ready;
+
+    FenceTimelineStats m_Stats;
+};
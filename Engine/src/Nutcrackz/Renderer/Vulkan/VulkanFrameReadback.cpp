@@ -0,0 +1,190 @@
+#include "VulkanFrameReadback.h"
+
+#include "Nutcrackz/Renderer/ImageFile.h"
+
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+// Frame Readback
+
+VulkanFrameReadback::VulkanFrameReadback(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline, ThreadPool& threadPool, uint32_t bufferCount)
+    : m_Device(device), m_PhysicalDevice(physicalDevice), m_FenceTimeline(fenceTimeline), m_ThreadPool(threadPool), m_Buffers(bufferCount)
+{
+}
+
+VulkanFrameReadback::~VulkanFrameReadback()
+{
+    WaitIdle();
+
+    // Nothing on the GPU copies into them any more
+    for (Buffer& buffer : m_Buffers)
+        DestroyBuffer(m_Device, buffer.Readback);
+}
+
+void VulkanFrameReadback::Capture(VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, bool swapRedBlue, const std::string& path)
+{
+    const uint32_t index = WaitForBuffers(false);
+    Buffer& buffer = m_Buffers[index];
+
+    const VkDeviceSize size = VkDeviceSize(width) * height * 4;
+
+    // Free buffers are done on the GPU and with the workers, a small one can
+    // be replaced right away
+    if (buffer.Readback.Size < size)
+    {
+        DestroyBuffer(m_Device, buffer.Readback);
+        buffer.Readback = CreateBuffer(m_Device, m_PhysicalDevice, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    }
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { width, height, 1 };
+
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer.Readback.Buffer, 1, &region);
+
+    // Makes the copy visible to the mapping once the fence value completes
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer.Readback.Buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    const uint64_t fenceValue = m_FenceTimeline.GetNextValue();
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        buffer.Width = width;
+        buffer.Height = height;
+        buffer.SwapRedBlue = swapRedBlue;
+        buffer.Path = path;
+        buffer.FenceValue = fenceValue;
+        buffer.State = BufferState::Copying;
+        m_Stats.Captures++;
+    }
+
+    m_FenceTimeline.OnComplete(fenceValue, [this, index]() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Buffers[index].State = BufferState::Writing;
+        }
+
+        m_ThreadPool.Submit([this, index]() { Write(index); });
+    });
+}
+
+void VulkanFrameReadback::WaitIdle()
+{
+    WaitForBuffers(true);
+}
+
+FrameReadbackStats VulkanFrameReadback::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+uint32_t VulkanFrameReadback::WaitForBuffers(bool all)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    bool waited = false;
+
+    for (;;)
+    {
+        uint32_t free = ~0u;
+        uint32_t oldestCopy = ~0u;
+        bool writing = false;
+
+        for (uint32_t i = 0; i < m_Buffers.size(); ++i)
+        {
+            const Buffer& buffer = m_Buffers[i];
+
+            if (buffer.State == BufferState::Free && free == ~0u)
+                free = i;
+            else if (buffer.State == BufferState::Copying && (oldestCopy == ~0u || buffer.FenceValue < m_Buffers[oldestCopy].FenceValue))
+                oldestCopy = i;
+            else if (buffer.State == BufferState::Writing)
+                writing = true;
+        }
+
+        if (free != ~0u && (!all || (oldestCopy == ~0u && !writing)))
+        {
+            if (waited && !all)
+                m_Stats.BlockingWaits++;
+
+            return free;
+        }
+
+        waited = true;
+
+        // Hand the oldest finished copy to a worker. Polling runs the
+        // callback, which is what moves buffers on to writing.
+        if (oldestCopy != ~0u)
+        {
+            const uint64_t fenceValue = m_Buffers[oldestCopy].FenceValue;
+
+            lock.unlock();
+            m_FenceTimeline.WaitFor(fenceValue);
+            m_FenceTimeline.Poll();
+            lock.lock();
+            continue;
+        }
+
+        m_BufferFreed.wait(lock);
+    }
+}
+
+void VulkanFrameReadback::Write(uint32_t index)
+{
+    Buffer& buffer = m_Buffers[index];
+
+    const auto start = std::chrono::steady_clock::now();
+    bool failed = false;
+
+    const uint32_t rowPitch = buffer.Width * 4;
+
+    try
+    {
+        // Swapchain images are usually BGRA, swizzle in place. The buffer is
+        // overwritten by the next capture anyway.
+        if (buffer.SwapRedBlue)
+        {
+            uint8_t* pixel = buffer.Readback.Mapped;
+            uint8_t* end = pixel + size_t(rowPitch) * buffer.Height;
+            for (; pixel < end; pixel += 4)
+                std::swap(pixel[0], pixel[2]);
+        }
+
+        WritePng(buffer.Path, buffer.Readback.Mapped, buffer.Width, buffer.Height, rowPitch);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << "\n";
+        failed = true;
+    }
+
+    const float writeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    buffer.State = BufferState::Free;
+
+    if (failed)
+        m_Stats.Failed++;
+    else
+        m_Stats.Written++;
+
+    m_Stats.LastWriteMs = writeMs;
+
+    m_BufferFreed.notify_all();
+}
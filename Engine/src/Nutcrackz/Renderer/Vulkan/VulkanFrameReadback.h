@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Nutcrackz/Core/ThreadPool.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanFenceTimeline.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanHelpers.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Frame Readback
+
+// The Vulkan counterpart of FrameReadback. Copies rendered frames back to the
+// CPU and writes them as PNGs, without the GPU ever waiting on the CPU.
+//
+// Capture records a copy of a texture into one of a ring of readback
+// buffers. The buffer is handed to a worker once the fence value of the
+// frame has completed, which encodes the pixels straight from the mapped
+// buffer and writes the file, then returns the buffer to the ring. Only
+// when every buffer is still in use does Capture wait, on the CPU side.
+class VulkanFrameReadback
+{
+  public:
+    VulkanFrameReadback(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline, ThreadPool& threadPool, uint32_t bufferCount);
+
+    // Waits for every capture to be written
+    ~VulkanFrameReadback();
+
+    VulkanFrameReadback(const VulkanFrameReadback&) = delete;
+    VulkanFrameReadback& operator=(const VulkanFrameReadback&) = delete;
+
+    // Record a copy of an RGBA8 image, or BGRA8 when swapRedBlue is set, in
+    // the transfer source layout. It is written to path once the work
+    // recorded so far has completed. Render thread only.
+    void Capture(VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, bool swapRedBlue, const std::string& path);
+
+    // Block until every capture so far has been written. Render thread only.
+    void WaitIdle();
+
+    FrameReadbackStats GetStats();
+
+  protected:
+    enum class BufferState
+    {
+        Free,
+
+        // Waiting for the GPU to finish the copy
+        Copying,
+
+        // With a worker
+        Writing,
+    };
+
+    struct Buffer
+    {
+        // Persistently mapped, tightly packed rows
+        VulkanBuffer Readback;
+
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        bool SwapRedBlue = false;
+
+        std::string Path;
+        uint64_t FenceValue = 0;
+        BufferState State = BufferState::Free;
+    };
+
+    // Wait until a buffer is free, or until all are when all is set.
+    // Returns a free buffer.
+    uint32_t WaitForBuffers(bool all);
+
+    // Runs on a worker
+    void Write(uint32_t buffer);
+
+    VkDevice m_Device;
+    VkPhysicalDevice m_PhysicalDevice;
+    VulkanFenceTimeline& m_FenceTimeline;
+    ThreadPool& m_ThreadPool;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_BufferFreed;
+    std::vector<Buffer> m_Buffers;
+
+    FrameReadbackStats m_Stats;
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <stdexcept>
+#include <string>
+
+// Helper functions shared by the Vulkan renderer and its subsystems
+
+inline void ThrowIfFailed(VkResult result)
+{
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("Vulkan call failed with VkResult " + std::to_string(result) + "!");
+}
+
+// First memory type allowed by typeBits that has all of properties
+inline uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties)
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        if ((typeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    }
+
+    throw std::runtime_error("No suitable Vulkan memory type!");
+}
+
+// A buffer with its own dedicated allocation. Host visible buffers are
+// mapped for their whole lifetime when mapped is given.
+struct VulkanBuffer
+{
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    uint8_t* Mapped = nullptr;
+    VkDeviceSize Size = 0;
+};
+
+inline VulkanBuffer CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+{
+    VulkanBuffer buffer;
+    buffer.Size = size;
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ThrowIfFailed(vkCreateBuffer(device, &bufferInfo, nullptr, &buffer.Buffer));
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, buffer.Buffer, &requirements);
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = requirements.size;
+    allocateInfo.memoryTypeIndex = FindMemoryType(physicalDevice, requirements.memoryTypeBits, properties);
+    ThrowIfFailed(vkAllocateMemory(device, &allocateInfo, nullptr, &buffer.Memory));
+    ThrowIfFailed(vkBindBufferMemory(device, buffer.Buffer, buffer.Memory, 0));
+
+    // Host visible memory may stay mapped, coherent memory needs no flushes
+    if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        ThrowIfFailed(vkMapMemory(device, buffer.Memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&buffer.Mapped)));
+
+    return buffer;
+}
+
+inline void DestroyBuffer(VkDevice device, VulkanBuffer& buffer)
+{
+    if (buffer.Buffer != VK_NULL_HANDLE)
+        vkDestroyBuffer(device, buffer.Buffer, nullptr);
+
+    // Freeing memory unmaps it
+    if (buffer.Memory != VK_NULL_HANDLE)
+        vkFreeMemory(device, buffer.Memory, nullptr);
+
+    buffer = VulkanBuffer();
+}
+
+// A 2D image with its own dedicated allocation and a view of all its mips
+struct VulkanImage
+{
+    VkImage Image = VK_NULL_HANDLE;
+    VkImageView View = VK_NULL_HANDLE;
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+};
+
+inline VulkanImage CreateImage(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage)
+{
+    VulkanImage image;
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = { width, height, 1 };
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    ThrowIfFailed(vkCreateImage(device, &imageInfo, nullptr, &image.Image));
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device, image.Image, &requirements);
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = requirements.size;
+    allocateInfo.memoryTypeIndex = FindMemoryType(physicalDevice, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    ThrowIfFailed(vkAllocateMemory(device, &allocateInfo, nullptr, &image.Memory));
+    ThrowIfFailed(vkBindImageMemory(device, image.Image, image.Memory, 0));
+
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image.Image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+    ThrowIfFailed(vkCreateImageView(device, &viewInfo, nullptr, &image.View));
+
+    return image;
+}
+
+inline void DestroyImage(VkDevice device, VulkanImage& image)
+{
+    if (image.View != VK_NULL_HANDLE)
+        vkDestroyImageView(device, image.View, nullptr);
+
+    if (image.Image != VK_NULL_HANDLE)
+        vkDestroyImage(device, image.Image, nullptr);
+
+    if (image.Memory != VK_NULL_HANDLE)
+        vkFreeMemory(device, image.Memory, nullptr);
+
+    image = VulkanImage();
+}
+
+// Layout transition of every mip of a color image. The access masks follow
+// from the layouts, which covers every transition the renderer makes.
+inline void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout before, VkImageLayout after)
+{
+    auto accessOf = [](VkImageLayout layout) -> VkAccessFlags {
+        switch (layout)
+        {
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+            return VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            return VK_ACCESS_SHADER_READ_BIT;
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            return VK_ACCESS_TRANSFER_READ_BIT;
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+            return VK_ACCESS_TRANSFER_WRITE_BIT;
+        default:
+            return 0;
+        }
+    };
+
+    auto stageOf = [](VkImageLayout layout) -> VkPipelineStageFlags {
+        switch (layout)
+        {
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+            return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            return VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+            return VK_PIPELINE_STAGE_TRANSFER_BIT;
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+            return VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        default:
+            return VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        }
+    };
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = accessOf(before);
+    barrier.dstAccessMask = accessOf(after);
+    barrier.oldLayout = before;
+    barrier.newLayout = after;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1 };
+
+    // Waiting on the acquire semaphore happens at color output, a present
+    // layout transition has to wait there too
+    VkPipelineStageFlags sourceStage = stageOf(before);
+    if (before == VK_IMAGE_LAYOUT_UNDEFINED || before == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR)
+        sourceStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, sourceStage, stageOf(after), 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
@@ -0,0 +1,35 @@
+#include "VulkanHudRenderer.h"
+
+#include <cstring>
+
+// HUD Renderer
+
+VulkanHudRenderer::VulkanHudRenderer(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline, uint32_t frameCount)
+    : m_FenceTimeline(fenceTimeline)
+{
+    const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    // A few hundred bytes, read straight from host visible memory
+    const std::vector<uint32_t> atlas = HudFont::BuildAtlas();
+    const VkDeviceSize atlasSize = atlas.size() * sizeof(uint32_t);
+
+    m_FontBuffer = CreateBuffer(device, physicalDevice, atlasSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible);
+    memcpy(m_FontBuffer.Mapped, atlas.data(), atlasSize);
+
+    m_QuadBuffer = CreateBuffer(device, physicalDevice, s_QuadSliceSize * frameCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible);
+}
+
+VulkanHudRenderer::~VulkanHudRenderer()
+{
+    // Frames already submitted may still read them
+    m_FenceTimeline.Release(m_FontBuffer);
+    m_FenceTimeline.Release(m_QuadBuffer);
+}
+
+uint32_t VulkanHudRenderer::Write(uint32_t frame, uint32_t width, uint32_t height)
+{
+    const std::vector<HudQuad>& quads = m_Hud.Build(width, height).GetQuads();
+    memcpy(m_QuadBuffer.Mapped + frame * s_QuadSliceSize, quads.data(), quads.size() * sizeof(HudQuad));
+
+    return static_cast<uint32_t>(quads.size());
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Nutcrackz/Renderer/PerformanceHud.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanFenceTimeline.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanHelpers.h"
+
+// HUD Renderer
+
+// The Vulkan counterpart of HudRenderer. The font atlas and a ring of per
+// frame quad slices live in host visible storage buffers the HUD shaders
+// read, every quad is drawn with one instanced draw.
+//
+// Render thread only.
+class VulkanHudRenderer
+{
+  public:
+    // Bytes of quads each frame's slice holds
+    static const uint64_t s_QuadSliceSize = HudLayout::s_MaxQuads * sizeof(HudQuad);
+
+    VulkanHudRenderer(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline, uint32_t frameCount);
+
+    ~VulkanHudRenderer();
+
+    VulkanHudRenderer(const VulkanHudRenderer&) = delete;
+    VulkanHudRenderer& operator=(const VulkanHudRenderer&) = delete;
+
+    // Record a frame's stats, every frame whether the HUD is shown or not
+    void AddFrame(const HudFrameStats& stats) { m_Hud.AddFrame(stats); }
+
+    // Lay the HUD out for a width by height target and write its quads into
+    // frame's slice. The last frame that used it must have completed on the
+    // GPU. Returns the number of quads to draw.
+    uint32_t Write(uint32_t frame, uint32_t width, uint32_t height);
+
+    // Frame f's quads start at f * s_QuadSliceSize
+    const VulkanBuffer& GetQuadBuffer() const { return m_QuadBuffer; }
+    const VulkanBuffer& GetFontBuffer() const { return m_FontBuffer; }
+
+  protected:
+    VulkanFenceTimeline& m_FenceTimeline;
+
+    PerformanceHud m_Hud;
+
+    VulkanBuffer m_FontBuffer;
+    VulkanBuffer m_QuadBuffer;
+};
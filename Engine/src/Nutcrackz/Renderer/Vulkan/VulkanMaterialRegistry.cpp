@@ -0,0 +1,73 @@
+#include "VulkanMaterialRegistry.h"
+
+#include <cstring>
+#include <stdexcept>
+
+// Materials
+
+VulkanMaterialRegistry::VulkanMaterialRegistry(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline)
+    : m_Buffer(device, physicalDevice, fenceTimeline, 16, s_MaxMaterials * StreamCount)
+{
+}
+
+MaterialHandle VulkanMaterialRegistry::Create(const MaterialDesc& desc)
+{
+    MaterialHandle material;
+    if (!m_FreeHandles.empty())
+    {
+        material = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+    }
+    else if (m_MaterialCount < s_MaxMaterials)
+    {
+        material = m_MaterialCount++;
+    }
+    else
+    {
+        throw std::runtime_error("too many materials!");
+    }
+
+    // The GPU copy of a new handle holds garbage, write every stream
+    WriteStreams(material, desc, false);
+
+    return material;
+}
+
+void VulkanMaterialRegistry::Update(MaterialHandle material, const MaterialDesc& desc)
+{
+    if (material >= m_MaterialCount)
+        return;
+
+    WriteStreams(material, desc, true);
+}
+
+void VulkanMaterialRegistry::WriteStreams(MaterialHandle material, const MaterialDesc& desc, bool onlyChanged)
+{
+    const glm::vec4 surface(desc.Roughness, desc.Metallic, desc.NormalScale, desc.AlphaCutoff);
+    const uint32_t textures[4] = { desc.BaseColorTexture, desc.NormalTexture, desc.RoughnessMetallicTexture, s_InvalidTexture };
+
+    WriteBlock(material, BaseColorStream, &desc.BaseColor, onlyChanged);
+    WriteBlock(material, SurfaceStream, &surface, onlyChanged);
+    WriteBlock(material, TextureStream, textures, onlyChanged);
+}
+
+void VulkanMaterialRegistry::Destroy(MaterialHandle material)
+{
+    if (material >= m_MaterialCount)
+        return;
+
+    // Uploads are ordered after the frames already submitted, reusing the
+    // handle can't change what they read
+    m_FreeHandles.push_back(material);
+}
+
+void VulkanMaterialRegistry::WriteBlock(MaterialHandle material, Stream stream, const void* block, bool onlyChanged)
+{
+    const uint32_t index = uint32_t(stream) * s_MaxMaterials + material;
+
+    // Writes of unchanged parameters don't cost an upload
+    if (onlyChanged && memcmp(m_Buffer.Read(index), block, 16) == 0)
+        return;
+
+    m_Buffer.Write(index, block);
+}
@@ -0,0 +1,180 @@
+#include "VulkanPersistentBuffer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// Persistent Buffer
+
+VulkanPersistentBuffer::VulkanPersistentBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline, uint32_t elementSize, uint32_t capacity)
+    : m_Device(device), m_PhysicalDevice(physicalDevice), m_FenceTimeline(fenceTimeline), m_ElementSize(elementSize)
+{
+    Grow(std::max(capacity, 64u));
+}
+
+VulkanPersistentBuffer::~VulkanPersistentBuffer()
+{
+    // Frames already submitted may still read the buffer or copy from a page
+    m_FenceTimeline.Release(m_Buffer);
+    m_Buffer = VulkanBuffer();
+
+    for (UploadPage& page : m_UploadPages)
+        m_FenceTimeline.Release(page.Buffer);
+
+    m_UploadPages.clear();
+}
+
+void VulkanPersistentBuffer::Write(uint32_t index, const void* element)
+{
+    if (index >= m_Stats.Capacity)
+        Grow(std::max(m_Stats.Capacity * 2, index + 1));
+
+    memcpy(&m_Elements[size_t(index) * m_ElementSize], element, m_ElementSize);
+    MarkDirty(index);
+
+    m_Stats.ElementCount = std::max(m_Stats.ElementCount, index + 1);
+}
+
+void VulkanPersistentBuffer::Upload(VkCommandBuffer commandBuffer)
+{
+    m_Stats.DirtyElements = 0;
+    m_Stats.UploadedRanges = 0;
+    m_Stats.UploadedBytes = 0;
+
+    // Turn the set bits into ranges. Runs crossing a word boundary continue
+    // the previous range, so adjacent elements always end up in one copy.
+    m_Ranges.clear();
+    uint32_t dirtyElements = 0;
+
+    for (size_t word = 0; word < m_DirtyWords.size(); ++word)
+    {
+        uint64_t bits = m_DirtyWords[word];
+        m_DirtyWords[word] = 0;
+
+        while (bits != 0)
+        {
+            const uint32_t start = std::countr_zero(bits);
+            const uint32_t length = std::countr_one(bits >> start);
+            const uint32_t first = static_cast<uint32_t>(word * 64) + start;
+
+            if (!m_Ranges.empty() && m_Ranges.back().First + m_Ranges.back().Count == first)
+                m_Ranges.back().Count += length;
+            else
+                m_Ranges.push_back({first, length});
+
+            dirtyElements += length;
+
+            if (start + length == 64)
+                bits = 0;
+            else
+                bits &= ~(((1ull << length) - 1) << start);
+        }
+    }
+
+    if (dirtyElements == 0)
+        return;
+
+    const uint64_t uploadSize = uint64_t(dirtyElements) * m_ElementSize;
+    UploadPage& page = AcquireUploadPage(uploadSize);
+
+    m_Copies.clear();
+
+    uint64_t offset = 0;
+    for (const DirtyRange& range : m_Ranges)
+    {
+        const uint64_t rangeSize = uint64_t(range.Count) * m_ElementSize;
+        memcpy(page.Buffer.Mapped + offset, &m_Elements[size_t(range.First) * m_ElementSize], rangeSize);
+
+        VkBufferCopy copy;
+        copy.srcOffset = offset;
+        copy.dstOffset = uint64_t(range.First) * m_ElementSize;
+        copy.size = rangeSize;
+        m_Copies.push_back(copy);
+
+        offset += rangeSize;
+    }
+
+    // The previous frame's shaders may still be reading the elements about
+    // to be overwritten
+    const VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    vkCmdPipelineBarrier(commandBuffer, shaderStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    vkCmdCopyBuffer(commandBuffer, page.Buffer.Buffer, m_Buffer.Buffer, static_cast<uint32_t>(m_Copies.size()), m_Copies.data());
+
+    page.FenceValue = m_FenceTimeline.GetNextValue();
+
+    // Any shader stage may read it
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = m_Buffer.Buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, shaderStages, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    m_Stats.DirtyElements = dirtyElements;
+    m_Stats.UploadedRanges = static_cast<uint32_t>(m_Ranges.size());
+    m_Stats.UploadedBytes = uploadSize;
+    m_Stats.TotalUploadedBytes += uploadSize;
+}
+
+void VulkanPersistentBuffer::Grow(uint32_t capacity)
+{
+    // Whole words of the dirty bitset
+    capacity = (capacity + 63) & ~63u;
+
+    if (m_Buffer.Buffer != VK_NULL_HANDLE)
+        m_FenceTimeline.Release(m_Buffer);
+
+    m_Buffer = CreateBuffer(m_Device, m_PhysicalDevice, uint64_t(capacity) * m_ElementSize,
+                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    m_Elements.resize(size_t(capacity) * m_ElementSize, 0);
+    m_DirtyWords.resize(capacity / 64, 0);
+    m_Stats.Capacity = capacity;
+
+    // The new buffer starts out empty, everything written so far goes up
+    // again with the next upload
+    for (uint32_t index = 0; index < m_Stats.ElementCount; ++index)
+        MarkDirty(index);
+}
+
+VulkanPersistentBuffer::UploadPage& VulkanPersistentBuffer::AcquireUploadPage(uint64_t size)
+{
+    UploadPage* slot = nullptr;
+
+    for (UploadPage& page : m_UploadPages)
+    {
+        if (!m_FenceTimeline.IsComplete(page.FenceValue))
+            continue;
+
+        if (page.Buffer.Size >= size)
+            return page;
+
+        slot = &page;
+    }
+
+    // Replace a retired page that is too small rather than adding another
+    if (slot)
+    {
+        m_FenceTimeline.Release(slot->Buffer);
+        *slot = UploadPage();
+    }
+    else
+    {
+        m_UploadPages.emplace_back();
+        slot = &m_UploadPages.back();
+    }
+
+    UploadPage& page = *slot;
+    const uint64_t minSize = s_MinUploadPageSize;
+
+    // Host coherent, so writes through the mapping need no flush
+    page.Buffer = CreateBuffer(m_Device, m_PhysicalDevice, std::max(std::bit_ceil(size), minSize), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    return page;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Nutcrackz/Renderer/RendererCommon.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanFenceTimeline.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanHelpers.h"
+
+#include <type_traits>
+#include <vector>
+
+// Persistent Buffer
+
+// The Vulkan counterpart of PersistentBuffer: a device local storage buffer
+// of fixed size elements that stay on the GPU between frames. Write only
+// changes the CPU copy and sets the element's bit in a dirty bitset. Upload
+// turns the set bits into ranges, merging runs of adjacent elements, and
+// copies just those slices from a host visible upload page.
+//
+// Upload pages are reused once the fence value of their last copy has
+// completed, so steady state frames don't create buffers. Not thread safe,
+// uploads happen on the render thread.
+class VulkanPersistentBuffer
+{
+  public:
+    VulkanPersistentBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VulkanFenceTimeline& fenceTimeline, uint32_t elementSize, uint32_t capacity);
+
+    ~VulkanPersistentBuffer();
+
+    VulkanPersistentBuffer(const VulkanPersistentBuffer&) = delete;
+    VulkanPersistentBuffer& operator=(const VulkanPersistentBuffer&) = delete;
+
+    // Copy elementSize bytes into an element, growing the buffer if index is
+    // past its end
+    void Write(uint32_t index, const void* element);
+
+    template<typename T>
+    void Update(uint32_t index, const T& element)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "elements are copied as bytes");
+        Write(index, &element);
+    }
+
+    // The CPU copy of an element, what the GPU sees after the next Upload
+    const void* Read(uint32_t index) const { return &m_Elements[size_t(index) * m_ElementSize]; }
+
+    // Record the copies of every element changed since the last upload. The
+    // buffer is ready to be read by the vertex and fragment shaders after
+    // this. Must be recorded outside of rendering.
+    void Upload(VkCommandBuffer commandBuffer);
+
+    // Changes when the buffer grows, descriptors have to be written again
+    VkBuffer GetBuffer() const { return m_Buffer.Buffer; }
+
+    VkDeviceSize GetSize() const { return m_Buffer.Size; }
+
+    uint32_t GetElementSize() const { return m_ElementSize; }
+
+    const PersistentBufferStats& GetStats() const { return m_Stats; }
+
+    // Upload pages are at least this large so small updates share one
+    static const uint64_t s_MinUploadPageSize = 64 * 1024;
+
+  protected:
+    struct DirtyRange
+    {
+        uint32_t First;
+        uint32_t Count;
+    };
+
+    struct UploadPage
+    {
+        VulkanBuffer Buffer;
+
+        // Fence value of the last frame that copied from this page
+        uint64_t FenceValue = 0;
+    };
+
+    void Grow(uint32_t capacity);
+
+    // A page of at least size bytes the GPU is no longer reading
+    UploadPage& AcquireUploadPage(uint64_t size);
+
+    void MarkDirty(uint32_t index) { m_DirtyWords[index / 64] |= 1ull << (index % 64); }
+
+    VkDevice m_Device;
+    VkPhysicalDevice m_PhysicalDevice;
+    VulkanFenceTimeline& m_FenceTimeline;
+
+    uint32_t m_ElementSize;
+
+    VulkanBuffer m_Buffer;
+
+    // CPU copy of every element, the source of the uploads
+    std::vector<uint8_t> m_Elements;
+
+    // One bit per element
+    std::vector<uint64_t> m_DirtyWords;
+
+    // Upload only, reused so steady state frames don't allocate
+    std::vector<DirtyRange> m_Ranges;
+    std::vector<VkBufferCopy> m_Copies;
+
+    std::vector<UploadPage> m_UploadPages;
+
+    PersistentBufferStats m_Stats;
+};
@@ -0,0 +1,1731 @@
+#include "VulkanRenderer.h"
+
+#include "Nutcrackz/Core/FrameArenas.h"
+
+#if defined(XWIN_XCB)
+#include <vulkan/vulkan_xcb.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+using namespace glm;
+
+// Helper functions
+
+namespace
+{
+const VkClearColorValue s_ClearColor = { { 0.2f, 0.2f, 0.2f, 1.0f } };
+
+// The scene is rendered in the same format as on DirectX 12
+const VkFormat s_SceneColorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+// SPIR-V of assets/<name>.hlsl, compiled by the build into assets/<name>.spv
+std::vector<char> LoadShader(const std::string& name)
+{
+    return ReadFile("assets/" + name + ".spv");
+}
+
+VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& code)
+{
+    VkShaderModuleCreateInfo moduleInfo = {};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.size();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    ThrowIfFailed(vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule));
+
+    return shaderModule;
+}
+
+// Higher is better. Software rasterizers such as lavapipe only win when they
+// were asked for, or when nothing else is there.
+int ScorePhysicalDevice(const VkPhysicalDeviceProperties& properties, bool preferSoftware)
+{
+    switch (properties.deviceType)
+    {
+    case VK_PHYSICAL_DEVICE_TYPE_CPU: return preferSoftware ? 4 : 1;
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 3;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 2;
+    default: return 1;
+    }
+}
+
+bool HasDeviceExtension(VkPhysicalDevice physicalDevice, const char* name)
+{
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+
+    for (const VkExtensionProperties& extension : extensions)
+    {
+        if (strcmp(extension.extensionName, name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+VkViewport FlippedViewport(uint32_t width, uint32_t height)
+{
+    // A negative height flips Y like DirectX, so the same shaders and
+    // matrices put things the right way up
+    VkViewport viewport;
+    viewport.x = 0.0f;
+    viewport.y = static_cast<float>(height);
+    viewport.width = static_cast<float>(width);
+    viewport.height = -static_cast<float>(height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    return viewport;
+}
+}
+
+// Renderer
+
+Renderer::Renderer(xwin::Window& window)
+{
+    m_Headless = false;
+    m_UseSoftwareRasterizer = false;
+
+    Startup(&window);
+}
+
+Renderer::Renderer(const HeadlessDesc& desc)
+{
+    m_Headless = true;
+    m_UseSoftwareRasterizer = desc.UseSoftwareRasterizer;
+
+    m_Width = clamp(desc.Width, 1u, 0xffffu);
+    m_Height = clamp(desc.Height, 1u, 0xffffu);
+
+    Startup(nullptr);
+}
+
+void Renderer::Startup(xwin::Window* window)
+{
+    m_Window = nullptr;
+
+    // Initialization
+    m_Instance = VK_NULL_HANDLE;
+    m_PhysicalDevice = VK_NULL_HANDLE;
+    m_Device = VK_NULL_HANDLE;
+    m_QueueFamily = 0;
+    m_Queue = VK_NULL_HANDLE;
+
+    m_Surface = VK_NULL_HANDLE;
+    m_Swapchain = VK_NULL_HANDLE;
+    m_TargetFormat = VK_FORMAT_UNDEFINED;
+    m_TargetIndex = 0;
+    m_SwapchainOutOfDate = false;
+
+    // Resources
+    m_SceneBuffer = nullptr;
+    m_MaterialRegistry = nullptr;
+
+    m_LinearSampler = VK_NULL_HANDLE;
+    m_ClampSampler = VK_NULL_HANDLE;
+    m_FrameSetLayout = VK_NULL_HANDLE;
+    m_TextureSetLayout = VK_NULL_HANDLE;
+    m_DescriptorPool = VK_NULL_HANDLE;
+    m_PipelineLayout = VK_NULL_HANDLE;
+    m_Pipeline = VK_NULL_HANDLE;
+
+    m_SceneColorVersion = 0;
+    m_UpscalePipeline = VK_NULL_HANDLE;
+    m_ResolutionScale = 1.0f;
+
+    m_TimestampPool = VK_NULL_HANDLE;
+    m_TimestampPeriod = 1.0f;
+    m_LastGpuFrameMs = 0.0f;
+
+    m_ClusteredLighting = nullptr;
+    m_FrameReadback = nullptr;
+    m_TextureStreamer = nullptr;
+    m_TextureBudget = s_DefaultTextureBudget;
+    m_HudRenderer = nullptr;
+    m_HudPipeline = VK_NULL_HANDLE;
+    m_HasMemoryBudget = false;
+
+    m_ResizePending = false;
+
+    // Sync
+    m_FrameIndex = 0;
+    m_FenceTimeline = nullptr;
+    m_LastFenceWait = std::chrono::nanoseconds(0);
+
+    // Startup
+    m_StartupMs = 0.0;
+    m_TimeToFirstFrameMs = 0.0;
+
+    // The game thread provides real constants with every frame
+    UboVS.ProjectionMatrix = glm::identity<mat4>();
+    UboVS.ViewMatrix = glm::identity<mat4>();
+
+    // Startup is a graph of tasks run on the worker threads. Shaders load
+    // while the device is created, pipelines build while buffers and the
+    // swapchain are created.
+    TaskGraph startup;
+
+    std::vector<char> triangleVertexShader, trianglePixelShader;
+    std::vector<char> upscaleVertexShader, upscalePixelShader;
+    std::vector<char> hudVertexShader, hudPixelShader;
+
+    const TaskId device = startup.Add("Create Device", {}, [this]() { CreateDevice(); });
+    const TaskId queues = startup.Add("Create Queues", { device }, [this]() { CreateQueues(); });
+
+    // Unlike DXGI, Vulkan never messages the window, any thread will do
+    const TaskId swapchain = window ? startup.Add("Create Swapchain", { queues }, [this, window]() { CreateSwapchain(window); })
+                                    : startup.Add("Create Offscreen Targets", { queues }, [this]() { CreateSwapchain(nullptr); });
+
+    const TaskId managers = startup.Add("Create Resource Managers", { queues }, [this]() { CreateResourceManagers(); });
+    const TaskId pipelineLayout = startup.Add("Create Pipeline Layout", { device }, [this]() { CreatePipelineLayout(); });
+
+    const TaskId triangleVertex = startup.Add("Load triangle.vert", {}, [&triangleVertexShader]() {
+        triangleVertexShader = LoadShader("triangle.vert");
+    });
+    const TaskId trianglePixel = startup.Add("Load triangle.frag", {}, [&trianglePixelShader]() {
+        trianglePixelShader = LoadShader("triangle.frag");
+    });
+    const TaskId upscaleVertex = startup.Add("Load upscale.vert", {}, [&upscaleVertexShader]() {
+        upscaleVertexShader = LoadShader("upscale.vert");
+    });
+    const TaskId upscalePixel = startup.Add("Load upscale.frag", {}, [&upscalePixelShader]() {
+        upscalePixelShader = LoadShader("upscale.frag");
+    });
+    const TaskId hudVertex = startup.Add("Load hud.vert", {}, [&hudVertexShader]() {
+        hudVertexShader = LoadShader("hud.vert");
+    });
+    const TaskId hudPixel = startup.Add("Load hud.frag", {}, [&hudPixelShader]() {
+        hudPixelShader = LoadShader("hud.frag");
+    });
+
+    startup.Add("Create Pipeline", { pipelineLayout, triangleVertex, trianglePixel }, [&, this]() {
+        m_Pipeline = CreatePipeline(triangleVertexShader, trianglePixelShader, true, s_SceneColorFormat);
+    });
+
+    // The upscale pass draws one triangle over the target without any vertex
+    // input, in whatever format the swapchain picked
+    startup.Add("Create Upscale Pipeline", { pipelineLayout, swapchain, upscaleVertex, upscalePixel }, [&, this]() {
+        m_UpscalePipeline = CreatePipeline(upscaleVertexShader, upscalePixelShader, false, m_TargetFormat);
+    });
+
+    // The HUD's quads come from a storage buffer, blended over the target
+    startup.Add("Create HUD Pipeline", { pipelineLayout, swapchain, hudVertex, hudPixel }, [&, this]() {
+        m_HudPipeline = CreatePipeline(hudVertexShader, hudPixelShader, false, m_TargetFormat, true);
+    });
+
+    startup.Add("Create Geometry Buffers", { device }, [this]() { CreateGeometryBuffers(); });
+
+    // Dynamic resolution
+    startup.Add("Create Scene Color", { swapchain }, [this]() { CreateSceneColor(); });
+
+    startup.Add("Create Timestamp Queries", { device }, [this]() { CreateTimestampQueries(); });
+
+    m_StartupStart = std::chrono::steady_clock::now();
+
+    // Run waits for every task before rethrowing, so what the others created
+    // is complete. The destructor doesn't run when the constructor throws.
+    try
+    {
+        startup.Run(m_ThreadPool);
+    }
+    catch (...)
+    {
+        Shutdown();
+        throw;
+    }
+
+    m_StartupMs = startup.GetTotalMs();
+    m_StartupTimings = startup.GetTimings();
+
+    std::cout << "Renderer startup:\n";
+    startup.WriteReport(std::cout);
+
+    // Everything above lives in host visible memory, nothing has been
+    // submitted to the GPU that needs waiting for.
+}
+
+Renderer::~Renderer()
+{
+    Shutdown();
+}
+
+void Renderer::Shutdown()
+{
+    DestroyCommands();
+    DestroyResources();
+    DestroyAPI();
+}
+
+void Renderer::CreateDevice()
+{
+    // Create Instance
+
+    std::vector<const char*> instanceExtensions;
+    if (!m_Headless)
+    {
+        instanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+#if defined(XWIN_XCB)
+        instanceExtensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
+#endif
+    }
+
+    std::vector<const char*> layers;
+#if defined(_DEBUG)
+    // Validation is only enabled where the SDK installed it
+    uint32_t layerCount = 0;
+    vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+    std::vector<VkLayerProperties> availableLayers(layerCount);
+    vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+
+    for (const VkLayerProperties& layer : availableLayers)
+    {
+        if (strcmp(layer.layerName, "VK_LAYER_KHRONOS_validation") == 0)
+            layers.push_back("VK_LAYER_KHRONOS_validation");
+    }
+#endif
+
+    VkApplicationInfo appInfo = {};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "Hello Triangle";
+    appInfo.pEngineName = "Nutcrackz";
+    appInfo.apiVersion = VK_API_VERSION_1_3;
+
+    VkInstanceCreateInfo instanceInfo = {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledExtensionCount = static_cast<uint32_t>(instanceExtensions.size());
+    instanceInfo.ppEnabledExtensionNames = instanceExtensions.data();
+    instanceInfo.enabledLayerCount = static_cast<uint32_t>(layers.size());
+    instanceInfo.ppEnabledLayerNames = layers.data();
+    ThrowIfFailed(vkCreateInstance(&instanceInfo, nullptr, &m_Instance));
+
+    // Pick Physical Device
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(m_Instance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> physicalDevices(deviceCount);
+    vkEnumeratePhysicalDevices(m_Instance, &deviceCount, physicalDevices.data());
+
+    int bestScore = 0;
+    for (VkPhysicalDevice physicalDevice : physicalDevices)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        if (properties.apiVersion < VK_API_VERSION_1_3)
+            continue;
+
+        // Everything runs on one queue that can draw
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+        uint32_t graphicsFamily = ~0u;
+        for (uint32_t i = 0; i < familyCount && graphicsFamily == ~0u; ++i)
+        {
+            if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+                graphicsFamily = i;
+        }
+
+        const int score = ScorePhysicalDevice(properties, m_UseSoftwareRasterizer);
+        if (graphicsFamily == ~0u || score <= bestScore)
+            continue;
+
+        bestScore = score;
+        m_PhysicalDevice = physicalDevice;
+        m_QueueFamily = graphicsFamily;
+    }
+
+    if (m_PhysicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("No Vulkan 1.3 device found!");
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_PhysicalDevice, &properties);
+    std::cout << "Rendering with " << properties.deviceName << "\n";
+
+    // Check Features
+
+    VkPhysicalDeviceVulkan13Features supported13 = {};
+    supported13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+    VkPhysicalDeviceVulkan12Features supported12 = {};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    supported12.pNext = &supported13;
+
+    VkPhysicalDeviceFeatures2 supported = {};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext = &supported12;
+    vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &supported);
+
+    if (!supported12.timelineSemaphore || !supported12.runtimeDescriptorArray || !supported12.descriptorBindingPartiallyBound ||
+        !supported12.shaderSampledImageArrayNonUniformIndexing || !supported13.dynamicRendering)
+        throw std::runtime_error("The Vulkan device lacks timeline semaphores, descriptor indexing or dynamic rendering!");
+
+    // Create Device
+
+    VkPhysicalDeviceVulkan13Features features13 = {};
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    features13.dynamicRendering = VK_TRUE;
+
+    VkPhysicalDeviceVulkan12Features features12 = {};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.pNext = &features13;
+    features12.timelineSemaphore = VK_TRUE;
+    features12.runtimeDescriptorArray = VK_TRUE;
+    features12.descriptorBindingPartiallyBound = VK_TRUE;
+    features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
+    // Block compressed textures are optional, the streamer checks each
+    // format before using it
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &features12;
+    features.features.textureCompressionBC = supported.features.textureCompressionBC;
+
+    const float queuePriority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo = {};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = m_QueueFamily;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &queuePriority;
+
+    std::vector<const char*> deviceExtensions;
+    if (!m_Headless)
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+    // Reports the video memory budget like DXGI does on Windows
+    m_HasMemoryBudget = HasDeviceExtension(m_PhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (m_HasMemoryBudget)
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    VkDeviceCreateInfo deviceInfo = {};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = &features;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+    deviceInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    deviceInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    ThrowIfFailed(vkCreateDevice(m_PhysicalDevice, &deviceInfo, nullptr, &m_Device));
+
+    vkGetDeviceQueue(m_Device, m_QueueFamily, 0, &m_Queue);
+}
+
+void Renderer::CreateQueues()
+{
+    // Sync
+    m_FenceTimeline = new VulkanFenceTimeline(m_Device, m_Queue);
+
+    // Each frame in flight records into its own pool, reset as a whole once
+    // the frame has completed
+    for (FrameResources& frame : m_Frames)
+    {
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = m_QueueFamily;
+        ThrowIfFailed(vkCreateCommandPool(m_Device, &poolInfo, nullptr, &frame.CommandPool));
+
+        VkCommandBufferAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = frame.CommandPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+        ThrowIfFailed(vkAllocateCommandBuffers(m_Device, &allocateInfo, &frame.CommandBuffer));
+
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        ThrowIfFailed(vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &frame.ImageAvailable));
+    }
+}
+
+void Renderer::CreateSwapchain(xwin::Window* window)
+{
+    if (window)
+    {
+        // The renderer needs the window when resizing the swapchain
+        m_Window = window;
+
+        const xwin::WindowDesc wdesc = window->getDesc();
+        m_Width = clamp(wdesc.width, 1u, 0xffffu);
+        m_Height = clamp(wdesc.height, 1u, 0xffffu);
+
+#if defined(XWIN_XCB)
+        VkXcbSurfaceCreateInfoKHR surfaceInfo = {};
+        surfaceInfo.sType = VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR;
+        surfaceInfo.connection = window->getConnection();
+        surfaceInfo.window = window->getWindowId();
+        ThrowIfFailed(vkCreateXcbSurfaceKHR(m_Instance, &surfaceInfo, nullptr, &m_Surface));
+#else
+        throw std::runtime_error("The Vulkan renderer has no surface for this platform's windows!");
+#endif
+    }
+    else
+    {
+        // Matches what the swapchain usually picks, captures need no swizzle
+        m_TargetFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    }
+
+    SetupSwapchain(m_Width, m_Height);
+}
+
+void Renderer::DestroyAPI()
+{
+    for (FrameResources& frame : m_Frames)
+    {
+        if (frame.CommandPool != VK_NULL_HANDLE)
+            vkDestroyCommandPool(m_Device, frame.CommandPool, nullptr);
+
+        if (frame.ImageAvailable != VK_NULL_HANDLE)
+            vkDestroySemaphore(m_Device, frame.ImageAvailable, nullptr);
+
+        frame = FrameResources();
+    }
+
+    // Waits for the GPU and destroys everything still deferred
+    if (m_FenceTimeline)
+    {
+        delete m_FenceTimeline;
+        m_FenceTimeline = nullptr;
+    }
+
+    if (m_Device)
+    {
+        vkDestroyDevice(m_Device, nullptr);
+        m_Device = VK_NULL_HANDLE;
+        m_Queue = VK_NULL_HANDLE;
+    }
+
+    if (m_Instance)
+    {
+        vkDestroyInstance(m_Instance, nullptr);
+        m_Instance = VK_NULL_HANDLE;
+        m_PhysicalDevice = VK_NULL_HANDLE;
+    }
+}
+
+void Renderer::CreateOffscreenTargets()
+{
+    // Like swapchain images, frames take turns rendering into them
+    for (uint32_t i = 0; i < s_BackbufferCount; ++i)
+    {
+        VulkanImage target = CreateImage(m_Device, m_PhysicalDevice, m_Width, m_Height, 1, m_TargetFormat,
+                                         VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+
+        m_OffscreenTargets.push_back(target);
+        m_TargetImages.push_back(target.Image);
+        m_TargetViews.push_back(target.View);
+    }
+}
+
+void Renderer::ReleaseRenderTargets()
+{
+    // Offscreen targets own their views, swapchain image views are ours
+    if (m_Headless)
+    {
+        for (const VulkanImage& target : m_OffscreenTargets)
+            m_FenceTimeline->Release(target);
+    }
+    else
+    {
+        for (VkImageView view : m_TargetViews)
+            vkDestroyImageView(m_Device, view, nullptr);
+    }
+
+    m_OffscreenTargets.clear();
+    m_TargetImages.clear();
+    m_TargetViews.clear();
+}
+
+void Renderer::CreateSceneColor()
+{
+    // Rendered to, then sampled by the upscale pass
+    m_SceneColor = CreateImage(m_Device, m_PhysicalDevice, m_Width, m_Height, 1, s_SceneColorFormat,
+                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+    // Every frame's texture set has to point at the new view
+    m_SceneColorVersion++;
+}
+
+void Renderer::ReleaseSceneColor()
+{
+    if (m_SceneColor.Image != VK_NULL_HANDLE)
+    {
+        m_FenceTimeline->Release(m_SceneColor);
+        m_SceneColor = VulkanImage();
+    }
+}
+
+void Renderer::CreateResourceManagers()
+{
+    m_TextureStreamer = new VulkanTextureStreamer(m_Device, m_PhysicalDevice, m_ThreadPool, *m_FenceTimeline, s_FirstTextureDescriptor, m_TextureBudget);
+
+    // Listeners run on the render thread, outside of the streamer's lock
+    m_ResidencyPlanner.AddBudgetListener([this](const ResidencyBudget&) {
+        std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+        UpdateTextureBudget();
+    });
+    m_SceneBuffer = new VulkanPersistentBuffer(m_Device, m_PhysicalDevice, *m_FenceTimeline, sizeof(SceneObject), s_InitialSceneCapacity);
+    m_MaterialRegistry = new VulkanMaterialRegistry(m_Device, m_PhysicalDevice, *m_FenceTimeline);
+    m_ClusteredLighting = new VulkanClusteredLighting(m_Device, m_PhysicalDevice, *m_FenceTimeline, s_BackbufferCount);
+    m_FrameReadback = new VulkanFrameReadback(m_Device, m_PhysicalDevice, *m_FenceTimeline, m_ThreadPool, s_ReadbackBufferCount);
+    m_HudRenderer = new VulkanHudRenderer(m_Device, m_PhysicalDevice, *m_FenceTimeline, s_BackbufferCount);
+
+    // Material 0 is what objects get unless they ask for something else
+    m_MaterialRegistry->Create(MaterialDesc());
+}
+
+void Renderer::CreatePipelineLayout()
+{
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.compareOp = VK_COMPARE_OP_NEVER;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    ThrowIfFailed(vkCreateSampler(m_Device, &samplerInfo, nullptr, &m_LinearSampler));
+
+    // The upscale pass must not wrap around into the other edge
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    ThrowIfFailed(vkCreateSampler(m_Device, &samplerInfo, nullptr, &m_ClampSampler));
+
+    const VkShaderStageFlags graphicsStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Set 0, the frame's constants and buffers, rewritten every frame
+    const VkDescriptorSetLayoutBinding frameBindings[] = {
+        { s_FrameConstantsBinding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, graphicsStages, nullptr },
+        { s_LightingConstantsBinding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, graphicsStages, nullptr },
+        { s_SceneBufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr },
+        { s_MaterialBufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr },
+        { s_TextureTableBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr },
+        { s_LightBufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr },
+        { s_ClusterBufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr },
+        { s_LightIndexBufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr },
+        { s_HudQuadBufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr },
+        { s_HudFontBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, graphicsStages, nullptr },
+        { s_LinearSamplerBinding, VK_DESCRIPTOR_TYPE_SAMPLER, 1, graphicsStages, &m_LinearSampler },
+        { s_ClampSamplerBinding, VK_DESCRIPTOR_TYPE_SAMPLER, 1, graphicsStages, &m_ClampSampler },
+    };
+
+    VkDescriptorSetLayoutCreateInfo frameLayoutInfo = {};
+    frameLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    frameLayoutInfo.bindingCount = static_cast<uint32_t>(std::size(frameBindings));
+    frameLayoutInfo.pBindings = frameBindings;
+    ThrowIfFailed(vkCreateDescriptorSetLayout(m_Device, &frameLayoutInfo, nullptr, &m_FrameSetLayout));
+
+    // Set 1, every texture. Only partially filled, slots without a resident
+    // texture are never sampled.
+    const VkDescriptorSetLayoutBinding textureBinding = { s_BindlessTexturesBinding, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, s_BindlessTextureCount, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr };
+    const VkDescriptorBindingFlags textureBindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &textureBindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo textureLayoutInfo = {};
+    textureLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    textureLayoutInfo.pNext = &bindingFlagsInfo;
+    textureLayoutInfo.bindingCount = 1;
+    textureLayoutInfo.pBindings = &textureBinding;
+    ThrowIfFailed(vkCreateDescriptorSetLayout(m_Device, &textureLayoutInfo, nullptr, &m_TextureSetLayout));
+
+    // The draw's object index or the HUD constants, and the upscale
+    // constants, each only seen by one stage
+    const VkPushConstantRange pushConstantRanges[] = {
+        { VK_SHADER_STAGE_VERTEX_BIT, 0, static_cast<uint32_t>(std::max(sizeof(uint32_t), sizeof(HudConstants))) },
+        { VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(UpscaleConstants) },
+    };
+
+    const VkDescriptorSetLayout setLayouts[] = { m_FrameSetLayout, m_TextureSetLayout };
+
+    VkPipelineLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = static_cast<uint32_t>(std::size(setLayouts));
+    layoutInfo.pSetLayouts = setLayouts;
+    layoutInfo.pushConstantRangeCount = static_cast<uint32_t>(std::size(pushConstantRanges));
+    layoutInfo.pPushConstantRanges = pushConstantRanges;
+    ThrowIfFailed(vkCreatePipelineLayout(m_Device, &layoutInfo, nullptr, &m_PipelineLayout));
+
+    // Both sets for every frame in flight
+    const VkDescriptorPoolSize poolSizes[] = {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 * s_BackbufferCount },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 8 * s_BackbufferCount },
+        { VK_DESCRIPTOR_TYPE_SAMPLER, 2 * s_BackbufferCount },
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, s_BindlessTextureCount * s_BackbufferCount },
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 2 * s_BackbufferCount;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(std::size(poolSizes));
+    poolInfo.pPoolSizes = poolSizes;
+    ThrowIfFailed(vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_DescriptorPool));
+
+    for (FrameResources& frame : m_Frames)
+    {
+        VkDescriptorSetAllocateInfo allocateInfo = {};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = m_DescriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+
+        allocateInfo.pSetLayouts = &m_FrameSetLayout;
+        ThrowIfFailed(vkAllocateDescriptorSets(m_Device, &allocateInfo, &frame.FrameSet));
+
+        allocateInfo.pSetLayouts = &m_TextureSetLayout;
+        ThrowIfFailed(vkAllocateDescriptorSets(m_Device, &allocateInfo, &frame.TextureSet));
+    }
+}
+
+VkPipeline Renderer::CreatePipeline(const std::vector<char>& vertexShader, const std::vector<char>& pixelShader, bool vertexInput, VkFormat colorFormat, bool alphaBlend)
+{
+    const VkShaderModule vertexModule = CreateShaderModule(m_Device, vertexShader);
+    const VkShaderModule pixelModule = CreateShaderModule(m_Device, pixelShader);
+
+    VkPipelineShaderStageCreateInfo stages[2] = {};
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = vertexModule;
+    stages[0].pName = "main";
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = pixelModule;
+    stages[1].pName = "main";
+
+    // POSITION, COLOR and TEXCOORD0 in the order the vertex shader declares
+    // them
+    const VkVertexInputBindingDescription vertexBinding = { 0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX };
+    const VkVertexInputAttributeDescription vertexAttributes[] = {
+        { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+        { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, 12 },
+        { 2, 0, VK_FORMAT_R32G32_SFLOAT, 24 },
+    };
+
+    VkPipelineVertexInputStateCreateInfo vertexInputState = {};
+    vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    if (vertexInput)
+    {
+        vertexInputState.vertexBindingDescriptionCount = 1;
+        vertexInputState.pVertexBindingDescriptions = &vertexBinding;
+        vertexInputState.vertexAttributeDescriptionCount = static_cast<uint32_t>(std::size(vertexAttributes));
+        vertexInputState.pVertexAttributeDescriptions = vertexAttributes;
+    }
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = {};
+    inputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    // Viewport and scissor change with the resolution scale
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    const VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(std::size(dynamicStates));
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkPipelineRasterizationStateCreateInfo rasterizationState = {};
+    rasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizationState.cullMode = VK_CULL_MODE_NONE;
+    rasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    rasterizationState.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisampleState = {};
+    multisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencilState = {};
+    depthStencilState.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencilState.depthTestEnable = VK_FALSE;
+    depthStencilState.stencilTestEnable = VK_FALSE;
+
+    VkPipelineColorBlendAttachmentState blendAttachment = {};
+    blendAttachment.blendEnable = alphaBlend ? VK_TRUE : VK_FALSE;
+    blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo colorBlendState = {};
+    colorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlendState.attachmentCount = 1;
+    colorBlendState.pAttachments = &blendAttachment;
+
+    // Dynamic rendering, no render pass objects
+    VkPipelineRenderingCreateInfo renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &colorFormat;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = &renderingInfo;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = stages;
+    pipelineInfo.pVertexInputState = &vertexInputState;
+    pipelineInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizationState;
+    pipelineInfo.pMultisampleState = &multisampleState;
+    pipelineInfo.pDepthStencilState = &depthStencilState;
+    pipelineInfo.pColorBlendState = &colorBlendState;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = m_PipelineLayout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    const VkResult result = vkCreateGraphicsPipelines(m_Device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+
+    vkDestroyShaderModule(m_Device, vertexModule, nullptr);
+    vkDestroyShaderModule(m_Device, pixelModule, nullptr);
+
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("Failed to create Graphics Pipeline!");
+
+    return pipeline;
+}
+
+void Renderer::CreateGeometryBuffers()
+{
+    const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    // Create the UBO, written through its mapping every frame
+    m_UniformBuffer = CreateBuffer(m_Device, m_PhysicalDevice, s_UniformSliceSize * s_BackbufferCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, hostVisible);
+
+    // Note: host visible memory is not the fastest place for static
+    // geometry. It is used here for code simplicity and because there are
+    // very few verts to actually transfer.
+    m_VertexBuffer = CreateBuffer(m_Device, m_PhysicalDevice, sizeof(m_VertexBufferData), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, hostVisible);
+    memcpy(m_VertexBuffer.Mapped, m_VertexBufferData, sizeof(m_VertexBufferData));
+
+    m_IndexBuffer = CreateBuffer(m_Device, m_PhysicalDevice, sizeof(m_IndexBufferData), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, hostVisible);
+    memcpy(m_IndexBuffer.Mapped, m_IndexBufferData, sizeof(m_IndexBufferData));
+}
+
+void Renderer::CreateTimestampQueries()
+{
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_PhysicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_PhysicalDevice, &familyCount, families.data());
+
+    // Without timestamps dynamic resolution has nothing to go on and stays
+    // at full resolution
+    if (families[m_QueueFamily].timestampValidBits == 0)
+    {
+        std::cout << "The Vulkan queue has no timestamps, dynamic resolution is disabled\n";
+        return;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_PhysicalDevice, &properties);
+    m_TimestampPeriod = properties.limits.timestampPeriod;
+
+    // GPU frame times for the resolution controller, two timestamps per
+    // frame in flight
+    VkQueryPoolCreateInfo queryPoolInfo = {};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2 * s_BackbufferCount;
+    ThrowIfFailed(vkCreateQueryPool(m_Device, &queryPoolInfo, nullptr, &m_TimestampPool));
+}
+
+void Renderer::DestroyResources()
+{
+    // Waits for the captures still being written
+    if (m_FrameReadback)
+    {
+        delete m_FrameReadback;
+        m_FrameReadback = nullptr;
+    }
+
+    if (m_TextureStreamer)
+    {
+        delete m_TextureStreamer;
+        m_TextureStreamer = nullptr;
+    }
+
+    if (m_HudRenderer)
+    {
+        delete m_HudRenderer;
+        m_HudRenderer = nullptr;
+    }
+
+    if (m_ClusteredLighting)
+    {
+        delete m_ClusteredLighting;
+        m_ClusteredLighting = nullptr;
+    }
+
+    if (m_SceneBuffer)
+    {
+        delete m_SceneBuffer;
+        m_SceneBuffer = nullptr;
+    }
+
+    if (m_MaterialRegistry)
+    {
+        delete m_MaterialRegistry;
+        m_MaterialRegistry = nullptr;
+    }
+
+    if (m_FenceTimeline)
+    {
+        ReleaseSceneColor();
+        ReleaseRenderTargets();
+    }
+
+    if (m_Swapchain)
+    {
+        vkDestroySwapchainKHR(m_Device, m_Swapchain, nullptr);
+        m_Swapchain = VK_NULL_HANDLE;
+    }
+
+    for (VkSemaphore semaphore : m_RenderFinished)
+        vkDestroySemaphore(m_Device, semaphore, nullptr);
+
+    m_RenderFinished.clear();
+
+    if (m_Surface)
+    {
+        vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+        m_Surface = VK_NULL_HANDLE;
+    }
+
+    if (m_TimestampPool)
+    {
+        vkDestroyQueryPool(m_Device, m_TimestampPool, nullptr);
+        m_TimestampPool = VK_NULL_HANDLE;
+    }
+
+    if (m_Pipeline)
+    {
+        vkDestroyPipeline(m_Device, m_Pipeline, nullptr);
+        m_Pipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_UpscalePipeline)
+    {
+        vkDestroyPipeline(m_Device, m_UpscalePipeline, nullptr);
+        m_UpscalePipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_HudPipeline)
+    {
+        vkDestroyPipeline(m_Device, m_HudPipeline, nullptr);
+        m_HudPipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_PipelineLayout)
+    {
+        vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+        m_PipelineLayout = VK_NULL_HANDLE;
+    }
+
+    // Frees the descriptor sets along with it
+    if (m_DescriptorPool)
+    {
+        vkDestroyDescriptorPool(m_Device, m_DescriptorPool, nullptr);
+        m_DescriptorPool = VK_NULL_HANDLE;
+    }
+
+    if (m_FrameSetLayout)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_FrameSetLayout, nullptr);
+        m_FrameSetLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_TextureSetLayout)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_TextureSetLayout, nullptr);
+        m_TextureSetLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_LinearSampler)
+    {
+        vkDestroySampler(m_Device, m_LinearSampler, nullptr);
+        m_LinearSampler = VK_NULL_HANDLE;
+    }
+
+    if (m_ClampSampler)
+    {
+        vkDestroySampler(m_Device, m_ClampSampler, nullptr);
+        m_ClampSampler = VK_NULL_HANDLE;
+    }
+
+    DestroyBuffer(m_Device, m_VertexBuffer);
+    DestroyBuffer(m_Device, m_IndexBuffer);
+    DestroyBuffer(m_Device, m_UniformBuffer);
+}
+
+void Renderer::UpdateDescriptorSets()
+{
+    FrameResources& frameResources = m_Frames[m_FrameIndex];
+
+    // Buffers may have been replaced by a larger one since this frame's set
+    // was last used, point it at the current ones
+    const VkDeviceSize uniformOffset = VkDeviceSize(m_FrameIndex) * s_UniformSliceSize;
+
+    const VkDescriptorBufferInfo uniformInfos[] = {
+        { m_UniformBuffer.Buffer, uniformOffset, sizeof(FrameConstants) },
+        { m_UniformBuffer.Buffer, uniformOffset + s_LightingConstantsOffset, sizeof(ClusterConstants) },
+    };
+
+    const VkDescriptorBufferInfo storageInfos[] = {
+        { m_SceneBuffer->GetBuffer(), 0, VK_WHOLE_SIZE },
+        { m_MaterialRegistry->GetBuffer(), 0, VK_WHOLE_SIZE },
+        { m_TextureStreamer->GetDescriptorTable(), 0, VK_WHOLE_SIZE },
+        { m_ClusteredLighting->GetLightBuffer(m_FrameIndex).Buffer, 0, VK_WHOLE_SIZE },
+        { m_ClusteredLighting->GetClusterBuffer(m_FrameIndex).Buffer, 0, VK_WHOLE_SIZE },
+        { m_ClusteredLighting->GetLightIndexBuffer(m_FrameIndex).Buffer, 0, VK_WHOLE_SIZE },
+        { m_HudRenderer->GetQuadBuffer().Buffer, m_FrameIndex * VulkanHudRenderer::s_QuadSliceSize, VulkanHudRenderer::s_QuadSliceSize },
+        { m_HudRenderer->GetFontBuffer().Buffer, 0, VK_WHOLE_SIZE },
+    };
+
+    VkWriteDescriptorSet writes[2] = {};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = frameResources.FrameSet;
+    writes[0].descriptorCount = 1;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+    // The storage buffers have consecutive bindings, which one write covers
+    writes[1] = writes[0];
+    writes[1].dstBinding = s_SceneBufferBinding;
+    writes[1].descriptorCount = static_cast<uint32_t>(std::size(storageInfos));
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[1].pBufferInfo = storageInfos;
+
+    for (uint32_t i = 0; i < std::size(uniformInfos); ++i)
+    {
+        writes[0].dstBinding = i == 0 ? s_FrameConstantsBinding : s_LightingConstantsBinding;
+        writes[0].pBufferInfo = &uniformInfos[i];
+        vkUpdateDescriptorSets(m_Device, 1, &writes[0], 0, nullptr);
+    }
+
+    vkUpdateDescriptorSets(m_Device, 1, &writes[1], 0, nullptr);
+
+    // The texture set only changes when a texture or the scene color does
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+
+    const uint64_t textureVersion = m_TextureStreamer->GetDescriptorVersion();
+    if (frameResources.TextureVersion == textureVersion && frameResources.SceneColorVersion == m_SceneColorVersion)
+        return;
+
+    ArenaVector<VkDescriptorImageInfo> imageInfos = FrameArenas::MakeVector<VkDescriptorImageInfo>(s_BindlessTextureCount, MemoryTag::Textures);
+    ArenaVector<uint32_t> elements = FrameArenas::MakeVector<uint32_t>(s_BindlessTextureCount, MemoryTag::Textures);
+
+    imageInfos.push_back({ VK_NULL_HANDLE, m_SceneColor.View, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+    elements.push_back(s_SceneColorDescriptor);
+
+    // Slots of unloaded textures keep their stale view, the descriptor table
+    // no longer leads any shader to them
+    for (TextureHandle texture = 0; texture < VulkanTextureStreamer::s_MaxTextures; ++texture)
+    {
+        const VkImageView view = m_TextureStreamer->GetView(texture);
+        if (view == VK_NULL_HANDLE)
+            continue;
+
+        imageInfos.push_back({ VK_NULL_HANDLE, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+        elements.push_back(s_FirstTextureDescriptor + texture);
+    }
+
+    ArenaVector<VkWriteDescriptorSet> imageWrites = FrameArenas::MakeVector<VkWriteDescriptorSet>(imageInfos.size(), MemoryTag::Textures);
+    imageWrites.resize(imageInfos.size());
+
+    for (size_t i = 0; i < imageInfos.size(); ++i)
+    {
+        VkWriteDescriptorSet& write = imageWrites[i];
+        write = {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = frameResources.TextureSet;
+        write.dstBinding = s_BindlessTexturesBinding;
+        write.dstArrayElement = elements[i];
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        write.pImageInfo = &imageInfos[i];
+    }
+
+    vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(imageWrites.size()), imageWrites.data(), 0, nullptr);
+
+    frameResources.TextureVersion = textureVersion;
+    frameResources.SceneColorVersion = m_SceneColorVersion;
+}
+
+void Renderer::SetupCommands(const FrameSnapshot& frame, VkCommandBuffer commandBuffer)
+{
+    FrameResources& frameResources = m_Frames[m_FrameIndex];
+
+    // GPU time of the whole frame, read back once these frame resources are
+    // reused
+    if (m_TimestampPool)
+    {
+        vkCmdResetQueryPool(commandBuffer, m_TimestampPool, m_FrameIndex * 2, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_TimestampPool, m_FrameIndex * 2);
+    }
+
+    // Upload textures that finished reading before anything samples them.
+    // Replaced resources are released once this frame's fence value
+    // completes.
+    {
+        std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+
+        for (const TextureRequest& request : frame.TextureRequests)
+            m_TextureStreamer->RequestScreenSize(request.Texture, request.ScreenPixels);
+
+        m_TextureStreamer->Update(commandBuffer);
+    }
+
+    // Only objects and materials that changed since the last upload are
+    // copied
+    m_SceneBuffer->Upload(commandBuffer);
+
+    {
+        std::lock_guard<std::mutex> lock(m_MaterialMutex);
+        m_MaterialRegistry->Upload(commandBuffer);
+    }
+
+    // The uploads above may have replaced buffers
+    UpdateDescriptorSets();
+
+    // The scene covers the top left of the scene color target at the current
+    // resolution scale
+    const uint32_t sceneWidth = std::max(1u, static_cast<uint32_t>(m_Width * m_ResolutionScale + 0.5f));
+    const uint32_t sceneHeight = std::max(1u, static_cast<uint32_t>(m_Height * m_ResolutionScale + 0.5f));
+
+    const VkViewport sceneViewport = FlippedViewport(sceneWidth, sceneHeight);
+    const VkRect2D sceneRect = { { 0, 0 }, { sceneWidth, sceneHeight } };
+
+    const ClusterConstants clusterConstants = m_ClusteredLighting->GetConstants(sceneWidth, sceneHeight);
+    memcpy(m_UniformBuffer.Mapped + m_FrameIndex * s_UniformSliceSize + s_LightingConstantsOffset, &clusterConstants, sizeof(clusterConstants));
+
+    // Draw the scene into the scene color target. Its previous contents are
+    // never needed, only the rendered area is cleared and read.
+    TransitionImage(commandBuffer, m_SceneColor.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    VkRenderingAttachmentInfo sceneAttachment = {};
+    sceneAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    sceneAttachment.imageView = m_SceneColor.View;
+    sceneAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    sceneAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    sceneAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    sceneAttachment.clearValue.color = s_ClearColor;
+
+    VkRenderingInfo sceneRendering = {};
+    sceneRendering.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    sceneRendering.renderArea = sceneRect;
+    sceneRendering.layerCount = 1;
+    sceneRendering.colorAttachmentCount = 1;
+    sceneRendering.pColorAttachments = &sceneAttachment;
+
+    vkCmdBeginRendering(commandBuffer, &sceneRendering);
+
+    // Everything is bound once per frame, draws only change the object index
+    const VkDescriptorSet descriptorSets[] = { frameResources.FrameSet, frameResources.TextureSet };
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, static_cast<uint32_t>(std::size(descriptorSets)), descriptorSets, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+    vkCmdSetViewport(commandBuffer, 0, 1, &sceneViewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &sceneRect);
+
+    const VkDeviceSize vertexOffset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_VertexBuffer.Buffer, &vertexOffset);
+    vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer.Buffer, 0, VK_INDEX_TYPE_UINT32);
+
+    for (const DrawPacket& draw : frame.Draws)
+    {
+        vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(uint32_t), &draw.ObjectIndex);
+        vkCmdDrawIndexed(commandBuffer, draw.IndexCount, 1, draw.StartIndex, draw.BaseVertex, 0);
+    }
+
+    vkCmdEndRendering(commandBuffer);
+
+    // Upscale into the target image, which covers all of it so nothing is
+    // cleared
+    VkImage target = m_TargetImages[m_TargetIndex];
+
+    TransitionImage(commandBuffer, m_SceneColor.Image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    TransitionImage(commandBuffer, target, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+    VkRenderingAttachmentInfo targetAttachment = {};
+    targetAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    targetAttachment.imageView = m_TargetViews[m_TargetIndex];
+    targetAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    targetAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    targetAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+    VkRenderingInfo targetRendering = {};
+    targetRendering.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    targetRendering.renderArea = m_SurfaceSize;
+    targetRendering.layerCount = 1;
+    targetRendering.colorAttachmentCount = 1;
+    targetRendering.pColorAttachments = &targetAttachment;
+
+    vkCmdBeginRendering(commandBuffer, &targetRendering);
+
+    UpscaleConstants upscale;
+    upscale.UVScale[0] = static_cast<float>(sceneWidth) / m_Width;
+    upscale.UVScale[1] = static_cast<float>(sceneHeight) / m_Height;
+    upscale.UVMax[0] = (sceneWidth - 0.5f) / m_Width;
+    upscale.UVMax[1] = (sceneHeight - 0.5f) / m_Height;
+    upscale.SourceDescriptor = s_SceneColorDescriptor;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_UpscalePipeline);
+    vkCmdSetViewport(commandBuffer, 0, 1, &m_Viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &m_SurfaceSize);
+    vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(UpscaleConstants), &upscale);
+    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+
+    // The HUD goes on top at native resolution, every glyph and graph bar in
+    // one instanced draw of six vertices per quad
+    if (frame.View.ShowHud)
+    {
+        const uint32_t quadCount = m_HudRenderer->Write(m_FrameIndex, m_Width, m_Height);
+
+        HudConstants hud;
+        hud.InverseTargetSize[0] = 1.0f / m_Width;
+        hud.InverseTargetSize[1] = 1.0f / m_Height;
+
+        // The fragment stage's range overlaps these bytes, so it is named too
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_HudPipeline);
+        vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(HudConstants), &hud);
+        vkCmdDraw(commandBuffer, 6, quadCount, 0, 0);
+    }
+
+    vkCmdEndRendering(commandBuffer);
+
+    // Offscreen targets stay where the frame left them, the next frame
+    // discards their contents anyway
+    VkImageLayout targetLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    // A capture of a frame that couldn't be shown is taken from this one
+    const std::string& capturePath = frame.CapturePath.empty() ? m_PendingCapturePath : frame.CapturePath;
+
+    if (!capturePath.empty())
+    {
+        // Copy the finished frame into a readback buffer on the way. Most
+        // swapchains are BGRA, PNGs are RGBA.
+        TransitionImage(commandBuffer, target, targetLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        targetLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        m_FrameReadback->Capture(commandBuffer, target, m_Width, m_Height, m_TargetFormat == VK_FORMAT_B8G8R8A8_UNORM, capturePath);
+        m_PendingCapturePath.clear();
+    }
+
+    // Indicate that the swapchain image will now be used to present
+    if (m_Swapchain)
+        TransitionImage(commandBuffer, target, targetLayout, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    if (m_TimestampPool)
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampPool, m_FrameIndex * 2 + 1);
+        frameResources.TimestampsPending = true;
+    }
+}
+
+void Renderer::DestroyCommands()
+{
+    if (m_FenceTimeline)
+    {
+        // Shutdown is the one place that has to wait for the GPU to finish,
+        // presents included
+        vkDeviceWaitIdle(m_Device);
+        m_FenceTimeline->WaitForIdle();
+    }
+}
+
+void Renderer::SetupSwapchain(unsigned width, unsigned height)
+{
+    if (!m_Headless)
+    {
+        VkBool32 presentSupported = VK_FALSE;
+        ThrowIfFailed(vkGetPhysicalDeviceSurfaceSupportKHR(m_PhysicalDevice, m_QueueFamily, m_Surface, &presentSupported));
+        if (!presentSupported)
+            throw std::runtime_error("The Vulkan queue can't present to the window!");
+
+        VkSurfaceCapabilitiesKHR capabilities;
+        ThrowIfFailed(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_PhysicalDevice, m_Surface, &capabilities));
+
+        // The surface may dictate its size
+        if (capabilities.currentExtent.width != 0xffffffff)
+        {
+            width = clamp(capabilities.currentExtent.width, 1u, 0xffffu);
+            height = clamp(capabilities.currentExtent.height, 1u, 0xffffu);
+        }
+        else
+        {
+            width = clamp(width, std::max(capabilities.minImageExtent.width, 1u), capabilities.maxImageExtent.width);
+            height = clamp(height, std::max(capabilities.minImageExtent.height, 1u), capabilities.maxImageExtent.height);
+        }
+
+        m_Width = width;
+        m_Height = height;
+
+        // The pipelines were built for the first format, which a surface's
+        // formats don't change from
+        if (m_TargetFormat == VK_FORMAT_UNDEFINED)
+        {
+            uint32_t formatCount = 0;
+            vkGetPhysicalDeviceSurfaceFormatsKHR(m_PhysicalDevice, m_Surface, &formatCount, nullptr);
+            std::vector<VkSurfaceFormatKHR> formats(formatCount);
+            vkGetPhysicalDeviceSurfaceFormatsKHR(m_PhysicalDevice, m_Surface, &formatCount, formats.data());
+
+            for (const VkSurfaceFormatKHR& format : formats)
+            {
+                if (format.colorSpace != VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+                    continue;
+
+                if (format.format == VK_FORMAT_R8G8B8A8_UNORM || (format.format == VK_FORMAT_B8G8R8A8_UNORM && m_TargetFormat == VK_FORMAT_UNDEFINED))
+                    m_TargetFormat = format.format;
+            }
+
+            if (m_TargetFormat == VK_FORMAT_UNDEFINED)
+                throw std::runtime_error("The window has no RGBA8 or BGRA8 surface format!");
+        }
+
+        uint32_t imageCount = std::max(capabilities.minImageCount, s_BackbufferCount);
+        if (capabilities.maxImageCount > 0)
+            imageCount = std::min(imageCount, capabilities.maxImageCount);
+
+        VkSwapchainCreateInfoKHR swapchainInfo = {};
+        swapchainInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+        swapchainInfo.surface = m_Surface;
+        swapchainInfo.minImageCount = imageCount;
+        swapchainInfo.imageFormat = m_TargetFormat;
+        swapchainInfo.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+        swapchainInfo.imageExtent = { width, height };
+        swapchainInfo.imageArrayLayers = 1;
+        swapchainInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+        swapchainInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        swapchainInfo.preTransform = capabilities.currentTransform;
+        swapchainInfo.compositeAlpha = (capabilities.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR)
+                                           ? VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR
+                                           : static_cast<VkCompositeAlphaFlagBitsKHR>(capabilities.supportedCompositeAlpha & ~(capabilities.supportedCompositeAlpha - 1));
+        // Vsync, like presenting with a sync interval of 1
+        swapchainInfo.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+        swapchainInfo.clipped = VK_TRUE;
+        swapchainInfo.oldSwapchain = m_Swapchain;
+
+        VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+        ThrowIfFailed(vkCreateSwapchainKHR(m_Device, &swapchainInfo, nullptr, &swapchain));
+
+        // Every frame using the old one has completed
+        if (m_Swapchain)
+            vkDestroySwapchainKHR(m_Device, m_Swapchain, nullptr);
+
+        m_Swapchain = swapchain;
+
+        uint32_t swapchainImageCount = 0;
+        vkGetSwapchainImagesKHR(m_Device, m_Swapchain, &swapchainImageCount, nullptr);
+        m_TargetImages.resize(swapchainImageCount);
+        vkGetSwapchainImagesKHR(m_Device, m_Swapchain, &swapchainImageCount, m_TargetImages.data());
+
+        for (VkImage image : m_TargetImages)
+        {
+            VkImageViewCreateInfo viewInfo = {};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = m_TargetFormat;
+            viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+            VkImageView view = VK_NULL_HANDLE;
+            ThrowIfFailed(vkCreateImageView(m_Device, &viewInfo, nullptr, &view));
+            m_TargetViews.push_back(view);
+        }
+
+        // A present may still wait on a semaphore after its frame has
+        // completed, so they are only ever added to
+        while (m_RenderFinished.size() < swapchainImageCount)
+        {
+            VkSemaphoreCreateInfo semaphoreInfo = {};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+            VkSemaphore semaphore = VK_NULL_HANDLE;
+            ThrowIfFailed(vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &semaphore));
+            m_RenderFinished.push_back(semaphore);
+        }
+    }
+    else
+    {
+        CreateOffscreenTargets();
+    }
+
+    m_SurfaceSize = { { 0, 0 }, { m_Width, m_Height } };
+    m_Viewport = FlippedViewport(m_Width, m_Height);
+}
+
+void Renderer::Resize(unsigned width, unsigned height)
+{
+    // Dragging a window edge sends dozens of these per frame, only remember
+    // the latest size and rebuild the swapchain once in ApplyPendingResize.
+    m_PendingWidth = width;
+    m_PendingHeight = height;
+    m_ResizePending = true;
+}
+
+void Renderer::ApplyPendingResize()
+{
+    if (!m_ResizePending && !m_SwapchainOutOfDate)
+        return;
+
+    const unsigned width = m_ResizePending ? clamp(m_PendingWidth, 1u, 0xffffu) : m_Width;
+    const unsigned height = m_ResizePending ? clamp(m_PendingHeight, 1u, 0xffffu) : m_Height;
+
+    if (width == m_Width && height == m_Height && !m_SwapchainOutOfDate)
+    {
+        m_ResizePending = false;
+        return;
+    }
+
+    // The old swapchain's images and views are destroyed below, which is
+    // only valid once no submitted frame uses them. Wait for the last frame
+    // that rendered to one, the newest of the frames' fence values. Uploads
+    // and streaming signaled after it keep running.
+    uint64_t lastFrameFenceValue = 0;
+    for (const FrameResources& frame : m_Frames)
+        lastFrameFenceValue = std::max(lastFrameFenceValue, frame.FenceValue);
+
+    m_FenceTimeline->WaitFor(lastFrameFenceValue);
+
+    m_ResizePending = false;
+    m_SwapchainOutOfDate = false;
+    m_Width = width;
+    m_Height = height;
+
+    ReleaseRenderTargets();
+    ReleaseSceneColor();
+    SetupSwapchain(width, height);
+    CreateSceneColor();
+
+    // Frame times measured at the old size say little about the new one
+    m_ResolutionController.Reset(m_ResolutionScale);
+}
+
+void Renderer::RenderFrame(const FrameSnapshot& frame)
+{
+    // Transient allocations of the frame before last are done with
+    FrameArenas::BeginFrame();
+
+    const auto frameStart = std::chrono::steady_clock::now();
+
+    // Release resources and run callbacks of frames the GPU has finished
+    m_FenceTimeline->Poll();
+
+    for (const SceneObjectUpdate& update : frame.ObjectUpdates)
+        m_SceneBuffer->Update(update.Index, update.Object);
+
+    if (frame.View.Width > 0 && frame.View.Height > 0)
+        Resize(frame.View.Width, frame.View.Height);
+
+    // Resizes requested since the last frame are applied here, once. Their
+    // wait for the frames in flight counts as fence wait.
+    const auto waitStart = std::chrono::steady_clock::now();
+    ApplyPendingResize();
+
+    FrameResources& frameResources = m_Frames[m_FrameIndex];
+
+    // The command pool, descriptor sets and uniform slice of this frame are
+    // reused, wait for the frame that last used them. With vsync this is
+    // where the render thread is paced.
+    m_FenceTimeline->WaitFor(frameResources.FenceValue);
+    m_LastFenceWait = std::chrono::steady_clock::now() - waitStart;
+
+    UpdateMemoryBudget();
+
+    // Pick this frame's resolution from the GPU time of the last frame that
+    // used these resources. The measurement lags the scale by the frames in
+    // flight, the controller's smoothing and step limits absorb that.
+    ReadGpuFrameTime();
+
+    if (frame.View.FrameBudgetMs > 0.0f)
+    {
+        if (frame.View.FrameBudgetMs != m_ResolutionController.GetDesc().TargetFrameMs)
+            m_ResolutionController.SetTargetFrameMs(frame.View.FrameBudgetMs);
+
+        if (m_LastGpuFrameMs > 0.0f)
+            m_ResolutionScale = m_ResolutionController.Update(m_LastGpuFrameMs);
+    }
+    else if (m_ResolutionScale != 1.0f)
+    {
+        m_ResolutionScale = 1.0f;
+        m_ResolutionController.Reset(m_ResolutionScale);
+    }
+
+    UpdateHudStats(frame);
+    m_LastFrameStart = frameStart;
+
+    if (m_Swapchain)
+    {
+        VkResult result = vkAcquireNextImageKHR(m_Device, m_Swapchain, UINT64_MAX, frameResources.ImageAvailable, VK_NULL_HANDLE, &m_TargetIndex);
+
+        // The window changed size before the game thread noticed, rebuild
+        // the swapchain and try once more
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            m_SwapchainOutOfDate = true;
+            ApplyPendingResize();
+            result = vkAcquireNextImageKHR(m_Device, m_Swapchain, UINT64_MAX, frameResources.ImageAvailable, VK_NULL_HANDLE, &m_TargetIndex);
+        }
+
+        // Still changing, this frame can't be shown. Its capture is taken
+        // from the next one instead.
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            m_SwapchainOutOfDate = true;
+            if (!frame.CapturePath.empty())
+                m_PendingCapturePath = frame.CapturePath;
+            return;
+        }
+
+        if (result != VK_SUBOPTIMAL_KHR)
+            ThrowIfFailed(result);
+    }
+    else
+    {
+        // Offscreen targets take turns like the frames in flight
+        m_TargetIndex = m_FrameIndex;
+    }
+
+    // Update Uniforms
+    UboVS = frame.Constants;
+    memcpy(m_UniformBuffer.Mapped + m_FrameIndex * s_UniformSliceSize, &UboVS, sizeof(UboVS));
+
+    // Bin the lights into this frame's cluster buffers, on the worker
+    // threads
+    m_ClusteredLighting->Update(m_FrameIndex, frame.Lights, frame.Constants.ViewMatrix, frame.Constants.ProjectionMatrix, m_ThreadPool);
+
+    ThrowIfFailed(vkResetCommandPool(m_Device, frameResources.CommandPool, 0));
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    ThrowIfFailed(vkBeginCommandBuffer(frameResources.CommandBuffer, &beginInfo));
+
+    SetupCommands(frame, frameResources.CommandBuffer);
+
+    ThrowIfFailed(vkEndCommandBuffer(frameResources.CommandBuffer));
+
+    // Don't wait for the frame, the next use of these frame resources does
+    if (m_Swapchain)
+    {
+        VkSemaphore renderFinished = m_RenderFinished[m_TargetIndex];
+        frameResources.FenceValue = m_FenceTimeline->Submit(frameResources.CommandBuffer, frameResources.ImageAvailable, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, renderFinished);
+
+        VkPresentInfoKHR presentInfo = {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &renderFinished;
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &m_Swapchain;
+        presentInfo.pImageIndices = &m_TargetIndex;
+
+        const VkResult result = vkQueuePresentKHR(m_Queue, &presentInfo);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+            m_SwapchainOutOfDate = true;
+        else
+            ThrowIfFailed(result);
+    }
+    else
+    {
+        frameResources.FenceValue = m_FenceTimeline->Submit(frameResources.CommandBuffer);
+    }
+
+    if (m_TimeToFirstFrameMs == 0.0)
+        ReportFirstFrame();
+
+    // Every draw is recorded into a single submission on the one queue
+    const uint32_t drawCount = static_cast<uint32_t>(frame.Draws.size());
+    m_CommandCacheStats.CachedDraws = 0;
+    m_CommandCacheStats.RecordedDraws = drawCount;
+    m_CommandCacheStats.TotalRecordedDraws += drawCount;
+
+    m_QueueSchedulerStats.Passes = 1;
+    m_QueueSchedulerStats.Signals = 1;
+    m_QueueSchedulerStats.Submissions = 1;
+
+    m_FrameIndex = (m_FrameIndex + 1) % s_BackbufferCount;
+}
+
+void Renderer::UpdateMemoryBudget()
+{
+    if (!m_HasMemoryBudget)
+        return;
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT heapBudgets = {};
+    heapBudgets.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2 memoryProperties = {};
+    memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memoryProperties.pNext = &heapBudgets;
+    vkGetPhysicalDeviceMemoryProperties2(m_PhysicalDevice, &memoryProperties);
+
+    // Device local heaps are what DXGI calls the local segment group
+    ResidencyBudget budget;
+    for (uint32_t heap = 0; heap < memoryProperties.memoryProperties.memoryHeapCount; ++heap)
+    {
+        if (!(memoryProperties.memoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+            continue;
+
+        budget.Budget += heapBudgets.heapBudget[heap];
+        budget.Usage += heapBudgets.heapUsage[heap];
+    }
+
+    m_ResidencyPlanner.UpdateBudget(budget);
+}
+
+void Renderer::FlushCaptures()
+{
+    m_FrameReadback->WaitIdle();
+}
+
+void Renderer::ReportFirstFrame()
+{
+    m_TimeToFirstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_StartupStart).count();
+
+    // From the end of startup until the first frame was presented, on the
+    // row of the thread that ran startup
+    TaskTiming firstFrame;
+    firstFrame.Name = "First Frame";
+    firstFrame.StartMs = m_StartupMs;
+    firstFrame.EndMs = m_TimeToFirstFrameMs;
+    m_StartupTimings.push_back(firstFrame);
+
+    std::cout << "Time to first frame: " << m_TimeToFirstFrameMs << " ms\n";
+
+    // Open it in chrome://tracing or Perfetto
+    std::ofstream trace("startup_trace.json");
+    WriteChromeTrace(trace, m_StartupTimings);
+}
+
+void Renderer::ReadGpuFrameTime()
+{
+    // A sample is only used once, the controller never sees it twice
+    m_LastGpuFrameMs = 0.0f;
+
+    FrameResources& frameResources = m_Frames[m_FrameIndex];
+    if (!frameResources.TimestampsPending)
+        return;
+
+    frameResources.TimestampsPending = false;
+
+    // The frame has completed, the results are available without waiting
+    uint64_t timestamps[2];
+    if (vkGetQueryPoolResults(m_Device, m_TimestampPool, m_FrameIndex * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return;
+
+    if (timestamps[1] > timestamps[0])
+        m_LastGpuFrameMs = static_cast<float>(double(timestamps[1] - timestamps[0]) * m_TimestampPeriod / 1000000.0);
+}
+
+TextureHandle Renderer::LoadTexture(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+    return m_TextureStreamer->Load(path);
+}
+
+void Renderer::UnloadTexture(TextureHandle texture)
+{
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+    m_TextureStreamer->Unload(texture);
+}
+
+void Renderer::SetTextureBudget(uint64_t budgetBytes)
+{
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+    m_TextureBudget = budgetBytes;
+    UpdateTextureBudget();
+}
+
+void Renderer::UpdateTextureBudget()
+{
+    uint64_t budgetBytes = m_TextureBudget;
+
+    // Textures get what the OS budget leaves after everything else
+    const ResidencyStats& residency = m_ResidencyPlanner.GetStats();
+    if (residency.BudgetBytes > 0)
+    {
+        const uint64_t textureBytes = m_TextureStreamer->GetStats().ResidentBytes;
+        const uint64_t otherBytes = residency.UsageBytes > textureBytes ? residency.UsageBytes - textureBytes : 0;
+        const uint64_t availableBytes = residency.BudgetBytes > otherBytes ? residency.BudgetBytes - otherBytes : 0;
+
+        budgetBytes = std::min(budgetBytes, availableBytes);
+    }
+
+    m_TextureStreamer->SetBudget(budgetBytes);
+}
+
+void Renderer::UpdateHudStats(const FrameSnapshot& frame)
+{
+    HudFrameStats stats;
+
+    if (m_LastFrameStart != std::chrono::steady_clock::time_point())
+        stats.CpuFrameMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_LastFrameStart).count();
+
+    stats.GpuFrameMs = m_LastGpuFrameMs;
+    stats.ResolutionScale = m_ResolutionScale;
+
+    stats.Draws = static_cast<uint32_t>(frame.Draws.size());
+    for (const DrawPacket& draw : frame.Draws)
+        stats.Triangles += draw.IndexCount / 3;
+
+    {
+        std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+
+        const TextureStreamingStats& textures = m_TextureStreamer->GetStats();
+        stats.TextureResidentBytes = textures.ResidentBytes;
+        stats.TextureBudgetBytes = textures.BudgetBytes;
+    }
+
+    const ResidencyStats& residency = m_ResidencyPlanner.GetStats();
+    stats.VideoMemoryUsageBytes = residency.UsageBytes;
+    stats.VideoMemoryBudgetBytes = residency.BudgetBytes;
+
+    stats.Memory = MemoryTracking::GetLastFrame();
+
+    m_HudRenderer->AddFrame(stats);
+}
+
+TextureStreamingStats Renderer::GetTextureStreamingStats()
+{
+    std::lock_guard<std::mutex> lock(m_TextureStreamerMutex);
+    return m_TextureStreamer->GetStats();
+}
+
+MaterialHandle Renderer::CreateMaterial(const MaterialDesc& desc)
+{
+    std::lock_guard<std::mutex> lock(m_MaterialMutex);
+    return m_MaterialRegistry->Create(desc);
+}
+
+void Renderer::UpdateMaterial(MaterialHandle material, const MaterialDesc& desc)
+{
+    std::lock_guard<std::mutex> lock(m_MaterialMutex);
+    m_MaterialRegistry->Update(material, desc);
+}
+
+void Renderer::DestroyMaterial(MaterialHandle material)
+{
+    std::lock_guard<std::mutex> lock(m_MaterialMutex);
+    m_MaterialRegistry->Destroy(material);
+}
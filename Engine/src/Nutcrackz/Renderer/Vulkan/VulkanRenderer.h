@@ -0,0 +1,434 @@
+#pragma once
+
+#include "CrossWindow/CrossWindow.h"
+
+#define GLM_FORCE_SSE42 1
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 1
+#define GLM_FORCE_LEFT_HANDED
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Nutcrackz/Core/TaskGraph.h"
+#include "Nutcrackz/Core/ThreadPool.h"
+#include "Nutcrackz/Renderer/FrameSnapshot.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+#include "Nutcrackz/Renderer/ResidencyPlanner.h"
+#include "Nutcrackz/Renderer/ResolutionController.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanClusteredLighting.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanFenceTimeline.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanFrameReadback.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanHelpers.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanHudRenderer.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanMaterialRegistry.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanPersistentBuffer.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanTextureStreamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+// Renderer
+
+// Vulkan implementation, see Renderer.h. Needs Vulkan 1.3 for timeline
+// semaphores, dynamic rendering and descriptor indexing. The shaders are the
+// same HLSL as on DirectX 12, compiled to SPIR-V by the build.
+class Renderer
+{
+  public:
+    Renderer(xwin::Window& window);
+
+    // Frames are rendered into offscreen targets instead of a swapchain and
+    // only leave the GPU through FrameSnapshot::CapturePath
+    Renderer(const HeadlessDesc& desc);
+
+    ~Renderer();
+
+    // Render a frame snapshot onto the render target. Called on the render
+    // thread, see RenderThread.
+    void RenderFrame(const FrameSnapshot& frame);
+
+    // Request a new surface size. Any number of requests within a frame are
+    // applied once, at the start of the next rendered frame. Render thread
+    // only, the game thread passes its size through FrameSnapshot::View.
+    void Resize(unsigned width, unsigned height);
+
+    // Block until every frame captured so far has been written. Render thread
+    // only.
+    void FlushCaptures();
+
+    // Time the last RenderFrame spent waiting on the GPU
+    std::chrono::nanoseconds GetLastFenceWait() const { return m_LastFenceWait; }
+
+    // Load a DDS/KTX2 texture. Its mips are streamed in by screen size, see
+    // VulkanTextureStreamer. Safe to call from the game thread.
+    TextureHandle LoadTexture(const std::string& path);
+
+    // Release the texture once frames already submitted are done with it
+    void UnloadTexture(TextureHandle texture);
+
+    // Only reported in the texture streaming stats, nothing is evicted
+    void SetTextureBudget(uint64_t budgetBytes);
+
+    TextureStreamingStats GetTextureStreamingStats();
+
+    // Materials are referenced by SceneObject::MaterialIndex. Edits reach the
+    // GPU with the next rendered frame. Safe to call from the game thread.
+    MaterialHandle CreateMaterial(const MaterialDesc& desc);
+
+    void UpdateMaterial(MaterialHandle material, const MaterialDesc& desc);
+
+    void DestroyMaterial(MaterialHandle material);
+
+    // Draws are recorded every frame, there are no bundles to replay them
+    // from. Read it on the render thread, or after it has stopped.
+    const CommandCacheStats& GetCommandCacheStats() const { return m_CommandCacheStats; }
+
+    // Scene buffer uploads of the last frame and in total. Read it on the
+    // render thread, or after it has stopped.
+    const PersistentBufferStats& GetSceneBufferStats() const { return m_SceneBuffer->GetStats(); }
+
+    // Everything is submitted to a single queue, so there are never cross
+    // queue waits. Read it on the render thread, or after it has stopped.
+    const QueueSchedulerStats& GetQueueSchedulerStats() const { return m_QueueSchedulerStats; }
+
+    // Fraction of the surface size the scene was last rendered at along each
+    // axis, and the GPU time of the latest frame that has finished. Read
+    // them on the render thread, or after it has stopped.
+    float GetResolutionScale() const { return m_ResolutionScale; }
+
+    float GetLastGpuFrameMs() const { return m_LastGpuFrameMs; }
+
+    // Lights, clusters and time spent binning the last frame's lights. Read
+    // it on the render thread, or after it has stopped.
+    const LightBinningStats& GetLightBinningStats() const { return m_ClusteredLighting->GetStats(); }
+
+    // When each startup task ran and on which thread, followed by a "First
+    // Frame" entry once a frame has been presented. Times are since startup
+    // began. Also written to startup_trace.json in the working directory
+    // after the first frame. Read them on the render thread, or after it has
+    // stopped.
+    const std::vector<TaskTiming>& GetStartupTimings() const { return m_StartupTimings; }
+
+    // From the start of the constructor until the first present, 0 before
+    double GetTimeToFirstFrameMs() const { return m_TimeToFirstFrameMs; }
+
+    // Video memory budget and usage when the device reports them through
+    // VK_EXT_memory_budget. Nothing is evicted, Vulkan has no equivalent of
+    // D3D12's Evict. Read it on the render thread, or after it has stopped.
+    const ResidencyStats& GetResidencyStats() const { return m_ResidencyPlanner.GetStats(); }
+
+    // Frames captured and written. Safe to call from any thread.
+    FrameReadbackStats GetFrameReadbackStats() { return m_FrameReadback->GetStats(); }
+
+  protected:
+    // Build and run the startup task graph, without a window when headless
+    void Startup(xwin::Window* window);
+
+    // Wait for the GPU and release everything, also what a failed Startup
+    // got to create
+    void Shutdown();
+
+    // Startup tasks, run by the constructor as a task graph. Each may only
+    // touch what the tasks it depends on created.
+
+    // Instance, physical device, device and queue
+    void CreateDevice();
+
+    // Fence timeline and the per frame command buffers and semaphores
+    void CreateQueues();
+
+    // Surface, swapchain and its image views, or the offscreen targets when
+    // headless
+    void CreateSwapchain(xwin::Window* window);
+
+    // Texture streamer, scene buffer, materials, lighting and readback
+    void CreateResourceManagers();
+
+    // Query the video memory budget, once per frame
+    void UpdateMemoryBudget();
+
+    // The texture budget is the lower of SetTextureBudget's and what the
+    // video memory budget leaves. Called with the streamer's lock held.
+    void UpdateTextureBudget();
+
+    // Samplers, descriptor set layouts, the pipeline layout and the
+    // descriptor sets of every frame
+    void CreatePipelineLayout();
+
+    // A pipeline with the shared layout and render state, drawing into
+    // colorFormat and blending by source alpha when alphaBlend is set
+    VkPipeline CreatePipeline(const std::vector<char>& vertexShader, const std::vector<char>& pixelShader, bool vertexInput, VkFormat colorFormat, bool alphaBlend = false);
+
+    // Uniform, vertex and index buffers
+    void CreateGeometryBuffers();
+
+    void CreateTimestampQueries();
+
+    // Destroy the device and everything created along with it
+    void DestroyAPI();
+
+    // Destroy any resources used in this example
+    void DestroyResources();
+
+    // Record the commands that draw the frame
+    void SetupCommands(const FrameSnapshot& frame, VkCommandBuffer commandBuffer);
+
+    // Point this frame's descriptor sets at the buffers and textures it uses
+    void UpdateDescriptorSets();
+
+    // Wait for all submitted commands
+    void DestroyCommands();
+
+    // Create the swapchain, replacing the current one, and its image views
+    void SetupSwapchain(unsigned width, unsigned height);
+
+    // A render target in place of a swapchain image, when headless
+    void CreateOffscreenTargets();
+
+    void ReleaseRenderTargets();
+
+    // (Re)create the offscreen target the scene is drawn into at the current
+    // surface size
+    void CreateSceneColor();
+
+    void ReleaseSceneColor();
+
+    // Read the timestamps of the frame that last used these frame resources
+    void ReadGpuFrameTime();
+
+    // Hand the frame's timings, counts and memory use to the HUD
+    void UpdateHudStats(const FrameSnapshot& frame);
+
+    // Record the time to first frame and write the startup trace
+    void ReportFirstFrame();
+
+    // Rebuild the swapchain if a resize was requested since the last frame.
+    // Waits once for the frames still using the old images, the frame
+    // itself is always rendered.
+    void ApplyPendingResize();
+
+    struct Vertex
+    {
+        float Position[3];
+        float Color[3];
+        float TexCoord[2];
+    };
+
+    Vertex m_VertexBufferData[3] = {
+        { {  1.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f } },
+        { { -1.0f, -1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f } },
+        { {  0.0f,  1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.5f, 0.0f } }
+    };
+
+    uint32_t m_IndexBufferData[3] = {0, 1, 2};
+
+    // Uniform data
+    FrameConstants UboVS;
+
+    static const uint32_t s_BackbufferCount = 2;
+
+    // Descriptor bindings, the HLSL registers shifted by the shader build:
+    // b registers keep their number, t registers start at 16 and s registers
+    // at 32. Register spaces are descriptor sets.
+    static const uint32_t s_FrameConstantsBinding = 0;
+    static const uint32_t s_LightingConstantsBinding = 3;
+    static const uint32_t s_SceneBufferBinding = 16;
+    static const uint32_t s_MaterialBufferBinding = 17;
+    static const uint32_t s_TextureTableBinding = 18;
+    static const uint32_t s_LightBufferBinding = 19;
+    static const uint32_t s_ClusterBufferBinding = 20;
+    static const uint32_t s_LightIndexBufferBinding = 21;
+    static const uint32_t s_HudQuadBufferBinding = 22;
+    static const uint32_t s_HudFontBinding = 23;
+    static const uint32_t s_LinearSamplerBinding = 32;
+    static const uint32_t s_ClampSamplerBinding = 33;
+
+    // Set 1 only holds the bindless textures
+    static const uint32_t s_BindlessTexturesBinding = 16;
+
+    // The scene color comes first, streamed textures follow it
+    static const uint32_t s_SceneColorDescriptor = 0;
+    static const uint32_t s_FirstTextureDescriptor = 1;
+    static const uint32_t s_BindlessTextureCount = s_FirstTextureDescriptor + VulkanTextureStreamer::s_MaxTextures;
+
+    // Matches the upscale shader's push constants
+    struct UpscaleConstants
+    {
+        float UVScale[2];
+
+        // Last texel center inside the rendered area, keeps bilinear
+        // filtering from reading past it
+        float UVMax[2];
+
+        uint32_t SourceDescriptor;
+    };
+
+    // Matches the HUD shader's push constants
+    struct HudConstants
+    {
+        float InverseTargetSize[2];
+    };
+
+    // Each frame gets its own slice of the uniform buffer with the frame
+    // constants followed by the cluster constants, both 256 byte aligned
+    static const uint32_t s_LightingConstantsOffset = 256;
+    static const uint32_t s_UniformSliceSize = 512;
+
+    static_assert(sizeof(FrameConstants) <= s_LightingConstantsOffset, "frame constants overlap the cluster constants");
+    static_assert(s_LightingConstantsOffset + sizeof(ClusterConstants) <= s_UniformSliceSize, "cluster constants overflow the uniform slice");
+
+    static const uint64_t s_DefaultTextureBudget = 256ull * 1024 * 1024;
+
+    // Captured frames on their way to the CPU before Capture has to wait
+    static const uint32_t s_ReadbackBufferCount = 4;
+
+    // Scene objects the scene buffer holds before it first grows
+    static const uint32_t s_InitialSceneCapacity = 1024;
+
+    xwin::Window* m_Window;
+    unsigned m_Width, m_Height;
+
+    // No window, see HeadlessDesc
+    bool m_Headless;
+    bool m_UseSoftwareRasterizer;
+
+    // Latest size requested through Resize
+    unsigned m_PendingWidth, m_PendingHeight;
+    bool m_ResizePending;
+
+    // Initialization
+    VkInstance m_Instance;
+    VkPhysicalDevice m_PhysicalDevice;
+    VkDevice m_Device;
+    uint32_t m_QueueFamily;
+
+    // Graphics, transfer and present all happen on this queue
+    VkQueue m_Queue;
+
+    // Swapchain, or the offscreen targets when headless
+    VkSurfaceKHR m_Surface;
+    VkSwapchainKHR m_Swapchain;
+    VkFormat m_TargetFormat;
+    std::vector<VkImage> m_TargetImages;
+    std::vector<VkImageView> m_TargetViews;
+    std::vector<VulkanImage> m_OffscreenTargets;
+
+    // Signalled by each swapchain image's frame and waited on by its present
+    std::vector<VkSemaphore> m_RenderFinished;
+
+    // Image the current frame renders into
+    uint32_t m_TargetIndex;
+
+    // Acquire or present reported the swapchain no longer matches the
+    // surface, it is rebuilt like on a resize
+    bool m_SwapchainOutOfDate;
+
+    // Capture of a frame dropped because the swapchain was out of date
+    std::string m_PendingCapturePath;
+
+    // Resources
+    VkViewport m_Viewport;
+    VkRect2D m_SurfaceSize;
+
+    VulkanBuffer m_VertexBuffer;
+    VulkanBuffer m_IndexBuffer;
+
+    // One slice per frame, see s_UniformSliceSize
+    VulkanBuffer m_UniformBuffer;
+
+    // Per object data, persistent across frames
+    VulkanPersistentBuffer* m_SceneBuffer;
+
+    // Edited from the game thread, uploaded on the render thread
+    VulkanMaterialRegistry* m_MaterialRegistry;
+    std::mutex m_MaterialMutex;
+
+    VkSampler m_LinearSampler;
+    VkSampler m_ClampSampler;
+    VkDescriptorSetLayout m_FrameSetLayout;
+    VkDescriptorSetLayout m_TextureSetLayout;
+    VkDescriptorPool m_DescriptorPool;
+    VkPipelineLayout m_PipelineLayout;
+    VkPipeline m_Pipeline;
+
+    // Dynamic resolution. The scene is drawn into the top left of an
+    // offscreen target the size of the surface, then upscaled into the
+    // target image, so changing the scale never reallocates anything.
+    VulkanImage m_SceneColor;
+    uint64_t m_SceneColorVersion;
+    VkPipeline m_UpscalePipeline;
+    ResolutionController m_ResolutionController;
+    float m_ResolutionScale;
+
+    // A timestamp at the start and end of each frame's commands
+    VkQueryPool m_TimestampPool;
+    float m_TimestampPeriod;
+    float m_LastGpuFrameMs;
+
+    // Lights binned into view clusters for the fragment shader
+    VulkanClusteredLighting* m_ClusteredLighting;
+
+    // Frames copied back and written as PNGs
+    VulkanFrameReadback* m_FrameReadback;
+
+    // Drawn over the upscaled frame when FrameSnapshot::View asks for it
+    VulkanHudRenderer* m_HudRenderer;
+    VkPipeline m_HudPipeline;
+
+    // Start of the last RenderFrame, for the HUD's CPU frame time
+    std::chrono::steady_clock::time_point m_LastFrameStart;
+
+    CommandCacheStats m_CommandCacheStats;
+    QueueSchedulerStats m_QueueSchedulerStats;
+
+    // Background work such as texture reads
+    ThreadPool m_ThreadPool;
+    VulkanTextureStreamer* m_TextureStreamer;
+
+    // The streamer is updated on the render thread while the game thread
+    // may load textures
+    std::mutex m_TextureStreamerMutex;
+
+    // Set through SetTextureBudget
+    uint64_t m_TextureBudget;
+
+    // Only tracks the budget, no objects are under residency management
+    ResidencyPlanner m_ResidencyPlanner;
+    bool m_HasMemoryBudget;
+
+    // Everything a frame in flight owns, reused once its fence value has
+    // completed
+    struct FrameResources
+    {
+        VkCommandPool CommandPool = VK_NULL_HANDLE;
+        VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+
+        // Signalled when the swapchain image is ready to be rendered to
+        VkSemaphore ImageAvailable = VK_NULL_HANDLE;
+
+        VkDescriptorSet FrameSet = VK_NULL_HANDLE;
+        VkDescriptorSet TextureSet = VK_NULL_HANDLE;
+
+        // Versions the texture set was last written for
+        uint64_t TextureVersion = ~0ull;
+        uint64_t SceneColorVersion = ~0ull;
+
+        uint64_t FenceValue = 0;
+        bool TimestampsPending = false;
+    };
+
+    // Sync
+    uint32_t m_FrameIndex;
+    FrameResources m_Frames[s_BackbufferCount];
+    VulkanFenceTimeline* m_FenceTimeline;
+    std::chrono::nanoseconds m_LastFenceWait;
+
+    // Startup
+    std::chrono::steady_clock::time_point m_StartupStart;
+    double m_StartupMs;
+    double m_TimeToFirstFrameMs;
+    std::vector<TaskTiming> m_StartupTimings;
+};
@@ -0,0 +1,446 @@
+#include "VulkanTextureStreamer.h"
+
+#include "Nutcrackz/Core/FrameArenas.h"
+#include "Nutcrackz/Core/LinearArena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// Helper functions
+
+namespace
+{
+VkFormat GetVkFormat(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8: return VK_FORMAT_R8G8B8A8_UNORM;
+    case TextureFormat::RGBA8_SRGB: return VK_FORMAT_R8G8B8A8_SRGB;
+    case TextureFormat::BC1: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case TextureFormat::BC1_SRGB: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+    case TextureFormat::BC2: return VK_FORMAT_BC2_UNORM_BLOCK;
+    case TextureFormat::BC2_SRGB: return VK_FORMAT_BC2_SRGB_BLOCK;
+    case TextureFormat::BC3: return VK_FORMAT_BC3_UNORM_BLOCK;
+    case TextureFormat::BC3_SRGB: return VK_FORMAT_BC3_SRGB_BLOCK;
+    case TextureFormat::BC4: return VK_FORMAT_BC4_UNORM_BLOCK;
+    case TextureFormat::BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TextureFormat::BC6H: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+    case TextureFormat::BC7: return VK_FORMAT_BC7_UNORM_BLOCK;
+    case TextureFormat::BC7_SRGB: return VK_FORMAT_BC7_SRGB_BLOCK;
+    default: return VK_FORMAT_UNDEFINED;
+    }
+}
+}
+
+// Texture Streaming
+
+VulkanTextureStreamer::VulkanTextureStreamer(VkDevice device, VkPhysicalDevice physicalDevice, ThreadPool& threadPool, VulkanFenceTimeline& fenceTimeline, uint32_t firstDescriptor, uint64_t budgetBytes)
+    : m_Device(device), m_PhysicalDevice(physicalDevice), m_ThreadPool(threadPool), m_FenceTimeline(fenceTimeline), m_FirstDescriptor(firstDescriptor),
+      m_DescriptorTable(device, physicalDevice, fenceTimeline, sizeof(uint32_t), s_MaxTextures), m_BudgetBytes(budgetBytes)
+{
+    m_Textures.reserve(s_MaxTextures);
+    m_Stats.BudgetBytes = m_BudgetBytes;
+
+    // Handles that were never loaded must not index the descriptor array
+    for (TextureHandle handle = 0; handle < s_MaxTextures; ++handle)
+        m_DescriptorTable.Update(handle, ~0u);
+}
+
+VulkanTextureStreamer::~VulkanTextureStreamer()
+{
+    // Reads in flight still reference this streamer
+    m_ThreadPool.WaitIdle();
+
+    for (StreamedTexture& texture : m_Textures)
+        m_FenceTimeline.Release(texture.Image);
+
+    m_Textures.clear();
+}
+
+TextureHandle VulkanTextureStreamer::Load(const std::string& path)
+{
+    if (m_FreeHandles.empty() && m_Textures.size() >= s_MaxTextures)
+        throw std::runtime_error("too many streamed textures!");
+
+    StreamedTexture texture;
+    texture.Desc = ReadTextureFileDesc(path);
+
+    const VkFormat format = GetVkFormat(texture.Desc.Format);
+
+    VkFormatProperties formatProperties = {};
+    if (format != VK_FORMAT_UNDEFINED)
+        vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &formatProperties);
+
+    // Block compressed formats are optional, software rasterizers may not
+    // sample them
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+        throw std::runtime_error("unsupported texture format!");
+
+    const uint32_t mipCount = static_cast<uint32_t>(texture.Desc.Mips.size());
+
+    // The tail starts at the first mip that is small enough to always keep
+    texture.TailMip = mipCount - 1;
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        const TextureMip& level = texture.Desc.Mips[mip];
+
+        if (std::max(level.Width, level.Height) <= s_TailMipSize)
+        {
+            texture.TailMip = mip;
+            break;
+        }
+    }
+
+    texture.ResidentMip = mipCount;
+    texture.DesiredMip = texture.TailMip;
+    texture.Loaded = true;
+
+    TextureHandle handle;
+    if (!m_FreeHandles.empty())
+    {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+
+        texture.Generation = m_Textures[handle].Generation;
+        m_Textures[handle] = std::move(texture);
+    }
+    else
+    {
+        handle = static_cast<TextureHandle>(m_Textures.size());
+        m_Textures.push_back(std::move(texture));
+    }
+
+    // The tail is needed no matter what, so it bypasses the budget
+    QueueRead(handle, m_Textures[handle].TailMip, mipCount - 1);
+
+    return handle;
+}
+
+void VulkanTextureStreamer::Unload(TextureHandle texture)
+{
+    if (texture >= m_Textures.size() || !m_Textures[texture].Loaded)
+        return;
+
+    StreamedTexture& streamed = m_Textures[texture];
+
+    // A read still in flight is dropped when it completes, its bytes are
+    // given back now
+    m_Stats.ResidentBytes -= GetChainBytes(streamed, streamed.ResidentMip) + streamed.PendingBytes;
+
+    // Frames recorded so far may still sample it
+    if (streamed.Image.Image != VK_NULL_HANDLE)
+    {
+        m_FenceTimeline.Release(streamed.Image);
+        m_DescriptorVersion++;
+    }
+
+    StreamedTexture unloaded;
+    unloaded.Generation = streamed.Generation + 1;
+    streamed = std::move(unloaded);
+
+    m_DescriptorTable.Update(texture, ~0u);
+    m_FreeHandles.push_back(texture);
+}
+
+void VulkanTextureStreamer::RequestScreenSize(TextureHandle texture, float screenPixels)
+{
+    if (texture >= m_Textures.size() || !m_Textures[texture].Loaded)
+        return;
+
+    StreamedTexture& streamed = m_Textures[texture];
+
+    // One texel per pixel: every mip above that is wasted on this frame.
+    uint32_t mip = streamed.TailMip;
+    if (screenPixels > 0.0f)
+    {
+        const float texels = static_cast<float>(std::max(streamed.Desc.Width, streamed.Desc.Height));
+        const float level = std::floor(std::log2(std::max(texels / screenPixels, 1.0f)));
+        mip = std::min(static_cast<uint32_t>(level), streamed.TailMip);
+    }
+
+    if (streamed.LastUsedFrame != m_FrameNumber)
+    {
+        streamed.LastUsedFrame = m_FrameNumber;
+        streamed.DesiredMip = mip;
+    }
+    else
+    {
+        streamed.DesiredMip = std::min(streamed.DesiredMip, mip);
+    }
+}
+
+void VulkanTextureStreamer::Update(VkCommandBuffer commandBuffer)
+{
+    m_Stats.EvictedMips = 0;
+
+    // Upload mips that finished reading
+    {
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        m_Uploading.swap(m_Completed);
+    }
+
+    for (CompletedRead& read : m_Uploading)
+    {
+        StreamedTexture& texture = m_Textures[read.Texture];
+        m_Stats.PendingRequests--;
+
+        // The texture was unloaded while reading, Unload gave the bytes back
+        if (read.Generation != texture.Generation)
+            continue;
+
+        texture.Pending = false;
+
+        if (!read.Error.empty())
+        {
+            std::cout << "Failed to stream " << texture.Desc.Path << ": " << read.Error << "\n";
+            m_Stats.ResidentBytes -= texture.PendingBytes;
+            texture.PendingBytes = 0;
+            texture.Failed = true;
+            continue;
+        }
+
+        texture.PendingBytes = 0;
+
+        Reallocate(commandBuffer, read.Texture, read.FirstMip, &read.Data);
+    }
+
+    m_Uploading.clear();
+
+    // Gather textures that want more detail than they have, biggest deficit
+    // first so the most visibly blurry textures are served before the rest.
+    ArenaVector<TextureHandle> requests = FrameArenas::MakeVector<TextureHandle>(m_Textures.size(), MemoryTag::Textures);
+    uint64_t requestedBytes = 0;
+
+    for (TextureHandle handle = 0; handle < m_Textures.size(); ++handle)
+    {
+        const StreamedTexture& texture = m_Textures[handle];
+        if (!texture.Loaded)
+            continue;
+
+        const uint32_t demanded = GetDemandedMip(texture);
+
+        requestedBytes += GetChainBytes(texture, demanded);
+
+        if (!texture.Pending && !texture.Failed && demanded < texture.ResidentMip)
+            requests.push_back(handle);
+    }
+
+    std::sort(requests.begin(), requests.end(), [this](TextureHandle a, TextureHandle b) {
+        const StreamedTexture& ta = m_Textures[a];
+        const StreamedTexture& tb = m_Textures[b];
+        return ta.ResidentMip - GetDemandedMip(ta) > tb.ResidentMip - GetDemandedMip(tb);
+    });
+
+    for (TextureHandle handle : requests)
+    {
+        const StreamedTexture& texture = m_Textures[handle];
+        const uint64_t residentBytes = GetChainBytes(texture, texture.ResidentMip);
+
+        // If the budget can't fit the whole request, settle for fewer mips
+        for (uint32_t mip = GetDemandedMip(texture); mip < texture.ResidentMip; ++mip)
+        {
+            if (MakeRoom(commandBuffer, GetChainBytes(texture, mip) - residentBytes, handle))
+            {
+                QueueRead(handle, mip, texture.ResidentMip - 1);
+                break;
+            }
+        }
+    }
+
+    // Shaders see this frame's descriptors
+    m_DescriptorTable.Upload(commandBuffer);
+
+    m_Stats.RequestedBytes = requestedBytes;
+    m_Stats.BudgetBytes = m_BudgetBytes;
+    m_Stats.BudgetPressure = m_BudgetBytes > 0 ? static_cast<float>(double(requestedBytes) / double(m_BudgetBytes)) : 0.0f;
+
+    m_FrameNumber++;
+}
+
+void VulkanTextureStreamer::SetBudget(uint64_t budgetBytes)
+{
+    m_BudgetBytes = budgetBytes;
+    m_Stats.BudgetBytes = budgetBytes;
+}
+
+VkImageView VulkanTextureStreamer::GetView(TextureHandle texture) const
+{
+    return texture < m_Textures.size() ? m_Textures[texture].Image.View : VK_NULL_HANDLE;
+}
+
+uint32_t VulkanTextureStreamer::GetResidentMip(TextureHandle texture) const
+{
+    return m_Textures[texture].ResidentMip;
+}
+
+uint64_t VulkanTextureStreamer::GetChainBytes(const StreamedTexture& texture, uint32_t mip) const
+{
+    uint64_t bytes = 0;
+    for (size_t level = mip; level < texture.Desc.Mips.size(); ++level)
+        bytes += texture.Desc.Mips[level].Size;
+
+    return bytes;
+}
+
+uint32_t VulkanTextureStreamer::GetDemandedMip(const StreamedTexture& texture) const
+{
+    return texture.LastUsedFrame == m_FrameNumber ? texture.DesiredMip : texture.TailMip;
+}
+
+void VulkanTextureStreamer::QueueRead(TextureHandle texture, uint32_t firstMip, uint32_t lastMip)
+{
+    StreamedTexture& streamed = m_Textures[texture];
+    streamed.Pending = true;
+    streamed.PendingBytes = GetChainBytes(streamed, firstMip) - GetChainBytes(streamed, lastMip + 1);
+
+    m_Stats.ResidentBytes += streamed.PendingBytes;
+    m_Stats.PendingRequests++;
+
+    // The read gets its own copy of the description, the texture array may
+    // change while the job runs.
+    m_ThreadPool.Submit([this, texture, generation = streamed.Generation, firstMip, lastMip, desc = streamed.Desc]() {
+        CompletedRead read;
+        read.Texture = texture;
+        read.Generation = generation;
+        read.FirstMip = firstMip;
+        read.LastMip = lastMip;
+
+        try
+        {
+            read.Data = ReadTextureMips(desc, firstMip, lastMip);
+        }
+        catch (std::exception& e)
+        {
+            read.Error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(m_CompletedMutex);
+        m_Completed.push_back(std::move(read));
+    });
+}
+
+bool VulkanTextureStreamer::MakeRoom(VkCommandBuffer commandBuffer, uint64_t bytes, TextureHandle requester)
+{
+    if (m_Stats.ResidentBytes + bytes <= m_BudgetBytes)
+        return true;
+
+    // Candidates hold more detail than this frame asks of them
+    ArenaVector<TextureHandle> victims = FrameArenas::MakeVector<TextureHandle>(m_Textures.size(), MemoryTag::Textures);
+    for (TextureHandle handle = 0; handle < m_Textures.size(); ++handle)
+    {
+        const StreamedTexture& texture = m_Textures[handle];
+
+        if (handle != requester && texture.Loaded && !texture.Pending && texture.ResidentMip < GetDemandedMip(texture))
+            victims.push_back(handle);
+    }
+
+    std::sort(victims.begin(), victims.end(), [this](TextureHandle a, TextureHandle b) {
+        return m_Textures[a].LastUsedFrame < m_Textures[b].LastUsedFrame;
+    });
+
+    for (TextureHandle handle : victims)
+    {
+        if (m_Stats.ResidentBytes + bytes <= m_BudgetBytes)
+            break;
+
+        const StreamedTexture& texture = m_Textures[handle];
+        const uint32_t demanded = GetDemandedMip(texture);
+
+        m_Stats.EvictedMips += demanded - texture.ResidentMip;
+        Reallocate(commandBuffer, handle, demanded, nullptr);
+    }
+
+    return m_Stats.ResidentBytes + bytes <= m_BudgetBytes;
+}
+
+void VulkanTextureStreamer::Reallocate(VkCommandBuffer commandBuffer, TextureHandle texture, uint32_t residentMip, const std::vector<uint8_t>* data)
+{
+    StreamedTexture& streamed = m_Textures[texture];
+    const TextureFileDesc& desc = streamed.Desc;
+    const uint32_t mipCount = static_cast<uint32_t>(desc.Mips.size());
+    const uint32_t oldResidentMip = streamed.ResidentMip;
+    const VulkanImage oldImage = streamed.Image;
+
+    // Evicting only changes the accounting here, streamed in mips were
+    // accounted for when their read was queued.
+    if (residentMip > oldResidentMip)
+        m_Stats.ResidentBytes -= GetChainBytes(streamed, oldResidentMip) - GetChainBytes(streamed, residentMip);
+
+    const VulkanImage image = CreateImage(m_Device, m_PhysicalDevice, desc.Mips[residentMip].Width, desc.Mips[residentMip].Height, mipCount - residentMip,
+                                          GetVkFormat(desc.Format), VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+    TransitionImage(commandBuffer, image.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    // Keep the mips both images share
+    if (oldImage.Image != VK_NULL_HANDLE)
+    {
+        TransitionImage(commandBuffer, oldImage.Image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+        const uint32_t firstShared = std::max(residentMip, oldResidentMip);
+        const uint32_t sharedCount = mipCount - firstShared;
+
+        ScopedStack stack;
+        VkImageCopy* copies = stack.Allocate<VkImageCopy>(sharedCount, MemoryTag::Textures);
+
+        for (uint32_t i = 0; i < sharedCount; ++i)
+        {
+            const uint32_t mip = firstShared + i;
+            const TextureMip& level = desc.Mips[mip];
+
+            VkImageCopy& copy = copies[i];
+            copy = {};
+            copy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - oldResidentMip, 0, 1 };
+            copy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - residentMip, 0, 1 };
+            copy.extent = { level.Width, level.Height, 1 };
+        }
+
+        vkCmdCopyImage(commandBuffer, oldImage.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, sharedCount, copies);
+
+        // Frames recorded so far still sample it through their own
+        // descriptor sets
+        m_FenceTimeline.Release(oldImage);
+    }
+
+    // Upload the newly read mips, data holds [residentMip, oldResidentMip)
+    if (data && residentMip < oldResidentMip)
+    {
+        const uint32_t uploadCount = oldResidentMip - residentMip;
+
+        // Released as soon as the copies have completed
+        VulkanBuffer staging = CreateBuffer(m_Device, m_PhysicalDevice, data->size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        memcpy(staging.Mapped, data->data(), data->size());
+
+        // The mips are back to back with tightly packed rows
+        ScopedStack stack;
+        VkBufferImageCopy* regions = stack.Allocate<VkBufferImageCopy>(uploadCount, MemoryTag::Textures);
+        VkDeviceSize offset = 0;
+
+        for (uint32_t i = 0; i < uploadCount; ++i)
+        {
+            const TextureMip& level = desc.Mips[residentMip + i];
+
+            VkBufferImageCopy& region = regions[i];
+            region = {};
+            region.bufferOffset = offset;
+            region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 };
+            region.imageExtent = { level.Width, level.Height, 1 };
+
+            offset += level.Size;
+        }
+
+        vkCmdCopyBufferToImage(commandBuffer, staging.Buffer, image.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, uploadCount, regions);
+
+        m_FenceTimeline.Release(staging);
+    }
+
+    TransitionImage(commandBuffer, image.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    streamed.Image = image;
+    streamed.ResidentMip = residentMip;
+
+    m_DescriptorTable.Update(texture, m_FirstDescriptor + texture);
+    m_DescriptorVersion++;
+}
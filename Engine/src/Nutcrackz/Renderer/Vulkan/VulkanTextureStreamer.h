@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Nutcrackz/Core/ThreadPool.h"
+#include "Nutcrackz/Renderer/RendererCommon.h"
+#include "Nutcrackz/Renderer/TextureFile.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanFenceTimeline.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanHelpers.h"
+#include "Nutcrackz/Renderer/Vulkan/VulkanPersistentBuffer.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Texture Streaming
+
+// The Vulkan counterpart of TextureStreamer. Loads DDS/KTX2 textures with
+// only their mip tail resident, then streams finer mips in and out based on
+// how large each texture is on screen. When resident memory would exceed the
+// budget the least recently used textures give up their finest mips first.
+//
+// Residency changes recreate the image with the new mip count and copy the
+// mips that stay resident. Replaced images are released through the fence
+// timeline once the GPU is done with them.
+//
+// Each texture has a fixed bindless index, firstDescriptor plus its handle.
+// Shaders find it through the descriptor table, a buffer indexed by texture
+// handle that holds the bindless index of resident textures. The renderer
+// writes the image views into the descriptor sets of the frame it records
+// whenever GetDescriptorVersion changes, frames in flight keep the views
+// they were recorded with.
+class VulkanTextureStreamer
+{
+  public:
+    VulkanTextureStreamer(VkDevice device, VkPhysicalDevice physicalDevice, ThreadPool& threadPool, VulkanFenceTimeline& fenceTimeline, uint32_t firstDescriptor, uint64_t budgetBytes);
+
+    ~VulkanTextureStreamer();
+
+    // Read the texture's header and queue its mip tail for upload
+    TextureHandle Load(const std::string& path);
+
+    // Free the texture's memory once the GPU stops using it, the handle may
+    // be reused by a later Load
+    void Unload(TextureHandle texture);
+
+    // Report the texture's on screen size (in pixels along its largest axis)
+    // for this frame. The largest report of the frame wins.
+    void RequestScreenSize(TextureHandle texture, float screenPixels);
+
+    // Upload finished reads, evict over budget, queue new reads and upload the
+    // changed descriptor table entries. Copies are recorded into
+    // commandBuffer, outside of rendering.
+    void Update(VkCommandBuffer commandBuffer);
+
+    void SetBudget(uint64_t budgetBytes);
+
+    // View of the resident mips of a texture, null before its tail arrives
+    VkImageView GetView(TextureHandle texture) const;
+
+    // Most detailed mip currently resident, mip count if nothing is
+    uint32_t GetResidentMip(TextureHandle texture) const;
+
+    // Incremented whenever a view is added or removed
+    uint64_t GetDescriptorVersion() const { return m_DescriptorVersion; }
+
+    // Buffer of s_MaxTextures bindless indices, ~0u for handles without a
+    // resident texture
+    VkBuffer GetDescriptorTable() const { return m_DescriptorTable.GetBuffer(); }
+
+    const TextureStreamingStats& GetStats() const { return m_Stats; }
+
+    static const uint32_t s_MaxTextures = 1024;
+
+    // Mips whose largest side is at or below this are loaded up front and
+    // never evicted
+    static const uint32_t s_TailMipSize = 64;
+
+  protected:
+    struct StreamedTexture
+    {
+        TextureFileDesc Desc;
+        VulkanImage Image;
+
+        uint32_t ResidentMip = 0;
+        uint32_t TailMip = 0;
+        uint32_t DesiredMip = 0;
+        uint64_t LastUsedFrame = 0;
+
+        // Bytes accounted for by the read in flight
+        uint64_t PendingBytes = 0;
+
+        // Incremented on unload so reads for a previous texture in this slot
+        // are recognised
+        uint32_t Generation = 0;
+
+        bool Loaded = false;
+        bool Pending = false;
+        bool Failed = false;
+    };
+
+    struct CompletedRead
+    {
+        TextureHandle Texture;
+        uint32_t Generation;
+        uint32_t FirstMip;
+        uint32_t LastMip;
+        std::vector<uint8_t> Data;
+        std::string Error;
+    };
+
+    // Bytes of the mip chain starting at mip
+    uint64_t GetChainBytes(const StreamedTexture& texture, uint32_t mip) const;
+
+    // The mip this frame's demand asks for, the tail if it wasn't used
+    uint32_t GetDemandedMip(const StreamedTexture& texture) const;
+
+    void QueueRead(TextureHandle texture, uint32_t firstMip, uint32_t lastMip);
+
+    // Evict least recently used mips until bytes more fit in the budget
+    bool MakeRoom(VkCommandBuffer commandBuffer, uint64_t bytes, TextureHandle requester);
+
+    // Recreate the image holding mips [residentMip, mip count), copying mips
+    // that stay resident and uploading the rest from data
+    void Reallocate(VkCommandBuffer commandBuffer, TextureHandle texture, uint32_t residentMip, const std::vector<uint8_t>* data);
+
+    VkDevice m_Device;
+    VkPhysicalDevice m_PhysicalDevice;
+    ThreadPool& m_ThreadPool;
+    VulkanFenceTimeline& m_FenceTimeline;
+    uint32_t m_FirstDescriptor;
+
+    // Texture handle to bindless index
+    VulkanPersistentBuffer m_DescriptorTable;
+    uint64_t m_DescriptorVersion = 0;
+
+    std::vector<StreamedTexture> m_Textures;
+    std::vector<TextureHandle> m_FreeHandles;
+
+    std::mutex m_CompletedMutex;
+    std::vector<CompletedRead> m_Completed;
+
+    // Swapped with m_Completed by Update, the two keep their capacity
+    std::vector<CompletedRead> m_Uploading;
+
+    uint64_t m_BudgetBytes;
+    uint64_t m_FrameNumber = 1;
+
+    TextureStreamingStats m_Stats;
+};
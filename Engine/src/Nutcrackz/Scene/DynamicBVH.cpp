@@ -0,0 +1,1014 @@
+#include "DynamicBVH.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define NUTCRACKZ_BVH_SSE 1
+#endif
+
+// Helper functions
+
+namespace
+{
+const uint32_t s_SahBinCount = 16;
+
+// Deeper than this a build splits at the median, bounding its recursion
+const uint32_t s_MaxSahDepth = 48;
+
+AABB Union(const AABB& a, const AABB& b)
+{
+    AABB result;
+    result.Min = glm::vec3(std::min(a.Min.x, b.Min.x), std::min(a.Min.y, b.Min.y), std::min(a.Min.z, b.Min.z));
+    result.Max = glm::vec3(std::max(a.Max.x, b.Max.x), std::max(a.Max.y, b.Max.y), std::max(a.Max.z, b.Max.z));
+    return result;
+}
+
+// Empty boxes have no area
+float SurfaceArea(const AABB& bounds)
+{
+    const float x = std::max(bounds.Max.x - bounds.Min.x, 0.0f);
+    const float y = std::max(bounds.Max.y - bounds.Min.y, 0.0f);
+    const float z = std::max(bounds.Max.z - bounds.Min.z, 0.0f);
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+bool Overlaps(const BVHNode& node, uint32_t slot, const AABB& bounds)
+{
+    return node.MinX[slot] <= bounds.Max.x && node.MaxX[slot] >= bounds.Min.x &&
+           node.MinY[slot] <= bounds.Max.y && node.MaxY[slot] >= bounds.Min.y &&
+           node.MinZ[slot] <= bounds.Max.z && node.MaxZ[slot] >= bounds.Min.z;
+}
+
+AABB GetSlotBounds(const BVHNode& node, uint32_t slot)
+{
+    AABB bounds;
+    bounds.Min = glm::vec3(node.MinX[slot], node.MinY[slot], node.MinZ[slot]);
+    bounds.Max = glm::vec3(node.MaxX[slot], node.MaxY[slot], node.MaxZ[slot]);
+    return bounds;
+}
+
+void WriteSlotBounds(BVHNode& node, uint32_t slot, const AABB& bounds)
+{
+    node.MinX[slot] = bounds.Min.x;
+    node.MinY[slot] = bounds.Min.y;
+    node.MinZ[slot] = bounds.Min.z;
+    node.MaxX[slot] = bounds.Max.x;
+    node.MaxY[slot] = bounds.Max.y;
+    node.MaxZ[slot] = bounds.Max.z;
+}
+
+bool SlotEquals(const BVHNode& node, uint32_t slot, const AABB& bounds)
+{
+    return node.MinX[slot] == bounds.Min.x && node.MinY[slot] == bounds.Min.y && node.MinZ[slot] == bounds.Min.z &&
+           node.MaxX[slot] == bounds.Max.x && node.MaxY[slot] == bounds.Max.y && node.MaxZ[slot] == bounds.Max.z;
+}
+
+// Inside out, so it neither overlaps anything nor grows a union
+AABB EmptyBounds()
+{
+    AABB bounds;
+    bounds.Min = glm::vec3(FLT_MAX);
+    bounds.Max = glm::vec3(-FLT_MAX);
+    return bounds;
+}
+
+AABB GetNodeBounds(const BVHNode& node)
+{
+    return Union(GetSlotBounds(node, 0), GetSlotBounds(node, 1));
+}
+
+// Zero direction components would turn slab distances into NaNs
+float SafeInverse(float direction)
+{
+    const float tiny = 1e-20f;
+    return 1.0f / (std::fabs(direction) > tiny ? direction : std::copysign(tiny, direction));
+}
+
+struct RaySetup
+{
+    float Origin[3];
+    float InvDirection[3];
+};
+
+RaySetup SetupRay(const BVHRay& ray)
+{
+    RaySetup setup;
+    setup.Origin[0] = ray.Origin.x;
+    setup.Origin[1] = ray.Origin.y;
+    setup.Origin[2] = ray.Origin.z;
+    setup.InvDirection[0] = SafeInverse(ray.Direction.x);
+    setup.InvDirection[1] = SafeInverse(ray.Direction.y);
+    setup.InvDirection[2] = SafeInverse(ray.Direction.z);
+    return setup;
+}
+
+// Slab test, distance is where the ray enters the slot's box
+bool IntersectSlot(const BVHNode& node, uint32_t slot, const RaySetup& ray, float maxDistance, float& distance)
+{
+    const float t1x = (node.MinX[slot] - ray.Origin[0]) * ray.InvDirection[0];
+    const float t2x = (node.MaxX[slot] - ray.Origin[0]) * ray.InvDirection[0];
+    const float t1y = (node.MinY[slot] - ray.Origin[1]) * ray.InvDirection[1];
+    const float t2y = (node.MaxY[slot] - ray.Origin[1]) * ray.InvDirection[1];
+    const float t1z = (node.MinZ[slot] - ray.Origin[2]) * ray.InvDirection[2];
+    const float t2z = (node.MaxZ[slot] - ray.Origin[2]) * ray.InvDirection[2];
+
+    const float tNear = std::max(std::max(std::min(t1x, t2x), std::min(t1y, t2y)), std::max(std::min(t1z, t2z), 0.0f));
+    const float tFar = std::min(std::min(std::max(t1x, t2x), std::max(t1y, t2y)), std::min(std::max(t1z, t2z), maxDistance));
+
+    distance = tNear;
+    return tNear <= tFar;
+}
+
+// Traversal stack, spills to the heap in trees that grew deep between
+// rebuilds
+template <typename T>
+class TraversalStack
+{
+  public:
+    void Push(const T& value)
+    {
+        if (m_Count < s_InlineCapacity)
+            m_Inline[m_Count] = value;
+        else
+            m_Overflow.push_back(value);
+
+        m_Count++;
+    }
+
+    T Pop()
+    {
+        m_Count--;
+        if (m_Count < s_InlineCapacity)
+            return m_Inline[m_Count];
+
+        const T value = m_Overflow.back();
+        m_Overflow.pop_back();
+        return value;
+    }
+
+    bool IsEmpty() const { return m_Count == 0; }
+
+  private:
+    static const uint32_t s_InlineCapacity = 64;
+
+    T m_Inline[s_InlineCapacity];
+    std::vector<T> m_Overflow;
+    uint32_t m_Count = 0;
+};
+
+struct StackEntry
+{
+    uint32_t Node;
+
+    // Where the ray enters the node's box
+    float Distance;
+};
+}
+
+// Dynamic BVH
+
+DynamicBVH::DynamicBVH(const DynamicBVHDesc& desc)
+    : m_Desc(desc)
+{
+}
+
+BVHProxy DynamicBVH::Insert(const AABB& bounds, uint32_t userData)
+{
+    BVHProxy proxy;
+    if (m_FreeProxy != s_InvalidProxy)
+    {
+        proxy = m_FreeProxy;
+        m_FreeProxy = m_Proxies[proxy].Node;
+    }
+    else
+    {
+        proxy = static_cast<BVHProxy>(m_Proxies.size());
+        m_Proxies.emplace_back();
+    }
+
+    Proxy& entry = m_Proxies[proxy];
+    entry.Bounds = bounds;
+    entry.UserData = userData;
+    entry.Generation++;
+    entry.Alive = true;
+
+    InsertLeaf(proxy);
+
+    m_ObjectCount++;
+    m_Stats.ObjectCount = m_ObjectCount;
+    m_Changed = true;
+
+    return proxy;
+}
+
+void DynamicBVH::Remove(BVHProxy proxy)
+{
+    Proxy& entry = m_Proxies[proxy];
+    RemoveLeaf(entry.Node, entry.Slot);
+
+    entry.Alive = false;
+    entry.Node = m_FreeProxy;
+    m_FreeProxy = proxy;
+
+    m_ObjectCount--;
+    m_Stats.ObjectCount = m_ObjectCount;
+    m_Changed = true;
+}
+
+void DynamicBVH::Move(BVHProxy proxy, const AABB& bounds)
+{
+    Proxy& entry = m_Proxies[proxy];
+    entry.Bounds = bounds;
+
+    WriteSlotBounds(m_Nodes[entry.Node], entry.Slot, bounds);
+    RefitUpward(entry.Node);
+
+    m_Changed = true;
+}
+
+void DynamicBVH::Update(ThreadPool& threadPool)
+{
+    if (m_Rebuild.valid())
+    {
+        if (m_Rebuild.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+
+        InstallRebuild(m_Rebuild.get());
+    }
+
+    if (!m_Changed)
+        return;
+
+    m_Changed = false;
+
+    if (++m_ChangedUpdates < m_Desc.CostCheckInterval)
+        return;
+
+    m_ChangedUpdates = 0;
+    m_Stats.Cost = ComputeCost();
+
+    if (m_ObjectCount < 2 || m_Stats.Cost <= m_Stats.RebuiltCost * m_Desc.RebuildCostRatio)
+        return;
+
+    // The job only sees its own copy of the objects, the tree stays usable
+    // while it runs
+    auto task = std::make_shared<std::packaged_task<RebuildResult()>>([items = GatherRebuildItems()]() mutable {
+        return Build(std::move(items));
+    });
+
+    m_Rebuild = task->get_future();
+    threadPool.Submit([task]() { (*task)(); });
+}
+
+void DynamicBVH::Rebuild()
+{
+    // A rebuild already running is dropped, this one sees newer boxes
+    if (m_Rebuild.valid())
+        m_Rebuild.wait();
+
+    m_Rebuild = std::future<RebuildResult>();
+    InstallRebuild(Build(GatherRebuildItems()));
+}
+
+bool DynamicBVH::RayCast(const BVHRay& ray, BVHRayHit& hit) const
+{
+    if (m_Root == s_NullNode)
+        return false;
+
+    const RaySetup setup = SetupRay(ray);
+
+    float closest = ray.MaxDistance;
+    BVHProxy closestProxy = s_InvalidProxy;
+
+    TraversalStack<StackEntry> stack;
+    stack.Push({ m_Root, 0.0f });
+
+    while (!stack.IsEmpty())
+    {
+        const StackEntry entry = stack.Pop();
+        if (entry.Distance > closest)
+            continue;
+
+        const BVHNode& node = m_Nodes[entry.Node];
+
+        float distances[2];
+        bool visit[2];
+
+        for (uint32_t slot = 0; slot < 2; ++slot)
+        {
+            const uint32_t child = node.Children[slot];
+            visit[slot] = child != s_EmptyChild && IntersectSlot(node, slot, setup, closest, distances[slot]);
+
+            // Objects are resolved right away, only nodes are visited
+            if (visit[slot] && (child & s_LeafFlag) != 0)
+            {
+                closest = distances[slot];
+                closestProxy = child & ~s_LeafFlag;
+                visit[slot] = false;
+            }
+        }
+
+        // Nearest child on top
+        if (visit[0] && visit[1])
+        {
+            const uint32_t near = distances[0] <= distances[1] ? 0 : 1;
+            stack.Push({ node.Children[1 - near], distances[1 - near] });
+            stack.Push({ node.Children[near], distances[near] });
+        }
+        else if (visit[0] || visit[1])
+        {
+            const uint32_t slot = visit[0] ? 0 : 1;
+            stack.Push({ node.Children[slot], distances[slot] });
+        }
+    }
+
+    if (closestProxy == s_InvalidProxy)
+        return false;
+
+    hit.Proxy = closestProxy;
+    hit.UserData = m_Proxies[closestProxy].UserData;
+    hit.Distance = closest;
+    return true;
+}
+
+bool DynamicBVH::RayOccluded(const BVHRay& ray) const
+{
+    if (m_Root == s_NullNode)
+        return false;
+
+    const RaySetup setup = SetupRay(ray);
+
+    TraversalStack<uint32_t> stack;
+    stack.Push(m_Root);
+
+    while (!stack.IsEmpty())
+    {
+        const BVHNode& node = m_Nodes[stack.Pop()];
+
+        for (uint32_t slot = 0; slot < 2; ++slot)
+        {
+            const uint32_t child = node.Children[slot];
+
+            float distance;
+            if (child == s_EmptyChild || !IntersectSlot(node, slot, setup, ray.MaxDistance, distance))
+                continue;
+
+            if ((child & s_LeafFlag) != 0)
+                return true;
+
+            stack.Push(child);
+        }
+    }
+
+    return false;
+}
+
+uint32_t DynamicBVH::RayCastPacket(const BVHRay (&rays)[4], BVHRayHit (&hits)[4]) const
+{
+#if defined(NUTCRACKZ_BVH_SSE)
+    if (m_Root == s_NullNode)
+        return 0;
+
+    alignas(16) float originX[4], originY[4], originZ[4];
+    alignas(16) float invX[4], invY[4], invZ[4];
+    alignas(16) float closest[4];
+    BVHProxy closestProxy[4];
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        const RaySetup setup = SetupRay(rays[i]);
+        originX[i] = setup.Origin[0];
+        originY[i] = setup.Origin[1];
+        originZ[i] = setup.Origin[2];
+        invX[i] = setup.InvDirection[0];
+        invY[i] = setup.InvDirection[1];
+        invZ[i] = setup.InvDirection[2];
+        closest[i] = rays[i].MaxDistance;
+        closestProxy[i] = s_InvalidProxy;
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 ox = _mm_load_ps(originX), oy = _mm_load_ps(originY), oz = _mm_load_ps(originZ);
+    const __m128 ix = _mm_load_ps(invX), iy = _mm_load_ps(invY), iz = _mm_load_ps(invZ);
+    __m128 closestDistance = _mm_load_ps(closest);
+
+    // A node is skipped once every ray has a hit closer than its box
+    float farthestClosest = std::max(std::max(closest[0], closest[1]), std::max(closest[2], closest[3]));
+
+    TraversalStack<StackEntry> stack;
+    stack.Push({ m_Root, 0.0f });
+
+    while (!stack.IsEmpty())
+    {
+        const StackEntry entry = stack.Pop();
+        if (entry.Distance > farthestClosest)
+            continue;
+
+        const BVHNode& node = m_Nodes[entry.Node];
+
+        float distances[2];
+        bool visit[2] = { false, false };
+
+        for (uint32_t slot = 0; slot < 2; ++slot)
+        {
+            const uint32_t child = node.Children[slot];
+            if (child == s_EmptyChild)
+                continue;
+
+            const __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.MinX[slot]), ox), ix);
+            const __m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.MaxX[slot]), ox), ix);
+            const __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.MinY[slot]), oy), iy);
+            const __m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.MaxY[slot]), oy), iy);
+            const __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.MinZ[slot]), oz), iz);
+            const __m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.MaxZ[slot]), oz), iz);
+
+            const __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)), _mm_max_ps(_mm_min_ps(t1z, t2z), zero));
+            const __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_min_ps(_mm_max_ps(t1z, t2z), closestDistance));
+
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+            if (mask == 0)
+                continue;
+
+            alignas(16) float nearDistances[4];
+            _mm_store_ps(nearDistances, tNear);
+
+            if ((child & s_LeafFlag) != 0)
+            {
+                for (unsigned lanes = mask; lanes != 0; lanes &= lanes - 1)
+                {
+                    const uint32_t lane = std::countr_zero(lanes);
+                    closest[lane] = nearDistances[lane];
+                    closestProxy[lane] = child & ~s_LeafFlag;
+                }
+
+                closestDistance = _mm_load_ps(closest);
+                farthestClosest = std::max(std::max(closest[0], closest[1]), std::max(closest[2], closest[3]));
+                continue;
+            }
+
+            // The node is as close as the nearest ray entering it
+            distances[slot] = FLT_MAX;
+            for (unsigned lanes = mask; lanes != 0; lanes &= lanes - 1)
+                distances[slot] = std::min(distances[slot], nearDistances[std::countr_zero(lanes)]);
+
+            visit[slot] = true;
+        }
+
+        if (visit[0] && visit[1])
+        {
+            const uint32_t near = distances[0] <= distances[1] ? 0 : 1;
+            stack.Push({ node.Children[1 - near], distances[1 - near] });
+            stack.Push({ node.Children[near], distances[near] });
+        }
+        else if (visit[0] || visit[1])
+        {
+            const uint32_t slot = visit[0] ? 0 : 1;
+            stack.Push({ node.Children[slot], distances[slot] });
+        }
+    }
+
+    uint32_t hitMask = 0;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        if (closestProxy[i] == s_InvalidProxy)
+            continue;
+
+        hits[i].Proxy = closestProxy[i];
+        hits[i].UserData = m_Proxies[closestProxy[i]].UserData;
+        hits[i].Distance = closest[i];
+        hitMask |= 1u << i;
+    }
+
+    return hitMask;
+#else
+    uint32_t hitMask = 0;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        if (RayCast(rays[i], hits[i]))
+            hitMask |= 1u << i;
+    }
+
+    return hitMask;
+#endif
+}
+
+void DynamicBVH::QueryAABB(const AABB& bounds, std::vector<BVHProxy>& results) const
+{
+    if (m_Root == s_NullNode)
+        return;
+
+    TraversalStack<uint32_t> stack;
+    stack.Push(m_Root);
+
+    while (!stack.IsEmpty())
+    {
+        const BVHNode& node = m_Nodes[stack.Pop()];
+
+        for (uint32_t slot = 0; slot < 2; ++slot)
+        {
+            const uint32_t child = node.Children[slot];
+            if (child == s_EmptyChild || !Overlaps(node, slot, bounds))
+                continue;
+
+            if ((child & s_LeafFlag) != 0)
+                results.push_back(child & ~s_LeafFlag);
+            else
+                stack.Push(child);
+        }
+    }
+}
+
+uint32_t DynamicBVH::AllocateNode()
+{
+    m_Stats.NodeCount++;
+
+    if (m_FreeNode == s_NullNode)
+    {
+        m_Nodes.emplace_back();
+        return static_cast<uint32_t>(m_Nodes.size() - 1);
+    }
+
+    const uint32_t node = m_FreeNode;
+    m_FreeNode = m_Nodes[node].Parent;
+    m_FreeNodeCount--;
+    return node;
+}
+
+void DynamicBVH::FreeNode(uint32_t node)
+{
+    m_Stats.NodeCount--;
+
+    // Free nodes hold nothing a traversal could reach, nor add to the cost
+    m_Nodes[node].Children[0] = s_EmptyChild;
+    m_Nodes[node].Children[1] = s_EmptyChild;
+    WriteSlotBounds(m_Nodes[node], 0, EmptyBounds());
+    WriteSlotBounds(m_Nodes[node], 1, EmptyBounds());
+    m_Nodes[node].Parent = m_FreeNode;
+    m_FreeNode = node;
+    m_FreeNodeCount++;
+}
+
+void DynamicBVH::LinkSlot(uint32_t node, uint32_t slot, uint32_t child, const AABB& bounds)
+{
+    m_Nodes[node].Children[slot] = child;
+    WriteSlotBounds(m_Nodes[node], slot, bounds);
+
+    if (child == s_EmptyChild)
+        return;
+
+    if ((child & s_LeafFlag) != 0)
+    {
+        Proxy& proxy = m_Proxies[child & ~s_LeafFlag];
+        proxy.Node = node;
+        proxy.Slot = slot;
+    }
+    else
+    {
+        m_Nodes[child].Parent = node;
+        m_Nodes[child].ParentSlot = slot;
+    }
+}
+
+void DynamicBVH::InsertLeaf(BVHProxy proxy)
+{
+    const AABB bounds = m_Proxies[proxy].Bounds;
+    const uint32_t leaf = s_LeafFlag | proxy;
+
+    if (m_Root == s_NullNode)
+    {
+        m_Root = AllocateNode();
+        m_Nodes[m_Root].Parent = s_NullNode;
+        m_Nodes[m_Root].ParentSlot = 0;
+
+        LinkSlot(m_Root, 0, leaf, bounds);
+        LinkSlot(m_Root, 1, s_EmptyChild, EmptyBounds());
+        return;
+    }
+
+    if (m_Nodes[m_Root].Children[1] == s_EmptyChild)
+    {
+        LinkSlot(m_Root, 1, leaf, bounds);
+        return;
+    }
+
+    // Walk down while pairing the object with a child is cheaper than with
+    // the whole node, Box2D's insertion cost
+    uint32_t parent = s_NullNode;
+    uint32_t parentSlot = 0;
+    uint32_t sibling = m_Root;
+
+    uint32_t current = m_Root;
+    for (;;)
+    {
+        const BVHNode& node = m_Nodes[current];
+
+        const AABB nodeBounds = GetNodeBounds(node);
+        const float combinedArea = SurfaceArea(Union(nodeBounds, bounds));
+
+        // Pairing here creates a node covering both
+        const float pairCost = 2.0f * combinedArea;
+
+        // Every node further down grows the boxes above it as well
+        const float inheritedCost = 2.0f * (combinedArea - SurfaceArea(nodeBounds));
+
+        float childCosts[2];
+        for (uint32_t slot = 0; slot < 2; ++slot)
+        {
+            const AABB childBounds = GetSlotBounds(node, slot);
+            const float childArea = SurfaceArea(Union(childBounds, bounds));
+
+            if ((node.Children[slot] & s_LeafFlag) != 0)
+                childCosts[slot] = childArea + inheritedCost;
+            else
+                childCosts[slot] = childArea - SurfaceArea(childBounds) + inheritedCost;
+        }
+
+        if (pairCost < childCosts[0] && pairCost < childCosts[1])
+            break;
+
+        const uint32_t slot = childCosts[0] <= childCosts[1] ? 0 : 1;
+        parent = current;
+        parentSlot = slot;
+        sibling = node.Children[slot];
+
+        if ((sibling & s_LeafFlag) != 0)
+            break;
+
+        current = sibling;
+    }
+
+    const AABB siblingBounds = parent == s_NullNode ? GetNodeBounds(m_Nodes[sibling]) : GetSlotBounds(m_Nodes[parent], parentSlot);
+
+    const uint32_t pair = AllocateNode();
+    LinkSlot(pair, 0, sibling, siblingBounds);
+    LinkSlot(pair, 1, leaf, bounds);
+
+    if (parent == s_NullNode)
+    {
+        m_Nodes[pair].Parent = s_NullNode;
+        m_Nodes[pair].ParentSlot = 0;
+        m_Root = pair;
+        return;
+    }
+
+    LinkSlot(parent, parentSlot, pair, GetNodeBounds(m_Nodes[pair]));
+    RefitUpward(parent);
+}
+
+void DynamicBVH::RemoveLeaf(uint32_t node, uint32_t slot)
+{
+    const uint32_t siblingSlot = 1 - slot;
+    const uint32_t sibling = m_Nodes[node].Children[siblingSlot];
+    const AABB siblingBounds = GetSlotBounds(m_Nodes[node], siblingSlot);
+
+    const uint32_t parent = m_Nodes[node].Parent;
+    const uint32_t parentSlot = m_Nodes[node].ParentSlot;
+
+    if (parent == s_NullNode)
+    {
+        if (sibling == s_EmptyChild)
+        {
+            FreeNode(node);
+            m_Root = s_NullNode;
+        }
+        else if ((sibling & s_LeafFlag) != 0)
+        {
+            // The root keeps a lone object in its first slot
+            LinkSlot(node, 0, sibling, siblingBounds);
+            LinkSlot(node, 1, s_EmptyChild, EmptyBounds());
+        }
+        else
+        {
+            m_Root = sibling;
+            m_Nodes[sibling].Parent = s_NullNode;
+            m_Nodes[sibling].ParentSlot = 0;
+            FreeNode(node);
+        }
+
+        return;
+    }
+
+    // The sibling takes the node's place
+    LinkSlot(parent, parentSlot, sibling, siblingBounds);
+    FreeNode(node);
+    RefitUpward(parent);
+}
+
+void DynamicBVH::RefitUpward(uint32_t node)
+{
+    for (;;)
+    {
+        const BVHNode& child = m_Nodes[node];
+        if (child.Parent == s_NullNode)
+            return;
+
+        const AABB bounds = GetNodeBounds(child);
+        BVHNode& parent = m_Nodes[child.Parent];
+
+        // Nothing above can change either
+        if (SlotEquals(parent, child.ParentSlot, bounds))
+            return;
+
+        WriteSlotBounds(parent, child.ParentSlot, bounds);
+        node = child.Parent;
+    }
+}
+
+float DynamicBVH::ComputeCost() const
+{
+    if (m_Root == s_NullNode)
+        return 0.0f;
+
+    const float rootArea = SurfaceArea(GetNodeBounds(m_Nodes[m_Root]));
+    if (rootArea <= 0.0f)
+        return 0.0f;
+
+    // Free nodes are inside out and add nothing
+    double area = 0.0;
+    for (const BVHNode& node : m_Nodes)
+        area += SurfaceArea(GetNodeBounds(node));
+
+    return static_cast<float>(area / rootArea);
+}
+
+std::vector<DynamicBVH::RebuildItem> DynamicBVH::GatherRebuildItems() const
+{
+    std::vector<RebuildItem> items;
+    items.reserve(m_ObjectCount);
+
+    for (BVHProxy proxy = 0; proxy < m_Proxies.size(); ++proxy)
+    {
+        const Proxy& entry = m_Proxies[proxy];
+        if (entry.Alive)
+            items.push_back({ entry.Bounds, proxy, entry.Generation, {} });
+    }
+
+    return items;
+}
+
+void DynamicBVH::InstallRebuild(RebuildResult&& result)
+{
+    m_Nodes = std::move(result.Nodes);
+    m_Root = m_Nodes.empty() ? s_NullNode : 0;
+    m_FreeNode = s_NullNode;
+    m_FreeNodeCount = 0;
+    m_Stats.NodeCount = static_cast<uint32_t>(m_Nodes.size());
+
+    // Objects inserted during the rebuild are left without a node
+    for (Proxy& proxy : m_Proxies)
+    {
+        if (proxy.Alive)
+            proxy.Node = s_NullNode;
+    }
+
+    // Point leaves at their proxies with today's boxes, objects removed
+    // during the rebuild leave an empty slot behind
+    for (uint32_t node = 0; node < m_Nodes.size(); ++node)
+    {
+        for (uint32_t slot = 0; slot < 2; ++slot)
+        {
+            const uint32_t child = m_Nodes[node].Children[slot];
+            if (child == s_EmptyChild || (child & s_LeafFlag) == 0)
+                continue;
+
+            const RebuildItem& item = result.Items[child & ~s_LeafFlag];
+            const Proxy& proxy = m_Proxies[item.Proxy];
+
+            if (proxy.Alive && proxy.Generation == item.Generation)
+                LinkSlot(node, slot, s_LeafFlag | item.Proxy, proxy.Bounds);
+            else
+                LinkSlot(node, slot, s_EmptyChild, EmptyBounds());
+        }
+    }
+
+    // Parents come before their children, so walking backwards refits bottom
+    // up and removes the emptied slots on the way
+    for (uint32_t node = static_cast<uint32_t>(m_Nodes.size()); node-- > 0;)
+    {
+        const bool empty0 = m_Nodes[node].Children[0] == s_EmptyChild;
+        const bool empty1 = m_Nodes[node].Children[1] == s_EmptyChild;
+        const uint32_t parent = m_Nodes[node].Parent;
+        const uint32_t parentSlot = m_Nodes[node].ParentSlot;
+
+        if (!empty0 && !empty1)
+        {
+            if (parent != s_NullNode)
+                WriteSlotBounds(m_Nodes[parent], parentSlot, GetNodeBounds(m_Nodes[node]));
+
+            continue;
+        }
+
+        if (empty0 && empty1)
+        {
+            if (parent == s_NullNode)
+                m_Root = s_NullNode;
+            else
+                LinkSlot(parent, parentSlot, s_EmptyChild, EmptyBounds());
+
+            FreeNode(node);
+            continue;
+        }
+
+        const uint32_t remainingSlot = empty0 ? 1 : 0;
+        const uint32_t remaining = m_Nodes[node].Children[remainingSlot];
+        const AABB remainingBounds = GetSlotBounds(m_Nodes[node], remainingSlot);
+
+        if (parent != s_NullNode)
+        {
+            LinkSlot(parent, parentSlot, remaining, remainingBounds);
+            FreeNode(node);
+        }
+        else if ((remaining & s_LeafFlag) != 0)
+        {
+            LinkSlot(node, 0, remaining, remainingBounds);
+            LinkSlot(node, 1, s_EmptyChild, EmptyBounds());
+        }
+        else
+        {
+            m_Root = remaining;
+            m_Nodes[remaining].Parent = s_NullNode;
+            m_Nodes[remaining].ParentSlot = 0;
+            FreeNode(node);
+        }
+    }
+
+    for (BVHProxy proxy = 0; proxy < m_Proxies.size(); ++proxy)
+    {
+        if (m_Proxies[proxy].Alive && m_Proxies[proxy].Node == s_NullNode)
+            InsertLeaf(proxy);
+    }
+
+    m_Stats.Cost = ComputeCost();
+    m_Stats.RebuiltCost = m_Stats.Cost;
+    m_Stats.Rebuilds++;
+    m_Stats.RebuildMs = result.BuildMs;
+    m_ChangedUpdates = 0;
+}
+
+DynamicBVH::RebuildResult DynamicBVH::Build(std::vector<RebuildItem> items)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    RebuildResult result;
+
+    for (RebuildItem& item : items)
+    {
+        item.Centroid[0] = item.Bounds.Min.x + item.Bounds.Max.x;
+        item.Centroid[1] = item.Bounds.Min.y + item.Bounds.Max.y;
+        item.Centroid[2] = item.Bounds.Min.z + item.Bounds.Max.z;
+    }
+
+    if (items.size() == 1)
+    {
+        // A lone object sits in the root's first slot
+        BVHNode root;
+        root.Children[0] = s_LeafFlag;
+        root.Children[1] = s_EmptyChild;
+        root.Parent = s_NullNode;
+        root.ParentSlot = 0;
+        WriteSlotBounds(root, 0, items[0].Bounds);
+        WriteSlotBounds(root, 1, EmptyBounds());
+        result.Nodes.push_back(root);
+    }
+    else if (items.size() > 1)
+    {
+        result.Nodes.reserve(items.size() - 1);
+
+        AABB bounds;
+        BuildSubtree(items, 0, static_cast<uint32_t>(items.size()), 0, result.Nodes, bounds);
+        result.Nodes[0].Parent = s_NullNode;
+        result.Nodes[0].ParentSlot = 0;
+    }
+
+    result.Items = std::move(items);
+    result.BuildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+uint32_t DynamicBVH::BuildSubtree(std::vector<RebuildItem>& items, uint32_t begin, uint32_t end, uint32_t depth, std::vector<BVHNode>& nodes, AABB& bounds)
+{
+    if (end - begin == 1)
+    {
+        bounds = items[begin].Bounds;
+        return s_LeafFlag | begin;
+    }
+
+    // Allocated before the children, so nodes end up depth first
+    const uint32_t node = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    float centroidMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float centroidMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            centroidMin[axis] = std::min(centroidMin[axis], items[i].Centroid[axis]);
+            centroidMax[axis] = std::max(centroidMax[axis], items[i].Centroid[axis]);
+        }
+    }
+
+    const float extents[3] = {
+        centroidMax[0] - centroidMin[0],
+        centroidMax[1] - centroidMin[1],
+        centroidMax[2] - centroidMin[2],
+    };
+
+    const uint32_t axis = extents[0] >= extents[1] && extents[0] >= extents[2] ? 0 : (extents[1] >= extents[2] ? 1 : 2);
+
+    uint32_t middle = begin;
+
+    if (extents[axis] > 0.0f && depth < s_MaxSahDepth)
+    {
+        const float axisMin = centroidMin[axis];
+        const float binScale = s_SahBinCount / extents[axis];
+        auto binOf = [&](const RebuildItem& item) {
+            const uint32_t bin = static_cast<uint32_t>((item.Centroid[axis] - axisMin) * binScale);
+            return std::min(bin, s_SahBinCount - 1);
+        };
+
+        AABB binBounds[s_SahBinCount];
+        uint32_t binCounts[s_SahBinCount] = {};
+        for (AABB& binBound : binBounds)
+            binBound = EmptyBounds();
+
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const uint32_t bin = binOf(items[i]);
+            binBounds[bin] = Union(binBounds[bin], items[i].Bounds);
+            binCounts[bin]++;
+        }
+
+        // Cost of everything right of each split plane
+        float rightCosts[s_SahBinCount];
+        AABB rightBounds = EmptyBounds();
+        uint32_t rightCount = 0;
+        for (uint32_t bin = s_SahBinCount - 1; bin > 0; --bin)
+        {
+            rightBounds = Union(rightBounds, binBounds[bin]);
+            rightCount += binCounts[bin];
+            rightCosts[bin] = rightCount * SurfaceArea(rightBounds);
+        }
+
+        float bestCost = FLT_MAX;
+        uint32_t bestSplit = 0;
+        AABB leftBounds = EmptyBounds();
+        uint32_t leftCount = 0;
+        for (uint32_t split = 1; split < s_SahBinCount; ++split)
+        {
+            leftBounds = Union(leftBounds, binBounds[split - 1]);
+            leftCount += binCounts[split - 1];
+
+            if (leftCount == 0 || leftCount == end - begin)
+                continue;
+
+            const float cost = leftCount * SurfaceArea(leftBounds) + rightCosts[split];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = split;
+            }
+        }
+
+        if (bestSplit != 0)
+        {
+            auto split = std::partition(items.begin() + begin, items.begin() + end, [&](const RebuildItem& item) { return binOf(item) < bestSplit; });
+            middle = static_cast<uint32_t>(split - items.begin());
+        }
+    }
+
+    // Everything in one bin, split in the middle
+    if (middle == begin || middle == end)
+    {
+        middle = begin + (end - begin) / 2;
+        std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end, [&](const RebuildItem& a, const RebuildItem& b) {
+            return a.Centroid[axis] < b.Centroid[axis];
+        });
+    }
+
+    AABB childBounds[2];
+    const uint32_t children[2] = {
+        BuildSubtree(items, begin, middle, depth + 1, nodes, childBounds[0]),
+        BuildSubtree(items, middle, end, depth + 1, nodes, childBounds[1]),
+    };
+
+    for (uint32_t slot = 0; slot < 2; ++slot)
+    {
+        nodes[node].Children[slot] = children[slot];
+        WriteSlotBounds(nodes[node], slot, childBounds[slot]);
+
+        if ((children[slot] & s_LeafFlag) == 0)
+        {
+            nodes[children[slot]].Parent = node;
+            nodes[children[slot]].ParentSlot = slot;
+        }
+    }
+
+    bounds = Union(childBounds[0], childBounds[1]);
+    return node;
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#define GLM_FORCE_SSE42 1
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 1
+#define GLM_FORCE_LEFT_HANDED
+#include "glm/glm.hpp"
+
+#include "Nutcrackz/Core/ThreadPool.h"
+
+#include <cfloat>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+// Dynamic BVH
+
+struct AABB
+{
+    glm::vec3 Min = glm::vec3(0.0f);
+    glm::vec3 Max = glm::vec3(0.0f);
+};
+
+// Stable handle of an object in a DynamicBVH, reused after removal
+using BVHProxy = uint32_t;
+
+const BVHProxy s_InvalidProxy = ~0u;
+
+struct BVHRay
+{
+    glm::vec3 Origin = glm::vec3(0.0f);
+
+    // Need not be normalized, distances are in multiples of it
+    glm::vec3 Direction = glm::vec3(0.0f, 0.0f, 1.0f);
+
+    float MaxDistance = FLT_MAX;
+};
+
+struct BVHRayHit
+{
+    BVHProxy Proxy = s_InvalidProxy;
+    uint32_t UserData = 0;
+
+    // Where the ray enters the object's box, 0 when it starts inside
+    float Distance = 0.0f;
+};
+
+// A node holds the boxes of both its children, so visiting one reads a
+// single cache line and decides which children to descend into. Children
+// are node indices, or s_LeafFlag | proxy for objects.
+struct alignas(64) BVHNode
+{
+    float MinX[2], MinY[2], MinZ[2];
+    float MaxX[2], MaxY[2], MaxZ[2];
+
+    uint32_t Children[2];
+
+    // Next free node while unused
+    uint32_t Parent;
+    uint32_t ParentSlot;
+};
+
+static_assert(sizeof(BVHNode) == 64, "BVHNode must fill exactly one cache line");
+
+struct DynamicBVHDesc
+{
+    // The SAH cost is measured every this many updates that saw changes
+    uint32_t CostCheckInterval = 60;
+
+    // A rebuild starts once the SAH cost grew by this factor since the last
+    // one, through inserts, removes and moves
+    float RebuildCostRatio = 1.3f;
+};
+
+struct DynamicBVHStats
+{
+    uint32_t ObjectCount = 0;
+    uint32_t NodeCount = 0;
+
+    // Surface area heuristic cost of the tree as last measured, the summed
+    // area of its nodes relative to the root's, and right after the last
+    // rebuild
+    float Cost = 0.0f;
+    float RebuiltCost = 0.0f;
+
+    uint32_t Rebuilds = 0;
+
+    // Time the last rebuild took on its worker
+    float RebuildMs = 0.0f;
+};
+
+// Bounding volume hierarchy over object boxes for ray casts, picking and
+// region queries.
+//
+// Inserts, removes and moves update the tree in place in O(depth): inserts
+// descend along the cheapest SAH path, moves refit the boxes above the
+// object until one stops changing. The tree degrades as objects move, so
+// Update measures its SAH cost now and then and rebuilds it with binned SAH
+// on a worker thread, swapping the result in once it is done. Objects
+// changed meanwhile are patched into the new tree. Rebuilt trees store
+// their nodes depth first, keeping traversals mostly walking forward.
+//
+// Not thread safe, but any number of threads may query while nothing
+// modifies the tree.
+class DynamicBVH
+{
+  public:
+    DynamicBVH(const DynamicBVHDesc& desc = DynamicBVHDesc());
+
+    BVHProxy Insert(const AABB& bounds, uint32_t userData);
+    void Remove(BVHProxy proxy);
+    void Move(BVHProxy proxy, const AABB& bounds);
+
+    // Once per frame, installs a finished rebuild and starts a new one when
+    // the tree has degraded enough
+    void Update(ThreadPool& threadPool);
+
+    // Rebuild on the calling thread, for example after loading a level
+    void Rebuild();
+
+    // Closest object box the ray hits within its MaxDistance
+    bool RayCast(const BVHRay& ray, BVHRayHit& hit) const;
+
+    // Whether the ray hits any object box within its MaxDistance
+    bool RayOccluded(const BVHRay& ray) const;
+
+    // Closest hits of four rays traversing the tree together, testing each
+    // box against all of them at once. Pays off for coherent rays, such as
+    // neighbouring pixels. Returns a mask of the rays that hit.
+    uint32_t RayCastPacket(const BVHRay (&rays)[4], BVHRayHit (&hits)[4]) const;
+
+    // Appends every object whose box overlaps bounds
+    void QueryAABB(const AABB& bounds, std::vector<BVHProxy>& results) const;
+
+    const AABB& GetBounds(BVHProxy proxy) const { return m_Proxies[proxy].Bounds; }
+    uint32_t GetUserData(BVHProxy proxy) const { return m_Proxies[proxy].UserData; }
+
+    uint32_t GetObjectCount() const { return m_ObjectCount; }
+
+    const DynamicBVHStats& GetStats() const { return m_Stats; }
+
+  protected:
+    struct Proxy
+    {
+        AABB Bounds;
+        uint32_t UserData = 0;
+
+        // Node and slot holding the object, Node is the next free proxy
+        // while unused
+        uint32_t Node = s_NullNode;
+        uint32_t Slot = 0;
+
+        // Tells a reused proxy apart from the object a rebuild saw
+        uint32_t Generation = 0;
+        bool Alive = false;
+    };
+
+    // What a rebuild sees of an object
+    struct RebuildItem
+    {
+        AABB Bounds;
+        BVHProxy Proxy;
+        uint32_t Generation;
+
+        // Twice the box center, filled in by the build
+        float Centroid[3];
+    };
+
+    struct RebuildResult
+    {
+        // Leaves reference Items, not proxies
+        std::vector<RebuildItem> Items;
+        std::vector<BVHNode> Nodes;
+
+        float BuildMs = 0.0f;
+    };
+
+    uint32_t AllocateNode();
+    void FreeNode(uint32_t node);
+
+    // Point a slot at child and fix up the child's link back
+    void LinkSlot(uint32_t node, uint32_t slot, uint32_t child, const AABB& bounds);
+
+    void InsertLeaf(BVHProxy proxy);
+    void RemoveLeaf(uint32_t node, uint32_t slot);
+
+    // Recompute the boxes above node until one stays the same
+    void RefitUpward(uint32_t node);
+
+    float ComputeCost() const;
+
+    std::vector<RebuildItem> GatherRebuildItems() const;
+    void InstallRebuild(RebuildResult&& result);
+
+    // Binned SAH build, runs on a worker
+    static RebuildResult Build(std::vector<RebuildItem> items);
+    static uint32_t BuildSubtree(std::vector<RebuildItem>& items, uint32_t begin, uint32_t end, uint32_t depth, std::vector<BVHNode>& nodes, AABB& bounds);
+
+    static const uint32_t s_NullNode = ~0u;
+    static const uint32_t s_LeafFlag = 0x80000000u;
+
+    // Only the root has an empty slot, while it holds a single object
+    static const uint32_t s_EmptyChild = ~0u;
+
+    DynamicBVHDesc m_Desc;
+
+    std::vector<BVHNode> m_Nodes;
+    uint32_t m_Root = s_NullNode;
+    uint32_t m_FreeNode = s_NullNode;
+    uint32_t m_FreeNodeCount = 0;
+
+    std::vector<Proxy> m_Proxies;
+    BVHProxy m_FreeProxy = s_InvalidProxy;
+    uint32_t m_ObjectCount = 0;
+
+    // Updates since the cost was last measured that saw changes
+    uint32_t m_ChangedUpdates = 0;
+    bool m_Changed = false;
+
+    std::future<RebuildResult> m_Rebuild;
+
+    DynamicBVHStats m_Stats;
+};
@@ -0,0 +1,343 @@
+#include "SceneFile.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// Helper functions
+
+namespace
+{
+// Arrays start on a cache line, which also keeps the matrices aligned
+const uint64_t s_ArrayAlignment = 64;
+
+// The checksum covers everything from the file size on
+const uint64_t s_ChecksumStart = offsetof(SceneFileHeader, FileSize);
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Point array, stored at arrayAddress in the file, at data
+template <typename T>
+void WriteArray(std::vector<uint8_t>& file, uint64_t arrayAddress, uint64_t dataAddress, uint64_t count)
+{
+    SceneFileArray<T> array;
+    array.Offset = static_cast<int64_t>(dataAddress) - static_cast<int64_t>(arrayAddress);
+    array.Count = count;
+    memcpy(file.data() + arrayAddress, &array, sizeof(array));
+}
+
+SceneFileString MakeString(uint64_t stringAddress, uint64_t dataAddress, uint32_t length)
+{
+    SceneFileString string;
+    string.Offset = static_cast<int64_t>(dataAddress) - static_cast<int64_t>(stringAddress);
+    string.Length = length;
+    return string;
+}
+
+// Whether count elements of T at offset from base lie within the file
+template <typename T>
+bool ArrayInFile(const SceneFileArray<T>& array, const uint8_t* data, uint64_t size)
+{
+    const int64_t start = static_cast<int64_t>(reinterpret_cast<const uint8_t*>(&array) - data) + array.Offset;
+    if (start < 0 || static_cast<uint64_t>(start) > size || start % alignof(T) != 0)
+        return false;
+
+    return array.Count <= (size - static_cast<uint64_t>(start)) / sizeof(T);
+}
+
+SceneFileBounds TransformBounds(const AABB& bounds, const glm::mat4& transform)
+{
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    for (uint32_t corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec3 local = glm::vec3(corner & 1 ? bounds.Max.x : bounds.Min.x, corner & 2 ? bounds.Max.y : bounds.Min.y, corner & 4 ? bounds.Max.z : bounds.Min.z);
+        const glm::vec3 world = glm::vec3(transform * glm::vec4(local, 1.0f));
+
+        min = glm::min(min, world);
+        max = glm::max(max, world);
+    }
+
+    const glm::vec3 center = (min + max) * 0.5f;
+
+    SceneFileBounds result = {};
+    result.Center[0] = center.x;
+    result.Center[1] = center.y;
+    result.Center[2] = center.z;
+    result.Radius = glm::length(max - center);
+    result.Min[0] = min.x;
+    result.Min[1] = min.y;
+    result.Min[2] = min.z;
+    result.Max[0] = max.x;
+    result.Max[1] = max.y;
+    result.Max[2] = max.z;
+    return result;
+}
+}
+
+// Checksum
+
+uint64_t ComputeSceneFileChecksum(const uint8_t* data, uint64_t size)
+{
+    // FNV-1a over 64 bit words in four independent lanes, so the multiplies
+    // overlap instead of waiting on each other. Files are read at memory
+    // speed, which keeps checking them cheap next to mapping them.
+    const uint64_t prime = 0x100000001B3ull;
+    uint64_t lanes[4] = { 0xCBF29CE484222325ull, 0x84222325CBF29CE4ull, 0xE484222325CBF29Cull, 0x2325CBF29CE48422ull };
+
+    uint64_t offset = 0;
+    for (; offset + 32 <= size; offset += 32)
+    {
+        for (uint32_t lane = 0; lane < 4; ++lane)
+        {
+            uint64_t word;
+            memcpy(&word, data + offset + lane * 8, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+        }
+    }
+
+    for (; offset < size; ++offset)
+        lanes[0] = (lanes[0] ^ data[offset]) * prime;
+
+    uint64_t checksum = size;
+    for (uint64_t lane : lanes)
+        checksum = (checksum ^ lane) * prime;
+
+    return checksum;
+}
+
+// Scene File Builder
+
+uint32_t SceneFileBuilder::AddMesh(const std::string& name, uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    m_Meshes.push_back({ name, indexCount, startIndex, baseVertex });
+    return static_cast<uint32_t>(m_Meshes.size() - 1);
+}
+
+uint32_t SceneFileBuilder::AddMaterial(const std::string& name, const glm::vec4& baseColor, float roughness, float metallic)
+{
+    m_Materials.push_back({ name, baseColor, roughness, metallic });
+    return static_cast<uint32_t>(m_Materials.size() - 1);
+}
+
+uint32_t SceneFileBuilder::AddEntity(const std::string& name, uint32_t parent, const glm::mat4& localTransform, uint32_t mesh, uint32_t material, const AABB& localBounds)
+{
+    if (parent != s_SceneFileNone && parent >= m_Entities.size())
+        throw std::runtime_error("scene entity " + name + " has a parent that wasn't added before it!");
+
+    if (mesh != s_SceneFileNone && mesh >= m_Meshes.size())
+        throw std::runtime_error("scene entity " + name + " references an unknown mesh!");
+
+    if (material != s_SceneFileNone && material >= m_Materials.size())
+        throw std::runtime_error("scene entity " + name + " references an unknown material!");
+
+    m_Entities.push_back({ name, parent, localTransform, mesh, material, localBounds });
+    return static_cast<uint32_t>(m_Entities.size() - 1);
+}
+
+std::vector<uint8_t> SceneFileBuilder::Serialize() const
+{
+    const uint64_t entityCount = m_Entities.size();
+
+    // Every name with its terminator, back to back
+    uint64_t stringBytes = 0;
+    for (const Entity& entity : m_Entities)
+        stringBytes += entity.Name.size() + 1;
+    for (const Mesh& mesh : m_Meshes)
+        stringBytes += mesh.Name.size() + 1;
+    for (const Material& material : m_Materials)
+        stringBytes += material.Name.size() + 1;
+
+    // Lay the arrays out after the header
+    uint64_t size = sizeof(SceneFileHeader);
+    auto place = [&size](uint64_t bytes) {
+        const uint64_t address = AlignUp(size, s_ArrayAlignment);
+        size = address + bytes;
+        return address;
+    };
+
+    const uint64_t entities = place(entityCount * sizeof(SceneFileEntity));
+    const uint64_t localTransforms = place(entityCount * sizeof(glm::mat4));
+    const uint64_t worldTransforms = place(entityCount * sizeof(glm::mat4));
+    const uint64_t bounds = place(entityCount * sizeof(SceneFileBounds));
+    const uint64_t meshes = place(m_Meshes.size() * sizeof(SceneFileMesh));
+    const uint64_t materials = place(m_Materials.size() * sizeof(SceneFileMaterial));
+    const uint64_t strings = place(stringBytes);
+
+    std::vector<uint8_t> file(size, 0);
+
+    uint64_t stringAddress = strings;
+    auto addString = [&](uint64_t address, const std::string& string) {
+        memcpy(file.data() + stringAddress, string.c_str(), string.size() + 1);
+        const SceneFileString result = MakeString(address, stringAddress, static_cast<uint32_t>(string.size()));
+        stringAddress += string.size() + 1;
+        return result;
+    };
+
+    // Child lists are built back to front, so children keep the order they
+    // were added in
+    std::vector<SceneFileEntity> fileEntities(entityCount);
+    for (uint64_t i = entityCount; i-- > 0;)
+    {
+        const Entity& entity = m_Entities[i];
+        SceneFileEntity& fileEntity = fileEntities[i];
+
+        fileEntity.Name = addString(entities + i * sizeof(SceneFileEntity) + offsetof(SceneFileEntity, Name), entity.Name);
+        fileEntity.Parent = entity.Parent;
+        fileEntity.Mesh = entity.Mesh;
+        fileEntity.Material = entity.Material;
+
+        if (entity.Parent != s_SceneFileNone)
+        {
+            fileEntity.NextSibling = fileEntities[entity.Parent].FirstChild;
+            fileEntities[entity.Parent].FirstChild = static_cast<uint32_t>(i);
+        }
+    }
+
+    memcpy(file.data() + entities, fileEntities.data(), entityCount * sizeof(SceneFileEntity));
+
+    // Parents come first, so their world transform is always ready
+    std::vector<glm::mat4> worlds(entityCount);
+    for (uint64_t i = 0; i < entityCount; ++i)
+    {
+        const Entity& entity = m_Entities[i];
+        worlds[i] = entity.Parent != s_SceneFileNone ? worlds[entity.Parent] * entity.LocalTransform : entity.LocalTransform;
+
+        const SceneFileBounds worldBounds = TransformBounds(entity.LocalBounds, worlds[i]);
+
+        memcpy(file.data() + localTransforms + i * sizeof(glm::mat4), &entity.LocalTransform, sizeof(glm::mat4));
+        memcpy(file.data() + worldTransforms + i * sizeof(glm::mat4), &worlds[i], sizeof(glm::mat4));
+        memcpy(file.data() + bounds + i * sizeof(SceneFileBounds), &worldBounds, sizeof(SceneFileBounds));
+    }
+
+    for (uint64_t i = 0; i < m_Meshes.size(); ++i)
+    {
+        const Mesh& mesh = m_Meshes[i];
+        const uint64_t address = meshes + i * sizeof(SceneFileMesh);
+
+        SceneFileMesh fileMesh;
+        fileMesh.Name = addString(address + offsetof(SceneFileMesh, Name), mesh.Name);
+        fileMesh.IndexCount = mesh.IndexCount;
+        fileMesh.StartIndex = mesh.StartIndex;
+        fileMesh.BaseVertex = mesh.BaseVertex;
+        memcpy(file.data() + address, &fileMesh, sizeof(fileMesh));
+    }
+
+    for (uint64_t i = 0; i < m_Materials.size(); ++i)
+    {
+        const Material& material = m_Materials[i];
+        const uint64_t address = materials + i * sizeof(SceneFileMaterial);
+
+        SceneFileMaterial fileMaterial = {};
+        fileMaterial.Name = addString(address + offsetof(SceneFileMaterial, Name), material.Name);
+        fileMaterial.BaseColor[0] = material.BaseColor.r;
+        fileMaterial.BaseColor[1] = material.BaseColor.g;
+        fileMaterial.BaseColor[2] = material.BaseColor.b;
+        fileMaterial.BaseColor[3] = material.BaseColor.a;
+        fileMaterial.Roughness = material.Roughness;
+        fileMaterial.Metallic = material.Metallic;
+        fileMaterial.NormalScale = 1.0f;
+        fileMaterial.AlphaCutoff = 0.0f;
+        memcpy(file.data() + address, &fileMaterial, sizeof(fileMaterial));
+    }
+
+    WriteArray<SceneFileEntity>(file, offsetof(SceneFileHeader, Entities), entities, entityCount);
+    WriteArray<glm::mat4>(file, offsetof(SceneFileHeader, LocalTransforms), localTransforms, entityCount);
+    WriteArray<glm::mat4>(file, offsetof(SceneFileHeader, WorldTransforms), worldTransforms, entityCount);
+    WriteArray<SceneFileBounds>(file, offsetof(SceneFileHeader, Bounds), bounds, entityCount);
+    WriteArray<SceneFileMesh>(file, offsetof(SceneFileHeader, Meshes), meshes, m_Meshes.size());
+    WriteArray<SceneFileMaterial>(file, offsetof(SceneFileHeader, Materials), materials, m_Materials.size());
+    WriteArray<char>(file, offsetof(SceneFileHeader, Strings), strings, stringBytes);
+
+    const uint32_t magic = s_SceneFileMagic;
+    const uint32_t version = s_SceneFileVersion;
+    memcpy(file.data() + offsetof(SceneFileHeader, Magic), &magic, sizeof(magic));
+    memcpy(file.data() + offsetof(SceneFileHeader, Version), &version, sizeof(version));
+    memcpy(file.data() + offsetof(SceneFileHeader, FileSize), &size, sizeof(size));
+
+    // Last, it covers everything else
+    const uint64_t checksum = ComputeSceneFileChecksum(file.data() + s_ChecksumStart, size - s_ChecksumStart);
+    memcpy(file.data() + offsetof(SceneFileHeader, Checksum), &checksum, sizeof(checksum));
+
+    return file;
+}
+
+void SceneFileBuilder::Write(const std::string& path) const
+{
+    const std::vector<uint8_t> data = Serialize();
+
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file)
+        throw std::runtime_error("failed to open " + path + " for writing!");
+
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file)
+        throw std::runtime_error("failed to write " + path + "!");
+}
+
+// Scene File
+
+SceneFile::SceneFile(const std::string& path, bool verifyChecksum)
+    : m_File(path), m_Header(nullptr)
+{
+    try
+    {
+        m_Header = &Validate(m_File.GetData(), m_File.GetSize(), verifyChecksum);
+    }
+    catch (const std::runtime_error& error)
+    {
+        throw std::runtime_error(path + ": " + error.what());
+    }
+}
+
+const SceneFileHeader& SceneFile::Validate(const uint8_t* data, uint64_t size, bool verifyChecksum)
+{
+    if (!data || size < sizeof(SceneFileHeader))
+        throw std::runtime_error("too small for a scene file!");
+
+    // Mappings are page aligned, other buffers must be aligned enough for
+    // the matrices
+    if (reinterpret_cast<uintptr_t>(data) % alignof(glm::mat4) != 0)
+        throw std::runtime_error("scene file data isn't aligned!");
+
+    const SceneFileHeader& header = *reinterpret_cast<const SceneFileHeader*>(data);
+
+    if (header.Magic != s_SceneFileMagic)
+        throw std::runtime_error("not a scene file!");
+
+    if (header.Version != s_SceneFileVersion)
+        throw std::runtime_error("scene file version " + std::to_string(header.Version) + ", expected " + std::to_string(s_SceneFileVersion) + "!");
+
+    if (header.FileSize != size)
+        throw std::runtime_error("scene file is truncated!");
+
+    if (verifyChecksum && ComputeSceneFileChecksum(data + s_ChecksumStart, size - s_ChecksumStart) != header.Checksum)
+        throw std::runtime_error("scene file checksum doesn't match its contents!");
+
+    const uint64_t entityCount = header.Entities.Count;
+    const bool arraysInFile = ArrayInFile(header.Entities, data, size) && ArrayInFile(header.LocalTransforms, data, size) &&
+                              ArrayInFile(header.WorldTransforms, data, size) && ArrayInFile(header.Bounds, data, size) &&
+                              ArrayInFile(header.Meshes, data, size) && ArrayInFile(header.Materials, data, size) &&
+                              ArrayInFile(header.Strings, data, size);
+
+    if (!arraysInFile || header.LocalTransforms.Count != entityCount || header.WorldTransforms.Count != entityCount || header.Bounds.Count != entityCount)
+        throw std::runtime_error("scene file arrays are out of bounds!");
+
+    return header;
+}
+
+void SceneFile::ResolveMaterials(const std::function<uint32_t(const SceneFileMaterial&)>& resolve)
+{
+    m_MaterialHandles.clear();
+    m_MaterialHandles.reserve(m_Header->Materials.Count);
+
+    for (const SceneFileMaterial& material : m_Header->Materials)
+        m_MaterialHandles.push_back(resolve(material));
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#define GLM_FORCE_SSE42 1
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 1
+#define GLM_FORCE_LEFT_HANDED
+#include "glm/glm.hpp"
+
+#include "Nutcrackz/Core/MappedFile.h"
+#include "Nutcrackz/Scene/DynamicBVH.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Scene File
+
+// A binary snapshot of a scene that is used where it is mapped instead of
+// being parsed. Everything lives in flat arrays, and every reference inside
+// the file is an offset relative to where it is stored, so the file works at
+// any address without patching. Loading maps the file, checks its header and
+// checksum, and resolves the materials, nothing is done per entity.
+//
+// Entities are stored parents first, so walking the array in order visits a
+// parent before any of its children.
+
+// Count elements of T, Offset bytes from this array's own address
+template <typename T>
+struct SceneFileArray
+{
+    int64_t Offset = 0;
+    uint64_t Count = 0;
+
+    const T* begin() const { return reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(this) + Offset); }
+    const T* end() const { return begin() + Count; }
+
+    const T& operator[](uint64_t index) const { return begin()[index]; }
+
+    uint64_t size() const { return Count; }
+};
+
+// A null terminated string in the file's string data, Offset bytes from
+// this string's own address
+struct SceneFileString
+{
+    int64_t Offset = 0;
+    uint32_t Length = 0;
+    uint32_t Padding = 0;
+
+    const char* c_str() const { return reinterpret_cast<const char*>(this) + Offset; }
+};
+
+// Entities without a parent, mesh or material, and the end of a child list
+const uint32_t s_SceneFileNone = ~0u;
+
+struct SceneFileEntity
+{
+    SceneFileString Name;
+
+    // Always a lower index than the entity's own
+    uint32_t Parent = s_SceneFileNone;
+
+    uint32_t FirstChild = s_SceneFileNone;
+    uint32_t NextSibling = s_SceneFileNone;
+
+    // Index into the file's meshes and materials
+    uint32_t Mesh = s_SceneFileNone;
+    uint32_t Material = s_SceneFileNone;
+
+    uint32_t Padding[3] = {};
+};
+
+// World space bounds, the box for the BVH and the sphere for culling
+struct SceneFileBounds
+{
+    float Center[3];
+    float Radius;
+    float Min[3];
+    float Padding0;
+    float Max[3];
+    float Padding1;
+};
+
+// A range of the renderer's shared index and vertex buffers, like a
+// DrawPacket
+struct SceneFileMesh
+{
+    SceneFileString Name;
+    uint32_t IndexCount = 0;
+    uint32_t StartIndex = 0;
+    int32_t BaseVertex = 0;
+    uint32_t Padding = 0;
+};
+
+struct SceneFileMaterial
+{
+    SceneFileString Name;
+    float BaseColor[4];
+    float Roughness;
+    float Metallic;
+    float NormalScale;
+    float AlphaCutoff;
+};
+
+struct SceneFileHeader
+{
+    // s_SceneFileMagic and s_SceneFileVersion
+    uint32_t Magic;
+    uint32_t Version;
+
+    // Of every byte after this field, up to FileSize
+    uint64_t Checksum;
+
+    uint64_t FileSize;
+    uint64_t Padding;
+
+    SceneFileArray<SceneFileEntity> Entities;
+
+    // Parallel to Entities. World transforms are the local ones multiplied
+    // down the hierarchy when the file was written.
+    SceneFileArray<glm::mat4> LocalTransforms;
+    SceneFileArray<glm::mat4> WorldTransforms;
+    SceneFileArray<SceneFileBounds> Bounds;
+
+    SceneFileArray<SceneFileMesh> Meshes;
+    SceneFileArray<SceneFileMaterial> Materials;
+
+    // The names' characters
+    SceneFileArray<char> Strings;
+};
+
+static_assert(sizeof(SceneFileEntity) == 48, "SceneFileEntity is part of the file format");
+static_assert(sizeof(SceneFileBounds) == 48, "SceneFileBounds is part of the file format");
+static_assert(sizeof(SceneFileMesh) == 32, "SceneFileMesh is part of the file format");
+static_assert(sizeof(SceneFileMaterial) == 48, "SceneFileMaterial is part of the file format");
+static_assert(sizeof(SceneFileHeader) == 144, "SceneFileHeader is part of the file format");
+
+// "NSCN"
+const uint32_t s_SceneFileMagic = 0x4E43534E;
+
+// Files of any other version are rejected, bump it with every change to the
+// structures above
+const uint32_t s_SceneFileVersion = 1;
+
+// Collects a scene and writes it as a scene file
+class SceneFileBuilder
+{
+  public:
+    uint32_t AddMesh(const std::string& name, uint32_t indexCount, uint32_t startIndex, int32_t baseVertex);
+
+    uint32_t AddMaterial(const std::string& name, const glm::vec4& baseColor, float roughness = 0.5f, float metallic = 0.0f);
+
+    // Parent must have been added before, or be s_SceneFileNone. Bounds are
+    // in the entity's local space. Throws std::runtime_error for an unknown
+    // parent, mesh or material.
+    uint32_t AddEntity(const std::string& name, uint32_t parent, const glm::mat4& localTransform, uint32_t mesh, uint32_t material, const AABB& localBounds);
+
+    uint32_t GetEntityCount() const { return static_cast<uint32_t>(m_Entities.size()); }
+
+    // The file's bytes, with world transforms, world bounds and child lists
+    // filled in
+    std::vector<uint8_t> Serialize() const;
+
+    // Throws std::runtime_error if the file can't be written
+    void Write(const std::string& path) const;
+
+  protected:
+    struct Entity
+    {
+        std::string Name;
+        uint32_t Parent;
+        glm::mat4 LocalTransform;
+        uint32_t Mesh;
+        uint32_t Material;
+        AABB LocalBounds;
+    };
+
+    struct Mesh
+    {
+        std::string Name;
+        uint32_t IndexCount;
+        uint32_t StartIndex;
+        int32_t BaseVertex;
+    };
+
+    struct Material
+    {
+        std::string Name;
+        glm::vec4 BaseColor;
+        float Roughness;
+        float Metallic;
+    };
+
+    std::vector<Entity> m_Entities;
+    std::vector<Mesh> m_Meshes;
+    std::vector<Material> m_Materials;
+};
+
+// A mapped scene file. The arrays point straight into the mapping and stay
+// valid as long as the SceneFile does.
+class SceneFile
+{
+  public:
+    // Map path and check it. Throws std::runtime_error if it can't be read,
+    // isn't a scene file, was written by another version, or, when
+    // verifyChecksum is set, its contents don't match the checksum.
+    SceneFile(const std::string& path, bool verifyChecksum = true);
+
+    // The header of the scene file in data, after the same checks as the
+    // constructor. Array ranges are checked to lie within the file, names
+    // and indices inside the arrays are trusted once the checksum matches.
+    static const SceneFileHeader& Validate(const uint8_t* data, uint64_t size, bool verifyChecksum = true);
+
+    // The fixup pass: resolve calls resolve once per material, in order, and
+    // keeps what it returns for GetMaterialHandle
+    void ResolveMaterials(const std::function<uint32_t(const SceneFileMaterial&)>& resolve);
+
+    // What ResolveMaterials returned for the entity's material, fallback
+    // for entities without one
+    uint32_t GetMaterialHandle(const SceneFileEntity& entity, uint32_t fallback = 0) const
+    {
+        return entity.Material < m_MaterialHandles.size() ? m_MaterialHandles[entity.Material] : fallback;
+    }
+
+    uint32_t GetEntityCount() const { return static_cast<uint32_t>(m_Header->Entities.Count); }
+
+    const SceneFileArray<SceneFileEntity>& GetEntities() const { return m_Header->Entities; }
+    const SceneFileArray<glm::mat4>& GetLocalTransforms() const { return m_Header->LocalTransforms; }
+    const SceneFileArray<glm::mat4>& GetWorldTransforms() const { return m_Header->WorldTransforms; }
+    const SceneFileArray<SceneFileBounds>& GetBounds() const { return m_Header->Bounds; }
+    const SceneFileArray<SceneFileMesh>& GetMeshes() const { return m_Header->Meshes; }
+    const SceneFileArray<SceneFileMaterial>& GetMaterials() const { return m_Header->Materials; }
+
+  protected:
+    MappedFile m_File;
+    const SceneFileHeader* m_Header;
+
+    std::vector<uint32_t> m_MaterialHandles;
+};
+
+// Checksum of a scene file's contents, also usable on any other bytes
+uint64_t ComputeSceneFileChecksum(const uint8_t* data, uint64_t size);
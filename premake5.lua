@@ -1,8 +1,22 @@
 include "Dependencies.lua"
 
+newoption
+{
+	trigger = "vulkan",
+	description = "Generate the Engine and Benchmarks projects on Linux, with the experimental Vulkan renderer"
+}
+
+-- The Vulkan renderer hasn't been compiled or run on a device yet, so Linux
+-- only gets the CPU-only tools unless asked for it
+local includeRenderer = not os.istarget("linux") or _OPTIONS["vulkan"] ~= nil
+
+if not includeRenderer then
+	premake.warn("Skipping Engine and Benchmarks, the Vulkan renderer is experimental. Pass --vulkan to generate them.")
+end
+
 workspace "SimpleDirectX12Renderer"
 	conformancemode "On"
-	startproject "Engine"
+	startproject (includeRenderer and "Engine" or "Checks")
 
 	configurations
 	{
@@ -21,10 +35,20 @@ workspace "SimpleDirectX12Renderer"
 
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
-group "Dependencies"
-	include "Engine/vendor/crosswindow"
-group ""
+if includeRenderer then
+	group "Dependencies"
+		include "Engine/vendor/crosswindow"
+	group ""
+
+	group "Core"
+		include "Engine"
+	group ""
+end
 
-group "Core"
-	include "Engine"
+group "Tools"
+	include "Cooker"
+	if includeRenderer then
+		include "Benchmarks"
+	end
+	include "Checks"
 group ""
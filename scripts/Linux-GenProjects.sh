@@ -0,0 +1,6 @@
+#!/bin/sh
+# Needs premake5 on the PATH. Pass --vulkan for the Engine and Benchmarks
+# projects on the experimental Vulkan renderer, which need dxc, the Vulkan
+# SDK and libxcb to build.
+cd "$(dirname "$0")/.."
+premake5 "$@" gmake2